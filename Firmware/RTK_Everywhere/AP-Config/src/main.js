@@ -584,6 +584,9 @@ function parseIncoming(msg) {
                 }
             }
         }
+        else if (id.startsWith("rbStats")) {
+            ringBufferStatsAdd(id, val);
+        }
         //Strings generated by RTK unit
         else if (id.includes("sdFreeSpace")
             || id.includes("sdSize")
@@ -2651,6 +2654,25 @@ function removeBadChars(val) {
     return (val);
 }
 
+function getRingBufferStats() {
+    ge("ringBufferStatsTable").innerHTML = "";
+    websocket.send("getRingBufferStats,1,");
+}
+
+function resetRingBufferStats() {
+    ge("ringBufferStatsTable").innerHTML = "";
+    hide("ringBufferStatsDiv");
+    websocket.send("resetRingBufferStats,1,");
+}
+
+//Add a ring buffer statistic to the table, drop the rbStats prefix
+function ringBufferStatsAdd(id, val) {
+    var row = ge("ringBufferStatsTable").insertRow(-1);
+    row.insertCell(0).innerHTML = id.substring(7);
+    row.insertCell(1).innerHTML = val;
+    show("ringBufferStatsDiv");
+}
+
 function getFileList() {
     if (showingFileList == false) {
         showingFileList = true;
@@ -2,35 +2,36 @@
 
 Base.ino
 
-         RTCM Buffers
-    0   .-------------. <--- rtcmConsumerBufferPtr
-        |             |
-        |             |
-        |             |
-        |             |
-    1   +-------------+ <--- rtcmConsumerBufferTail
-        |  RTCM Data  |   |
-        |     xxx     |   V  rtcmConsumerBufferLengths[1]
-        |   -------   |  ---
-        |             |
-    2   +-------------+  ---
-        |  RTCM Data  |   |
-        |     yyy     |   V  rtcmConsumerBufferLengths[2]
-        |   -------   |  ---
-        |             |
-    3   +-------------+ <--- rtcmConsumerBufferHead
-        |             |
-        |             |
-        |             |
-        |             |
-    4   +-------------+
-              ***
-   15   +-------------+  --- rtcmConsumerBufferEntries - 1
-        |             |   |
-        |             |   | rtcmConsumerBufferEntrySize
-        |             |   |
-        |             |   V
-        '-------------'  ---  rtcmConsumerBufferEntries
+  The RTCM messages are not copied a second time.  processUart1Message records
+  the ring buffer offset and length of each RTCM message and the RTCM ring
+  buffer consumer (RBC_RTCM) sends the data directly from the ring buffer.
+  The RTCM consumer's tail keeps the data in the ring buffer until it is sent.
+
+     rtcmConsumerBuffer                              ringBuffer
+     Offset  Length  End                        .-----------------.
+    .-------.-------.---.                       |                 |
+    |       |       |   |                       |                 |
+    +-------+-------+---+ <--- Tail             +-----------------+
+    |   x   |  xxx  | 1 |---------------------->|    RTCM  xxx    |
+    +-------+-------+---+                       +-----------------+
+    |   y   |  yyy  | 0 |-------------.         |      NMEA       |
+    +-------+-------+---+ <--- Head   |         +-----------------+
+    |       |       |   |             '-------->|    RTCM  yyy    |
+    |       |       |   |                       +-----------------+ <--- dataHead
+    '-------'-------'---'                       |                 |
+                                                '-----------------'
+
+  The messages are packed in the ring buffer, the rtcmConsumerBuffer only
+  holds a small reference to each message.  The number of references is set
+  by settings.rtcmConsumerBufferEntries and is rounded up to a power of two.
+
+  Head and Tail are free running message counts, the reference index is the
+  count modulo the number of entries.  The End column marks the last MSM of
+  each epoch (multiple message bit clear).  When the references are full,
+  storeRTCMForConsumers discards the oldest complete epoch rather than the
+  newest message so that the epoch being received stays intact.  The tail
+  is moved with compare and swap since both the producer (eviction) and the
+  consumer (sendRTCMToConsumers) move it.
 
 Data Flow:
           GNSS Receiver
@@ -45,16 +46,16 @@ Data Flow:
     Tasks.ino/processUart1Message
                 |
                 V
-    Base.ino/processRTCM
+        Into the ring buffer
                 |
                 V
-    Base.ino/storeRTCMForConsumers(rtcmData, dataLength);
+    Base.ino/processRTCM
                 |
                 V
-        Into buffers above
+    Base.ino/storeRTCMForConsumers(offset, dataLength);
                 |
                 V
-    Tasks.ino/handleGnssDataTask
+    Tasks.ino/handleGnssDataTask or gnssDataConsumerTask
                 |
                 V
     Base.ino/sendRTCMToConsumers
@@ -64,55 +65,69 @@ Data Flow:
 
 =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=*/
 
-// Enough storage for two rounds of RTCM 1005,1074,1084,1094,1124
+#define RTCM_CONSUMER_BUFFER_ENTRIES_MIN    8
+#define RTCM_CONSUMER_BUFFER_ENTRIES_MAX    1024
+
+// Reference to an RTCM message in the ring buffer
+typedef struct _RTCM_CONSUMER_REFERENCE
+{
+    RING_BUFFER_OFFSET offset; // Start of the RTCM message in ringBuffer
+    uint16_t length;           // Length of the RTCM message
+    bool epochEnd;             // Last MSM of the epoch
+} RTCM_CONSUMER_REFERENCE;
+
+// Enough references for several rounds of RTCM 1005,1074,1084,1094,1124
 // To help prevent the "no increase in file size" and "due to lack of RTCM" glitch:
-// RTCM is stored in PSRAM by the processUart1Message task and written by sendRTCMToConsumers
-const uint8_t rtcmConsumerBufferEntries = 16;
-const uint16_t rtcmConsumerBufferEntrySize = 1032; // RTCM can be up to 1024 + 6 bytes
-uint16_t rtcmConsumerBufferLengths[rtcmConsumerBufferEntries];
-volatile uint8_t rtcmConsumerBufferHead;
-volatile uint8_t rtcmConsumerBufferTail;
-uint8_t *rtcmConsumerBufferPtr = nullptr;
+// The references are added by the processUart1Message task and removed by sendRTCMToConsumers
+static RTCM_CONSUMER_REFERENCE *rtcmConsumerBuffer; // Allocated by rtcmConsumerBufferBegin
+static uint32_t rtcmConsumerBufferEntries;          // Power of two
+static volatile uint32_t rtcmConsumerBufferHead;    // Messages added
+static volatile uint32_t rtcmConsumerBufferTail;    // Messages sent or discarded
+
+// Overflow metrics, shared by all of the RTCM links
+static volatile uint32_t rtcmConsumerMessagesEvicted; // Messages discarded with the oldest epochs
+static volatile uint32_t rtcmConsumerEpochsEvicted;   // Oldest epochs discarded when the references were full
+static volatile uint32_t rtcmConsumerMessagesLost;    // Messages discarded with the ring buffer data
+static volatile uint32_t rtcmConsumerHighWater;       // Maximum number of references in use
+static uint32_t rtcmConsumerMessagesEvictedSeen;      // Evictions seen by sendRTCMToConsumers
+
+// RTCM Tail advances as the RTCM is sent to the consumers
+static volatile RING_BUFFER_OFFSET rtcmRingBufferTail;
 
 //----------------------------------------
-// Allocate and initialize the rtcmConsumerBuffer
+// Allocate the RTCM message references
 //----------------------------------------
-bool rtcmConsumerBufferAllocated()
+void rtcmConsumerBufferBegin()
 {
-    size_t bufferLength;
+    uint32_t entries;
 
-    if (rtcmConsumerBufferPtr == nullptr)
-    {
-        bufferLength = (size_t)rtcmConsumerBufferEntrySize * (size_t)rtcmConsumerBufferEntries;
-        rtcmConsumerBufferPtr = (uint8_t *)rtkMalloc(bufferLength, "ntripBuffer");
-        for (uint8_t i = 0; i < rtcmConsumerBufferEntries; i++)
-            rtcmConsumerBufferLengths[i] = 0;
-        rtcmConsumerBufferHead = 0;
-        rtcmConsumerBufferTail = 0;
-        if (settings.debugRtcmBuffers && rtcmConsumerBufferPtr)
-            systemPrintf("RTCM buffer allocated: %p, %d bytes\r\n", rtcmConsumerBufferPtr, bufferLength);
-    }
-    if (rtcmConsumerBufferPtr == nullptr)
+    // Only allocated once, the ring buffer may grow but the references do not
+    if (rtcmConsumerBuffer)
+        return;
+
+    // Round the number of entries up to a power of two
+    entries = RTCM_CONSUMER_BUFFER_ENTRIES_MIN;
+    while ((entries < settings.rtcmConsumerBufferEntries) && (entries < RTCM_CONSUMER_BUFFER_ENTRIES_MAX))
+        entries <<= 1;
+
+    rtcmConsumerBuffer = (RTCM_CONSUMER_REFERENCE *)rtkMalloc(entries * sizeof(RTCM_CONSUMER_REFERENCE),
+                                                              "RTCM references (rtcmConsumerBuffer)");
+    if (!rtcmConsumerBuffer)
     {
-        systemPrintln("rtcmConsumerBuffer malloc failed!");
-        return false;
+        systemPrintln("ERROR: Failed to allocate the RTCM references!");
+        return;
     }
-
-    return true;
+    rtcmConsumerBufferTail = rtcmConsumerBufferHead;
+    __atomic_store_n(&rtcmConsumerBufferEntries, entries, __ATOMIC_RELEASE);
 }
 
 //----------------------------------------
-// Check how many RTCM buffers contain data
+// Check how many RTCM messages are waiting to be sent
 //----------------------------------------
-uint8_t rtcmBuffersInUse()
+uint32_t rtcmBuffersInUse()
 {
-    if (!rtcmConsumerBufferAllocated())
-        return 0;
-
-    uint8_t buffersInUse = rtcmConsumerBufferHead - rtcmConsumerBufferTail;
-    if (buffersInUse >= rtcmConsumerBufferEntries) // Wrap if Tail is > Head
-        buffersInUse += rtcmConsumerBufferEntries;
-    return buffersInUse;
+    return __atomic_load_n(&rtcmConsumerBufferHead, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&rtcmConsumerBufferTail, __ATOMIC_ACQUIRE);
 }
 
 //----------------------------------------
@@ -124,63 +139,229 @@ bool rtcmDataAvailable()
 }
 
 //----------------------------------------
-// Store each RTCM message in a PSRAM buffer
-// This function gets called as each complete RTCM message comes in
-// The messages are written to the servers by sendRTCMToConsumers
+// Determine if the RTCM message in the ring buffer is the last MSM of the epoch
 //----------------------------------------
-void storeRTCMForConsumers(uint8_t *rtcmData, uint16_t dataLength)
+bool rtcmConsumerEpochEnd(RING_BUFFER_OFFSET offset, uint16_t dataLength)
 {
-    if (!rtcmConsumerBufferAllocated())
-        return;
+    uint8_t header[RTCM_FRAME_HEADER_LENGTH + ((RTCM_MSM_MULTIPLE_BIT + 8) >> 3)];
+    uint16_t messageNumber;
+
+    if (dataLength < sizeof(header))
+        return false;
 
-    // Check if a buffer is available
-    if (rtcmBuffersInUse() < (rtcmConsumerBufferEntries - 1))
+    // Get the start of the message, through the MSM multiple message bit
+    for (int index = 0; index < (int)sizeof(header); index++)
     {
-        uint8_t *dest = rtcmConsumerBufferPtr;
-        dest += (size_t)rtcmConsumerBufferEntrySize * (size_t)rtcmConsumerBufferHead;
-        memcpy(dest, rtcmData, dataLength); // Store the RTCM
-        rtcmConsumerBufferLengths[rtcmConsumerBufferHead] = dataLength; // Store the length
-        if (settings.debugRtcmBuffers)
-            systemPrintf("Filling RTCM Buffer %d: %4d bytes\r\n", rtcmConsumerBufferHead, dataLength);
-        rtcmConsumerBufferHead = rtcmConsumerBufferHead + 1; // Increment the Head
-        rtcmConsumerBufferHead = rtcmConsumerBufferHead % rtcmConsumerBufferEntries; // Wrap
+        header[index] = ringBuffer[offset++];
+        if (offset >= ringBufferSize)
+            offset = 0;
     }
-    else
+    messageNumber = rtcmGetBits(&header[RTCM_FRAME_HEADER_LENGTH], 0, 12);
+    return rtcmIsMsm(messageNumber) &&
+           (rtcmGetBits(&header[RTCM_FRAME_HEADER_LENGTH], RTCM_MSM_MULTIPLE_BIT, 1) == 0);
+}
+
+//----------------------------------------
+// Discard the oldest epoch to make room for a new RTCM message
+// Called by storeRTCMForConsumers when all of the references are in use
+//----------------------------------------
+void rtcmConsumerEvictEpoch()
+{
+    bool epochEnd;
+    uint32_t head;
+    uint32_t mask;
+    uint32_t messages;
+    uint32_t newTail;
+    uint32_t tail;
+
+    head = rtcmConsumerBufferHead;
+    mask = rtcmConsumerBufferEntries - 1;
+    tail = __atomic_load_n(&rtcmConsumerBufferTail, __ATOMIC_ACQUIRE);
+    do
     {
-        if (settings.debugNtripServerRtcm && (!inMainMenu))
-            systemPrintln("rtcmConsumerBuffer full. RTCM lost");
-    }
+        // sendRTCMToConsumers may have made room
+        if ((head - tail) < rtcmConsumerBufferEntries)
+            return;
+
+        // Locate the end of the oldest epoch
+        epochEnd = false;
+        newTail = tail;
+        while ((newTail != head) && (epochEnd == false))
+            epochEnd = rtcmConsumerBuffer[newTail++ & mask].epochEnd;
+
+        // Without a complete epoch, all of the references belong to the
+        // epoch being received, discard the oldest message
+        if (epochEnd == false)
+            newTail = tail + 1;
+
+        // sendRTCMToConsumers may move the tail at any time
+    } while (!__atomic_compare_exchange_n(&rtcmConsumerBufferTail, &tail, newTail, false, __ATOMIC_ACQ_REL,
+                                          __ATOMIC_ACQUIRE));
+
+    // Account for the discarded messages
+    messages = newTail - tail;
+    rtcmConsumerMessagesEvicted = rtcmConsumerMessagesEvicted + messages;
+    if (epochEnd)
+        rtcmConsumerEpochsEvicted = rtcmConsumerEpochsEvicted + 1;
+    if (settings.debugNtripServerRtcm && (!inMainMenu))
+        systemPrintf("rtcmConsumerBuffer full. %lu RTCM messages lost\r\n", messages);
 }
 
 //----------------------------------------
-// Send the stored RTCM to consumers: ntripServer, LoRa and ESP-NOW
+// Remember the location of each RTCM message in the ring buffer
+// This function gets called as each complete RTCM message is placed in the ring buffer
+// The messages are written to the servers by sendRTCMToConsumers
 //----------------------------------------
-void sendRTCMToConsumers()
+void storeRTCMForConsumers(RING_BUFFER_OFFSET offset, uint16_t dataLength)
 {
-    if (!rtcmConsumerBufferAllocated())
+    uint32_t head;
+    uint32_t inUse;
+    RTCM_CONSUMER_REFERENCE *reference;
+
+    if (rtcmConsumerBufferEntries == 0)
         return;
 
-    while (rtcmConsumerBufferHead != rtcmConsumerBufferTail)
+    // Make room by discarding the oldest epoch
+    if (rtcmBuffersInUse() >= rtcmConsumerBufferEntries)
+        rtcmConsumerEvictEpoch();
+
+    // Store the reference
+    head = rtcmConsumerBufferHead;
+    reference = &rtcmConsumerBuffer[head & (rtcmConsumerBufferEntries - 1)];
+    reference->offset = offset;     // Store the location
+    reference->length = dataLength; // Store the length
+    reference->epochEnd = rtcmConsumerEpochEnd(offset, dataLength);
+    if (settings.debugRtcmBuffers)
+        systemPrintf("Filling RTCM Buffer %lu: %4d bytes @ %d\r\n", head & (rtcmConsumerBufferEntries - 1), dataLength,
+                     offset);
+
+    // Publish the reference after the offset and length
+    __atomic_store_n(&rtcmConsumerBufferHead, head + 1, __ATOMIC_RELEASE);
+
+    // Remember the maximum number of references in use
+    inUse = rtcmBuffersInUse();
+    if (rtcmConsumerHighWater < inUse)
+        rtcmConsumerHighWater = inUse;
+}
+
+//----------------------------------------
+// Display the RTCM reference usage and losses
+//----------------------------------------
+void rtcmConsumerPrintStats()
+{
+    systemPrintf("RTCM references: %lu in use, %lu high water, %lu entries\r\n", rtcmBuffersInUse(),
+                 rtcmConsumerHighWater, rtcmConsumerBufferEntries);
+    systemPrintf("RTCM dropped: %lu epochs (%lu messages) when full, %lu messages with ring buffer data\r\n",
+                 rtcmConsumerEpochsEvicted, rtcmConsumerMessagesEvicted, rtcmConsumerMessagesLost);
+}
+
+//----------------------------------------
+// Start an RTCM message on one of the consumers: ntripServer, LoRa or ESP-NOW
+//----------------------------------------
+void rtcmConsumerMessageBegin(int link, uint16_t dataLength)
+{
+    // NTRIP Server
+    if (link < RTCM_LINK_NTRIP_SERVER_MAX)
+        ntripServerRtcmMessageBegin(link - RTCM_LINK_NTRIP_SERVER, dataLength);
+
+    // LoRa
+    else if (link == RTCM_LINK_LORA)
+        loraRtcmMessageBegin(dataLength);
+
+    // ESP-NOW
+    else if (link == RTCM_LINK_ESPNOW)
+        espNowRtcmMessageBegin(dataLength);
+}
+
+//----------------------------------------
+// Pass a piece of an RTCM message to one of the consumers: ntripServer, LoRa or ESP-NOW
+//----------------------------------------
+void rtcmConsumerWrite(int link, uint8_t *data, uint16_t dataLength)
+{
+    // NTRIP Server
+    if (link < RTCM_LINK_NTRIP_SERVER_MAX)
+        ntripServerSendRTCM(link - RTCM_LINK_NTRIP_SERVER, data, dataLength);
+
+    // LoRa
+    else if (link == RTCM_LINK_LORA)
+        loraProcessRTCM(data, dataLength);
+
+    // ESP-NOW
+    else if (link == RTCM_LINK_ESPNOW)
+        espNowProcessRTCM(data, dataLength);
+}
+
+//----------------------------------------
+// Send the stored RTCM to consumers: ntripServer, LoRa and ESP-NOW
+// Called by ringBufferSendData for RBC_RTCM, returns the amount of data remaining
+// in the ring buffer for this consumer
+//----------------------------------------
+int32_t sendRTCMToConsumers(RING_BUFFER_OFFSET head)
+{
+    int32_t bytesInRingBuffer;
+    size_t dataLength;
+    uint32_t expected;
+    uint32_t mask;
+    RING_BUFFER_OFFSET newRtcmTail;
+    RING_BUFFER_OFFSET offset;
+    RTCM_CONSUMER_REFERENCE *reference;
+    unsigned long startMillis;
+    uint32_t tail;
+
+    startMillis = millis();
+    newRtcmTail = rtcmRingBufferTail;
+    bytesInRingBuffer = ringBufferBytes(rtcmRingBufferTail, head);
+    mask = rtcmConsumerBufferEntries - 1;
+    tail = __atomic_load_n(&rtcmConsumerBufferTail, __ATOMIC_ACQUIRE);
+    while (tail != __atomic_load_n(&rtcmConsumerBufferHead, __ATOMIC_ACQUIRE))
     {
-        uint8_t *dest = rtcmConsumerBufferPtr;
-        dest += (size_t)rtcmConsumerBufferEntrySize * (size_t)rtcmConsumerBufferTail;
-        size_t dataLength = rtcmConsumerBufferLengths[rtcmConsumerBufferTail];
-        if (settings.debugRtcmBuffers)
-            systemPrintf("Sending RTCM Buffer %d: %4d bytes\r\n", rtcmConsumerBufferTail, dataLength);
+        reference = &rtcmConsumerBuffer[tail & mask];
+        offset = reference->offset;
+        dataLength = reference->length;
+
+        // storeRTCMForConsumers may have discarded this message and reused the reference
+        expected = __atomic_load_n(&rtcmConsumerBufferTail, __ATOMIC_ACQUIRE);
+        if (expected != tail)
+        {
+            tail = expected;
+            continue;
+        }
 
-        // NTRIP Server
-        for (int serverIndex = 0; serverIndex < NTRIP_SERVER_MAX; serverIndex++)
-            ntripServerSendRTCM(serverIndex, dest, dataLength);
+        // Messages at or beyond the head were added after the head was read
+        if (ringBufferBytes(rtcmRingBufferTail, offset) >= bytesInRingBuffer)
+            break;
 
-        // LoRa
-        loraProcessRTCM(dest, dataLength);
+        // The link rules restart with the next epoch after messages were discarded
+        if (rtcmConsumerMessagesEvictedSeen != rtcmConsumerMessagesEvicted)
+        {
+            rtcmConsumerMessagesEvictedSeen = rtcmConsumerMessagesEvicted;
+            rtcmLinkEpochLost();
+        }
+
+        if (settings.debugRtcmBuffers)
+            systemPrintf("Sending RTCM Buffer %lu: %4d bytes @ %d\r\n", tail & mask, dataLength, offset);
+
+        // Send the message directly from the ring buffer, in two pieces when it wraps
+        // The link rules select the messages for each consumer
+        size_t bytesToEnd = ringBufferSize - offset;
+        if (dataLength <= bytesToEnd)
+            rtcmLinkSend(&ringBuffer[offset], dataLength, nullptr, 0);
+        else
+            rtcmLinkSend(&ringBuffer[offset], bytesToEnd, ringBuffer, dataLength - bytesToEnd);
 
-        // ESP-NOW
-        for (uint16_t x = 0; x < dataLength; x++)
-            espNowProcessRTCM(dest[x]);
+        // The RTCM data through the end of this message was sent
+        if (dataLength < bytesToEnd)
+            newRtcmTail = offset + dataLength;
+        else
+            newRtcmTail = dataLength - bytesToEnd;
 
-        rtcmConsumerBufferTail = rtcmConsumerBufferTail + 1; // Increment the Tail
-        rtcmConsumerBufferTail = rtcmConsumerBufferTail % rtcmConsumerBufferEntries; // Wrap
+        // Release the reference, storeRTCMForConsumers may have discarded it meanwhile
+        expected = tail;
+        if (__atomic_compare_exchange_n(&rtcmConsumerBufferTail, &expected, tail + 1, false, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE))
+            tail += 1;
+        else
+            tail = expected;
 
         // Account for this packet
         rtcmLastPacketSent = millis();
@@ -198,15 +379,84 @@ void sendRTCMToConsumers()
                 rtcmPacketsSent = 1; // Trim to three digits to avoid log icon and increasing bar
         }
     }
+
+    // Send the partial ESP-NOW frame at the end of the RTCM messages
+    espNowRtcmFlush();
+
+    if ((millis() - startMillis) > RTCM_CORRECTION_WRITE_TIMEOUT)
+    {
+        uint32_t milliseconds = millis() - startMillis;
+        uint32_t seconds = milliseconds / MILLISECONDS_IN_A_SECOND;
+        milliseconds -= seconds * MILLISECONDS_IN_A_SECOND;
+        systemPrintf("\aWARNING: RTCM writes took %d.%03d seconds!\r\n", seconds, milliseconds);
+    }
+
+    // Move the RTCM tail past the messages that were sent.  processUart1Message
+    // stores the reference before publishing dataHead, so when no references
+    // remain, all of the RTCM before the head was sent and the next message
+    // starts at or after the head.
+    if (tail == __atomic_load_n(&rtcmConsumerBufferHead, __ATOMIC_ACQUIRE))
+        newRtcmTail = head;
+    rtcmRingBufferTail = newRtcmTail;
+    return 0;
+}
+
+//----------------------------------------
+// Remove the references to the RTCM messages discarded from the ring buffer
+//----------------------------------------
+void rtcmConsumerDiscardBytes(RING_BUFFER_OFFSET previousTail, RING_BUFFER_OFFSET newTail)
+{
+    uint32_t head;
+    uint32_t mask;
+    uint32_t tail;
+    uint32_t newRtcmTail;
+
+    if (previousTail == newTail)
+        return;
+
+    // Drop the messages starting in the discarded data
+    mask = rtcmConsumerBufferEntries - 1;
+    tail = __atomic_load_n(&rtcmConsumerBufferTail, __ATOMIC_ACQUIRE);
+    do
+    {
+        head = __atomic_load_n(&rtcmConsumerBufferHead, __ATOMIC_ACQUIRE);
+        newRtcmTail = tail;
+        while ((newRtcmTail != head) &&
+               ringBufferTailInRange(rtcmConsumerBuffer[newRtcmTail & mask].offset, previousTail, newTail))
+            newRtcmTail += 1;
+
+        // storeRTCMForConsumers may discard the oldest epoch at any time
+    } while ((newRtcmTail != tail) &&
+             (!__atomic_compare_exchange_n(&rtcmConsumerBufferTail, &tail, newRtcmTail, false, __ATOMIC_ACQ_REL,
+                                           __ATOMIC_ACQUIRE)));
+
+    if (newRtcmTail != tail)
+    {
+        rtcmConsumerMessagesLost = rtcmConsumerMessagesLost + (newRtcmTail - tail);
+        if (settings.debugNtripServerRtcm && (!inMainMenu))
+            systemPrintf("%lu RTCM Buffers discarded from ring buffer. RTCM lost\r\n", newRtcmTail - tail);
+    }
+    if (ringBufferTailInRange(rtcmRingBufferTail, previousTail, newTail))
+        rtcmRingBufferTail = newTail;
+}
+
+//----------------------------------------
+// Discard the RTCM references when the ring buffer is reset
+//----------------------------------------
+void rtcmConsumerZeroTail()
+{
+    rtcmRingBufferTail = 0;
+    __atomic_store_n(&rtcmConsumerBufferTail, rtcmConsumerBufferHead, __ATOMIC_RELEASE);
 }
 
 //----------------------------------------
 // Store data ready to be passed along to NTRIP Server, or ESP-NOW radio
 // This function gets called when an RTCM packet passes parser check in processUart1Message() task
+// and is placed in the ring buffer at offset
 //----------------------------------------
-void processRTCM(uint8_t *rtcmData, uint16_t dataLength)
+void processRTCM(RING_BUFFER_OFFSET offset, uint16_t dataLength)
 {
-    storeRTCMForConsumers(rtcmData, dataLength);
+    storeRTCMForConsumers(offset, dataLength);
 }
 
 //------------------------------
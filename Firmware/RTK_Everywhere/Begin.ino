@@ -977,14 +977,25 @@ void beginGnssUart()
     size_t length;
     TaskHandle_t taskHandle;
 
+    // Size the ring buffer and UART buffer from the GNSS data rate
+    if (rbOffsetArray == nullptr)
+    {
+        ringBufferSize = settings.gnssHandlerBufferSize;
+        gnssUartReceiveBufferSize = settings.uartReceiveBufferSize;
+        ringBufferAutoSize();
+    }
+
+    // Allocate the references to the RTCM messages in the ring buffer
+    rtcmConsumerBufferBegin();
+
     // Determine the length of data to be retained in the ring buffer
     // after discarding the oldest data
-    length = settings.gnssHandlerBufferSize;
-    rbOffsetEntries = (length >> 1) / AVERAGE_SENTENCE_LENGTH_IN_BYTES;
-    length = settings.gnssHandlerBufferSize + (rbOffsetEntries * sizeof(RING_BUFFER_OFFSET));
+    length = ringBufferSize;
+    rbOffsetEntries = ringBufferOffsetEntries(length);
+    length = ringBufferSize + (rbOffsetEntries * (sizeof(RING_BUFFER_OFFSET) + sizeof(uint8_t)));
     ringBuffer = nullptr;
 
-    // Never freed...
+    // Only freed by ringBufferGrow when replacing the ring buffer
     if (rbOffsetArray == nullptr)
         rbOffsetArray = (RING_BUFFER_OFFSET *)rtkMalloc(length, "Ring buffer (rbOffsetArray)");
 
@@ -995,7 +1006,8 @@ void beginGnssUart()
     }
     else
     {
-        ringBuffer = (uint8_t *)&rbOffsetArray[rbOffsetEntries];
+        rbConsumerArray = (uint8_t *)&rbOffsetArray[rbOffsetEntries];
+        ringBuffer = &rbConsumerArray[rbOffsetEntries];
         rbOffsetArray[0] = 0;
 
         if (task.gnssUartPinnedTaskRunning == false)
@@ -1086,7 +1098,7 @@ void pinGnssUartTask(void *pvParameters)
     if (serialGNSS == nullptr)
         serialGNSS = new HardwareSerial(1);
 
-    serialGNSS->setRxBufferSize(settings.uartReceiveBufferSize);
+    serialGNSS->setRxBufferSize(gnssUartReceiveBufferSize);
     serialGNSS->setTimeout(settings.serialTimeoutGNSS); // Requires serial traffic on the UART pins for detection
 
     if (pin_GnssUart_RX == PIN_UNDEFINED || pin_GnssUart_TX == PIN_UNDEFINED)
@@ -1104,6 +1116,7 @@ void pinGnssUartTask(void *pvParameters)
 
     // Reduce threshold value above which RX FIFO full interrupt is generated
     // Allows more time between when the UART interrupt occurs and when the FIFO buffer overruns
+    // Each interrupt also wakes gnssReadTask, see gnssReadUartEvent
     serialGNSS->setRxFIFOFull(settings.serialGNSSRxFullThreshold);
 
     // Stop notification
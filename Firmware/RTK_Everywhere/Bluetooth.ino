@@ -162,7 +162,7 @@ byte bluetoothGetState()
     return bluetoothState;
 }
 
-// Read data from the Bluetooth device
+// Read the available data from the Bluetooth device, does not wait for more data
 int bluetoothRead(uint8_t *buffer, int length)
 {
     if (bluetoothGetState() == BT_OFF)
@@ -175,7 +175,7 @@ int bluetoothRead(uint8_t *buffer, int length)
         // Give incoming BLE the priority
         if (bluetoothSerialBle)
         {
-            bytesRead = bluetoothSerialBle->readBytes(buffer, length);
+            bytesRead = bluetoothSerialBle->read(buffer, length);
         }
 
         if (bytesRead > 0)
@@ -186,17 +186,17 @@ int bluetoothRead(uint8_t *buffer, int length)
             return 0;
 
         if (bluetoothSerialSpp)
-            return (bluetoothSerialSpp->readBytes(buffer, length));
+            return (bluetoothSerialSpp->read(buffer, length));
     }
     else if (settings.bluetoothRadioType == BLUETOOTH_RADIO_SPP)
     {
         if (bluetoothSerialSpp)
-            return bluetoothSerialSpp->readBytes(buffer, length);
+            return bluetoothSerialSpp->read(buffer, length);
     }
     else if (settings.bluetoothRadioType == BLUETOOTH_RADIO_BLE)
     {
         if (bluetoothSerialBle)
-            return bluetoothSerialBle->readBytes(buffer, length);
+            return bluetoothSerialBle->read(buffer, length);
     }
 
     return 0;
@@ -364,6 +364,59 @@ int bluetoothWrite(const uint8_t *buffer, int length)
     return (0);
 }
 
+// Determine if the GNSS data should be sent over SPP, used by the RBC_BLUETOOTH consumer
+bool bluetoothSppIsConnected()
+{
+    if (bluetoothGetState() == BT_OFF)
+        return (false);
+
+    // Accessory needs exclusive access to SPP
+    if ((settings.bluetoothRadioType == BLUETOOTH_RADIO_SPP_AND_BLE) && sppAccessoryMode)
+        return (false);
+
+    if ((settings.bluetoothRadioType == BLUETOOTH_RADIO_SPP_AND_BLE) ||
+        (settings.bluetoothRadioType == BLUETOOTH_RADIO_SPP))
+        return (bluetoothSerialSpp && bluetoothSerialSpp->connected());
+    return (false);
+}
+
+// Determine if the GNSS data should be sent over BLE, used by the RBC_BLE consumer
+bool bluetoothBleIsConnected()
+{
+    if (bluetoothGetState() == BT_OFF)
+        return (false);
+
+    if ((settings.bluetoothRadioType == BLUETOOTH_RADIO_SPP_AND_BLE) ||
+        (settings.bluetoothRadioType == BLUETOOTH_RADIO_BLE))
+        return (bluetoothSerialBle && bluetoothSerialBle->connected());
+    return (false);
+}
+
+// Write the GNSS data to the SPP interface, returns the number of bytes accepted
+int bluetoothWriteSpp(const uint8_t *buffer, int length)
+{
+    if (bluetoothSerialSpp && length)
+        return bluetoothSerialSpp->write(buffer, length);
+    return (0);
+}
+
+// Write the GNSS data to the BLE interface, returns the number of bytes accepted
+int bluetoothWriteBle(const uint8_t *buffer, int length)
+{
+    // BLE write does not handle 0 length requests correctly
+    if (bluetoothSerialBle && length)
+        return bluetoothSerialBle->write(buffer, length);
+    return (0);
+}
+
+// Determine the number of data bytes in a BLE notification
+int bluetoothBleNotifyBytes()
+{
+    if (bluetoothSerialBle)
+        return bluetoothSerialBle->maxWriteSize();
+    return (BLE_NOTIFY_DEFAULT_BYTES);
+}
+
 // Write data to the BLE Command interface
 int bluetoothCommandWrite(const uint8_t *buffer, int length)
 {
@@ -1012,6 +1065,9 @@ void bluetoothPrintStatus()
     }
 
     systemPrintln();
+
+    if (bluetoothSerialSpp && bluetoothSerialSpp->rxOverflow())
+        systemPrintf("Bluetooth SPP RX overflow: %lu bytes discarded\r\n", bluetoothSerialSpp->rxOverflow());
 }
 
 // Send over dedicated BLE service
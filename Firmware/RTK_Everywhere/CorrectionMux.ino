@@ -0,0 +1,511 @@
+/*=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+CorrectionMux.ino
+
+  Single writer for the correction data sent to the GNSS.  The correction
+  sources run in different contexts:
+
+    * loop: NTRIP client, LoRa, USB serial, PointPerfect Library, MQTT
+    * WiFi task: ESP-NOW
+    * btReadTask: Bluetooth
+
+  Each source places its data into its own queue with correctionPushRawData.
+  Only the source selected by correctionLastSeen is copied, data from the
+  other sources is dropped before the copy.  RTCM data is released to the
+  writer one whole frame at a time, so the frames from different sources are
+  never interleaved on the GNSS UART.  After RTCM data is dropped the source
+  data is discarded until a frame with a valid CRC is received, so the end of
+  an interrupted frame is never written to the GNSS.
+
+    NTRIP Client ---> Queue ---.
+                               |
+    ESP-NOW -------> Queue ----+
+                               |     correctionMuxTask
+    Bluetooth -----> Queue ----+---> (selected source) ---> pushRawData ---> GNSS
+                               |
+    ...            > Queue ----'
+
+  The ZED is connected via I2C and its library is called from loop, so the
+  ZED corrections are written directly by the caller as before.  The data is
+  also written directly when the task is not running.
+
+=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=*/
+
+//----------------------------------------
+// Constants
+//----------------------------------------
+
+#define CORRECTION_MUX_QUEUE_BYTES 4096 // Allocated when the source is first used
+#define CORRECTION_MUX_POLL_MSEC 50
+#define CORRECTION_MUX_RTCM_PREAMBLE 0xd3
+#define CORRECTION_MUX_RTCM_OVERHEAD 6 // Preamble, length and CRC
+
+//----------------------------------------
+// Types
+//----------------------------------------
+
+// Queue for a single correction source.  Bytes are added at head by the
+// source, published when the RTCM frame is complete and removed at tail
+// by correctionMuxTask.
+typedef struct _CORRECTION_MUX_QUEUE
+{
+    uint8_t *buffer;
+    volatile uint16_t head;      // Next byte written by the source
+    volatile uint16_t published; // End of the last complete frame
+    volatile uint16_t tail;      // Next byte written to the GNSS
+
+    // RTCM frame scanner, used by the source
+    uint16_t frameBytes;  // Bytes received of the current frame, zero when searching for the preamble
+    uint16_t frameLength; // Total frame length, zero until the length is received
+    uint8_t frameHeader;  // Second byte of the frame
+    bool resync;          // Data was dropped, discard data until a frame with a valid CRC
+    bool skipped;         // Data was dropped because the source was not selected
+
+    // Statistics
+    volatile uint32_t pendingMillis; // Time when the queue went from empty to holding data
+    volatile uint32_t bytesWritten;
+    volatile uint32_t bytesDropped;
+    volatile uint32_t latencyMsec; // Time from the queue to the GNSS for the last burst
+    volatile uint32_t latencyMaxMsec;
+} CORRECTION_MUX_QUEUE;
+
+//----------------------------------------
+// Locals
+//----------------------------------------
+
+static CORRECTION_MUX_QUEUE correctionMuxQueue[CORR_NUM];
+static TaskHandle_t correctionMuxTaskHandle;
+
+//----------------------------------------
+// Determine the number of bytes in a correction source queue
+//----------------------------------------
+int correctionMuxBytes(CORRECTION_ID_T id, uint16_t head)
+{
+    int bytes = head - correctionMuxQueue[id].tail;
+    if (bytes < 0)
+        bytes += CORRECTION_MUX_QUEUE_BYTES;
+    return bytes;
+}
+
+//----------------------------------------
+// Determine the number of bytes added by the source and not yet published
+//----------------------------------------
+int correctionMuxUnpublishedBytes(CORRECTION_ID_T id)
+{
+    int bytes = correctionMuxQueue[id].head - correctionMuxQueue[id].published;
+    if (bytes < 0)
+        bytes += CORRECTION_MUX_QUEUE_BYTES;
+    return bytes;
+}
+
+//----------------------------------------
+// Remove bytes from the start of the unpublished data
+// Inputs:
+//    id: correctionsSource value, ID of the correction source
+//    bytes: Number of bytes to remove
+//----------------------------------------
+void correctionMuxDropBytes(CORRECTION_ID_T id, int bytes)
+{
+    uint16_t from;
+    CORRECTION_MUX_QUEUE *queue = &correctionMuxQueue[id];
+    uint16_t to;
+
+    // Move the remaining data down to the published offset
+    to = queue->published;
+    from = (to + bytes) % CORRECTION_MUX_QUEUE_BYTES;
+    while (from != queue->head)
+    {
+        queue->buffer[to] = queue->buffer[from];
+        to = (to + 1) % CORRECTION_MUX_QUEUE_BYTES;
+        from = (from + 1) % CORRECTION_MUX_QUEUE_BYTES;
+    }
+    queue->head = to;
+    queue->bytesDropped = queue->bytesDropped + bytes;
+}
+
+//----------------------------------------
+// Locate the end of the last complete RTCM frame in the new data
+// Inputs:
+//    id: correctionsSource value, ID of the correction source
+//    offset: Queue offset of the new data
+//    length: Number of bytes of new data
+// Outputs:
+//    Returns the queue offset following the last complete frame or
+//    non-RTCM byte, returns the published offset when no frame completes
+//----------------------------------------
+uint16_t correctionMuxScanRtcm(CORRECTION_ID_T id, uint16_t offset, uint16_t length)
+{
+    uint8_t data;
+    uint16_t end;
+    CORRECTION_MUX_QUEUE *queue = &correctionMuxQueue[id];
+    uint16_t skip;
+
+    end = queue->published;
+    while (length)
+    {
+        // Skip over the frame body
+        if (queue->frameLength)
+        {
+            skip = queue->frameLength - queue->frameBytes;
+            if (skip > length)
+                skip = length;
+            queue->frameBytes += skip;
+            offset = (offset + skip) % CORRECTION_MUX_QUEUE_BYTES;
+            length -= skip;
+            if (queue->frameBytes == queue->frameLength)
+            {
+                // Frame complete
+                queue->frameBytes = 0;
+                queue->frameLength = 0;
+                end = offset;
+            }
+            continue;
+        }
+
+        data = queue->buffer[offset];
+        offset = (offset + 1) % CORRECTION_MUX_QUEUE_BYTES;
+        length -= 1;
+        switch (queue->frameBytes++)
+        {
+        case 0:
+            // Release the data between the frames
+            if (data != CORRECTION_MUX_RTCM_PREAMBLE)
+            {
+                queue->frameBytes = 0;
+                end = offset;
+            }
+            break;
+
+        case 1:
+            // The upper six bits of the length field are reserved
+            queue->frameHeader = data;
+            if (data & 0xfc)
+            {
+                queue->frameBytes = 0;
+                end = offset;
+            }
+            break;
+
+        case 2:
+            // Get the frame length
+            queue->frameLength = ((((uint16_t)queue->frameHeader) << 8) | data) + CORRECTION_MUX_RTCM_OVERHEAD;
+            break;
+        }
+    }
+    return end;
+}
+
+//----------------------------------------
+// Discard the unpublished data until an RTCM frame with a valid CRC is found
+// Inputs:
+//    id: correctionsSource value, ID of the correction source
+// Outputs:
+//    Returns the queue offset following the last complete frame, returns
+//    the published offset until a valid frame is found
+//----------------------------------------
+uint16_t correctionMuxResyncRtcm(CORRECTION_ID_T id)
+{
+    int bytes;
+    uint32_t crc;
+    uint16_t crcOffset;
+    int frameLength;
+    uint8_t header;
+    uint16_t offset;
+    CORRECTION_MUX_QUEUE *queue = &correctionMuxQueue[id];
+    int skip;
+    uint16_t start;
+
+    // Scan the candidate frames in place, the skipped bytes are removed with
+    // a single move once the scan stops
+    offset = queue->published;
+    bytes = correctionMuxUnpublishedBytes(id);
+    skip = 0;
+    while (1)
+    {
+        // Skip the bytes before the next preamble
+        while ((skip < bytes) && (queue->buffer[(offset + skip) % CORRECTION_MUX_QUEUE_BYTES]
+                                  != CORRECTION_MUX_RTCM_PREAMBLE))
+            skip++;
+
+        // Wait for the frame length
+        if ((bytes - skip) < RTCM_FRAME_HEADER_LENGTH)
+            break;
+        start = (offset + skip) % CORRECTION_MUX_QUEUE_BYTES;
+        header = queue->buffer[(start + 1) % CORRECTION_MUX_QUEUE_BYTES];
+        frameLength = ((((uint16_t)header) << 8) | queue->buffer[(start + 2) % CORRECTION_MUX_QUEUE_BYTES]) +
+                      CORRECTION_MUX_RTCM_OVERHEAD;
+
+        // The upper six bits of the length field are reserved
+        if ((header & 0xfc) == 0)
+        {
+            // Wait for the rest of the frame
+            if ((bytes - skip) < frameLength)
+                break;
+
+            // Compute the CRC, in two pieces when the frame wraps
+            crcOffset = (start + frameLength - RTCM_FRAME_CRC_LENGTH) % CORRECTION_MUX_QUEUE_BYTES;
+            if (crcOffset > start)
+                crc = rtcmCrc24q(&queue->buffer[start], crcOffset - start);
+            else
+                crc = rtcmCrc24qUpdate(rtcmCrc24q(&queue->buffer[start], CORRECTION_MUX_QUEUE_BYTES - start),
+                                       queue->buffer, crcOffset);
+
+            // Compare the CRC with the end of the frame
+            if (((crc >> 16) == queue->buffer[crcOffset])
+                && (((crc >> 8) & 0xff) == queue->buffer[(crcOffset + 1) % CORRECTION_MUX_QUEUE_BYTES])
+                && ((crc & 0xff) == queue->buffer[(crcOffset + 2) % CORRECTION_MUX_QUEUE_BYTES]))
+            {
+                // Discard the bytes before the frame, the frame moves to the published offset
+                if (skip)
+                    correctionMuxDropBytes(id, skip);
+
+                // Synchronized, scan the rest of the data starting after the preamble
+                queue->resync = false;
+                queue->frameBytes = 1;
+                queue->frameLength = frameLength;
+                return correctionMuxScanRtcm(id, (offset + 1) % CORRECTION_MUX_QUEUE_BYTES, bytes - skip - 1);
+            }
+        }
+
+        // Not a frame, search for the next preamble
+        skip++;
+    }
+
+    // Discard the bytes that can not start a frame
+    if (skip)
+        correctionMuxDropBytes(id, skip);
+    return offset;
+}
+
+//----------------------------------------
+// Queue correction data for the GNSS
+// Inputs:
+//    id: correctionsSource value, ID of the correction source
+//    data: Address of a buffer containing the data
+//    length: The number of valid data bytes in the buffer
+//    rtcm: True when the data is RTCM, only whole frames are written
+// Outputs:
+//    Returns the number of correction data bytes accepted
+//----------------------------------------
+int correctionPushRawData(CORRECTION_ID_T id, uint8_t *data, int length, bool rtcm)
+{
+    int bytesToEnd;
+    int bytesFree;
+    uint16_t head;
+    uint16_t published;
+    CORRECTION_MUX_QUEUE *queue;
+
+    // Write the data directly when the task is not running or the GNSS is not on a UART
+    if ((!task.correctionMuxTaskRunning) || present.gnss_zedf9p || present.gnss_zedx20p)
+        return gnss->pushRawData(data, length);
+
+    if ((id >= CORR_NUM) || (length <= 0))
+        return 0;
+    queue = &correctionMuxQueue[id];
+
+    // Drop the data from the other sources before the copy
+    if (id != correctionGetSource())
+    {
+        queue->skipped = true;
+        return 0;
+    }
+
+    // Allocate the queue
+    if (!queue->buffer)
+    {
+        queue->buffer = (uint8_t *)rtkMalloc(CORRECTION_MUX_QUEUE_BYTES, "Correction queue");
+        if (!queue->buffer)
+            return gnss->pushRawData(data, length);
+
+        // The data may start in the middle of a frame
+        queue->resync = true;
+    }
+
+    // Discard the partial frame when the data was interrupted
+    head = queue->head;
+    bytesFree = CORRECTION_MUX_QUEUE_BYTES - 1 - correctionMuxBytes(id, head);
+    if (queue->skipped || (length > bytesFree))
+    {
+        queue->bytesDropped = queue->bytesDropped + correctionMuxBytes(id, head) -
+                              correctionMuxBytes(id, queue->published);
+        queue->head = queue->published;
+        queue->frameBytes = 0;
+        queue->frameLength = 0;
+        queue->resync = true;
+        queue->skipped = false;
+        head = queue->head;
+        bytesFree = CORRECTION_MUX_QUEUE_BYTES - 1 - correctionMuxBytes(id, head);
+    }
+
+    // Drop the data when the queue is full
+    if (length > bytesFree)
+    {
+        queue->bytesDropped = queue->bytesDropped + length;
+        if (settings.debugCorrections && (!inMainMenu))
+            systemPrintf("%s correction queue full, %d bytes dropped\r\n", correctionsSourceNames[id], length);
+        return 0;
+    }
+
+    // Copy the data into the queue, in two pieces when it wraps
+    bytesToEnd = CORRECTION_MUX_QUEUE_BYTES - head;
+    if (length <= bytesToEnd)
+        memcpy(&queue->buffer[head], data, length);
+    else
+    {
+        memcpy(&queue->buffer[head], data, bytesToEnd);
+        memcpy(queue->buffer, &data[bytesToEnd], length - bytesToEnd);
+    }
+    queue->head = (head + length) % CORRECTION_MUX_QUEUE_BYTES;
+
+    // Release the complete frames to the writer
+    if (!rtcm)
+        published = queue->head;
+    else if (queue->resync)
+        published = correctionMuxResyncRtcm(id);
+    else
+        published = correctionMuxScanRtcm(id, head, length);
+    if (published != queue->published)
+    {
+        if (queue->published == queue->tail)
+            queue->pendingMillis = millis();
+        __atomic_store_n(&queue->published, published, __ATOMIC_RELEASE);
+        if (correctionMuxTaskHandle)
+            xTaskNotifyGive(correctionMuxTaskHandle);
+    }
+    return length;
+}
+
+//----------------------------------------
+// Display the correction source statistics
+//----------------------------------------
+void correctionMuxPrintStats()
+{
+    CORRECTION_MUX_QUEUE *queue;
+
+    systemPrintln("   Written    Dropped   Latency   Max       Source");
+    systemPrintln("----------  ---------  --------  --------  ------");
+    for (int id = 0; id < CORR_NUM; id++)
+    {
+        queue = &correctionMuxQueue[id];
+        if (queue->buffer)
+            systemPrintf("%10lu  %9lu  %5lu ms  %5lu ms  %s\r\n", queue->bytesWritten, queue->bytesDropped,
+                         queue->latencyMsec, queue->latencyMaxMsec, correctionsSourceNames[id]);
+    }
+}
+
+//----------------------------------------
+// Write the correction data from the selected source to the GNSS
+//----------------------------------------
+void correctionMuxTask(void *e)
+{
+    int bytesToEnd;
+    int bytesToWrite;
+    uint32_t latency;
+    uint16_t published;
+    CORRECTION_MUX_QUEUE *queue;
+    CORRECTION_ID_T source;
+
+    // Start notification
+    task.correctionMuxTaskRunning = true;
+    if (settings.printTaskStartStop)
+        systemPrintln("Task correctionMuxTask started");
+
+    // Run task until a request is raised
+    task.correctionMuxTaskStopRequest = false;
+    while (task.correctionMuxTaskStopRequest == false)
+    {
+        // Wait for correction data
+        ulTaskNotifyTake(pdTRUE, CORRECTION_MUX_POLL_MSEC / portTICK_PERIOD_MS);
+
+        source = correctionGetSource();
+        for (int id = 0; id < CORR_NUM; id++)
+        {
+            queue = &correctionMuxQueue[id];
+            if (!queue->buffer)
+                continue;
+            published = __atomic_load_n(&queue->published, __ATOMIC_ACQUIRE);
+            if (published == queue->tail)
+                continue;
+
+            // Discard the data when the source is no longer selected
+            if (id != source)
+            {
+                queue->bytesDropped = queue->bytesDropped + correctionMuxBytes(id, published);
+                queue->tail = published;
+                continue;
+            }
+
+            // Write the complete frames, in two pieces when the data wraps
+            bytesToWrite = correctionMuxBytes(id, published);
+            bytesToEnd = CORRECTION_MUX_QUEUE_BYTES - queue->tail;
+            if (bytesToWrite > bytesToEnd)
+                bytesToWrite = bytesToEnd;
+            gnss->pushRawData(&queue->buffer[queue->tail], bytesToWrite);
+            queue->bytesWritten = queue->bytesWritten + bytesToWrite;
+            queue->tail = (queue->tail + bytesToWrite) % CORRECTION_MUX_QUEUE_BYTES;
+
+            // Account for the latency once the queue is empty
+            if (queue->tail == queue->published)
+            {
+                latency = millis() - queue->pendingMillis;
+                queue->latencyMsec = latency;
+                if (queue->latencyMaxMsec < latency)
+                    queue->latencyMaxMsec = latency;
+            }
+            else
+                // Write the remaining data
+                xTaskNotifyGive(xTaskGetCurrentTaskHandle());
+        }
+
+        if ((settings.enableTaskReports == true) && (!inMainMenu))
+            systemPrintf("correctionMuxTask High watermark: %d\r\n", uxTaskGetStackHighWaterMark(nullptr));
+    }
+
+    // Stop notification
+    if (settings.printTaskStartStop)
+        systemPrintln("Task correctionMuxTask stopped");
+    task.correctionMuxTaskRunning = false;
+    vTaskDelete(NULL);
+}
+
+//----------------------------------------
+// Start the correction writer task
+//----------------------------------------
+void correctionMuxTaskStart()
+{
+    TaskHandle_t taskHandle;
+
+    if (task.correctionMuxTaskRunning)
+        return;
+
+    // Discard the previous data
+    for (int id = 0; id < CORR_NUM; id++)
+        correctionMuxQueue[id].tail = correctionMuxQueue[id].published;
+
+    if (xTaskCreatePinnedToCore(correctionMuxTask,                  // Function to call
+                                "correctionMux",                    // Just for humans
+                                correctionMuxTaskStackSize,         // Stack Size
+                                nullptr,                            // Task input parameter
+                                settings.correctionMuxTaskPriority, // Priority
+                                &taskHandle,                        // Task handle
+                                settings.correctionMuxTaskCore) != pdPASS)
+        systemPrintln("ERROR: Failed to start correctionMuxTask, writing corrections directly!");
+    else
+        correctionMuxTaskHandle = taskHandle;
+}
+
+//----------------------------------------
+// Stop the correction writer task
+//----------------------------------------
+void correctionMuxTaskStop()
+{
+    // Stop waking the task
+    TaskHandle_t taskHandle = correctionMuxTaskHandle;
+    correctionMuxTaskHandle = nullptr;
+
+    // Wait for the task to stop
+    task.correctionMuxTaskStopRequest = true;
+    if (taskHandle && task.correctionMuxTaskRunning)
+        xTaskNotifyGive(taskHandle);
+    while (task.correctionMuxTaskRunning)
+        delay(10);
+}
@@ -16,7 +16,7 @@ Developer.ino
 #ifndef COMPILE_LG290P
 
 void lg290pHandler(uint8_t * buffer, int length) {}
-bool lg290pMessageEnabled(char *nmeaSentence, int sentenceLength)   {return false;}
+bool lg290pMessageEnabled(char *nmeaSentence, int sentenceLength, NMEA_SENTENCE_ID sentenceId)   {return false;}
 
 #endif // COMPILE_LG290P
 
@@ -29,6 +29,7 @@ bool lg290pMessageEnabled(char *nmeaSentence, int sentenceLength)   {return fals
 void mosaicVerifyTables() {}
 void nmeaExtractStdDeviations(char *nmeaSentence, int arraySize) {}
 void processNonSBFData(const uint8_t * buffer, size_t length) {}
+void gnssReadSbfData(const uint8_t *buffer, size_t length, bool spartnParserNeeded) {}
 void processUart1SBF(SEMP_PARSE_STATE *parse, uint16_t type) {}
 void processUart1SPARTN(SEMP_PARSE_STATE *parse, uint16_t type) {}
 void menuLogMosaic() {}
@@ -237,6 +238,7 @@ void ntripClientSettingsChanged() {}
 #ifndef COMPILE_NTRIP_SERVER
 bool ntripServerIsCasting(int serverIndex) {return false;}
 void ntripServerPrintStatus(int serverIndex) {systemPrintf("**NTRIP Server %d not compiled**\r\n", serverIndex);}
+void ntripServerRtcmMessageBegin(int serverIndex, uint16_t dataLength) {}
 void ntripServerSendRTCM(int serverIndex, uint8_t *rtcmData, uint16_t dataLength) {}
 void ntripServerStop(int serverIndex, bool shutdown) {online.ntripServer[serverIndex] = false;}
 void ntripServerUpdate() {}
@@ -324,7 +326,7 @@ bool webServerIsRunning() {return false;}
 #ifndef  COMPILE_IM19_IMU
 
 void menuTilt() {}
-void nmeaApplyCompensation(char *nmeaSentence, int arraySize) {}
+void nmeaApplyCompensation(char *nmeaSentence, int arraySize, NMEA_SENTENCE_ID sentenceId) {}
 void tiltDetect() {systemPrintln("**Tilt Not Compiled**");}
 bool tiltIsCorrecting() {return(false);}
 void tiltRequestStop() {}
@@ -512,6 +514,7 @@ void    bluetoothFlush() {}
 byte    bluetoothGetState() {return BT_OFF;}
 void    bluetoothPrintStatus() {}
 uint8_t bluetoothRead() {return 0;}
+int     bluetoothRead(uint8_t *buffer, int length) {return 0;}
 int     bluetoothRxDataAvailable() {return 0;}
 void    bluetoothSendBatteryPercent(int batteryLevelPercent) {}
 void    bluetoothStart() {}
@@ -521,6 +524,11 @@ void    bluetoothStop() {}
 void    bluetoothEnd() {}
 void    bluetoothUpdate() {}
 int     bluetoothWrite(const uint8_t *buffer, int length) {return 0;}
+bool    bluetoothSppIsConnected() {return false;}
+bool    bluetoothBleIsConnected() {return false;}
+int     bluetoothWriteSpp(const uint8_t *buffer, int length) {return 0;}
+int     bluetoothWriteBle(const uint8_t *buffer, int length) {return 0;}
+int     bluetoothBleNotifyBytes() {return 20;}
 #endif  // COMPILE_BT
 
 //----------------------------------------
@@ -532,7 +540,9 @@ int     bluetoothWrite(const uint8_t *buffer, int length) {return 0;}
 bool espNowIsPaired()                   {return false;}
 bool espNowIsPairing()                   {return false;}
 bool espNowIsBroadcasting()                   {return false;}
-void espNowProcessRTCM(byte incoming)   {}
+void espNowProcessRTCM(const uint8_t *buffer, size_t length) {}
+void espNowRtcmFlush()                  {}
+void espNowRtcmMessageBegin(uint16_t length) {}
 bool espNowProcessRxPairedMessage()     {return true;}
 esp_err_t espNowRemovePeer(const uint8_t *peerMac)        {return ESP_OK;}
 esp_err_t espNowSendPairMessage(const uint8_t *sendToMac) {return ESP_OK;}
@@ -553,13 +563,16 @@ bool checkUpdateLoraFirmware() {return false;}
 bool createLoRaPassthrough() {return false;}
 bool createLoraRxDirectFile() {return false;}
 bool createLoraTxDirectFile() {return false;}
+bool loraConsoleHold(const uint8_t *buffer, uint16_t length) {return false;}
 void loraGetVersion() {}
 void loraPowerOff() {}
 void loraProcessRTCM(uint8_t *rtcmData, uint16_t dataLength) {}
+void loraRtcmMessageBegin(uint16_t length) {}
 bool loraRxDirectCheckFile() {return false;}
 void loraRxDirectConnect() {}
 bool loraTxDirectCheckFile() {return false;}
 void loraTxDirectConnect() {}
+size_t loraUsbSerialWrite(const uint8_t *buffer, uint16_t length) {return Serial.write(buffer, length);}
 void muxSelectUm980() {}
 void muxSelectUsb() {}
 void updateLora() {}
@@ -19,6 +19,21 @@
   * We don't care if the ESP NOW packet is corrupt or not. RTCM has its own
     CRC. RTK needs valid RTCM once every few seconds so a single dropped
     frame is not critical.
+
+  RTCM framing:
+  * Each RTCM frame starts with an ESP_NOW_RTCM_HEADER holding a sequence
+    number and a fragment index.  Whole RTCM messages are packed into a
+    frame when they fit, larger messages are split across frames with
+    consecutive sequence numbers.
+  * The base sends the partial frame once the RTCM messages waiting in the
+    ring buffer are queued, there is no idle timeout.
+  * The rover reassembles the fragments and drops incomplete messages
+    instead of passing the remaining fragments to the GNSS.  Frames without
+    the header (older firmware) are passed to the GNSS as before.
+  * Older rovers pass the header to the GNSS, so the header is only sent
+    when settings.espnowRtcmFraming is set.  The pairing message advertises
+    framing support, pairing sets espnowRtcmFraming when every paired radio
+    supports framing.  Otherwise the RTCM is sent without the header.
 =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=*/
 
 #ifdef COMPILE_ESPNOW
@@ -32,23 +47,83 @@ typedef struct _ESP_NOW_PAIR_MESSAGE
 {
     uint8_t macAddress[6];
     bool encrypt;
-    uint8_t channel;
+    uint8_t features; // ESPNOW_PAIR_xxx, was channel which older firmware sets to zero and ignores
     uint8_t crc; // Simple check - add MAC together and limit to 8 bit
 } ESP_NOW_PAIR_MESSAGE;
 
+#define ESPNOW_PAIR_RTCM_FRAMING 0x01 // Accepts the RTCM frames with ESP_NOW_RTCM_HEADER
+
+// Header at the start of each RTCM frame
+typedef struct _ESP_NOW_RTCM_HEADER
+{
+    uint8_t marker[2];  // ESPNOW_RTCM_MARKER_1, ESPNOW_RTCM_MARKER_2
+    uint8_t fragment;   // Bits 0-6: Fragment index, bit 7: Last fragment of the message
+    uint8_t reserved;
+    uint16_t sequence;  // Incremented for each frame
+    uint16_t queueMsec; // Milliseconds the frame waited in the base's transmit queue
+} ESP_NOW_RTCM_HEADER;
+
+#define ESPNOW_RTCM_MARKER_1 0xe5
+#define ESPNOW_RTCM_MARKER_2 0x4e
+#define ESPNOW_RTCM_LAST_FRAGMENT 0x80
+#define ESPNOW_RTCM_FRAGMENT_MASK 0x7f
+#define ESPNOW_RTCM_HEADER_LENGTH sizeof(ESP_NOW_RTCM_HEADER)
+#define ESPNOW_RTCM_MESSAGE_MAX (3 + 1023 + 3) // RTCM header, maximum payload and CRC
+
 //****************************************
 // Locals
 //****************************************
 
-uint16_t espNowBytesSent;    // May be more than 255
-unsigned long espNowLastAdd; // Tracks how long since the last byte was added to the outgoing buffer
+uint16_t espNowBytesSent; // May be more than 255
 unsigned long espNowLastRssiUpdate;
-uint8_t espNowOutgoing[250];  // ESP NOW has max of 250 characters
-uint8_t espNowOutgoingSpot;   // ESP Now has a max of 250 characters
+uint8_t espNowOutgoingSpot;   // RTCM bytes in the frame being filled
+uint8_t espNowOutgoingFragment; // Fragment index of the frame being filled
+uint16_t espNowOutgoingRemaining; // RTCM bytes of the current message not yet in a frame
+uint16_t espNowTxSequence;
 uint8_t espNowReceivedMAC[6]; // Holds the MAC received during pairing
+uint8_t espNowReceivedFeatures; // Holds the features received during pairing
 ESPNOWState espNowState;
 ESPNOWState espNowPrePairingState;
 
+// RTCM transmit queue, filled by espNowProcessRTCM and drained by espNowOnDataSent.
+// The entry at espNowTxHead is being filled, the entry at espNowTxTail is the next
+// to send.  A 1 Hz MSM7 epoch of 4 - 5 KB needs 20 frames.
+#define ESPNOW_TX_QUEUE_ENTRIES 24
+#define ESPNOW_TX_TIMEOUT_MSEC 100 // Release the queue if the send callback is lost
+
+typedef struct _ESP_NOW_TX_FRAME
+{
+    uint8_t data[ESP_NOW_MAX_DATA_LEN]; // ESP NOW has max of 250 characters
+    uint8_t length;
+    uint8_t headerLength; // ESPNOW_RTCM_HEADER_LENGTH or zero when sent without the header
+    unsigned long queuedMillis;
+} ESP_NOW_TX_FRAME;
+
+ESP_NOW_TX_FRAME espNowTxQueue[ESPNOW_TX_QUEUE_ENTRIES];
+volatile uint8_t espNowTxHead;
+volatile uint8_t espNowTxTail;
+volatile bool espNowTxInFlight; // Waiting for the send callback
+volatile bool espNowTxSending;  // Calling esp_now_send
+volatile unsigned long espNowTxStartMillis;
+uint32_t espNowTxDropped; // Frames discarded because the queue was full or the send failed
+portMUX_TYPE espNowTxLock = portMUX_INITIALIZER_UNLOCKED;
+
+// Rover reassembly, runs in the WiFi task
+uint8_t espNowRxMessage[ESPNOW_RTCM_MESSAGE_MAX];
+uint16_t espNowRxMessageLength;
+uint8_t espNowRxFragmentNext;  // Zero when no message is being reassembled
+uint16_t espNowRxSequenceNext;
+bool espNowRxSequenceValid;
+unsigned long espNowRxStartMillis; // Arrival of the first fragment
+uint16_t espNowRxQueueMsec;        // Base queue time of the first fragment
+
+// Rover statistics
+uint32_t espNowRxFrames;
+uint32_t espNowRxLost;       // Frames missing from the sequence
+uint32_t espNowRxIncomplete; // RTCM messages dropped due to missing fragments
+uint32_t espNowRxLatencyMsec; // Base queue time plus reassembly time of the last message
+uint32_t espNowRxLatencyMaxMsec;
+
 //*********************************************************************
 // Add a peer to the ESP-NOW network
 esp_err_t espNowAddPeer(const uint8_t *peerMac, bool encrypt)
@@ -136,6 +211,131 @@ bool espNowIsBroadcasting()
     return (espNowState == ESPNOW_BROADCASTING);
 }
 
+//*********************************************************************
+// Pass the received RTCM to the GNSS
+void espNowPushRTCM(const uint8_t *data, int len)
+{
+    // Determine if ESPNOW is the correction source
+    if (correctionLastSeen(CORR_ESPNOW))
+    {
+        // Pass RTCM bytes (presumably) from ESP NOW out ESP32-UART to GNSS
+        correctionPushRawData(CORR_ESPNOW, (uint8_t *)data, len, true);
+        sempParseNextBytes(rtcmParse, (uint8_t *)data, len); // Parse the data for RTCM1005/1006
+
+        if ((settings.debugEspNow == true || settings.debugCorrections == true) && !inMainMenu)
+            systemPrintf("ESPNOW received %d RTCM bytes, pushed to GNSS, RSSI: %d\r\n", len, espNowRSSI);
+    }
+    else
+    {
+        if ((settings.debugEspNow == true || settings.debugCorrections == true) && !inMainMenu)
+            systemPrintf("ESPNOW received %d RTCM bytes, NOT pushed due to priority, RSSI: %d\r\n", len,
+                         espNowRSSI);
+    }
+}
+
+//*********************************************************************
+// Account for a complete RTCM message or frame of messages
+void espNowRtcmComplete(uint16_t queueMsec, unsigned long startMillis)
+{
+    espNowRxLatencyMsec = queueMsec + (millis() - startMillis);
+    if (espNowRxLatencyMaxMsec < espNowRxLatencyMsec)
+        espNowRxLatencyMaxMsec = espNowRxLatencyMsec;
+}
+
+//*********************************************************************
+// Drop the partially reassembled RTCM message
+void espNowRtcmDropMessage()
+{
+    if (espNowRxFragmentNext)
+    {
+        espNowRxIncomplete += 1;
+        if (settings.debugEspNow == true && !inMainMenu)
+            systemPrintf("ESPNOW dropped incomplete RTCM message, %d bytes received\r\n", espNowRxMessageLength);
+    }
+    espNowRxFragmentNext = 0;
+    espNowRxMessageLength = 0;
+}
+
+//*********************************************************************
+// Process an RTCM frame, reassemble the fragmented messages
+void espNowRtcmFrameReceived(const uint8_t *data, int len)
+{
+    uint8_t fragment;
+    uint16_t gap;
+    ESP_NOW_RTCM_HEADER header;
+    bool last;
+    const uint8_t *payload;
+    uint16_t payloadLength;
+
+    memcpy(&header, data, sizeof(header));
+    payload = &data[ESPNOW_RTCM_HEADER_LENGTH];
+    payloadLength = len - ESPNOW_RTCM_HEADER_LENGTH;
+    fragment = header.fragment & ESPNOW_RTCM_FRAGMENT_MASK;
+    last = (header.fragment & ESPNOW_RTCM_LAST_FRAGMENT) != 0;
+    espNowRxFrames += 1;
+
+    // Count the missing frames, a large jump is a base restart or a different base
+    gap = espNowRxSequenceValid ? (uint16_t)(header.sequence - espNowRxSequenceNext) : 0;
+    if (gap && (gap < 0x8000))
+        espNowRxLost += gap;
+    espNowRxSequenceNext = header.sequence + 1;
+    espNowRxSequenceValid = true;
+
+    // Any gap breaks the message being reassembled
+    if (gap || (fragment != espNowRxFragmentNext))
+    {
+        espNowRtcmDropMessage();
+
+        // Ignore the remaining fragments of a broken message
+        if (fragment)
+            return;
+    }
+
+    // Whole messages, pass them to the GNSS
+    if ((fragment == 0) && last)
+    {
+        espNowPushRTCM(payload, payloadLength);
+        espNowRtcmComplete(header.queueMsec, millis());
+        return;
+    }
+
+    // Start of a fragmented message
+    if (fragment == 0)
+    {
+        espNowRxStartMillis = millis();
+        espNowRxQueueMsec = header.queueMsec;
+    }
+
+    // Add the fragment to the message
+    if ((espNowRxMessageLength + payloadLength) > sizeof(espNowRxMessage))
+    {
+        espNowRxFragmentNext = fragment + 1; // Count this message as incomplete
+        espNowRtcmDropMessage();
+        return;
+    }
+    memcpy(&espNowRxMessage[espNowRxMessageLength], payload, payloadLength);
+    espNowRxMessageLength += payloadLength;
+    espNowRxFragmentNext = fragment + 1;
+
+    // Pass the complete message to the GNSS
+    if (last)
+    {
+        espNowPushRTCM(espNowRxMessage, espNowRxMessageLength);
+        espNowRtcmComplete(espNowRxQueueMsec, espNowRxStartMillis);
+        espNowRxFragmentNext = 0;
+        espNowRxMessageLength = 0;
+    }
+}
+
+//*********************************************************************
+// Display the RTCM receive statistics
+void espNowPrintRxStats()
+{
+    systemPrintf("  RTCM frames received: %lu, lost: %lu, incomplete messages: %lu\r\n", espNowRxFrames, espNowRxLost,
+                 espNowRxIncomplete);
+    systemPrintf("  RTCM latency: %lu mSec, maximum: %lu mSec\r\n", espNowRxLatencyMsec, espNowRxLatencyMaxMsec);
+}
+
 //*********************************************************************
 // Callback when data is received
 void espNowOnDataReceived(const esp_now_recv_info *mac, const uint8_t *incomingData, int len)
@@ -173,6 +373,7 @@ void espNowOnDataReceived(const esp_now_recv_info *mac, const uint8_t *incomingD
             {
                 // Valid CRC, save the MAC address
                 memcpy(&espNowReceivedMAC, pairMessage.macAddress, 6);
+                espNowReceivedFeatures = pairMessage.features;
                 espNowSetState(ESPNOW_MAC_RECEIVED);
             }
             // else Pair CRC failed
@@ -183,22 +384,11 @@ void espNowOnDataReceived(const esp_now_recv_info *mac, const uint8_t *incomingD
         espNowRSSI = packetRSSI; // Record this packet's RSSI as an ESP NOW packet
 
         // We've just received ESP-NOW data. We assume this is RTCM and push it directly to the GNSS.
-        // Determine if ESPNOW is the correction source
-        if (correctionLastSeen(CORR_ESPNOW))
-        {
-            // Pass RTCM bytes (presumably) from ESP NOW out ESP32-UART to GNSS
-            gnss->pushRawData((uint8_t *)incomingData, len);
-            sempParseNextBytes(rtcmParse, (uint8_t *)incomingData, len); // Parse the data for RTCM1005/1006
-
-            if ((settings.debugEspNow == true || settings.debugCorrections == true) && !inMainMenu)
-                systemPrintf("ESPNOW received %d RTCM bytes, pushed to GNSS, RSSI: %d\r\n", len, espNowRSSI);
-        }
+        if ((len > ESPNOW_RTCM_HEADER_LENGTH) && (incomingData[0] == ESPNOW_RTCM_MARKER_1) &&
+            (incomingData[1] == ESPNOW_RTCM_MARKER_2))
+            espNowRtcmFrameReceived(incomingData, len);
         else
-        {
-            if ((settings.debugEspNow == true || settings.debugCorrections == true) && !inMainMenu)
-                systemPrintf("ESPNOW received %d RTCM bytes, NOT pushed due to priority, RSSI: %d\r\n", len,
-                             espNowRSSI);
-        }
+            espNowPushRTCM(incomingData, len); // Unframed data from older firmware
 
         espNowIncomingRTCM = true; // Display a download icon
         espNowLastRssiUpdate = millis();
@@ -206,40 +396,236 @@ void espNowOnDataReceived(const esp_now_recv_info *mac, const uint8_t *incomingD
 }
 
 //*********************************************************************
-// Buffer RTCM data and send to ESP-NOW peer
-void espNowProcessRTCM(byte incoming)
+// Start sending the next queued frame if the radio is ready
+// Called by the RTCM producer, the send callback and espNowUpdate
+void espNowTxNext()
 {
-    // If we are paired,
-    // Or if the radio is broadcasting
-    // Then add bytes to the outgoing buffer
-    if (espNowState == ESPNOW_PAIRED || espNowState == ESPNOW_BROADCASTING)
-    {
-        // Move this byte into ESP NOW to send buffer
-        espNowOutgoing[espNowOutgoingSpot++] = incoming;
-        espNowLastAdd = millis();
-    }
+    ESP_NOW_TX_FRAME *frame;
+    esp_err_t status;
+    bool waiting;
 
-    // Send buffer when full
-    if (espNowOutgoingSpot == sizeof(espNowOutgoing))
+    do
     {
-        espNowOutgoingSpot = 0; // Wrap
+        portENTER_CRITICAL(&espNowTxLock);
+        if (espNowTxSending || espNowTxInFlight || (espNowTxTail == espNowTxHead))
+        {
+            portEXIT_CRITICAL(&espNowTxLock);
+            return;
+        }
+        espNowTxSending = true;
+        espNowTxInFlight = true;
+        espNowTxStartMillis = millis();
+        frame = &espNowTxQueue[espNowTxTail];
+        portEXIT_CRITICAL(&espNowTxLock);
+
+        // Record the time spent in the queue
+        if (frame->headerLength)
+            ((ESP_NOW_RTCM_HEADER *)frame->data)->queueMsec = espNowTxStartMillis - frame->queuedMillis;
 
+        // esp_now_send copies the data, the entry may be reused once the call returns
         if (espNowState == ESPNOW_PAIRED)
-            esp_now_send(0, (uint8_t *)&espNowOutgoing, sizeof(espNowOutgoing)); // Send packet to all peers
+            status = esp_now_send(0, frame->data, frame->length); // Send packet to all peers
         else // if (espNowState == ESPNOW_BROADCASTING)
+            status = esp_now_send(espNowBroadcastAddr, frame->data, frame->length); // Send packet via broadcast
+
+        portENTER_CRITICAL(&espNowTxLock);
+        espNowTxTail = (espNowTxTail + 1) % ESPNOW_TX_QUEUE_ENTRIES;
+        espNowTxSending = false;
+        if (status != ESP_OK)
         {
-            esp_now_send(espNowBroadcastAddr, (uint8_t *)&espNowOutgoing,
-                         sizeof(espNowOutgoing)); // Send packet via broadcast
+            // No callback will arrive for this frame, espNowUpdate tries the next frame
+            espNowTxInFlight = false;
+            espNowTxDropped += 1;
+            portEXIT_CRITICAL(&espNowTxLock);
+            return;
         }
 
-        delay(10); // We need a small delay between sending multiple packets
+        // The callback may have arrived during esp_now_send, if so send the next frame
+        waiting = espNowTxInFlight;
+        portEXIT_CRITICAL(&espNowTxLock);
+    } while (!waiting);
+}
+
+//*********************************************************************
+// Discard the queued frames
+void espNowTxFlush()
+{
+    portENTER_CRITICAL(&espNowTxLock);
+    espNowTxHead = 0;
+    espNowTxTail = 0;
+    espNowTxInFlight = false;
+    espNowOutgoingSpot = 0;
+    espNowOutgoingRemaining = 0;
+    portEXIT_CRITICAL(&espNowTxLock);
+    espNowBytesSent = 0;
+    espNowRxSequenceValid = false;
+    espNowRxFragmentNext = 0;
+    espNowRxMessageLength = 0;
+}
+
+//*********************************************************************
+// Callback when the radio has finished sending a frame
+// Runs in the WiFi task, keep it short
+void espNowOnDataSent(const uint8_t *mac, esp_now_send_status_t status)
+{
+    espNowTxInFlight = false;
+    espNowTxNext();
+}
+
+//*********************************************************************
+// Queue the frame being filled, returns false if the queue is full
+// Called with espNowTxLock held
+bool espNowTxCommit()
+{
+    ESP_NOW_TX_FRAME *frame;
+    ESP_NOW_RTCM_HEADER *header;
+    uint8_t head;
 
-        espNowBytesSent += sizeof(espNowOutgoing);
+    // Build the header
+    frame = &espNowTxQueue[espNowTxHead];
+    if (frame->headerLength)
+    {
+        header = (ESP_NOW_RTCM_HEADER *)frame->data;
+        header->marker[0] = ESPNOW_RTCM_MARKER_1;
+        header->marker[1] = ESPNOW_RTCM_MARKER_2;
+        header->fragment = espNowOutgoingFragment;
+        if (espNowOutgoingRemaining == 0)
+            header->fragment |= ESPNOW_RTCM_LAST_FRAGMENT;
+        header->reserved = 0;
+        header->sequence = espNowTxSequence++;
+    }
+    frame->length = frame->headerLength + espNowOutgoingSpot;
+    frame->queuedMillis = millis();
+    espNowBytesSent += espNowOutgoingSpot;
+    espNowOutgoingSpot = 0;
+    espNowOutgoingFragment += 1;
+
+    // Reuse the entry when the queue is full
+    head = (espNowTxHead + 1) % ESPNOW_TX_QUEUE_ENTRIES;
+    if (head == espNowTxTail)
+    {
+        espNowTxDropped += 1;
+        return false;
+    }
+    espNowTxHead = head;
+    return true;
+}
 
+//*********************************************************************
+// Start the next RTCM message
+// Called by rtcmConsumerMessageBegin before passing the message to espNowProcessRTCM
+void espNowRtcmMessageBegin(uint16_t length)
+{
+    bool queued;
+
+    if ((espNowState != ESPNOW_PAIRED) && (espNowState != ESPNOW_BROADCASTING))
+        return;
+
+    // Send the partial frame when it holds the end of a fragmented message,
+    // the previous message was not completed or this message does not fit
+    queued = false;
+    portENTER_CRITICAL(&espNowTxLock);
+    if (espNowOutgoingSpot &&
+        (espNowOutgoingFragment || espNowOutgoingRemaining ||
+         (length > (ESP_NOW_MAX_DATA_LEN - espNowTxQueue[espNowTxHead].headerLength - espNowOutgoingSpot))))
+        queued = espNowTxCommit();
+    espNowOutgoingRemaining = length;
+    espNowOutgoingFragment = 0;
+    portEXIT_CRITICAL(&espNowTxLock);
+
+    if (queued)
+    {
         espNowOutgoingRTCM = true;
+        espNowTxNext();
     }
 }
 
+//*********************************************************************
+// Send the partial frame at the end of the RTCM messages
+// Called by sendRTCMToConsumers once the waiting RTCM messages are queued
+void espNowRtcmFlush()
+{
+    bool queued;
+
+    if ((espNowState != ESPNOW_PAIRED) && (espNowState != ESPNOW_BROADCASTING))
+        return;
+
+    // Only send whole messages
+    queued = false;
+    portENTER_CRITICAL(&espNowTxLock);
+    if (espNowOutgoingSpot && (espNowOutgoingRemaining == 0))
+        queued = espNowTxCommit();
+    portEXIT_CRITICAL(&espNowTxLock);
+
+    if (settings.debugEspNow == true && !inMainMenu && espNowBytesSent)
+        systemPrintf("ESPNOW queued %d RTCM bytes\r\n", espNowBytesSent);
+    espNowBytesSent = 0;
+
+    if (queued)
+    {
+        espNowOutgoingRTCM = true;
+        espNowTxNext();
+    }
+}
+
+//*********************************************************************
+// Buffer RTCM data and queue it for the ESP-NOW peer
+// Transmission is paced by the send callback, this routine does not wait for the radio
+void espNowProcessRTCM(const uint8_t *buffer, size_t length)
+{
+    size_t bytesToCopy;
+    uint32_t dropped;
+    ESP_NOW_TX_FRAME *frame;
+    bool queued;
+
+    // If we are paired,
+    // Or if the radio is broadcasting
+    // Then add bytes to the outgoing buffer
+    if ((espNowState != ESPNOW_PAIRED) && (espNowState != ESPNOW_BROADCASTING))
+        return;
+
+    // Discard data beyond the end of the message
+    if (length > espNowOutgoingRemaining)
+        length = espNowOutgoingRemaining;
+
+    queued = false;
+    dropped = espNowTxDropped;
+    while (length)
+    {
+        portENTER_CRITICAL(&espNowTxLock);
+        frame = &espNowTxQueue[espNowTxHead];
+
+        // Only send the header to radios that accept it
+        if (espNowOutgoingSpot == 0)
+            frame->headerLength = settings.espnowRtcmFraming ? ESPNOW_RTCM_HEADER_LENGTH : 0;
+
+        // Move the bytes into the ESP NOW send buffer
+        bytesToCopy = ESP_NOW_MAX_DATA_LEN - frame->headerLength - espNowOutgoingSpot;
+        if (bytesToCopy > length)
+            bytesToCopy = length;
+        memcpy(&frame->data[frame->headerLength + espNowOutgoingSpot], buffer, bytesToCopy);
+        espNowOutgoingSpot += bytesToCopy;
+        espNowOutgoingRemaining -= bytesToCopy;
+
+        // Queue the buffer when full
+        if ((frame->headerLength + espNowOutgoingSpot) == ESP_NOW_MAX_DATA_LEN)
+            queued |= espNowTxCommit();
+        portEXIT_CRITICAL(&espNowTxLock);
+
+        buffer += bytesToCopy;
+        length -= bytesToCopy;
+    }
+
+    if (queued)
+    {
+        espNowOutgoingRTCM = true;
+        espNowTxNext();
+    }
+
+    if ((dropped != espNowTxDropped) && (settings.debugEspNow == true) && !inMainMenu)
+        systemPrintf("ESPNOW TX queue full, %lu frames dropped\r\n", espNowTxDropped);
+}
+
 //*********************************************************************
 // Update the state of the ESP Now state machine
 //
@@ -304,7 +690,7 @@ esp_err_t espNowSendPairMessage(const uint8_t *sendToMac)
     // Get unit MAC address
     memcpy(pairMessage.macAddress, wifiMACAddress, 6);
     pairMessage.encrypt = false;
-    pairMessage.channel = 0;
+    pairMessage.features = ESPNOW_PAIR_RTCM_FRAMING;
 
     pairMessage.crc = 0; // Calculate CRC
     for (int x = 0; x < 6; x++)
@@ -390,6 +776,17 @@ bool espNowStart()
             break;
         }
 
+        // Set the send complete routine address, used to pace the RTCM transmissions
+        espNowTxFlush();
+        if (settings.debugEspNow)
+            systemPrintf("Calling esp_now_register_send_cb\r\n");
+        status = esp_now_register_send_cb(espNowOnDataSent);
+        if (status != ESP_OK)
+        {
+            systemPrintf("ERROR: Failed to set ESP_NOW TX callback, status: %d\r\n", status);
+            break;
+        }
+
         // Using ESP-NOW, a receiver will receive all packets addressed to its MAC and the broadcast MAC
         // with no peers added. It is the transmitter that needs peers assigned to filter out packets.
         // Therefore, if ESP-NOW is enabled, we add the broadcast MAC to the peer list by default to allow
@@ -587,6 +984,7 @@ bool espNowStop()
             systemPrintf("ERROR: Failed to deinit ESP-NOW, status: %d\r\n", status);
             break;
         }
+        espNowTxFlush();
 
         //  11. Restart WiFi if necessary
 
@@ -602,7 +1000,7 @@ bool espNowStop()
 
 //*********************************************************************
 // Called from main loop
-// Update the ESP-NOW state machine to allow for broadcasting partial packets, pairing, etc.
+// Update the ESP-NOW state machine to allow for pairing, restarting the transmit queue, etc.
 // Control incoming/outgoing RTCM data from internal ESP NOW radio
 void espNowUpdate()
 {
@@ -634,21 +1032,12 @@ void espNowUpdate()
             espNowSetState(ESPNOW_OFF);
         }
 
-        // If it's been longer than 50ms since we last added a byte to the buffer
-        // then we've reached the end of the RTCM stream. Send partial buffer.
-        if ((espNowOutgoingSpot > 0) && ((millis() - espNowLastAdd) > 50))
-        {
-            if (espNowState == ESPNOW_PAIRED)
-                esp_now_send(0, (uint8_t *)&espNowOutgoing, espNowOutgoingSpot); // Send partial packet to all peers
-            else // if (espNowState == ESPNOW_BROADCASTING)
-                esp_now_send(espNowBroadcastAddr, (uint8_t *)&espNowOutgoing,
-                             espNowOutgoingSpot); // Send packet via broadcast
-
-            if (settings.debugEspNow == true && !inMainMenu)
-                systemPrintf("ESPNOW transmitted %d RTCM bytes\r\n", espNowBytesSent + espNowOutgoingSpot);
-            espNowBytesSent = 0;
-            espNowOutgoingSpot = 0; // Reset
-        }
+        // Release the queue if the send callback did not arrive
+        if (espNowTxInFlight && ((millis() - espNowTxStartMillis) > ESPNOW_TX_TIMEOUT_MSEC))
+            espNowTxInFlight = false;
+
+        // Send the next frame if the radio is ready
+        espNowTxNext();
 
         // If we don't receive an ESP NOW packet after some time, set RSSI to very negative
         // This removes the ESPNOW icon from the display when the link goes down
@@ -724,13 +1113,21 @@ void espNowUpdate()
             settings.espnowPeerCount %= ESPNOW_MAX_PEERS;
         }
 
+        // Only frame the RTCM when every paired radio accepts the header
+        if (settings.espnowPeerCount <= 1)
+            settings.espnowRtcmFraming = (espNowReceivedFeatures & ESPNOW_PAIR_RTCM_FRAMING) != 0;
+        else if ((espNowReceivedFeatures & ESPNOW_PAIR_RTCM_FRAMING) == 0)
+            settings.espnowRtcmFraming = false;
+        if (settings.debugEspNow == true)
+            systemPrintf("ESP-NOW RTCM framing: %s\r\n", settings.espnowRtcmFraming ? "Enabled" : "Disabled");
+
         // Send message directly to the received MAC (not unicast)
         espNowSendPairMessage(espNowReceivedMAC);
 
         // Report success to the CLI
         commandSendStringOkResponse((char *)"SPEXE", (char *)"UPDATEPAIR", (char *)"SUCCESS");
 
-        // Record enableEspNow setting and espnowPeerCount to NVM
+        // Record enableEspNow setting, espnowPeerCount and espnowRtcmFraming to NVM
         recordSystemSettings();
 
         espNowSetState(ESPNOW_PAIRED);
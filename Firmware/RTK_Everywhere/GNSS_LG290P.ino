@@ -2799,9 +2799,36 @@ bool GNSS_LG290P::setRtcmRoverMessageRateByName(const char *msgName, uint8_t msg
 // so should not be logged or passed to other consumers (Bluetooth, TCP, etc).
 // If the message is unknown, allow messages through - this assumes the user has configured the message outside
 // of the standard firmware settings.
-bool lg290pMessageEnabled(char *nmeaSentence, int sentenceLength)
+bool lg290pMessageEnabled(char *nmeaSentence, int sentenceLength, NMEA_SENTENCE_ID sentenceId)
 {
-    // Identify message type: PQTM, RTCM, RAW, NAV, or Gx???
+    // lgMessagesNMEA index for each NMEA_SENTENCE_ID, -1 if not in the table
+    static int8_t nmeaMessageNumber[NMEA_SENTENCE_MAX];
+    static bool nmeaMessageNumberInitialized;
+
+    // Standard Gx??? NMEA sentences were identified by processUart1Message
+    if (sentenceId != NMEA_SENTENCE_UNKNOWN)
+    {
+        // Build the lookup table from the settings array once
+        if (nmeaMessageNumberInitialized == false)
+        {
+            for (int index = 0; index < NMEA_SENTENCE_MAX; index++)
+                nmeaMessageNumber[index] = -1;
+            for (int messageNumber = 0; messageNumber < MAX_LG290P_NMEA_MSG; messageNumber++)
+                nmeaMessageNumber[nmeaSentenceFormatterId(lgMessagesNMEA[messageNumber].msgTextName)] = messageNumber;
+            nmeaMessageNumber[NMEA_SENTENCE_UNKNOWN] = -1;
+            nmeaMessageNumberInitialized = true;
+        }
+
+        // Verify the talker ID starts with G
+        int messageNumber = nmeaMessageNumber[sentenceId];
+        if ((nmeaSentence[0] == '$') && (nmeaSentence[1] == 'G') && (messageNumber >= 0))
+            return (settings.lg290pMessageRatesNMEA[messageNumber] > 0);
+
+        // If we can't ID this message, allow it by default
+        return (true);
+    }
+
+    // Identify message type: PQTM, RTCM, RAW or NAV
 
     // Create array with worst case length
     char sentenceHeader[strlen("$PQTMGEOFENCESTATUS,") + 1] = {0};
@@ -2845,29 +2872,6 @@ bool lg290pMessageEnabled(char *nmeaSentence, int sentenceLength)
     // else if (strnstr(sentenceHeader, "RAW-", sizeof(sentenceHeader)) != nullptr) // TODO
     // else if (strnstr(sentenceHeader, "NAV-", sizeof(sentenceHeader)) != nullptr) // TODO
 
-    else // We assume a Gx??? NMEA type sentenceHeader
-    {
-        if (sentenceHeader[0] == 'G') // Verify sentenceHeader starts with G
-        {
-            // Identify the messageType type
-            char messageName[strlen("GSV") + 1] = {0};
-
-            // Copy three letters, starting in spot 2. Null terminated from array initializer.
-            strncpy(messageName, &sentenceHeader[2], 3);
-
-            // Find this sentence type in the settings array
-            for (int messageNumber = 0; messageNumber < MAX_LG290P_NMEA_MSG; messageNumber++)
-            {
-                if (strncmp(lgMessagesNMEA[messageNumber].msgTextName, messageName, sizeof(messageName)) == 0)
-                {
-                    if (settings.lg290pMessageRatesNMEA[messageNumber] > 0)
-                        return (true);
-                    return (false);
-                }
-            }
-        }
-    }
-
     // If we can't ID this message, allow it by default. The device configuration should control most message flow.
     return (true);
 }
@@ -9,21 +9,7 @@ GNSS_Mosaic.h
 
 #include <SparkFun_Extensible_Message_Parser.h> //http://librarymanager/All#SparkFun_Extensible_Message_Parser
 
-typedef struct
-{
-    const uint16_t ID;
-    const bool fixedLength;
-    const uint16_t length; // Padded to modulo-4
-    const char name[19];
-} mosaicExpectedID;
-
-const mosaicExpectedID mosaicExpectedIDs[] = {
-    {4007, true, 96, "PVTGeodetic"},  {4013, false, 0, "ChannelStatus"}, {4014, false, 0, "ReceiverStatus"},
-    {4059, false, 0, "DiskStatus"},   {4090, false, 0, "InputLink"},     {4097, false, 0, "EncapsulatedOutput"},
-    {5914, true, 24, "ReceiverTime"},
-};
-
-#define MAX_MOSAIC_EXPECTED_SBF (sizeof(mosaicExpectedIDs) / sizeof(mosaicExpectedID))
+#include "SbfBlock.h" // mosaicExpectedIDs
 
 // "A Stream is defined as a list of messages that should be output with the same interval on one
 //  connection descriptor (Cd). In other words, one Stream is associated with one Cd and one Interval."
@@ -3161,9 +3161,109 @@ void nmeaExtractStdDeviations(char *nmeaSentence, int sentenceLength)
 //----------------------------------------
 void processNonSBFData(const uint8_t * buffer, size_t length)
 {
-    for (uint32_t dataOffset = 0; dataOffset < length; dataOffset++)
+    const uint8_t *end;
+    const uint8_t *preamble;
+
+    end = &buffer[length];
+    while (buffer < end)
+    {
+        // The idle SPARTN parser discards everything before the preamble, skip it in bulk
+        if (spartnParse->state == sempFirstByte)
+        {
+            preamble = (const uint8_t *)memchr(buffer, SPARTN_PREAMBLE, end - buffer);
+            if (!preamble)
+                break;
+            buffer = preamble;
+        }
+
         // Update the SPARTN parser state based on the non-SBF byte
-        sempParseNextByte(spartnParse, buffer[dataOffset]);
+        sempParseNextByte(spartnParse, *buffer++);
+    }
+}
+
+//----------------------------------------
+// Pass the mosaic-X5 COM1 data to the SBF parser, called by gnssReadTask
+// While the SBF parser is idle, the data up to the next SBF sync is raw L-Band
+// and is passed to the SPARTN parser in bulk.  Within a block, the data is
+// passed in bulk up to the next check, see SbfBlock.h.  The SBF ID and length
+// are checked once the header is complete, the EncapsulatedOutput payload
+// length once its header is complete.
+//----------------------------------------
+void gnssReadSbfData(const uint8_t *buffer, size_t length, bool spartnParserNeeded)
+{
+    size_t bytes;
+    const uint8_t *end;
+    bool expected;
+    size_t received;
+    const uint8_t *sync;
+
+    end = &buffer[length];
+    while (buffer < end)
+    {
+        // Determine the number of block bytes already received
+        received = 0;
+        if (sbfParse->state == sempFirstByte)
+        {
+            // Skip the L-Band data before the next SBF sync
+            sync = (const uint8_t *)memchr(buffer, SBF_SYNC_1, end - buffer);
+            bytes = (sync ? sync : end) - buffer;
+            if (bytes)
+            {
+                // The invalidDataCallback would pass these bytes to the SPARTN parser
+                if (spartnParserNeeded)
+                    processNonSBFData(buffer, bytes);
+                buffer += bytes;
+                continue;
+            }
+        }
+        else
+            received = sbfParse->length;
+
+        // Pass the data up to the next check
+        if (received >= SBF_HEADER_LENGTH)
+            bytes = mosaicSbfBytesToCheck(received, sempSbfGetId(sbfParse), sempSbfGetLength(sbfParse));
+        else
+            bytes = mosaicSbfBytesToCheck(received, 0, 0);
+        if (bytes > (size_t)(end - buffer))
+            bytes = end - buffer;
+        sempParseNextBytes(sbfParse, (uint8_t *)buffer, bytes);
+        buffer += bytes;
+
+        // Also check parser is running - as invalidDataCallback may have just been called
+        if (sbfParse->state == sempFirstByte)
+            continue;
+
+        // Check the SBF ID and length once the header is complete
+        if (sbfParse->length == SBF_HEADER_LENGTH)
+        {
+            expected = mosaicSbfHeaderValid(sempSbfGetId(sbfParse), sempSbfGetLength(sbfParse));
+            if ((!expected) && settings.debugGnss)
+                systemPrintf("Unexpected SBF block %d - rejected on ID or length\r\n", sempSbfGetId(sbfParse));
+        }
+
+        // Extra checks for EncapsulatedOutput - length is variable but we can compare the length to the
+        // payload length
+        else if ((sbfParse->length == SBF_ENCAPSULATED_HEADER_LENGTH)
+                 && (sempSbfGetId(sbfParse) == SBF_ENCAPSULATED_OUTPUT_ID))
+        {
+            expected = mosaicSbfEncapsulatedValid(sbfParse->buffer, sempSbfGetLength(sbfParse));
+            if ((!expected) && settings.debugGnss)
+                systemPrintf("Unexpected EncapsulatedOutput block - rejected\r\n");
+        }
+        else
+            continue;
+
+        // SBF is not expected so restart the parsers
+        // We could pass the rejected bytes to the SPARTN parser but this is ~risky
+        // as the L-Band data could overlap the start of actual SBF. I think it's
+        // probably safer to discard the data and let both parsers re-sync?
+        if (!expected)
+        {
+            sbfParse->state = sempFirstByte;
+            if (spartnParserNeeded)
+                spartnParse->state = sempFirstByte;
+        }
+    }
 }
 
 //----------------------------------------
@@ -3238,8 +3338,7 @@ void processUart1SBF(SEMP_PARSE_STATE *parse, uint16_t type)
     {
         uint16_t len = sempSbfGetEncapsulatedPayloadLength(parse);
         const uint8_t *ptr = sempSbfGetEncapsulatedPayload(parse);
-        for (uint16_t i = 0; i < len; i++)
-            sempParseNextByte(rtkParse, *ptr++);
+        sempParseNextBytes(rtkParse, (uint8_t *)ptr, len);
     }
 }
 
@@ -3295,6 +3394,11 @@ void mosaicVerifyTables()
         reportFatalError("Fix mosaicRTCMv3IntervalGroups to match mosaicRTCMv3MsgIntervalGroups");
     if (MOSAIC_NUM_DYN_MODELS != MAX_MOSAIC_RX_DYNAMICS)
         reportFatalError("Fix mosaic_Dynamics to match mosaicReceiverDynamics");
+
+    // mosaicExpectedIdLookup uses a binary search
+    for (int index = 1; index < MAX_MOSAIC_EXPECTED_SBF; index++)
+        if (mosaicExpectedIDs[index - 1].ID >= mosaicExpectedIDs[index].ID)
+            reportFatalError("Fix mosaicExpectedIDs to be sorted by ID");
 }
 
 //==========================================================================
@@ -19,8 +19,11 @@ LoRa.ino
     This poses a bit of a problem: we have to disconnect from USB serial (no prints)
     while configuration or data is being passed.
 
-    If we are in Base mode, listen from RTCM. Once received, disconnect from USB, send to
-    LoRa radio, then re-connect to USB.
+    If we are in Base mode, listen from RTCM. The RTCM consumer queues the messages for
+    loraTxTask. At the end of the epoch (the MSM with the multiple message bit clear, or
+    no more RTCM for LORA_TX_EPOCH_IDLE_MSEC) loraTxTask disconnects from USB once, sends
+    the epoch to the LoRa radio as a single burst, then re-connects to USB. The console
+    output written during the burst is held and printed once USB is re-connected.
 
     If we are in Rover mode, and LoRa is enabled, then we are connected permanently to the LoRa
     radio to listen for incoming serial data. If no USB cable is attached, immediately
@@ -95,6 +98,37 @@ int loraBytesSent = 0;
 
 HardwareSerial *SerialForLoRa; // Don't instantiate until we know the platform. May compete with SerialForTilt.
 
+// RTCM bursts on Torch
+#define LORA_TX_BUFFER_BYTES 4096    // RTCM waiting for loraTxTask
+#define LORA_TX_BURST_BYTES 1024     // Send the burst without waiting for the end of the epoch
+#define LORA_TX_EPOCH_IDLE_MSEC 100  // Send the burst when no more RTCM arrives within this time
+#define LORA_TX_PACING_BYTES 64      // Bytes written between the delays when pacing to loraAirDataRate_bps
+#define LORA_CONSOLE_HOLD_BYTES 1024 // Console output held while UART0 is connected to the radio
+
+static uint8_t *loraTxBuffer;
+static uint16_t loraTxHead;            // Written by the RTCM consumer
+static uint16_t loraTxMessageStart;    // Offset of the current RTCM message
+static uint16_t loraTxMessageLength;   // Length of the current RTCM message
+static uint16_t loraTxMessageReceived; // Bytes of the current RTCM message in the buffer
+static bool loraTxMessageDropped;      // The current RTCM message did not fit in the buffer
+static uint16_t loraTxPublished;       // End of the last complete message, published to loraTxTask
+static uint16_t loraTxTail;            // Written by loraTxTask
+static volatile uint32_t loraTxLastMessageMillis;
+static TaskHandle_t loraTxTaskHandle;
+
+static uint32_t loraTxBursts;       // Mux selections since the last report
+static uint32_t loraTxWindowMsec;   // Time UART0 was connected to the radio since the last report
+static uint32_t loraTxAirMsec;      // Time on the air at loraAirDataRate_bps since the last report
+static uint32_t loraTxBytesDropped; // RTCM discarded because the buffer was full
+
+static uint8_t loraConsoleHoldBuffer[LORA_CONSOLE_HOLD_BYTES];
+static uint16_t loraConsoleHoldBytes;
+static uint16_t loraConsoleHoldOffset; // Next byte to print
+static uint32_t loraConsoleBytesDropped;
+static volatile bool loraConsoleHoldActive;
+static volatile bool loraUsbSerialWriteActive; // The USB serial consumer is writing GNSS data to UART0
+static portMUX_TYPE loraConsoleLock = portMUX_INITIALIZER_UNLOCKED;
+
 // Called from main loop
 // Control incoming/outgoing RTCM data from STM32 based LoRa radio (if supported by platform)
 void updateLora()
@@ -125,6 +159,7 @@ void updateLora()
 
             // Configure LoRa for transmit and move to LORA_TX
             loraSetupTransmit();
+            loraTxTaskStart();
 
             loraState = LORA_TX;
         }
@@ -191,6 +226,7 @@ void updateLora()
                 systemPrintln("LoRa: Moving to TX");
 
             loraSetupTransmit();
+            loraTxTaskStart();
 
             loraState = LORA_TX;
         }
@@ -202,7 +238,7 @@ void updateLora()
 
     case (LORA_TX):
         // Nothing to do but print debug statements.
-        // Incoming RTCM to send out over LoRa is handled by processUart1Message() task and loraProcessRTCM()
+        // Incoming RTCM to send out over LoRa is handled by loraProcessRTCM() and loraTxTask()
         // On Facet FP, GNSS UART2 is connected directly to LoRa
 
         if (inMainMenu == false)
@@ -212,15 +248,21 @@ void updateLora()
                 static unsigned long lastReport = 0;
                 if ((millis() - lastReport) > 3000)
                 {
+                    uint32_t elapsed = millis() - lastReport;
                     lastReport = millis();
                     systemPrintf("LoRa %stransmitted %d RTCM bytes\r\n",
                                  (productVariant == RTK_FACET_FP) ? "should have " : "", loraBytesSent);
                     loraBytesSent = 0;
+                    if (productVariant == RTK_TORCH)
+                        loraTxReport(elapsed);
                 }
             }
 
             if (inBaseMode() == false)
+            {
+                loraTxTaskStop();
                 loraState = LORA_NOT_STARTED; // Force restart to move to other modes
+            }
         }
 
         break;
@@ -268,7 +310,7 @@ void updateLora()
             if (correctionLastSeen(CORR_RADIO_LORA))
             {
                 // Pass RTCM bytes (presumably) from LoRa out ESP32-UART to GNSS
-                gnss->pushRawData(rtcmData, rtcmCount); // Push RTCM to GNSS module
+                correctionPushRawData(CORR_RADIO_LORA, rtcmData, rtcmCount, true); // Push RTCM to GNSS module
 
                 if (((settings.debugCorrections == true) || (settings.debugLora == true)) && !inMainMenu)
                 {
@@ -318,7 +360,7 @@ void updateLora()
             if (correctionLastSeen(CORR_RADIO_LORA))
             {
                 // Pass RTCM bytes (presumably) from LoRa out ESP32-UART to GNSS
-                gnss->pushRawData(rtcmData, rtcmCount); // Push RTCM to GNSS module
+                correctionPushRawData(CORR_RADIO_LORA, rtcmData, rtcmCount, true); // Push RTCM to GNSS module
 
                 if (((settings.debugCorrections == true) || (settings.debugLora == true)) && !inMainMenu)
                 {
@@ -412,6 +454,8 @@ void loraStop()
         if (settings.debugLora == true)
             systemPrintln("Stopping LoRa");
 
+        loraTxTaskStop();
+
         loraPowerOff(); // Power down STM32/radio
 
         if (SerialForLoRa != nullptr)
@@ -1479,32 +1523,339 @@ void loraTxDirectConnectFacetFP()
     }
 }
 
+// Get a byte of the RTCM message from the LoRa TX buffer
+static uint8_t loraTxByte(uint16_t messageStart, uint16_t index)
+{
+    return loraTxBuffer[(messageStart + index) % LORA_TX_BUFFER_BYTES];
+}
+
+// Determine if the RTCM message ends the epoch: an MSM message with the multiple message bit clear
+static bool loraTxEpochEnd(uint16_t messageStart, uint16_t length)
+{
+    uint16_t messageNumber;
+
+    // Preamble, reserved and length (3 bytes) followed by the MSM header through the multiple message bit
+    if (length < 10)
+        return false;
+    messageNumber = (loraTxByte(messageStart, 3) << 4) | (loraTxByte(messageStart, 4) >> 4);
+    if ((messageNumber < 1071) || (messageNumber > 1137) || ((messageNumber % 10) < 1) || ((messageNumber % 10) > 7))
+        return false;
+
+    // Multiple message bit is header bit 54
+    return (loraTxByte(messageStart, 9) & 0x02) == 0;
+}
+
+// Start a new RTCM message, called by rtcmConsumerMessageBegin before the message is passed to loraProcessRTCM
+void loraRtcmMessageBegin(uint16_t length)
+{
+    uint16_t bytesFree;
+    uint16_t tail;
+
+    // Only needed for Torch. Facet FP has GNSS tied directly to LoRa.
+    loraTxMessageStart = loraTxHead;
+    loraTxMessageLength = length;
+    loraTxMessageReceived = 0;
+    loraTxMessageDropped = true;
+    if ((loraState != LORA_TX) || (productVariant != RTK_TORCH) || (loraTxTaskHandle == nullptr))
+        return;
+
+    // Discard the message when it does not fit
+    tail = __atomic_load_n(&loraTxTail, __ATOMIC_ACQUIRE);
+    bytesFree = (tail + LORA_TX_BUFFER_BYTES - loraTxHead - 1) % LORA_TX_BUFFER_BYTES;
+    if (length > bytesFree)
+    {
+        loraTxBytesDropped = loraTxBytesDropped + length;
+        return;
+    }
+    loraTxMessageDropped = false;
+}
+
 // Send stored RTCM out the radio. Data from GNSS has been filtered to *only* RTCM.
 // Fed from processUart1Message. See storeRTCMForConsumers()/sendRTCMToConsumers()
 // Note this only applies to Torch. FP has a direct GNSS UART2 to LoRa UART0 connection.
 // See settings.enableNmeaOnRadio for limiting RTCM out GNSS UART2.
 void loraProcessRTCM(uint8_t *rtcmData, uint16_t dataLength)
 {
+    uint16_t bytesToEnd;
+    uint16_t bytesToWrite;
+    uint16_t pending;
+    TaskHandle_t taskHandle;
+
     if (loraState == LORA_TX)
     {
-        // Only needed for Torch. Facet FP has GNSS tied directly to LoRa.
+        // Torch shares UART0 with USB, queue the data for loraTxTask
         if (productVariant == RTK_TORCH)
         {
-            // Send this data to the LoRa radio
-            systemFlush();                // Complete prints
-            muxSelectLoRaCommunication(); // Connect the LoRa radio to ESP32 UART0 (shared with USB)
+            if (loraTxMessageDropped)
+                return;
+
+            // Copy the data into the buffer, in two pieces when it wraps
+            while (dataLength)
+            {
+                bytesToEnd = LORA_TX_BUFFER_BYTES - loraTxHead;
+                bytesToWrite = (dataLength < bytesToEnd) ? dataLength : bytesToEnd;
+                memcpy(&loraTxBuffer[loraTxHead], rtcmData, bytesToWrite);
+                loraTxHead = (loraTxHead + bytesToWrite) % LORA_TX_BUFFER_BYTES;
+                loraTxMessageReceived += bytesToWrite;
+                rtcmData += bytesToWrite;
+                dataLength -= bytesToWrite;
+            }
+            if (loraTxMessageReceived < loraTxMessageLength)
+                return;
+
+            // Publish the complete message
+            loraTxLastMessageMillis = millis();
+            __atomic_store_n(&loraTxPublished, loraTxHead, __ATOMIC_RELEASE);
+
+            // Send the burst at the end of the epoch
+            pending = (loraTxHead + LORA_TX_BUFFER_BYTES - __atomic_load_n(&loraTxTail, __ATOMIC_ACQUIRE)) %
+                      LORA_TX_BUFFER_BYTES;
+            taskHandle = loraTxTaskHandle;
+            if (taskHandle &&
+                (loraTxEpochEnd(loraTxMessageStart, loraTxMessageLength) || (pending >= LORA_TX_BURST_BYTES)))
+                xTaskNotifyGive(taskHandle);
+        }
+        else
+            // Keep a record of how many LoRa bytes _should_ be being sent
+            // Note: on Facet FP, this may not represent reality since it is difficult to know
+            //       what is being output on GNSS UART2
+            loraBytesSent += dataLength;
+    }
+}
+
+// Hold the console output written while UART0 is connected to the radio
+// Called by systemWrite, returns true when the output was held
+bool loraConsoleHold(const uint8_t *buffer, uint16_t length)
+{
+    bool held;
+    uint16_t bytesToCopy;
 
-            loraWrite(rtcmData, dataLength);
+    if (loraConsoleHoldActive == false)
+        return false;
 
-            systemFlush();  // Complete prints
-            muxSelectUsb(); // Connect USB
+    held = false;
+    portENTER_CRITICAL(&loraConsoleLock);
+    if (loraConsoleHoldActive)
+    {
+        bytesToCopy = LORA_CONSOLE_HOLD_BYTES - loraConsoleHoldBytes;
+        if (bytesToCopy > length)
+            bytesToCopy = length;
+        memcpy(&loraConsoleHoldBuffer[loraConsoleHoldBytes], buffer, bytesToCopy);
+        loraConsoleHoldBytes += bytesToCopy;
+        loraConsoleBytesDropped += length - bytesToCopy;
+        held = true;
+    }
+    portEXIT_CRITICAL(&loraConsoleLock);
+    return held;
+}
+
+// Write the GNSS data to USB serial unless loraTxTask has UART0 connected to the radio
+// Called by systemWriteGnssDataToUsbSerial, returns the number of bytes written or discarded,
+// zero while the output is held leaving the data in the ring buffer
+size_t loraUsbSerialWrite(const uint8_t *buffer, uint16_t length)
+{
+    size_t bytesWritten;
+
+    // loraTxBurst sets the hold then waits for this write to complete
+    bytesWritten = 0;
+    __atomic_store_n(&loraUsbSerialWriteActive, true, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&loraConsoleHoldActive, __ATOMIC_SEQ_CST) == false)
+    {
+        // Discard the data while the mux on the ESP's UART is pointed at the LoRa radio
+        if (usbSerialIsSelected == false)
+            bytesWritten = length;
+        else
+            bytesWritten = Serial.write(buffer, length);
+    }
+    __atomic_store_n(&loraUsbSerialWriteActive, false, __ATOMIC_SEQ_CST);
+    return bytesWritten;
+}
+
+// Print the console output held during the LoRa burst, then stop holding the output
+static void loraConsoleRelease()
+{
+    uint8_t buffer[64];
+    uint16_t bytesToWrite;
+
+    do
+    {
+        portENTER_CRITICAL(&loraConsoleLock);
+        bytesToWrite = loraConsoleHoldBytes - loraConsoleHoldOffset;
+        if (bytesToWrite > sizeof(buffer))
+            bytesToWrite = sizeof(buffer);
+        memcpy(buffer, &loraConsoleHoldBuffer[loraConsoleHoldOffset], bytesToWrite);
+        loraConsoleHoldOffset += bytesToWrite;
+
+        // New output goes directly to USB once the held output is printed
+        if (loraConsoleHoldOffset == loraConsoleHoldBytes)
+        {
+            loraConsoleHoldBytes = 0;
+            loraConsoleHoldOffset = 0;
+            loraConsoleHoldActive = false;
         }
+        portEXIT_CRITICAL(&loraConsoleLock);
+
+        if (bytesToWrite && (forwardGnssDataToUsbSerial == false))
+            Serial.write(buffer, bytesToWrite);
+    } while (bytesToWrite);
+}
 
-        // Keep a record of how many LoRa bytes _should_ be being sent
-        // Note: on Facet FP, this may not represent reality since it is difficult to know
-        //       what is being output on GNSS UART2
-        loraBytesSent += dataLength;
+// Send the queued RTCM to the radio, connecting UART0 to the radio once for the burst
+static void loraTxBurst(uint16_t published)
+{
+    uint32_t airMsec;
+    uint32_t burstBytes;
+    uint16_t bytesToEnd;
+    uint16_t bytesToWrite;
+    uint32_t elapsed;
+    uint32_t startMillis;
+    uint16_t tail;
+
+    // Hold new prints and GNSS data, then complete the previous output before disconnecting from USB
+    __atomic_store_n(&loraConsoleHoldActive, true, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&loraUsbSerialWriteActive, __ATOMIC_SEQ_CST))
+        delay(1);
+    systemFlush();
+    if (forwardGnssDataToUsbSerial)
+        Serial.flush();
+    muxSelectLoRaCommunication(); // Connect the LoRa radio to ESP32 UART0 (shared with USB)
+
+    startMillis = millis();
+    burstBytes = 0;
+    tail = loraTxTail;
+    while (tail != published)
+    {
+        // Write the data in two pieces when it wraps
+        bytesToWrite = (published + LORA_TX_BUFFER_BYTES - tail) % LORA_TX_BUFFER_BYTES;
+        bytesToEnd = LORA_TX_BUFFER_BYTES - tail;
+        if (bytesToWrite > bytesToEnd)
+            bytesToWrite = bytesToEnd;
+        if (settings.loraAirDataRate_bps && (bytesToWrite > LORA_TX_PACING_BYTES))
+            bytesToWrite = LORA_TX_PACING_BYTES;
+        Serial.write(&loraTxBuffer[tail], bytesToWrite);
+        burstBytes += bytesToWrite;
+        tail = (tail + bytesToWrite) % LORA_TX_BUFFER_BYTES;
+        __atomic_store_n(&loraTxTail, tail, __ATOMIC_RELEASE);
+
+        // Don't get ahead of the radio
+        if (settings.loraAirDataRate_bps)
+        {
+            airMsec = (burstBytes * 8 * 1000) / settings.loraAirDataRate_bps;
+            elapsed = millis() - startMillis;
+            if (elapsed < airMsec)
+                delay(airMsec - elapsed);
+        }
     }
+    Serial.flush(); // Ensure all data is sent before we switch back to USB
+
+    muxSelectUsb(); // Connect USB
+    loraConsoleRelease();
+
+    // Account for the burst
+    loraTxBursts++;
+    loraTxWindowMsec += millis() - startMillis;
+    if (settings.loraAirDataRate_bps)
+        loraTxAirMsec += (burstBytes * 8 * 1000) / settings.loraAirDataRate_bps;
+    loraBytesSent += burstBytes;
+}
+
+// Print the LoRa transmit statistics
+void loraTxReport(uint32_t elapsedMsec)
+{
+    if (elapsedMsec == 0)
+        return;
+    systemPrintf("LoRa TX: %lu bursts, UART0 connected %lu ms (%lu%%)", loraTxBursts, loraTxWindowMsec,
+                 (loraTxWindowMsec * 100) / elapsedMsec);
+    if (settings.loraAirDataRate_bps)
+        systemPrintf(", on air %lu ms (%lu%%)", loraTxAirMsec, (loraTxAirMsec * 100) / elapsedMsec);
+    systemPrintf(", %lu RTCM bytes dropped, %lu console bytes dropped\r\n", loraTxBytesDropped,
+                 loraConsoleBytesDropped);
+    loraTxBursts = 0;
+    loraTxWindowMsec = 0;
+    loraTxAirMsec = 0;
+}
+
+// Send each RTCM epoch to the LoRa radio on Torch
+void loraTxTask(void *e)
+{
+    bool sendNow;
+    uint16_t published;
+
+    // Start notification
+    task.loraTxTaskRunning = true;
+    if (settings.printTaskStartStop)
+        systemPrintln("Task loraTxTask started");
+
+    // Run task until a request is raised
+    task.loraTxTaskStopRequest = false;
+    while (task.loraTxTaskStopRequest == false)
+    {
+        // Wait for the end of the epoch
+        sendNow = ulTaskNotifyTake(pdTRUE, LORA_TX_EPOCH_IDLE_MSEC / portTICK_PERIOD_MS) > 0;
+
+        // Send the epoch, or the partial epoch when the RTCM stops arriving
+        published = __atomic_load_n(&loraTxPublished, __ATOMIC_ACQUIRE);
+        if ((published != loraTxTail) &&
+            (sendNow || ((millis() - loraTxLastMessageMillis) >= LORA_TX_EPOCH_IDLE_MSEC)))
+            loraTxBurst(published);
+
+        if ((settings.enableTaskReports == true) && (!inMainMenu))
+            systemPrintf("loraTxTask High watermark: %d\r\n", uxTaskGetStackHighWaterMark(nullptr));
+    }
+
+    // Stop notification
+    if (settings.printTaskStartStop)
+        systemPrintln("Task loraTxTask stopped");
+    task.loraTxTaskRunning = false;
+    vTaskDelete(NULL);
+}
+
+// Start the LoRa transmit task, only Torch shares UART0 with the radio
+void loraTxTaskStart()
+{
+    TaskHandle_t taskHandle;
+
+    if ((productVariant != RTK_TORCH) || task.loraTxTaskRunning)
+        return;
+
+    if (loraTxBuffer == nullptr)
+    {
+        loraTxBuffer = (uint8_t *)rtkMalloc(LORA_TX_BUFFER_BYTES, "LoRa TX buffer");
+        if (loraTxBuffer == nullptr)
+        {
+            systemPrintln("ERROR: Failed to allocate the LoRa TX buffer!");
+            return;
+        }
+    }
+
+    // Discard the previous data
+    loraTxTail = __atomic_load_n(&loraTxPublished, __ATOMIC_ACQUIRE);
+
+    if (xTaskCreatePinnedToCore(loraTxTask,                  // Function to call
+                                "loraTx",                    // Just for humans
+                                loraTxTaskStackSize,         // Stack Size
+                                nullptr,                     // Task input parameter
+                                settings.loraTxTaskPriority, // Priority
+                                &taskHandle,                 // Task handle
+                                settings.loraTxTaskCore) != pdPASS)
+        systemPrintln("ERROR: Failed to start loraTxTask!");
+    else
+        loraTxTaskHandle = taskHandle;
+}
+
+// Stop the LoRa transmit task
+void loraTxTaskStop()
+{
+    // Stop queuing RTCM
+    TaskHandle_t taskHandle = loraTxTaskHandle;
+    loraTxTaskHandle = nullptr;
+
+    // Wait for the task to stop
+    task.loraTxTaskStopRequest = true;
+    if (taskHandle && task.loraTxTaskRunning)
+        xTaskNotifyGive(taskHandle);
+    while (task.loraTxTaskRunning)
+        delay(10);
 }
 
 // Write data to the LoRa radio, depends on platform
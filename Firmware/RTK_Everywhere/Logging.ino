@@ -126,6 +126,15 @@ void menuLog()
                 systemPrintln("Disabled");
         }
 
+        if (present.microSd && online.psram)
+        {
+            systemPrint("10) SD log buffer size: ");
+            if (settings.sdLogBufferSize)
+                systemPrintf("%d bytes\r\n", settings.sdLogBufferSize);
+            else
+                systemPrintln("Disabled, write from the ring buffer");
+        }
+
         systemPrintln("x) Exit");
 
         int incoming = getUserInputNumber(); // Returns EXIT, TIMEOUT, or long
@@ -180,6 +189,13 @@ void menuLog()
         {
             settings.alignedLogFiles ^= 1;
         }
+        else if ((incoming == 10) && present.microSd && online.psram)
+        {
+            // Zero disables sdLogTask
+            if (getNewSetting("Enter the size of each SD log buffer in bytes, 0 to disable", 0, 65536,
+                              &settings.sdLogBufferSize) == INPUT_RESPONSE_VALID)
+                systemPrintln("SD log buffer size changes take effect after a restart");
+        }
         else if (incoming == 'x')
             break;
         else if (incoming == INPUT_RESPONSE_GETNUMBER_EXIT)
@@ -223,6 +239,7 @@ void printMicroSdInfo()
 
     if (bufferOverruns)
         systemPrintf("Buffer overruns: %d\r\n", bufferOverruns);
+    sdLogPrintStats();
 }
 
 // Creates a log if logging is enabled, and SD is detected
@@ -242,6 +259,7 @@ bool beginLogging(const char *customFileName)
         if (online.microSD == true && settings.enableLogging == true &&
             online.rtc == true) // We can't create a file until we have date/time
         {
+            bool appendLog = false;
             if (customFileName == nullptr)
             {
                 // Generate a standard log file name
@@ -259,7 +277,10 @@ bool beginLogging(const char *customFileName)
                         log_d("Failed to find last log. Making new one.");
                     }
                     else
+                    {
                         log_d("Using last log file.");
+                        appendLog = true;
+                    }
                 }
                 else
                 {
@@ -305,9 +326,12 @@ bool beginLogging(const char *customFileName)
                 markSemaphore(FUNCTION_CREATEFILE);
 
                 // O_CREAT - create the file if it does not exist
-                // O_APPEND - seek to the end of the file prior to each write
-                // O_WRITE - open for write
-                if (logFile->open(logFileName, O_CREAT | O_APPEND | O_WRITE) == false)
+                // O_RDWR - open for read and write, needed to truncate the preallocated file
+                // O_APPEND - seek to the end of the file prior to each write, only used
+                //            for the last log.  A preallocated file has its preallocated
+                //            length as the file size, so appending would write after the
+                //            preallocated clusters.
+                if (logFile->open(logFileName, O_CREAT | O_RDWR | (appendLog ? O_APPEND : 0)) == false)
                 {
                     systemPrintf("Failed to create GNSS log file: %s\r\n", logFileName);
                     online.logging = false;
@@ -315,7 +339,8 @@ bool beginLogging(const char *customFileName)
                     return (false);
                 }
 
-                logFileSize = 0;
+                // Preallocate the log file and start the sector aligned writes
+                logWriterBegin();
                 lastLogSize = 0;           // Reset counter - used for displaying active logging icon
                 lastFileReport = millis(); // Fake last file report to avoid an immediate timeout
 
@@ -385,7 +410,7 @@ bool beginLogging(const char *customFileName)
                 char nmeaMessage[82]; // Max NMEA sentence length is 82
                 createNMEASentence(CUSTOM_NMEA_TYPE_RESET_REASON, nmeaMessage, sizeof(nmeaMessage),
                                    rstReason); // textID, buffer, sizeOfBuffer, text
-                logFile->println(nmeaMessage);
+                logWriterPrintln(nmeaMessage);
 
                 // Record system firmware versions and info to log
 
@@ -395,22 +420,22 @@ bool beginLogging(const char *customFileName)
                 firmwareVersionGet(&firmwareVersion[1], sizeof(firmwareVersion) - 1, true);
                 createNMEASentence(CUSTOM_NMEA_TYPE_SYSTEM_VERSION, nmeaMessage, sizeof(nmeaMessage),
                                    firmwareVersion); // textID, buffer, sizeOfBuffer, text
-                logFile->println(nmeaMessage);
+                logWriterPrintln(nmeaMessage);
 
                 // ZED-F9P firmware: HPG 1.30
                 createNMEASentence(CUSTOM_NMEA_TYPE_ZED_VERSION, nmeaMessage, sizeof(nmeaMessage),
                                    gnssFirmwareVersion); // textID, buffer, sizeOfBuffer, text
-                logFile->println(nmeaMessage);
+                logWriterPrintln(nmeaMessage);
 
                 // GNSS module unique chip ID
                 createNMEASentence(CUSTOM_NMEA_TYPE_GNSS_UNIQUE_ID, nmeaMessage, sizeof(nmeaMessage),
                                    gnssUniqueId); // textID, buffer, sizeOfBuffer, text
-                logFile->println(nmeaMessage);
+                logWriterPrintln(nmeaMessage);
 
                 // Device BT MAC. See issue: https://github.com/sparkfun/SparkFun_RTK_Firmware/issues/346
                 createNMEASentence(CUSTOM_NMEA_TYPE_DEVICE_BT_ID, nmeaMessage, sizeof(nmeaMessage),
                                    serialNumber); // textID, buffer, sizeOfBuffer, text
-                logFile->println(nmeaMessage);
+                logWriterPrintln(nmeaMessage);
 
                 // Record today's time/date into log. This is in case a log is restarted. See issue 440:
                 // https://github.com/sparkfun/SparkFun_RTK_Firmware/issues/440
@@ -422,9 +447,9 @@ bool beginLogging(const char *customFileName)
                 );
                 createNMEASentence(CUSTOM_NMEA_TYPE_CURRENT_DATE, nmeaMessage, sizeof(nmeaMessage),
                                    currentDate); // textID, buffer, sizeOfBuffer, text
-                logFile->println(nmeaMessage);
+                logWriterPrintln(nmeaMessage);
 
-                logFile->sync(); // Sync any partially written data
+                logWriterSync(); // Sync any partially written data
 
                 if (reuseLastLog == true)
                 {
@@ -462,6 +487,9 @@ void endLogging(bool gotSemaphore, bool releaseSemaphore)
 
             online.logging = false;
 
+            // Write the GNSS data waiting in the log buffers
+            sdLogFlush();
+
             // Record the number of NMEA/RTCM/UBX messages that were filtered out
             char parserStats[50];
 
@@ -471,9 +499,8 @@ void endLogging(bool gotSemaphore, bool releaseSemaphore)
             char nmeaMessage[82]; // Max NMEA sentence length is 82
             createNMEASentence(CUSTOM_NMEA_TYPE_PARSER_STATS, nmeaMessage, sizeof(nmeaMessage),
                                parserStats); // textID, buffer, sizeOfBuffer, text
-            logFile->sync();                 // Sync any partially written data
-            logFile->println(nmeaMessage);
-            logFile->sync();
+            logWriterPrintln(nmeaMessage);
+            logWriterEnd(); // Write the partial sector, release the unused preallocated space
 
             // Reset stats in case a new log is created
             failedParserMessages_NMEA = 0;
@@ -505,6 +532,530 @@ void endLogging(bool gotSemaphore, bool releaseSemaphore)
     }
 }
 
+//----------------------------------------
+// Log writer
+//
+// The GNSS data arrives in odd sized pieces.  Writing these pieces directly
+// causes the SD card to read-modify-write partial sectors and the FAT to
+// allocate a cluster in the middle of a write, resulting in long writes.
+//
+// The log writer only writes whole sectors to the file, the partial sector
+// at the end of the data is held in logWriterBuffer until the sector is
+// complete.  A new log file is preallocated as contiguous clusters, sized
+// from maxLogLength and the GNSS data rate, then truncated to the data
+// length when the log is closed.
+//----------------------------------------
+
+#define LOG_WRITER_SECTOR_SIZE              512
+#define LOG_WRITER_PREALLOCATE_MARGIN       125                  // Percent of the expected log length
+#define LOG_WRITER_PREALLOCATE_MAXIMUM      (2ull * 1024 * 1024 * 1024) // FAT32 limits files to 4 GB
+#define LOG_WRITER_PREALLOCATE_MINUTES      60                   // Used when maxLogLength is zero (no limit)
+
+static uint8_t logWriterBuffer[LOG_WRITER_SECTOR_SIZE]; // Partial sector waiting for more data
+static uint16_t logWriterStaged;                        // Bytes in logWriterBuffer
+static uint64_t logWriterCommitted;                     // Bytes written to the log file
+static uint64_t logWriterPreallocated;                  // Length of the preallocated file, zero if not preallocated
+
+// Determine the number of bytes to preallocate for a new log file
+uint64_t logWriterPreallocateBytes()
+{
+    uint64_t bytes;
+    uint32_t minutes;
+
+    minutes = settings.maxLogLength_minutes;
+    if (minutes == 0)
+        minutes = LOG_WRITER_PREALLOCATE_MINUTES;
+    bytes = (uint64_t)ringBufferBytesPerSecond() * 60 * minutes * LOG_WRITER_PREALLOCATE_MARGIN / 100;
+
+    // Leave room on the SD card for the other files
+    if (bytes > (sdFreeSpace >> 1))
+        bytes = sdFreeSpace >> 1;
+    if (bytes > LOG_WRITER_PREALLOCATE_MAXIMUM)
+        bytes = LOG_WRITER_PREALLOCATE_MAXIMUM;
+    return bytes & ~(uint64_t)(LOG_WRITER_SECTOR_SIZE - 1);
+}
+
+// Start writing to the log file, called with the sdCardSemaphore after the log file is opened
+void logWriterBegin()
+{
+    uint64_t bytes;
+    unsigned long startMillis;
+
+    logWriterStaged = 0;
+    logWriterCommitted = logFile->fileSize();
+    logWriterPreallocated = 0;
+    logFileSize = logWriterCommitted;
+
+    // Only an empty file may be preallocated, data is added to the end of an existing log
+    if (logWriterCommitted)
+    {
+        logFile->seekSet(logWriterCommitted);
+        return;
+    }
+
+    // Allocate contiguous clusters for the log file
+    bytes = logWriterPreallocateBytes();
+    if (bytes == 0)
+        return;
+    startMillis = millis();
+    if (logFile->preAllocate(bytes))
+    {
+        // preAllocate sets the file size to the preallocated length, write
+        // the data from the start of the file
+        logFile->seekSet(0);
+        logWriterPreallocated = bytes;
+        if ((settings.enablePrintLogFileStatus) && (!inMainMenu))
+            systemPrintf("Log file: preallocated %llu bytes in %lu ms\r\n", bytes, millis() - startMillis);
+    }
+    else if ((settings.enablePrintLogFileStatus) && (!inMainMenu))
+        systemPrintf("Log file: failed to preallocate %llu bytes\r\n", bytes);
+}
+
+// Write the partial sector to the log file
+// Returns true when the data was written
+bool logWriterCommit()
+{
+    int32_t bytesWritten;
+
+    if (logWriterStaged == 0)
+        return true;
+    bytesWritten = logFile->write(logWriterBuffer, logWriterStaged);
+    if (bytesWritten <= 0)
+        return false;
+
+    // Keep the data that was not written
+    logWriterCommitted += bytesWritten;
+    logWriterStaged -= bytesWritten;
+    if (logWriterStaged)
+        memmove(logWriterBuffer, &logWriterBuffer[bytesWritten], logWriterStaged);
+    return (logWriterStaged == 0);
+}
+
+// Add data to the log file, only whole sectors are written to the SD card
+// Returns the number of bytes accepted
+int32_t logWriterWrite(const uint8_t *data, int32_t length)
+{
+    int32_t bytes;
+    int32_t bytesAccepted;
+    int32_t bytesWritten;
+
+    bytesAccepted = 0;
+
+    // Complete the partial sector
+    if (logWriterStaged || (logWriterCommitted % LOG_WRITER_SECTOR_SIZE))
+    {
+        // A failed write may leave a complete sector in the buffer
+        bytes = (LOG_WRITER_SECTOR_SIZE - ((logWriterCommitted + logWriterStaged) % LOG_WRITER_SECTOR_SIZE))
+              % LOG_WRITER_SECTOR_SIZE;
+        if (bytes > length)
+            bytes = length;
+        memcpy(&logWriterBuffer[logWriterStaged], data, bytes);
+        logWriterStaged += bytes;
+        logFileSize = logWriterCommitted + logWriterStaged;
+        data += bytes;
+        length -= bytes;
+        bytesAccepted += bytes;
+
+        // Wait for the rest of the sector
+        if ((logWriterCommitted + logWriterStaged) % LOG_WRITER_SECTOR_SIZE)
+            return bytesAccepted;
+        if (logWriterCommit() == false)
+            return bytesAccepted;
+    }
+
+    // Write the whole sectors directly from the caller's buffer
+    bytes = length & ~(LOG_WRITER_SECTOR_SIZE - 1);
+    if (bytes)
+    {
+        bytesWritten = logFile->write(data, bytes);
+        if (bytesWritten > 0)
+        {
+            logWriterCommitted += bytesWritten;
+            bytesAccepted += bytesWritten;
+        }
+        logFileSize = logWriterCommitted;
+        if (bytesWritten != bytes)
+            return bytesAccepted;
+        data += bytes;
+        length -= bytes;
+    }
+
+    // Hold the start of the next sector
+    memcpy(logWriterBuffer, data, length);
+    logWriterStaged = length;
+    logFileSize = logWriterCommitted + logWriterStaged;
+    return bytesAccepted + length;
+}
+
+// Add a line of text to the log file
+void logWriterPrintln(const char *text)
+{
+    logWriterWrite((const uint8_t *)text, strlen(text));
+    logWriterWrite((const uint8_t *)"\r\n", 2);
+}
+
+// Write the partial sector and update the directory entry
+void logWriterSync()
+{
+    logWriterCommit();
+    logFile->sync();
+}
+
+// Finish writing the log file, release the unused preallocated space
+void logWriterEnd()
+{
+    logWriterCommit();
+    if (logWriterPreallocated && (logWriterCommitted < logWriterPreallocated))
+        logFile->truncate(logWriterCommitted);
+    logFile->sync();
+    logWriterPreallocated = 0;
+}
+
+//----------------------------------------
+// SD log task
+//
+// When PSRAM is available, the SD card ring buffer consumer only copies the
+// GNSS data into one of two large log buffers.  sdLogTask owns the writes to
+// the log file: it writes the full buffer while the consumer fills the other
+// buffer and records the events.  sdLogTask runs sdLogUpdate at least every
+// SD_LOG_POLL_MSEC, which syncs the log file every 60 seconds, or after 2
+// seconds when the log file size is not increasing.
+//
+//    handleGnssDataTask            sdLogTask
+//    gnssDataSendSdCard            sdLogWriteBuffer
+//            |                            ^
+//            V                            |
+//    sdLogBuffer[sdLogActive] --> sdLogBuffer[sdLogFull] --> logWriterWrite
+//
+// The consumer hands the active buffer to sdLogTask when the buffer is full
+// or holds data older than SD_LOG_SWAP_MSEC.  When sdLogTask is still writing
+// the other buffer, the data waits in the ring buffer.
+//----------------------------------------
+
+#define SD_LOG_BUFFER_SIZE_MINIMUM  (1024 * 4)
+#define SD_LOG_BUFFER_SIZE_MAXIMUM  (1024 * 64)
+#define SD_LOG_POLL_MSEC            100  // Retry and sync check interval
+#define SD_LOG_SWAP_MSEC            1000 // Maximum age of the data in the active buffer
+#define SD_LOG_FLUSH_TIMEOUT_MSEC   500  // Time for the consumer to hand over the active buffer
+
+static uint8_t *sdLogBuffer[2];                  // Allocated by sdLogTaskStart, never freed
+static volatile uint32_t sdLogBufferLength[2];   // Bytes in each buffer
+static uint32_t sdLogBufferSize;                 // Size of each buffer
+static uint8_t sdLogActive;                      // Buffer filled by gnssDataSendSdCard
+static uint32_t sdLogActiveMillis;               // Arrival of the oldest data in the active buffer
+static volatile int8_t sdLogFull = -1;           // Buffer waiting for sdLogTask, -1 when none
+static volatile bool sdLogFlushRequest;          // endLogging is waiting for the active buffer
+static TaskHandle_t sdLogTaskHandle;
+
+// sdLogTask statistics
+static uint32_t sdLogSwaps;         // Buffers handed to sdLogTask
+static uint32_t sdLogWaits;         // Active buffer full while sdLogTask was writing
+static uint32_t sdLogWriteMaxMsec;  // Longest buffer write
+static uint64_t sdLogBytesWritten;  // Bytes written by sdLogTask
+static uint32_t sdLogWriteMillis;   // Total time spent writing
+
+// Determine if the SD card data is written by sdLogTask
+bool sdLogTaskIsRunning()
+{
+    return (sdLogTaskHandle != nullptr);
+}
+
+// Hand the active buffer to sdLogTask
+// Returns false while sdLogTask is writing the other buffer
+bool sdLogSwap()
+{
+    TaskHandle_t taskHandle;
+
+    if (__atomic_load_n(&sdLogFull, __ATOMIC_ACQUIRE) >= 0)
+        return false;
+    __atomic_store_n(&sdLogFull, (int8_t)sdLogActive, __ATOMIC_RELEASE);
+    sdLogActive ^= 1;
+    sdLogSwaps++;
+
+    // Wake sdLogTask
+    taskHandle = sdLogTaskHandle;
+    if (taskHandle)
+        xTaskNotifyGive(taskHandle);
+    return true;
+}
+
+// Copy the SD card logging data from the ring buffer into the active log buffer
+// Called by gnssDataSendSdCard, returns the amount of data remaining in the ring buffer
+int32_t sdLogCopyRingBufferData(int32_t bytesToSend)
+{
+    int32_t bytes;
+    bool flushRequest;
+    uint32_t length;
+    RING_BUFFER_OFFSET sdTail;
+
+    // Stop copying once the log file is closed.  endLogging clears online.logging
+    // before calling sdLogFlush, the partial buffer is still handed over below.
+    sdTail = sdRingBufferTail;
+    while (bytesToSend && online.logging)
+    {
+        // Hand the full buffer to sdLogTask
+        length = sdLogBufferLength[sdLogActive];
+        if (length >= sdLogBufferSize)
+        {
+            if (sdLogSwap() == false)
+            {
+                sdLogWaits++;
+                break;
+            }
+            continue;
+        }
+
+        // Copy the data, in two pieces when the data wraps
+        bytes = sdLogBufferSize - length;
+        if (bytes > bytesToSend)
+            bytes = bytesToSend;
+        if ((sdTail + bytes) > ringBufferSize)
+            bytes = ringBufferSize - sdTail;
+        if (length == 0)
+            sdLogActiveMillis = millis();
+        memcpy(&sdLogBuffer[sdLogActive][length], &ringBuffer[sdTail], bytes);
+        sdLogBufferLength[sdLogActive] = length + bytes;
+
+        // Account for the copied data
+        sdTail += bytes;
+        if (sdTail >= ringBufferSize)
+            sdTail -= ringBufferSize;
+        bytesToSend -= bytes;
+    }
+
+    // Publish the new tail with a single write
+    sdRingBufferTail = sdTail;
+
+    // Don't let the data get too old, sdLogTask also syncs the log file.
+    // Hand over the partial buffer when endLogging is closing the log file.
+    flushRequest = __atomic_load_n(&sdLogFlushRequest, __ATOMIC_ACQUIRE);
+    if (sdLogBufferLength[sdLogActive]
+        && (flushRequest || (online.logging && ((millis() - sdLogActiveMillis) >= SD_LOG_SWAP_MSEC))))
+        sdLogSwap();
+    if (flushRequest && (sdLogBufferLength[sdLogActive] == 0))
+        __atomic_store_n(&sdLogFlushRequest, false, __ATOMIC_RELEASE);
+    return bytesToSend;
+}
+
+// Write the log buffers before the log file is closed
+// Called by endLogging while holding the sdCardSemaphore, sdLogTask waits for
+// the semaphore so the full buffers are written here
+void sdLogFlush()
+{
+    int32_t bytesWritten;
+    bool flushed;
+    int8_t index;
+    uint32_t length;
+    uint32_t startMillis;
+
+    if (sdLogTaskIsRunning() == false)
+        return;
+
+    // Ask the SD card consumer for the active buffer
+    __atomic_store_n(&sdLogFlushRequest, true, __ATOMIC_RELEASE);
+    startMillis = millis();
+    do
+    {
+        // The consumer hands over the active buffer before clearing the request
+        flushed = (__atomic_load_n(&sdLogFlushRequest, __ATOMIC_ACQUIRE) == false);
+        index = __atomic_load_n(&sdLogFull, __ATOMIC_ACQUIRE);
+        if (index >= 0)
+        {
+            // Write the full buffer
+            length = sdLogBufferLength[index];
+            bytesWritten = logWriterWrite(sdLogBuffer[index], length);
+            if (bytesWritten != (int32_t)length)
+                systemPrintf("SD write mismatch @ %s: wrote %d bytes of %lu\r\n", getTimeStamp(), bytesWritten,
+                             length);
+            if (bytesWritten > 0)
+            {
+                sdFreeSpace -= bytesWritten;
+                sdLogBytesWritten += bytesWritten;
+            }
+
+            // Release the buffer
+            sdLogBufferLength[index] = 0;
+            __atomic_store_n(&sdLogFull, (int8_t)-1, __ATOMIC_RELEASE);
+        }
+        else if (flushed)
+            return;
+        else
+            delay(1);
+    } while ((millis() - startMillis) < SD_LOG_FLUSH_TIMEOUT_MSEC);
+
+    __atomic_store_n(&sdLogFlushRequest, false, __ATOMIC_RELEASE);
+    systemPrintln("SD log buffer not written, the SD card consumer is not running");
+}
+
+// Write the full buffer to the log file, sync the log file on a timer
+void sdLogWriteBuffer()
+{
+    int32_t bytesWritten;
+    uint32_t deltaMillis;
+    int8_t index;
+    uint32_t length;
+    unsigned long startMillis;
+
+    index = __atomic_load_n(&sdLogFull, __ATOMIC_ACQUIRE);
+    if ((index < 0) && (online.logging == false))
+        return;
+
+    // Attempt to gain access to the SD card, avoids collisions with file
+    // writing from other functions like recordSystemSettingsToFile()
+    if (xSemaphoreTake(sdCardSemaphore, loggingSemaphoreWait_ms) != pdPASS)
+        return; // Retry after SD_LOG_POLL_MSEC
+    markSemaphore(FUNCTION_WRITESD);
+
+    // endLogging may have written the full buffer while holding the semaphore
+    index = __atomic_load_n(&sdLogFull, __ATOMIC_ACQUIRE);
+
+    // The data is discarded when the log file was closed
+    if (online.logging && logFile)
+    {
+        bytesWritten = 0;
+        startMillis = millis();
+        if (index >= 0)
+        {
+            length = sdLogBufferLength[index];
+            bytesWritten = logWriterWrite(sdLogBuffer[index], length);
+            if (bytesWritten != (int32_t)length)
+                systemPrintf("SD write mismatch @ %s: wrote %d bytes of %lu\r\n", getTimeStamp(), bytesWritten,
+                             length);
+        }
+
+        // Record the events and sync the log file
+        sdLogUpdate(bytesWritten);
+
+        // Account for the write
+        deltaMillis = millis() - startMillis;
+        if (bytesWritten > 0)
+        {
+            sdLogBytesWritten += bytesWritten;
+            sdLogWriteMillis += deltaMillis;
+        }
+        if (sdLogWriteMaxMsec < deltaMillis)
+            sdLogWriteMaxMsec = deltaMillis;
+        if (settings.enablePrintBufferOverrun && (deltaMillis > 150))
+            systemPrintf("Long Write! Time: %ld ms / Location: %ld / Recorded %d bytes\r\n", deltaMillis,
+                         logFileSize, bytesWritten);
+    }
+    xSemaphoreGive(sdCardSemaphore);
+
+    // Release the buffer
+    if (index >= 0)
+    {
+        sdLogBufferLength[index] = 0;
+        __atomic_store_n(&sdLogFull, (int8_t)-1, __ATOMIC_RELEASE);
+    }
+}
+
+// Write the GNSS data from the log buffers to the SD card
+void sdLogTask(void *e)
+{
+    // Start notification
+    task.sdLogTaskRunning = true;
+    if (settings.printTaskStartStop)
+        systemPrintln("Task sdLogTask started");
+
+    // Run task until a request is raised
+    task.sdLogTaskStopRequest = false;
+    while (task.sdLogTaskStopRequest == false)
+    {
+        // Wait for a full buffer
+        ulTaskNotifyTake(pdTRUE, SD_LOG_POLL_MSEC / portTICK_PERIOD_MS);
+        sdLogWriteBuffer();
+
+        if ((settings.enableTaskReports == true) && (!inMainMenu))
+            systemPrintf("sdLogTask High watermark: %d\r\n", uxTaskGetStackHighWaterMark(nullptr));
+    }
+
+    // Write the remaining data, the ring buffer consumers are stopped
+    sdLogWriteBuffer();
+    if (sdLogBufferLength[sdLogActive] && sdLogSwap())
+        sdLogWriteBuffer();
+
+    // Stop notification
+    if (settings.printTaskStartStop)
+        systemPrintln("Task sdLogTask stopped");
+    task.sdLogTaskRunning = false;
+    vTaskDelete(NULL);
+}
+
+// Start the SD log task, the ring buffer data is written directly when PSRAM is not available
+void sdLogTaskStart()
+{
+    uint32_t size;
+    TaskHandle_t taskHandle;
+
+    if (task.sdLogTaskRunning || (present.microSd == false) || (online.psram == false) ||
+        (settings.sdLogBufferSize == 0))
+        return;
+
+    // Allocate the log buffers
+    if (sdLogBuffer[0] == nullptr)
+    {
+        size = settings.sdLogBufferSize;
+        if (size < SD_LOG_BUFFER_SIZE_MINIMUM)
+            size = SD_LOG_BUFFER_SIZE_MINIMUM;
+        if (size > SD_LOG_BUFFER_SIZE_MAXIMUM)
+            size = SD_LOG_BUFFER_SIZE_MAXIMUM;
+        size &= ~(LOG_WRITER_SECTOR_SIZE - 1);
+        sdLogBuffer[0] = (uint8_t *)rtkMalloc(size * 2, "SD log buffers (sdLogBuffer)");
+        if (sdLogBuffer[0] == nullptr)
+        {
+            systemPrintln("ERROR: Failed to allocate the SD log buffers, writing the SD card directly!");
+            return;
+        }
+        sdLogBuffer[1] = &sdLogBuffer[0][size];
+        sdLogBufferSize = size;
+    }
+
+    // Discard the previous data
+    sdLogBufferLength[0] = 0;
+    sdLogBufferLength[1] = 0;
+    sdLogFull = -1;
+
+    if (xTaskCreatePinnedToCore(sdLogTask,                  // Function to call
+                                "sdLog",                    // Just for humans
+                                sdLogTaskStackSize,         // Stack Size
+                                nullptr,                    // Task input parameter
+                                settings.sdLogTaskPriority, // Priority
+                                &taskHandle,                // Task handle
+                                settings.sdLogTaskCore) != pdPASS)
+        systemPrintln("ERROR: Failed to start sdLogTask, writing the SD card directly!");
+    else
+        sdLogTaskHandle = taskHandle;
+}
+
+// Stop the SD log task after writing the buffered data
+// Called after the ring buffer consumers are stopped
+void sdLogTaskStop()
+{
+    // Stop waking the task
+    TaskHandle_t taskHandle = sdLogTaskHandle;
+    sdLogTaskHandle = nullptr;
+
+    // Wait for the task to stop
+    task.sdLogTaskStopRequest = true;
+    if (taskHandle && task.sdLogTaskRunning)
+        xTaskNotifyGive(taskHandle);
+    while (task.sdLogTaskRunning)
+        delay(10);
+}
+
+// Display the SD log task statistics
+void sdLogPrintStats()
+{
+    if (sdLogSwaps == 0)
+        return;
+    systemPrintf("SD log buffers: %lu swaps, %lu waits, %lu ms max write, ", sdLogSwaps, sdLogWaits,
+                 sdLogWriteMaxMsec);
+    if (sdLogWriteMillis)
+        systemPrintf("%llu bytes/s write rate\r\n", (sdLogBytesWritten * 1000) / sdLogWriteMillis);
+    else
+        systemPrintln("no writes");
+}
+
 // Finds last log
 // Returns true if successful
 // lastLogName will contain the name of the last log file on return - ** but without the preceding slash **
@@ -513,7 +513,7 @@ int mqttClientProcessZedMessage(uint8_t *mqttData, uint16_t mqttCount, int bytes
             GNSS_ZED *zed = (GNSS_ZED *)gnss;
             zed->updateCorrectionsSource(0); // Set SOURCE to 0 (IP) if needed
 
-            gnss->pushRawData(mqttData, mqttCount);
+            correctionPushRawData(CORR_IP, mqttData, mqttCount, false);
             // Corrections are SPARTN. No point in pushing them to rtcmParse
             bytesPushed += mqttCount;
 
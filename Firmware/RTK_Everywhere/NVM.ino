@@ -41,6 +41,13 @@ NVM.ino
     Prints all available settings and their types as CSV in response to Command LIST
     - if they are inCommands
 
+  settingsSnapshotEntryLength();
+    In this file NVM.ino
+    Returns the number of bytes saved for the setting in the binary settings snapshot
+    The snapshot (.bin) is loaded at boot, the clear text file (.txt) is only imported
+    when the snapshot is missing or invalid, or when the SD card text file is newer
+    New settings types must be added here to be saved in the snapshot
+
   form.h also needs to be updated to include a space for user input. This is best
   edited in the index.html and main.js files.
 =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=*/
@@ -59,14 +66,15 @@ void loadSettings()
 {
     // If we have a profile in both LFS and SD, the SD settings will overwrite LFS
     // This will fail if LFS has been erased. That's OK.
-    loadSystemSettingsFromFileLFS(settingsFileName);
+    settingsSnapshotImport = false;
+    loadSystemSettingsLFS(settingsFileName);
 
     // Temp store any variables from LFS that should override SD
     int resetCount = settings.resetCount;
     uint32_t gnssConfigureRequest = settings.gnssConfigureRequest;
 
     // This will fail if no SD is present. That's OK.
-    loadSystemSettingsFromFileSD(settingsFileName);
+    loadSystemSettingsSD(settingsFileName);
 
     settings.resetCount = resetCount; // resetCount from LFS should override SD
 
@@ -83,6 +91,10 @@ void loadSettings()
         recordSystemSettings();
     }
 
+    // Record the snapshots after importing a clear text settings file
+    else if (settingsSnapshotImport)
+        recordSystemSettings();
+
     // Get bitmask of active profiles
     activeProfiles = loadProfileNames();
 
@@ -251,12 +263,13 @@ void loadSettingsPartial()
     // Set the settingsFileName used in many places
     setSettingsFileName();
 
-    loadSystemSettingsFromFileLFS(settingsFileName);
+    loadSystemSettingsLFS(settingsFileName);
 }
 
 void recordSystemSettings()
 {
     settings.sizeOfSettings = sizeof(settings); // Update to current setting size
+    settingsSnapshotImport = false;
 
     recordSystemSettingsToFileSD(settingsFileName);  // Record to SD if available
     recordSystemSettingsToFileLFS(settingsFileName); // Record to LFS if available
@@ -291,23 +304,30 @@ void recordSystemSettingsToFileSD(char *fileName)
                 sd->remove(fileName);
             }
 
+            // Export the clear text settings file before writing the snapshot, the text
+            // file is only imported when it is modified after the snapshot is written
             SdFile settingsFile; // FAT32
-            if (settingsFile.open(fileName, O_CREAT | O_APPEND | O_WRITE) == false)
+            if (settings.settingsTextExport == false)
             {
-                systemPrintf("Failed to create SD settings file %s\r\n", fileName);
-                break; // /while (online.microSD == true)
+                // The clear text settings file was removed above
             }
+            else if (settingsFile.open(fileName, O_CREAT | O_APPEND | O_WRITE) == false)
+                systemPrintf("Failed to create SD settings file %s\r\n", fileName);
+            else
+            {
+                sdUpdateFileCreateTimestamp(&settingsFile); // Update the file to create time & date
 
-            sdUpdateFileCreateTimestamp(&settingsFile); // Update the file to create time & date
+                recordSystemSettingsToFile((File *)&settingsFile); // Record all the settings via strings to file
 
-            recordSystemSettingsToFile((File *)&settingsFile); // Record all the settings via strings to file
+                sdUpdateFileAccessTimestamp(&settingsFile); // Update the file access time & date
 
-            sdUpdateFileAccessTimestamp(&settingsFile); // Update the file access time & date
+                settingsFile.close();
 
-            settingsFile.close();
+                if (settings.debugSettings)
+                    systemPrintf("Settings recorded to SD: %s\r\n", fileName);
+            }
 
-            if (settings.debugSettings)
-                systemPrintf("Settings recorded to SD: %s\r\n", fileName);
+            recordSystemSettingsToSnapshotSD(fileName);
         }
         else
         {
@@ -341,18 +361,23 @@ void recordSystemSettingsToFileLFS(char *fileName)
             LittleFS.remove(fileName);
         }
 
-        File settingsFile = LittleFS.open(fileName, FILE_WRITE);
-        if (!settingsFile)
-        {
-            systemPrintf("Failed to create LFS settings file %s\r\n", fileName);
-        }
-        else
+        if (settings.settingsTextExport)
         {
-            recordSystemSettingsToFile(&settingsFile); // Record all the settings via strings to file
-            settingsFile.close();
-            if (settings.debugSettings)
-                systemPrintf("Settings recorded to LittleFS: %s\r\n", fileName);
+            File settingsFile = LittleFS.open(fileName, FILE_WRITE);
+            if (!settingsFile)
+            {
+                systemPrintf("Failed to create LFS settings file %s\r\n", fileName);
+            }
+            else
+            {
+                recordSystemSettingsToFile(&settingsFile); // Record all the settings via strings to file
+                settingsFile.close();
+                if (settings.debugSettings)
+                    systemPrintf("Settings recorded to LittleFS: %s\r\n", fileName);
+            }
         }
+
+        recordSystemSettingsToSnapshotLFS(fileName);
     }
 }
 
@@ -607,6 +632,12 @@ void recordSystemSettingsToFile(File *settingsFile)
             settingsFile->printf("%s=%d\r\n", rtkSettingsEntries[i].name, (int)*ptr);
         }
         break;
+        case tRtcmLnk: {
+            uint16_t *ptr = (uint16_t *)rtkSettingsEntries[i].var;
+            for (int x = 0; x < rtkSettingsEntries[i].qualifier; x++)
+                settingsFile->printf("%s%d=%d\r\n", rtkSettingsEntries[i].name, x, ptr[x]);
+        }
+        break;
         }
     }
 
@@ -1422,6 +1453,16 @@ bool parseLine(const char *theLine)
                     knownSetting = true;
                 }
                 break;
+                case tRtcmLnk: {
+                    int link;
+                    if ((sscanf(suffix, "%d", &link) == 1) && (link >= 0) && (link < qualifier))
+                    {
+                        uint16_t *ptr = (uint16_t *)var;
+                        ptr[link] = (uint16_t)d;
+                        knownSetting = true;
+                    }
+                }
+                break;
                 }
             }
         }
@@ -1605,15 +1646,18 @@ void setProfileName(uint8_t ProfileNumber)
     activeProfiles |= 1 << ProfileNumber;
 }
 
-// Open the clear text file, scan for 'profileName' and return the string
+// Open the settings snapshot or the clear text file, scan for 'profileName' and return the string
 // Returns true if successfully found tag in file, length may be zero
 // Looks at LittleFS first, then SD
 bool getProfileName(char *fileName, char *profileName, uint8_t profileNameLength)
 {
+    // Use the snapshot when available, otherwise scan the clear text file
     char profileNameLFS[50];
-    loadSystemSettingsFromFileLFS(fileName, "profileName=", profileNameLFS, sizeof(profileNameLFS));
+    if (!settingsSnapshotFindStringLFS(fileName, "profileName", profileNameLFS, sizeof(profileNameLFS)))
+        loadSystemSettingsFromFileLFS(fileName, "profileName=", profileNameLFS, sizeof(profileNameLFS));
     char profileNameSD[50];
-    loadSystemSettingsFromFileSD(fileName, "profileName=", profileNameSD, sizeof(profileNameSD));
+    if (!settingsSnapshotFindStringSD(fileName, "profileName", profileNameSD, sizeof(profileNameSD)))
+        loadSystemSettingsFromFileSD(fileName, "profileName=", profileNameSD, sizeof(profileNameSD));
 
     // Zero terminate the profile name
     *profileName = 0;
@@ -1879,3 +1923,907 @@ void nvmDumpFile(const char * fileName)
     if (buffer)
         rtkFree(buffer, "NVM file dump buffer");
 }
+
+//----------------------------------------
+// Binary settings snapshot
+//
+// The snapshot holds the settings as binary entries so that they load with a
+// single read and without parsing text.  The header holds sizeOfSettings,
+// rtkIdentifier, the firmware version and a CRC-32 of the header and the
+// entries.  Each entry is the entry ID, the data length and the data.  The ID
+// is a hash of the setting name and type.  Entries with unknown IDs are
+// skipped, and settings without an entry keep their current value.
+//
+// The GNSS message arrays are indexed by the position of the message in the
+// firmware's message tables.  When the snapshot was written by a different
+// firmware version these arrays are skipped and the clear text settings file,
+// which names each message, is imported after the snapshot.
+//
+// The snapshot is written to a temporary file which is then renamed.  When the
+// rename does not complete, the temporary file is loaded at the next boot.
+// The clear text settings file is only used for import and export.
+//----------------------------------------
+
+#define SETTINGS_SNAPSHOT_SIGNATURE     0x534b5452 // "RTKS"
+#define SETTINGS_SNAPSHOT_VERSION       2
+#define SETTINGS_SNAPSHOT_MAX_LENGTH    (64 * 1024)
+#define SETTINGS_SNAPSHOT_ENTRY_HEADER  (sizeof(uint32_t) + sizeof(uint16_t)) // ID and data length
+#define SETTINGS_SNAPSHOT_IP_LENGTH     48 // IPAddress as text, zero filled
+#define SETTINGS_SNAPSHOT_NAME_LENGTH   64
+#define SETTINGS_SNAPSHOT_FIRMWARE_LENGTH   32 // Firmware version as text, zero filled
+
+// Snapshot file extensions, the temporary file is loaded first since it is
+// only present when it is newer than the snapshot
+#define SETTINGS_SNAPSHOT_TEMP          0
+#define SETTINGS_SNAPSHOT_FILE          1
+const char *settingsSnapshotExtensions[] = {".tmp", ".bin"};
+
+typedef struct _SETTINGS_SNAPSHOT_HEADER
+{
+    uint32_t signature;     // SETTINGS_SNAPSHOT_SIGNATURE
+    uint16_t version;       // SETTINGS_SNAPSHOT_VERSION
+    uint16_t headerLength;  // Offset of the first entry
+    int32_t sizeOfSettings; // sizeof(Settings) of the firmware that wrote the snapshot
+    int32_t rtkIdentifier;
+    char firmwareVersion[SETTINGS_SNAPSHOT_FIRMWARE_LENGTH]; // Firmware that wrote the snapshot
+    uint32_t entryCount;
+    uint32_t dataLength;    // Bytes of entries following the header
+    uint32_t crc;           // CRC-32 of the header (crc = 0) and the entries
+} SETTINGS_SNAPSHOT_HEADER;
+
+// Get the snapshot or temporary file name from the clear text settings file name
+bool settingsSnapshotFileName(const char *textFileName, int file, char *fileName, size_t fileNameLength)
+{
+    const char *dot;
+    size_t length;
+
+    dot = strrchr(textFileName, '.');
+    length = dot ? (dot - textFileName) : strlen(textFileName);
+    if ((length + strlen(settingsSnapshotExtensions[file])) >= fileNameLength)
+    {
+        systemPrintf("ERROR: Settings snapshot file name too long for %s\r\n", textFileName);
+        return false;
+    }
+    memcpy(fileName, textFileName, length);
+    strcpy(&fileName[length], settingsSnapshotExtensions[file]);
+    return true;
+}
+
+// Get the version and build time of this firmware, zero filled
+// Development builds share a version number, the build time tells them apart
+void settingsSnapshotFirmwareVersion(char *firmwareVersion)
+{
+    memset(firmwareVersion, 0, SETTINGS_SNAPSHOT_FIRMWARE_LENGTH);
+    snprintf(firmwareVersion, SETTINGS_SNAPSHOT_FIRMWARE_LENGTH, "%d.%d %s %s", FIRMWARE_VERSION_MAJOR,
+             FIRMWARE_VERSION_MINOR, __DATE__, __TIME__);
+}
+
+// Compute the entry ID from the setting name and type
+uint32_t settingsSnapshotId(const char *name, RTK_Settings_Types type)
+{
+    uint32_t id;
+
+    // FNV-1a hash
+    id = 2166136261ul;
+    while (*name)
+    {
+        id ^= (uint8_t)*name++;
+        id *= 16777619ul;
+    }
+    id ^= (uint8_t)type;
+    id *= 16777619ul;
+    return id;
+}
+
+// Get the number of data bytes in the snapshot entry, returns zero when the
+// setting is not saved in the snapshot
+int settingsSnapshotEntryLength(int i)
+{
+    int qualifier;
+
+    if (rtkSettingsEntries[i].var == nullptr)
+        return 0;
+    qualifier = rtkSettingsEntries[i].qualifier;
+    switch (rtkSettingsEntries[i].type)
+    {
+    default:
+        return 0;
+    case _bool:
+        return sizeof(bool);
+    case _int:
+        return sizeof(int);
+    case _float:
+        return sizeof(float);
+    case _double:
+        return sizeof(double);
+    case _uint8_t:
+        return sizeof(uint8_t);
+    case _uint16_t:
+        return sizeof(uint16_t);
+    case _uint32_t:
+        return sizeof(uint32_t);
+    case _uint64_t:
+        return sizeof(uint64_t);
+    case _int8_t:
+        return sizeof(int8_t);
+    case _int16_t:
+        return sizeof(int16_t);
+    case tMuxConn:
+        return sizeof(muxConnectionType_e);
+    case tSysState:
+        return sizeof(SystemState);
+    case tPulseEdg:
+        return sizeof(pulseEdgeType_e);
+    case tBtRadio:
+        return sizeof(BluetoothRadioType_e);
+    case tPerDisp:
+        return sizeof(PeriodicDisplay_t);
+    case tCoordInp:
+        return sizeof(CoordinateInputType);
+    case tGnssReceiver:
+        return sizeof(gnssReceiverType_e);
+    case tCharArry:
+        return qualifier;
+    case _IPString:
+        return SETTINGS_SNAPSHOT_IP_LENGTH;
+
+    // GNSS specific arrays
+    case tUbxMsgRt:
+    case tUbxConst:
+    case tUbMsgRtb:
+    case tUmConst:
+    case tMosaicConst:
+    case tMosaicMSNmea:
+    case tMosaicSINmea:
+    case tMosaicMERvRT:
+    case tMosaicMEBaRT:
+    case tLgConst:
+        return qualifier * sizeof(uint8_t);
+    case tUmMRNmea:
+    case tUmMRRvRT:
+    case tUmMRBaRT:
+    case tMosaicMIRvRT:
+    case tMosaicMIBaRT:
+        return qualifier * sizeof(float);
+    case tLgMRNmea:
+    case tLgMRRvRT:
+    case tLgMRBaRT:
+    case tLgMRPqtm:
+        return qualifier * sizeof(int);
+
+    // Arrays
+    case tEspNowPr:
+        return qualifier * sizeof(settings.espnowPeers[0]);
+    case tWiFiNet:
+        return qualifier * sizeof(settings.wifiNetworks[0]);
+    case tNSCEn:
+        return qualifier * sizeof(settings.ntripServer_CasterEnabled[0]);
+    case tNSCHost:
+        return qualifier * sizeof(settings.ntripServer_CasterHost[0]);
+    case tNSCPort:
+        return qualifier * sizeof(settings.ntripServer_CasterPort[0]);
+    case tNSCUser:
+        return qualifier * sizeof(settings.ntripServer_CasterUser[0]);
+    case tNSCUsrPw:
+        return qualifier * sizeof(settings.ntripServer_CasterUserPW[0]);
+    case tNSMtPt:
+        return qualifier * sizeof(settings.ntripServer_MountPoint[0]);
+    case tNSMtPtPw:
+        return qualifier * sizeof(settings.ntripServer_MountPointPW[0]);
+    case tCorrSPri:
+        return qualifier * sizeof(settings.correctionsSourcesPriority[0]);
+    case tRegCorTp:
+        return qualifier * sizeof(settings.regionalCorrectionTopics[0]);
+    case tRtcmLnk:
+        return qualifier * sizeof(uint16_t);
+    }
+}
+
+// Add an entry to the snapshot, returns the address of the next entry
+uint8_t *settingsSnapshotAddEntry(uint8_t *data, uint32_t id, const void *value, uint16_t length)
+{
+    memcpy(data, &id, sizeof(id));
+    data += sizeof(id);
+    memcpy(data, &length, sizeof(length));
+    data += sizeof(length);
+    memcpy(data, value, length);
+    return data + length;
+}
+
+// Build the settings snapshot, the caller must free the returned buffer with rtkFree
+uint8_t *settingsSnapshotCreate(uint32_t *snapshotLength)
+{
+    uint8_t *data;
+    SETTINGS_SNAPSHOT_HEADER header;
+    char ipAddress[SETTINGS_SNAPSHOT_IP_LENGTH];
+    int length;
+    uint8_t *snapshot;
+
+    // Determine the size of the snapshot, save the same settings as recordSystemSettingsToFile
+    memset(&header, 0, sizeof(header));
+    header.dataLength = 0;
+    for (int i = 0; i < numRtkSettingsEntries; i++)
+    {
+        length = settingsSnapshotEntryLength(i);
+        if (length && commandIndexInclude(i, savePossibleSettings))
+        {
+            header.dataLength += SETTINGS_SNAPSHOT_ENTRY_HEADER + length;
+            header.entryCount += 1;
+        }
+    }
+
+    // Add the settings that are not part of settings.h
+    header.dataLength += SETTINGS_SNAPSHOT_ENTRY_HEADER + sizeof(otaRcFirmwareJsonUrl);
+    header.dataLength += SETTINGS_SNAPSHOT_ENTRY_HEADER + sizeof(otaFirmwareJsonUrl);
+    header.entryCount += 2;
+
+    // Allocate the snapshot
+    *snapshotLength = sizeof(header) + header.dataLength;
+    snapshot = (uint8_t *)rtkMalloc(*snapshotLength, "Settings snapshot (snapshot)");
+    if (!snapshot)
+    {
+        systemPrintln("ERROR: Failed to allocate the settings snapshot!");
+        return nullptr;
+    }
+
+    // Add the entries
+    data = &snapshot[sizeof(header)];
+    for (int i = 0; i < numRtkSettingsEntries; i++)
+    {
+        length = settingsSnapshotEntryLength(i);
+        if ((length == 0) || (commandIndexInclude(i, savePossibleSettings) == false))
+            continue;
+
+        if (rtkSettingsEntries[i].type == _IPString)
+        {
+            // Save the IP address as text
+            memset(ipAddress, 0, sizeof(ipAddress));
+            strncpy(ipAddress, ((IPAddress *)rtkSettingsEntries[i].var)->toString().c_str(), sizeof(ipAddress) - 1);
+            data = settingsSnapshotAddEntry(data, settingsSnapshotId(rtkSettingsEntries[i].name, _IPString),
+                                            ipAddress, length);
+        }
+        else
+            data = settingsSnapshotAddEntry(data,
+                                            settingsSnapshotId(rtkSettingsEntries[i].name, rtkSettingsEntries[i].type),
+                                            rtkSettingsEntries[i].var, length);
+    }
+    data = settingsSnapshotAddEntry(data, settingsSnapshotId("otaRcFirmwareJsonUrl", tCharArry), otaRcFirmwareJsonUrl,
+                                    sizeof(otaRcFirmwareJsonUrl));
+    data = settingsSnapshotAddEntry(data, settingsSnapshotId("otaFirmwareJsonUrl", tCharArry), otaFirmwareJsonUrl,
+                                    sizeof(otaFirmwareJsonUrl));
+
+    // Finish the header
+    header.signature = SETTINGS_SNAPSHOT_SIGNATURE;
+    header.version = SETTINGS_SNAPSHOT_VERSION;
+    header.headerLength = sizeof(header);
+    header.sizeOfSettings = sizeof(Settings);
+    header.rtkIdentifier = settings.rtkIdentifier;
+    settingsSnapshotFirmwareVersion(header.firmwareVersion);
+    header.crc = 0;
+    header.crc = esp_rom_crc32_le(0, (uint8_t *)&header, sizeof(header));
+    header.crc = esp_rom_crc32_le(header.crc, &snapshot[sizeof(header)], header.dataLength);
+    memcpy(snapshot, &header, sizeof(header));
+    return snapshot;
+}
+
+// Verify the snapshot header and CRC
+bool settingsSnapshotValid(const uint8_t *snapshot, uint32_t length, const char *fileName)
+{
+    uint32_t crc;
+    SETTINGS_SNAPSHOT_HEADER header;
+
+    do
+    {
+        if (length < sizeof(header))
+            break;
+        memcpy(&header, snapshot, sizeof(header));
+        if ((header.signature != SETTINGS_SNAPSHOT_SIGNATURE) || (header.version != SETTINGS_SNAPSHOT_VERSION))
+            break;
+        if ((header.headerLength < sizeof(header)) || (header.headerLength > length)
+            || (header.dataLength != (length - header.headerLength)))
+            break;
+
+        // Verify the CRC
+        crc = header.crc;
+        header.crc = 0;
+        header.crc = esp_rom_crc32_le(0, (uint8_t *)&header, sizeof(header));
+        header.crc = esp_rom_crc32_le(header.crc, &snapshot[sizeof(header)], length - sizeof(header));
+        if (header.crc != crc)
+            break;
+        return true;
+    } while (0);
+
+    systemPrintf("Settings snapshot %s is invalid\r\n", fileName);
+    return false;
+}
+
+// Walk the snapshot entries, returns the entry data for the ID or nullptr
+// when the end of the snapshot is reached
+const uint8_t *settingsSnapshotNextEntry(const uint8_t *snapshot, uint32_t snapshotLength, uint32_t *offset,
+                                         uint32_t *id, uint16_t *length)
+{
+    const uint8_t *data;
+
+    if (*offset == 0)
+        *offset = ((const SETTINGS_SNAPSHOT_HEADER *)snapshot)->headerLength;
+    if ((*offset + SETTINGS_SNAPSHOT_ENTRY_HEADER) > snapshotLength)
+        return nullptr;
+    data = &snapshot[*offset];
+    memcpy(id, data, sizeof(*id));
+    memcpy(length, &data[sizeof(*id)], sizeof(*length));
+    if ((*offset + SETTINGS_SNAPSHOT_ENTRY_HEADER + *length) > snapshotLength)
+        return nullptr;
+    *offset += SETTINGS_SNAPSHOT_ENTRY_HEADER + *length;
+    return &data[SETTINGS_SNAPSHOT_ENTRY_HEADER];
+}
+
+// Copy a string entry, the value is always zero terminated
+void settingsSnapshotCopyString(char *value, size_t valueLength, const uint8_t *data, uint16_t length)
+{
+    if (length >= valueLength)
+        length = valueLength - 1;
+    memcpy(value, data, length);
+    memset(&value[length], 0, valueLength - length);
+}
+
+// Determine if the setting is an array indexed by the position of the message
+// in the firmware's GNSS message tables
+bool settingsSnapshotMessageArray(int i)
+{
+    switch (rtkSettingsEntries[i].type)
+    {
+    default:
+        return false;
+    case tUbxMsgRt:
+    case tUbxConst:
+    case tUbMsgRtb:
+    case tUmMRNmea:
+    case tUmMRRvRT:
+    case tUmMRBaRT:
+    case tUmConst:
+    case tMosaicConst:
+    case tMosaicMSNmea:
+    case tMosaicSINmea:
+    case tMosaicMIRvRT:
+    case tMosaicMIBaRT:
+    case tMosaicMERvRT:
+    case tMosaicMEBaRT:
+    case tLgMRNmea:
+    case tLgMRRvRT:
+    case tLgMRBaRT:
+    case tLgMRPqtm:
+    case tLgConst:
+        return true;
+    }
+}
+
+// Update the settings from a valid snapshot
+// Returns true when all of the settings in the snapshot were updated, false
+// when the size of a setting changed and its entry was skipped, or when the
+// GNSS message arrays were skipped because the snapshot was written by a
+// different firmware version
+bool settingsSnapshotApply(const uint8_t *snapshot, uint32_t snapshotLength)
+{
+    bool complete;
+    const uint8_t *data;
+    int entry;
+    char firmwareVersion[SETTINGS_SNAPSHOT_FIRMWARE_LENGTH];
+    SETTINGS_SNAPSHOT_HEADER header;
+    int i;
+    uint32_t id;
+    char ipAddress[SETTINGS_SNAPSHOT_IP_LENGTH];
+    uint16_t length;
+    uint32_t offset;
+    bool sameFirmware;
+
+    // Check to see if this snapshot was written by this version of RTK firmware
+    memcpy(&header, snapshot, sizeof(header));
+    settingsSnapshotFirmwareVersion(firmwareVersion);
+    sameFirmware = (header.sizeOfSettings == sizeof(Settings))
+                && (strncmp(header.firmwareVersion, firmwareVersion, sizeof(firmwareVersion)) == 0);
+    if (settings.debugSettings && (sameFirmware == false))
+        systemPrintf("Settings snapshot written by %.*s (settings size %d), current firmware %s (settings size %d), "
+                     "skipping the GNSS message arrays\r\n",
+                     (int)sizeof(header.firmwareVersion), header.firmwareVersion, header.sizeOfSettings,
+                     firmwareVersion, (int)sizeof(Settings));
+
+    complete = true;
+    entry = 0;
+    offset = 0;
+    while ((data = settingsSnapshotNextEntry(snapshot, snapshotLength, &offset, &id, &length)))
+    {
+        // The entries are in table order, start the search after the previous entry
+        for (i = 0; i < numRtkSettingsEntries; i++)
+        {
+            if (settingsSnapshotId(rtkSettingsEntries[entry].name, rtkSettingsEntries[entry].type) == id)
+                break;
+            entry = (entry + 1) % numRtkSettingsEntries;
+        }
+
+        // Handle the settings not part of settings.h/Settings struct
+        if (i >= numRtkSettingsEntries)
+        {
+            if (id == settingsSnapshotId("otaRcFirmwareJsonUrl", tCharArry))
+                settingsSnapshotCopyString(otaRcFirmwareJsonUrl, sizeof(otaRcFirmwareJsonUrl), data, length);
+            else if (id == settingsSnapshotId("otaFirmwareJsonUrl", tCharArry))
+                settingsSnapshotCopyString(otaFirmwareJsonUrl, sizeof(otaFirmwareJsonUrl), data, length);
+            else if (settings.debugSettings)
+                systemPrintf("Unknown / unwanted setting ID 0x%08lx\r\n", id);
+            continue;
+        }
+        i = entry;
+        entry = (entry + 1) % numRtkSettingsEntries;
+
+        // Only update the settings that are loaded from the settings file
+        if ((settingsSnapshotEntryLength(i) == 0) || (commandIndexInclude(i, savePossibleSettings) == false))
+            continue;
+
+        // The message tables may have changed, import these settings by name
+        // from the clear text settings file
+        if ((sameFirmware == false) && settingsSnapshotMessageArray(i))
+        {
+            complete = false;
+            continue;
+        }
+
+        // Update the setting
+        if (rtkSettingsEntries[i].type == _IPString)
+        {
+            settingsSnapshotCopyString(ipAddress, sizeof(ipAddress), data, length);
+            ((IPAddress *)rtkSettingsEntries[i].var)->fromString(ipAddress);
+        }
+        else if (rtkSettingsEntries[i].type == tCharArry)
+            settingsSnapshotCopyString((char *)rtkSettingsEntries[i].var, rtkSettingsEntries[i].qualifier, data,
+                                       length);
+        else if (length == settingsSnapshotEntryLength(i))
+            memcpy(rtkSettingsEntries[i].var, data, length);
+        else
+        {
+            if (settings.debugSettings)
+                systemPrintf("Setting %s size changed from %d to %d bytes, skipped\r\n", rtkSettingsEntries[i].name,
+                             length, settingsSnapshotEntryLength(i));
+            complete = false;
+        }
+    }
+    return complete;
+}
+
+// Get a string setting from a valid snapshot
+// Returns true if the setting was found
+bool settingsSnapshotFindString(const uint8_t *snapshot, uint32_t snapshotLength, const char *settingName,
+                                char *value, int valueLength)
+{
+    const uint8_t *data;
+    uint32_t id;
+    uint16_t length;
+    uint32_t offset;
+
+    offset = 0;
+    while ((data = settingsSnapshotNextEntry(snapshot, snapshotLength, &offset, &id, &length)))
+    {
+        if (id == settingsSnapshotId(settingName, tCharArry))
+        {
+            settingsSnapshotCopyString(value, valueLength, data, length);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Read the snapshot from LittleFS, loading the temporary file when it is valid
+// The caller must free the returned buffer with rtkFree
+uint8_t *settingsSnapshotReadLFS(const char *textFileName, uint32_t *snapshotLength)
+{
+    File file;
+    char fileName[SETTINGS_SNAPSHOT_NAME_LENGTH];
+    uint8_t *snapshot;
+
+    for (int index = SETTINGS_SNAPSHOT_TEMP; index <= SETTINGS_SNAPSHOT_FILE; index++)
+    {
+        if (!settingsSnapshotFileName(textFileName, index, fileName, sizeof(fileName)))
+            return nullptr;
+        if (!LittleFS.exists(fileName))
+            continue;
+        file = LittleFS.open(fileName, FILE_READ);
+        if (!file)
+        {
+            systemPrintf("Failed to open LFS settings snapshot %s\r\n", fileName);
+            continue;
+        }
+
+        // Read the snapshot
+        snapshot = nullptr;
+        *snapshotLength = file.size();
+        if ((*snapshotLength >= sizeof(SETTINGS_SNAPSHOT_HEADER)) && (*snapshotLength <= SETTINGS_SNAPSHOT_MAX_LENGTH))
+            snapshot = (uint8_t *)rtkMalloc(*snapshotLength, "Settings snapshot (snapshot)");
+        if (snapshot && (file.read(snapshot, *snapshotLength) != *snapshotLength))
+        {
+            systemPrintf("Hard read error in LFS settings snapshot %s!\r\n", fileName);
+            rtkFree(snapshot, "Settings snapshot (snapshot)");
+            snapshot = nullptr;
+        }
+        file.close();
+
+        // Verify the snapshot
+        if (snapshot)
+        {
+            if (settingsSnapshotValid(snapshot, *snapshotLength, fileName))
+            {
+                if (settings.debugSettings)
+                    systemPrintf("Loading settings snapshot from LFS: %s\r\n", fileName);
+                return snapshot;
+            }
+            rtkFree(snapshot, "Settings snapshot (snapshot)");
+        }
+    }
+    return nullptr;
+}
+
+// Get the modification date and time of the SD file, returns zero when the file is not present
+uint32_t settingsSnapshotModifyTimeSD(const char *fileName)
+{
+    uint16_t date;
+    SdFile file;
+    uint16_t time;
+
+    if (!sd->exists(fileName) || !file.open(fileName, O_READ))
+        return 0;
+    if (!file.getModifyDateTime(&date, &time))
+    {
+        date = 0;
+        time = 0;
+    }
+    file.close();
+    return (((uint32_t)date) << 16) | time;
+}
+
+// Read the snapshot from the SD card, loading the temporary file when it is valid
+// A clear text settings file modified after the snapshot is imported instead
+// The caller must hold the sdCardSemaphore and free the returned buffer with rtkFree
+uint8_t *settingsSnapshotReadSD(const char *textFileName, uint32_t *snapshotLength)
+{
+    SdFile file;
+    char fileName[SETTINGS_SNAPSHOT_NAME_LENGTH];
+    uint8_t *snapshot;
+    uint32_t textFileTime;
+
+    textFileTime = settingsSnapshotModifyTimeSD(textFileName);
+    for (int index = SETTINGS_SNAPSHOT_TEMP; index <= SETTINGS_SNAPSHOT_FILE; index++)
+    {
+        if (!settingsSnapshotFileName(textFileName, index, fileName, sizeof(fileName)))
+            return nullptr;
+        if (!sd->exists(fileName))
+            continue;
+
+        // Import the clear text settings file when it was edited after the snapshot was written
+        if (textFileTime > settingsSnapshotModifyTimeSD(fileName))
+        {
+            if (settings.debugSettings)
+                systemPrintf("SD file %s is newer than %s\r\n", textFileName, fileName);
+            continue;
+        }
+        if (file.open(fileName, O_READ) == false)
+        {
+            systemPrintf("Failed to open SD settings snapshot %s\r\n", fileName);
+            continue;
+        }
+
+        // Read the snapshot
+        snapshot = nullptr;
+        *snapshotLength = file.fileSize();
+        if ((*snapshotLength >= sizeof(SETTINGS_SNAPSHOT_HEADER)) && (*snapshotLength <= SETTINGS_SNAPSHOT_MAX_LENGTH))
+            snapshot = (uint8_t *)rtkMalloc(*snapshotLength, "Settings snapshot (snapshot)");
+        if (snapshot && (file.read(snapshot, *snapshotLength) != (int)*snapshotLength))
+        {
+            systemPrintf("Hard read error in SD settings snapshot %s!\r\n", fileName);
+            rtkFree(snapshot, "Settings snapshot (snapshot)");
+            snapshot = nullptr;
+        }
+        file.close();
+
+        // Verify the snapshot
+        if (snapshot)
+        {
+            if (settingsSnapshotValid(snapshot, *snapshotLength, fileName))
+            {
+                if (settings.debugSettings)
+                    systemPrintf("Loading settings snapshot from SD: %s\r\n", fileName);
+                return snapshot;
+            }
+            rtkFree(snapshot, "Settings snapshot (snapshot)");
+        }
+    }
+    return nullptr;
+}
+
+// Load the settings snapshot from LittleFS
+// Returns true if the snapshot was loaded, complete is set when all of the
+// settings in the snapshot were updated
+bool loadSystemSettingsFromSnapshotLFS(char *fileName, bool *complete)
+{
+    uint8_t *snapshot;
+    uint32_t snapshotLength;
+
+    *complete = false;
+    snapshot = settingsSnapshotReadLFS(fileName, &snapshotLength);
+    if (!snapshot)
+        return false;
+    *complete = settingsSnapshotApply(snapshot, snapshotLength);
+    rtkFree(snapshot, "Settings snapshot (snapshot)");
+    return true;
+}
+
+// Load the settings snapshot from the SD card
+// Returns true if the snapshot was loaded, complete is set when all of the
+// settings in the snapshot were updated
+bool loadSystemSettingsFromSnapshotSD(char *fileName, bool *complete)
+{
+    bool gotSemaphore = false;
+    uint8_t *snapshot = nullptr;
+    uint32_t snapshotLength;
+    bool wasSdCardOnline;
+
+    *complete = false;
+
+    // Try to gain access the SD card
+    wasSdCardOnline = online.microSD;
+    if (online.microSD != true)
+        beginSD();
+
+    if (online.microSD == true)
+    {
+        // Attempt to access file system. This avoids collisions with file writing from other functions like
+        // recordSystemSettingsToFile() and gnssSerialReadTask()
+        if (xSemaphoreTake(sdCardSemaphore, fatSemaphore_longWait_ms) == pdPASS)
+        {
+            markSemaphore(FUNCTION_LOADSETTINGS);
+
+            gotSemaphore = true;
+            snapshot = settingsSnapshotReadSD(fileName, &snapshotLength);
+        }
+        else
+            systemPrintf("sdCardSemaphore failed to yield, NVM.ino line %d\r\n", __LINE__);
+    }
+
+    // Release access the SD card
+    if (online.microSD && (!wasSdCardOnline))
+        endSD(gotSemaphore, true);
+    else if (gotSemaphore)
+        xSemaphoreGive(sdCardSemaphore);
+
+    if (!snapshot)
+        return false;
+    *complete = settingsSnapshotApply(snapshot, snapshotLength);
+    rtkFree(snapshot, "Settings snapshot (snapshot)");
+    return true;
+}
+
+// Load the settings from LittleFS
+// The snapshot is used when present, otherwise the clear text settings file is imported
+bool loadSystemSettingsLFS(char *fileName)
+{
+    bool complete;
+    bool loaded;
+
+    loaded = loadSystemSettingsFromSnapshotLFS(fileName, &complete);
+    if (loaded && complete)
+        return true;
+
+    // Import the clear text settings file
+    if (loadSystemSettingsFromFileLFS(fileName))
+    {
+        settingsSnapshotImport = true;
+        return true;
+    }
+    return loaded;
+}
+
+// Load the settings from the SD card
+// The snapshot is used when present, otherwise the clear text settings file is imported
+bool loadSystemSettingsSD(char *fileName)
+{
+    bool complete;
+    bool loaded;
+
+    loaded = loadSystemSettingsFromSnapshotSD(fileName, &complete);
+    if (loaded && complete)
+        return true;
+
+    // Import the clear text settings file
+    if (loadSystemSettingsFromFileSD(fileName))
+    {
+        settingsSnapshotImport = true;
+        return true;
+    }
+    return loaded;
+}
+
+// Write the settings snapshot to LittleFS
+void recordSystemSettingsToSnapshotLFS(char *textFileName)
+{
+    File file;
+    char fileName[SETTINGS_SNAPSHOT_NAME_LENGTH];
+    uint8_t *snapshot;
+    uint32_t snapshotLength;
+    char tempFileName[SETTINGS_SNAPSHOT_NAME_LENGTH];
+
+    if (!settingsSnapshotFileName(textFileName, SETTINGS_SNAPSHOT_TEMP, tempFileName, sizeof(tempFileName))
+        || !settingsSnapshotFileName(textFileName, SETTINGS_SNAPSHOT_FILE, fileName, sizeof(fileName)))
+        return;
+    snapshot = settingsSnapshotCreate(&snapshotLength);
+    if (!snapshot)
+        return;
+
+    do
+    {
+        // Write the temporary file
+        file = LittleFS.open(tempFileName, FILE_WRITE);
+        if (!file)
+        {
+            systemPrintf("Failed to create LFS settings snapshot %s\r\n", tempFileName);
+            break;
+        }
+        if (file.write(snapshot, snapshotLength) != snapshotLength)
+        {
+            file.close();
+            LittleFS.remove(tempFileName);
+            systemPrintf("Failed to write LFS settings snapshot %s\r\n", tempFileName);
+            break;
+        }
+        file.close();
+
+        // Replace the snapshot
+        if (LittleFS.exists(fileName))
+            LittleFS.remove(fileName);
+        if (!LittleFS.rename(tempFileName, fileName))
+        {
+            systemPrintf("Failed to rename LFS settings snapshot %s\r\n", tempFileName);
+            break;
+        }
+        if (settings.debugSettings)
+            systemPrintf("Settings snapshot recorded to LittleFS: %s\r\n", fileName);
+    } while (0);
+    rtkFree(snapshot, "Settings snapshot (snapshot)");
+}
+
+// Write the settings snapshot to the SD card
+// The caller must hold the sdCardSemaphore
+void recordSystemSettingsToSnapshotSD(char *textFileName)
+{
+    SdFile file;
+    char fileName[SETTINGS_SNAPSHOT_NAME_LENGTH];
+    uint8_t *snapshot;
+    uint32_t snapshotLength;
+    char tempFileName[SETTINGS_SNAPSHOT_NAME_LENGTH];
+
+    if (!settingsSnapshotFileName(textFileName, SETTINGS_SNAPSHOT_TEMP, tempFileName, sizeof(tempFileName))
+        || !settingsSnapshotFileName(textFileName, SETTINGS_SNAPSHOT_FILE, fileName, sizeof(fileName)))
+        return;
+    snapshot = settingsSnapshotCreate(&snapshotLength);
+    if (!snapshot)
+        return;
+
+    do
+    {
+        // Write the temporary file
+        if (file.open(tempFileName, O_CREAT | O_TRUNC | O_WRITE) == false)
+        {
+            systemPrintf("Failed to create SD settings snapshot %s\r\n", tempFileName);
+            break;
+        }
+        sdUpdateFileCreateTimestamp(&file);
+        if (file.write(snapshot, snapshotLength) != snapshotLength)
+        {
+            file.close();
+            sd->remove(tempFileName);
+            systemPrintf("Failed to write SD settings snapshot %s\r\n", tempFileName);
+            break;
+        }
+        sdUpdateFileAccessTimestamp(&file);
+        file.close();
+
+        // Replace the snapshot
+        if (sd->exists(fileName))
+            sd->remove(fileName);
+        if (!sd->rename(tempFileName, fileName))
+        {
+            systemPrintf("Failed to rename SD settings snapshot %s\r\n", tempFileName);
+            break;
+        }
+        if (settings.debugSettings)
+            systemPrintf("Settings snapshot recorded to SD: %s\r\n", fileName);
+    } while (0);
+    rtkFree(snapshot, "Settings snapshot (snapshot)");
+}
+
+// Get a string setting from the snapshot in LittleFS
+// Returns true if the setting was found
+bool settingsSnapshotFindStringLFS(char *fileName, const char *settingName, char *value, int valueLength)
+{
+    bool found;
+    uint8_t *snapshot;
+    uint32_t snapshotLength;
+
+    *value = 0;
+    snapshot = settingsSnapshotReadLFS(fileName, &snapshotLength);
+    if (!snapshot)
+        return false;
+    found = settingsSnapshotFindString(snapshot, snapshotLength, settingName, value, valueLength);
+    rtkFree(snapshot, "Settings snapshot (snapshot)");
+    return found;
+}
+
+// Get a string setting from the snapshot on the SD card
+// Returns true if the setting was found
+bool settingsSnapshotFindStringSD(char *fileName, const char *settingName, char *value, int valueLength)
+{
+    bool found = false;
+    bool gotSemaphore = false;
+    uint8_t *snapshot = nullptr;
+    uint32_t snapshotLength;
+    bool wasSdCardOnline;
+
+    *value = 0;
+
+    // Try to gain access the SD card
+    wasSdCardOnline = online.microSD;
+    if (online.microSD != true)
+        beginSD();
+
+    if (online.microSD == true)
+    {
+        if (xSemaphoreTake(sdCardSemaphore, fatSemaphore_longWait_ms) == pdPASS)
+        {
+            markSemaphore(FUNCTION_LOADSETTINGS);
+
+            gotSemaphore = true;
+            snapshot = settingsSnapshotReadSD(fileName, &snapshotLength);
+        }
+        else
+            systemPrintf("sdCardSemaphore failed to yield, NVM.ino line %d\r\n", __LINE__);
+    }
+
+    // Release access the SD card
+    if (online.microSD && (!wasSdCardOnline))
+        endSD(gotSemaphore, true);
+    else if (gotSemaphore)
+        xSemaphoreGive(sdCardSemaphore);
+
+    if (snapshot)
+    {
+        found = settingsSnapshotFindString(snapshot, snapshotLength, settingName, value, valueLength);
+        rtkFree(snapshot, "Settings snapshot (snapshot)");
+    }
+    return found;
+}
+
+// Remove the settings snapshot and temporary file from LittleFS
+void settingsSnapshotRemoveLFS(const char *textFileName)
+{
+    char fileName[SETTINGS_SNAPSHOT_NAME_LENGTH];
+
+    for (int index = SETTINGS_SNAPSHOT_TEMP; index <= SETTINGS_SNAPSHOT_FILE; index++)
+    {
+        if (settingsSnapshotFileName(textFileName, index, fileName, sizeof(fileName)) && LittleFS.exists(fileName))
+        {
+            if (LittleFS.remove(fileName) && settings.debugSettings)
+                systemPrintf("Deleted LFS file %s\r\n", fileName);
+        }
+    }
+}
+
+// Remove the settings snapshot and temporary file from the SD card
+// The caller must hold the sdCardSemaphore or own the SD card
+void settingsSnapshotRemoveSD(const char *textFileName)
+{
+    char fileName[SETTINGS_SNAPSHOT_NAME_LENGTH];
+
+    for (int index = SETTINGS_SNAPSHOT_TEMP; index <= SETTINGS_SNAPSHOT_FILE; index++)
+    {
+        if (settingsSnapshotFileName(textFileName, index, fileName, sizeof(fileName)) && sd->exists(fileName))
+        {
+            if (sd->remove(fileName) && settings.debugSettings)
+                systemPrintf("Deleted SD card file %s\r\n", fileName);
+        }
+    }
+}
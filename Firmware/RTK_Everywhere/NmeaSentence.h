@@ -0,0 +1,81 @@
+/*=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+NmeaSentence.h
+
+  Classify NMEA sentences once per message.  processUart1Message identifies
+  the sentence from its name and the handlers (Apple accessory, PointPerfect
+  Library, tilt compensation, GGA push, LG290P message filter) dispatch on
+  the resulting NMEA_SENTENCE_ID instead of searching the name again.
+
+  The three character sentence formatter is packed into an integer and
+  matched with a single switch statement.  Proprietary sentences ($Pxxxx)
+  are not classified and return NMEA_SENTENCE_UNKNOWN.
+
+  This file is also compiled on Linux by Tools/NMEA_Classify_Benchmark.c,
+  keep it free of ESP32 and Arduino dependencies.
+
+=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=*/
+
+#ifndef __NMEA_SENTENCE_H__
+#define __NMEA_SENTENCE_H__
+
+#include <stdint.h>
+
+// Standard NMEA sentences used by the firmware
+typedef enum
+{
+    NMEA_SENTENCE_UNKNOWN = 0, // Proprietary or unused sentence
+    NMEA_SENTENCE_GBS,
+    NMEA_SENTENCE_GGA,
+    NMEA_SENTENCE_GLL,
+    NMEA_SENTENCE_GNS,
+    NMEA_SENTENCE_GSA,
+    NMEA_SENTENCE_GST,
+    NMEA_SENTENCE_GSV,
+    NMEA_SENTENCE_HDT,
+    NMEA_SENTENCE_RMC,
+    NMEA_SENTENCE_THS,
+    NMEA_SENTENCE_VTG,
+    NMEA_SENTENCE_ZDA,
+    // Add new sentences above this line
+    NMEA_SENTENCE_MAX
+} NMEA_SENTENCE_ID;
+
+// Pack the three character sentence formatter into an integer
+#define NMEA_FORMATTER(a, b, c)     ((((uint32_t)(uint8_t)(a)) << 16) | (((uint32_t)(uint8_t)(b)) << 8) \
+                                     | ((uint32_t)(uint8_t)(c)))
+
+// Identify a sentence from its three character formatter, Ex: GGA
+static inline NMEA_SENTENCE_ID nmeaSentenceFormatterId(const char *formatter)
+{
+    // Don't read past the end of a short string
+    if ((!formatter[0]) || (!formatter[1]) || (!formatter[2]) || formatter[3])
+        return NMEA_SENTENCE_UNKNOWN;
+
+    switch (NMEA_FORMATTER(formatter[0], formatter[1], formatter[2]))
+    {
+    case NMEA_FORMATTER('G', 'B', 'S'): return NMEA_SENTENCE_GBS;
+    case NMEA_FORMATTER('G', 'G', 'A'): return NMEA_SENTENCE_GGA;
+    case NMEA_FORMATTER('G', 'L', 'L'): return NMEA_SENTENCE_GLL;
+    case NMEA_FORMATTER('G', 'N', 'S'): return NMEA_SENTENCE_GNS;
+    case NMEA_FORMATTER('G', 'S', 'A'): return NMEA_SENTENCE_GSA;
+    case NMEA_FORMATTER('G', 'S', 'T'): return NMEA_SENTENCE_GST;
+    case NMEA_FORMATTER('G', 'S', 'V'): return NMEA_SENTENCE_GSV;
+    case NMEA_FORMATTER('H', 'D', 'T'): return NMEA_SENTENCE_HDT;
+    case NMEA_FORMATTER('R', 'M', 'C'): return NMEA_SENTENCE_RMC;
+    case NMEA_FORMATTER('T', 'H', 'S'): return NMEA_SENTENCE_THS;
+    case NMEA_FORMATTER('V', 'T', 'G'): return NMEA_SENTENCE_VTG;
+    case NMEA_FORMATTER('Z', 'D', 'A'): return NMEA_SENTENCE_ZDA;
+    default: return NMEA_SENTENCE_UNKNOWN;
+    }
+}
+
+// Identify a sentence from its name (talker ID and formatter), Ex: GNGGA
+static inline NMEA_SENTENCE_ID nmeaSentenceId(const char *sentenceName)
+{
+    // Proprietary sentences start with P, standard sentences have a two character talker ID
+    if ((sentenceName[0] == 'P') || (!sentenceName[0]) || (!sentenceName[1]))
+        return NMEA_SENTENCE_UNKNOWN;
+    return nmeaSentenceFormatterId(&sentenceName[2]);
+}
+
+#endif  // __NMEA_SENTENCE_H__
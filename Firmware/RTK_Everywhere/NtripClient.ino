@@ -969,7 +969,7 @@ void ntripClientUpdate()
                         if (correctionLastSeen(CORR_TCP))
                         {
                             // Push RTCM to GNSS module over I2C / SPI
-                            gnss->pushRawData(rtcmData, rtcmCount);
+                            correctionPushRawData(CORR_TCP, rtcmData, rtcmCount, true);
                             sempParseNextBytes(rtcmParse, rtcmData, rtcmCount); // Parse the data for RTCM1005/1006
 
                             if ((settings.debugCorrections || settings.debugNtripClientRtcm ||
@@ -72,6 +72,29 @@ NtripServer.ino
                                              v
                                        NTRIP Caster
 
+  RTCM Fan-out:
+
+    Each NTRIP server has its own backlog and writer task.  sendRTCMToConsumers
+    (handleGnssDataTask) copies each RTCM message selected by the server's link
+    rules (RtcmLinks.ino) into the backlog of each casting server and wakes the
+    writer task.  The writer task sends the
+    messages to the NTRIP caster, so a slow caster only delays itself.  When
+    the backlog is full the whole RTCM message is dropped for that server.
+
+            sendRTCMToConsumers
+                    |
+        .-----------+-----------.
+        |           |           |
+        V           V           V
+     Backlog     Backlog     Backlog     ...
+        |           |           |
+        V           V           V
+     Writer      Writer      Writer
+      Task        Task        Task
+        |           |           |
+        V           V           V
+     Caster      Caster      Caster
+
   Possible NTRIP Casters
 
     * https://emlid.com/ntrip-caster/
@@ -127,6 +150,12 @@ NtripServer.ino
 // NTRIP Server data
 const TickType_t serverSemaphore_shortWait_ms = 10 / portTICK_PERIOD_MS;
 const TickType_t serverSemaphore_longWait_ms = 100 / portTICK_PERIOD_MS;
+
+// Per server RTCM backlog, several epochs of RTCM 1005,1074,1084,1094,1124
+#define NTRIP_SERVER_BACKLOG_BYTES 8192
+#define NTRIP_SERVER_BACKLOG_MESSAGES 64
+#define NTRIP_SERVER_TASK_POLL_MSEC 100
+
 typedef struct
 {
     // Network connection used to push RTCM to NTRIP caster
@@ -154,6 +183,32 @@ typedef struct
     volatile uint32_t rtcmBytesSent;
     volatile uint32_t previousMilliseconds;
 
+    // RTCM backlog, bytes are added at messageOffset by ntripServerSendRTCM and removed
+    // at backlogTail by ntripServerTask.  backlogHead and messageHead are updated
+    // once all of the message bytes are in the backlog.
+    uint8_t *backlog;
+    uint16_t messageLength[NTRIP_SERVER_BACKLOG_MESSAGES];
+    uint32_t messageMillis[NTRIP_SERVER_BACKLOG_MESSAGES]; // Time the message was added
+    volatile uint16_t backlogHead;
+    volatile uint16_t backlogTail;
+    volatile uint8_t messageHead;
+    volatile uint8_t messageTail;
+    uint16_t messageOffset;    // Backlog offset for the next byte of the current message
+    uint16_t messageRemaining; // Bytes of the current message still to be added
+    bool messageDropped;       // The current message did not fit in the backlog
+
+    // Backlog statistics
+    volatile uint32_t messagesDropped;
+    volatile uint32_t latencyMsec; // Time from the backlog to the caster for the last message
+    volatile uint32_t latencyMaxMsec;
+
+    // Writer task
+    char taskName[16];
+    TaskHandle_t taskHandle;
+    volatile bool taskRunning;
+    volatile bool taskStopRequest;
+    volatile bool writeDirect; // The writer task is not available, write from sendRTCMToConsumers
+
     // Protect all methods that manipulate timer with a mutex - to avoid race conditions
     // Also protect the write from connected checks
     SemaphoreHandle_t serverSemaphore = NULL;
@@ -643,70 +698,314 @@ void ntripServerPrintStatus(int serverIndex)
         systemPrint(" Uptime: ");
         systemPrintf("%d %02d:%02d:%02d.%03lld (Reconnects: %d)\r\n", days, hours, minutes, seconds, milliseconds,
                      ntripServer->connectionAttemptsTotal);
+
+        // Display the backlog
+        if (ntripServer->backlog)
+            systemPrintf("    Backlog: %d bytes, %d messages, Dropped: %lu messages, Latency: %lu mSec, Max: %lu mSec\r\n",
+                         ntripServerBacklogBytes(serverIndex), ntripServerBacklogMessages(serverIndex),
+                         ntripServer->messagesDropped, ntripServer->latencyMsec, ntripServer->latencyMaxMsec);
     }
 }
 
 //----------------------------------------
-// This function sends stored, complete RTCM messages to connected servers
+// Determine the number of bytes in the backlog
 //----------------------------------------
-void ntripServerSendRTCM(int serverIndex, uint8_t *rtcmData, uint16_t dataLength)
+int ntripServerBacklogBytes(int serverIndex)
+{
+    NTRIP_SERVER_DATA *ntripServer = &ntripServerArray[serverIndex];
+    int bytes = ntripServer->backlogHead - ntripServer->backlogTail;
+    if (bytes < 0)
+        bytes += NTRIP_SERVER_BACKLOG_BYTES;
+    return bytes;
+}
+
+//----------------------------------------
+// Determine the number of messages in the backlog
+//----------------------------------------
+int ntripServerBacklogMessages(int serverIndex)
 {
     NTRIP_SERVER_DATA *ntripServer = &ntripServerArray[serverIndex];
+    int messages = ntripServer->messageHead - ntripServer->messageTail;
+    if (messages < 0)
+        messages += NTRIP_SERVER_BACKLOG_MESSAGES;
+    return messages;
+}
 
-    if (ntripServer->state == NTRIP_SERVER_CASTING)
+//----------------------------------------
+// Start the next RTCM message
+// Called by rtcmConsumerMessageBegin before passing the message to ntripServerSendRTCM
+//----------------------------------------
+void ntripServerRtcmMessageBegin(int serverIndex, uint16_t dataLength)
+{
+    NTRIP_SERVER_DATA *ntripServer = &ntripServerArray[serverIndex];
+
+    // Drop the message unless it is added to the backlog, a message started
+    // before the server was casting must not be partially sent
+    ntripServer->messageRemaining = dataLength;
+    ntripServer->messageDropped = true;
+    ntripServer->messageOffset = ntripServer->backlogHead;
+    if ((ntripServer->state != NTRIP_SERVER_CASTING) || (!ntripServer->taskRunning))
+        return;
+
+    // Drop the whole message when the backlog is full
+    if ((ntripServerBacklogMessages(serverIndex) >= (NTRIP_SERVER_BACKLOG_MESSAGES - 1)) ||
+        ((ntripServerBacklogBytes(serverIndex) + dataLength) >= NTRIP_SERVER_BACKLOG_BYTES))
+    {
+        ntripServer->messagesDropped = ntripServer->messagesDropped + 1;
+        if (settings.debugNtripServerRtcm && (!inMainMenu))
+            systemPrintf("NTRIP Server %d backlog full, %d byte RTCM message dropped\r\n", serverIndex, dataLength);
+        return;
+    }
+
+    // Remember the message
+    ntripServer->messageLength[ntripServer->messageHead] = dataLength;
+    ntripServer->messageMillis[ntripServer->messageHead] = millis();
+    ntripServer->messageDropped = false;
+}
+
+//----------------------------------------
+// Write the RTCM data to the NTRIP caster
+//----------------------------------------
+bool ntripServerWriteRTCM(int serverIndex, const uint8_t *rtcmData, uint16_t dataLength)
+{
+    NTRIP_SERVER_DATA *ntripServer = &ntripServerArray[serverIndex];
+
+    // Generate and print timestamp if needed
+    uint32_t currentMilliseconds;
+    if (online.rtc)
     {
-        // Generate and print timestamp if needed
-        uint32_t currentMilliseconds;
-        if (online.rtc)
+        // Timestamp the RTCM messages
+        currentMilliseconds = millis();
+        if (((settings.debugNtripServerRtcm && ((currentMilliseconds - ntripServer->previousMilliseconds) > 5)) ||
+             PERIODIC_DISPLAY(PD_NTRIP_SERVER_DATA)) &&
+            (!settings.enableRtcmMessageChecking) && (!inMainMenu) && ntripServer->bytesSent)
         {
-            // Timestamp the RTCM messages
-            currentMilliseconds = millis();
-            if (((settings.debugNtripServerRtcm && ((currentMilliseconds - ntripServer->previousMilliseconds) > 5)) ||
-                 PERIODIC_DISPLAY(PD_NTRIP_SERVER_DATA)) &&
-                (!settings.enableRtcmMessageChecking) && (!inMainMenu) && ntripServer->bytesSent)
-            {
-                PERIODIC_CLEAR(PD_NTRIP_SERVER_DATA);
-                systemPrintf("    Tx%d RTCM: %s, %d bytes sent\r\n", serverIndex, getTimeStamp(),
-                             ntripServer->rtcmBytesSent);
-                ntripServer->rtcmBytesSent = 0;
-            }
-            ntripServer->previousMilliseconds = currentMilliseconds;
+            PERIODIC_CLEAR(PD_NTRIP_SERVER_DATA);
+            systemPrintf("    Tx%d RTCM: %s, %d bytes sent\r\n", serverIndex, getTimeStamp(),
+                         ntripServer->rtcmBytesSent);
+            ntripServer->rtcmBytesSent = 0;
         }
+        ntripServer->previousMilliseconds = currentMilliseconds;
+    }
+
+    // If we have not gotten new RTCM bytes for a period of time, assume end of frame
+    uint32_t totalBytesSent;
+    if (ntripServer->checkBytesSentAndReset(100, &totalBytesSent) && (!inMainMenu) && settings.debugNtripServerRtcm)
+        systemPrintf("NTRIP Server %d transmitted %d RTCM bytes to Caster\r\n", serverIndex, totalBytesSent);
 
-        // If we have not gotten new RTCM bytes for a period of time, assume end of frame
-        uint32_t totalBytesSent;
-        if (ntripServer->checkBytesSentAndReset(100, &totalBytesSent) && (!inMainMenu) && settings.debugNtripServerRtcm)
-            systemPrintf("NTRIP Server %d transmitted %d RTCM bytes to Caster\r\n", serverIndex, totalBytesSent);
+    bool written = false;
+    if (ntripServer->networkClient && ntripServer->networkClientConnected(true))
+    {
+        unsigned long entryTime = millis();
 
-        if (ntripServer->networkClient && ntripServer->networkClientConnected(true))
+        // pinDebugOn();
+        if (ntripServer->networkClientWrite(rtcmData, dataLength) == dataLength) // Send this byte to socket
         {
-            unsigned long entryTime = millis();
+            ntripServer->updateTimerAndBytesSent(dataLength);
+            netOutgoingRTCM = true;
+            ntripServer->networkClientAbsorb(); // Absorb any unwanted incoming traffic
+            written = true;
+        }
+        // Failed to write the data
+        else
+        {
+            // Done with this client connection
+            if (settings.debugNtripServerRtcm && (!inMainMenu))
+                systemPrintf("NTRIP Server %d broken connection to %s\r\n", serverIndex,
+                             settings.ntripServer_CasterHost[serverIndex]);
+        }
 
-            // pinDebugOn();
-            if (ntripServer->networkClientWrite(rtcmData, dataLength) == dataLength) // Send this byte to socket
-            {
-                ntripServer->updateTimerAndBytesSent(dataLength);
-                netOutgoingRTCM = true;
-                ntripServer->networkClientAbsorb(); // Absorb any unwanted incoming traffic
-            }
-            // Failed to write the data
-            else
-            {
-                // Done with this client connection
-                if (settings.debugNtripServerRtcm && (!inMainMenu))
-                    systemPrintf("NTRIP Server %d broken connection to %s\r\n", serverIndex,
-                                 settings.ntripServer_CasterHost[serverIndex]);
-            }
+        if (((millis() - entryTime) > settings.networkClientWriteTimeout_ms) && settings.debugNtripServerRtcm &&
+            (!inMainMenu))
+        {
+            if (pin_debug != PIN_UNDEFINED)
+                systemPrint(debugMessagePrefix);
+            systemPrintf("ntripServer write took %ldms\r\n", millis() - entryTime);
+        }
+    }
+    return written;
+}
 
-            if (((millis() - entryTime) > settings.networkClientWriteTimeout_ms) && settings.debugNtripServerRtcm &&
-                (!inMainMenu))
-            {
-                if (pin_debug != PIN_UNDEFINED)
-                    systemPrint(debugMessagePrefix);
-                systemPrintf("ntripServer write took %ldms\r\n", millis() - entryTime);
-            }
+//----------------------------------------
+// This function adds stored, complete RTCM messages to the backlog of the connected servers
+// Called by rtcmConsumerWrite after ntripServerRtcmMessageBegin, the message may arrive
+// in two pieces when it wraps in the ring buffer
+//----------------------------------------
+void ntripServerSendRTCM(int serverIndex, uint8_t *rtcmData, uint16_t dataLength)
+{
+    NTRIP_SERVER_DATA *ntripServer = &ntripServerArray[serverIndex];
+    uint16_t bytesToEnd;
+    uint16_t head;
+
+    if (ntripServer->state != NTRIP_SERVER_CASTING)
+        return;
+
+    // Write the data directly when the writer task is not available
+    if (ntripServer->writeDirect)
+    {
+        ntripServerWriteRTCM(serverIndex, rtcmData, dataLength);
+        return;
+    }
+
+    // Discard data beyond the end of the message
+    if ((!ntripServer->taskRunning) || ntripServer->messageDropped || (ntripServer->messageRemaining == 0))
+        return;
+    if (dataLength > ntripServer->messageRemaining)
+        dataLength = ntripServer->messageRemaining;
+
+    // Copy the data into the backlog, in two pieces when it wraps
+    head = ntripServer->messageOffset;
+    bytesToEnd = NTRIP_SERVER_BACKLOG_BYTES - head;
+    if (dataLength <= bytesToEnd)
+        memcpy(&ntripServer->backlog[head], rtcmData, dataLength);
+    else
+    {
+        memcpy(&ntripServer->backlog[head], rtcmData, bytesToEnd);
+        memcpy(ntripServer->backlog, &rtcmData[bytesToEnd], dataLength - bytesToEnd);
+    }
+    ntripServer->messageOffset = (head + dataLength) % NTRIP_SERVER_BACKLOG_BYTES;
+    ntripServer->messageRemaining -= dataLength;
+
+    // Publish the message once it is complete and wake the writer task
+    if (ntripServer->messageRemaining == 0)
+    {
+        ntripServer->backlogHead = ntripServer->messageOffset;
+        __atomic_store_n(&ntripServer->messageHead, (ntripServer->messageHead + 1) % NTRIP_SERVER_BACKLOG_MESSAGES,
+                         __ATOMIC_RELEASE);
+        if (ntripServer->taskHandle)
+            xTaskNotifyGive(ntripServer->taskHandle);
+    }
+}
+
+//----------------------------------------
+// Send the RTCM backlog to the NTRIP caster
+// Started when the server starts casting, a slow or broken caster only delays this task
+//----------------------------------------
+void ntripServerTask(void *e)
+{
+    uint16_t bytesToEnd;
+    uint16_t dataLength;
+    uint32_t latency;
+    int serverIndex;
+    uint16_t tail;
+
+    serverIndex = (int)(intptr_t)e;
+    NTRIP_SERVER_DATA *ntripServer = &ntripServerArray[serverIndex];
+
+    // Start notification
+    if (settings.printTaskStartStop)
+        systemPrintf("Task %s started\r\n", ntripServer->taskName);
+
+    // Run task until a request is raised
+    while (ntripServer->taskStopRequest == false)
+    {
+        // Wait for RTCM messages
+        ulTaskNotifyTake(pdTRUE, NTRIP_SERVER_TASK_POLL_MSEC / portTICK_PERIOD_MS);
+
+        // Send the messages
+        while ((ntripServer->taskStopRequest == false) &&
+               (ntripServer->messageTail != __atomic_load_n(&ntripServer->messageHead, __ATOMIC_ACQUIRE)))
+        {
+            // Send the message from the backlog, in two pieces when it wraps
+            dataLength = ntripServer->messageLength[ntripServer->messageTail];
+            tail = ntripServer->backlogTail;
+            bytesToEnd = NTRIP_SERVER_BACKLOG_BYTES - tail;
+            if (dataLength <= bytesToEnd)
+                ntripServerWriteRTCM(serverIndex, &ntripServer->backlog[tail], dataLength);
+            else if (ntripServerWriteRTCM(serverIndex, &ntripServer->backlog[tail], bytesToEnd))
+                ntripServerWriteRTCM(serverIndex, ntripServer->backlog, dataLength - bytesToEnd);
+
+            // Account for the message
+            latency = millis() - ntripServer->messageMillis[ntripServer->messageTail];
+            ntripServer->latencyMsec = latency;
+            if (ntripServer->latencyMaxMsec < latency)
+                ntripServer->latencyMaxMsec = latency;
+
+            // Release the backlog space
+            ntripServer->backlogTail = (tail + dataLength) % NTRIP_SERVER_BACKLOG_BYTES;
+            ntripServer->messageTail = (ntripServer->messageTail + 1) % NTRIP_SERVER_BACKLOG_MESSAGES;
+        }
+
+        if ((settings.enableTaskReports == true) && (!inMainMenu))
+            systemPrintf("%s High watermark: %d\r\n", ntripServer->taskName, uxTaskGetStackHighWaterMark(nullptr));
+    }
+
+    // Stop notification
+    if (settings.printTaskStartStop)
+        systemPrintf("Task %s stopped\r\n", ntripServer->taskName);
+    ntripServer->taskRunning = false;
+    vTaskDelete(NULL);
+}
+
+//----------------------------------------
+// Start the NTRIP server writer task, returns true when the task is running
+//----------------------------------------
+bool ntripServerTaskStart(int serverIndex)
+{
+    NTRIP_SERVER_DATA *ntripServer = &ntripServerArray[serverIndex];
+    TaskHandle_t taskHandle;
+
+    if (ntripServer->taskRunning)
+        return true;
+    ntripServer->writeDirect = true;
+
+    // Allocate the backlog, kept for the life of the system since handleGnssDataTask may be using it
+    if (!ntripServer->backlog)
+    {
+        ntripServer->backlog = (uint8_t *)rtkMalloc(NTRIP_SERVER_BACKLOG_BYTES, "NTRIP server backlog");
+        if (!ntripServer->backlog)
+        {
+            systemPrintf("ERROR: Failed to allocate the NTRIP server %d backlog, writing directly!\r\n", serverIndex);
+            return false;
         }
     }
+
+    // Discard any previous messages
+    ntripServer->backlogTail = ntripServer->backlogHead;
+    ntripServer->messageTail = ntripServer->messageHead;
+
+    // The server index is passed as the task parameter
+    snprintf(ntripServer->taskName, sizeof(ntripServer->taskName), "NtripServer%d", serverIndex);
+    ntripServer->taskStopRequest = false;
+    ntripServer->taskRunning = true;
+    if (xTaskCreatePinnedToCore(ntripServerTask,                  // Function to call
+                                ntripServer->taskName,            // Just for humans
+                                ntripServerTaskStackSize,         // Stack Size
+                                (void *)(intptr_t)serverIndex,    // Task input parameter
+                                settings.ntripServerTaskPriority, // Priority
+                                &taskHandle,                      // Task handle
+                                settings.ntripServerTaskCore) != pdPASS)
+    {
+        ntripServer->taskRunning = false;
+        systemPrintf("ERROR: Failed to start %s task, writing directly!\r\n", ntripServer->taskName);
+        return false;
+    }
+    ntripServer->taskHandle = taskHandle;
+    ntripServer->writeDirect = false;
+    return true;
+}
+
+//----------------------------------------
+// Stop the NTRIP server writer task
+//----------------------------------------
+void ntripServerTaskStop(int serverIndex)
+{
+    NTRIP_SERVER_DATA *ntripServer = &ntripServerArray[serverIndex];
+    TaskHandle_t taskHandle;
+
+    // Stop writing directly
+    ntripServer->writeDirect = false;
+
+    // Stop waking the task
+    taskHandle = ntripServer->taskHandle;
+    ntripServer->taskHandle = nullptr;
+
+    // Wait for the task to stop, the task may be waiting for a write to complete
+    ntripServer->taskStopRequest = true;
+    if (ntripServer->taskRunning && taskHandle)
+        xTaskNotifyGive(taskHandle);
+    while (ntripServer->taskRunning)
+        delay(10);
 }
 
 //----------------------------------------
@@ -800,6 +1099,9 @@ void ntripServerStop(int serverIndex, bool shutdown)
     int index;
     NTRIP_SERVER_DATA *ntripServer = &ntripServerArray[serverIndex];
 
+    // Stop writing to the network client
+    ntripServerTaskStop(serverIndex);
+
     if (ntripServer->networkClient)
     {
         // Break the NTRIP server connection if necessary
@@ -1042,7 +1344,8 @@ void ntripServerUpdate(int serverIndex)
                 // Connection is now open, start the RTCM correction data timer
                 ntripServer->setTimerToMillis();
 
-                // We don't use a task because we use I2C hardware (and don't have a semaphore).
+                // Start the writer task before casting, RTCM is written directly if the task fails to start
+                ntripServerTaskStart(serverIndex);
                 online.ntripServer[serverIndex] = true;
                 ntripServer->startTime = millis();
                 ntripServerSetState(serverIndex, NTRIP_SERVER_CASTING);
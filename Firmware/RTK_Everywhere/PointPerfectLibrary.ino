@@ -51,7 +51,7 @@ void updatePplTask(void *e)
 #endif // COMPILE_ZED
                         }
 
-                        gnss->pushRawData(pplRtcmBuffer, rtcmLength);
+                        correctionPushRawData(pplCorrectionsSource, pplRtcmBuffer, rtcmLength, true);
                         sempParseNextBytes(rtcmParse, pplRtcmBuffer, rtcmLength); // Parse the data for RTCM1005/1006
 
                         if (settings.debugCorrections == true && !inMainMenu)
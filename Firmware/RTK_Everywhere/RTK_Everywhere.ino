@@ -209,7 +209,9 @@ const uint16_t HTTPS_PORT = 443;
 #include <ArduinoJson.h> //http://librarymanager/All#Arduino_JSON_messagepack - Needed for settings.h
 
 #include "settings.h"
+#include "NmeaSentence.h" // Classify NMEA sentences once in processUart1Message
 #include <esp_mac.h> // MAC address support
+#include <esp_rom_crc.h> // CRC-32 of the binary settings snapshot
 
 #define MAX_CPU_CORES 2
 #define IDLE_COUNT_PER_SECOND 515400 // Found by empirical sketch
@@ -391,13 +393,6 @@ SemaphoreHandle_t sdCardSemaphore = NULL;
 TickType_t loggingSemaphoreWait_ms = 10 / portTICK_PERIOD_MS;
 const TickType_t fatSemaphore_shortWait_ms = 10 / portTICK_PERIOD_MS;
 const TickType_t fatSemaphore_longWait_ms = 200 / portTICK_PERIOD_MS;
-const TickType_t ringBuffer_shortWait_ms = 20 / portTICK_PERIOD_MS;
-const TickType_t ringBuffer_longWait_ms = 300 / portTICK_PERIOD_MS;
-
-// ringBuffer semaphore - prevent processUart1Message (gnssReadTask) and handleGnssDataTask
-// from gatecrashing each other.
-SemaphoreHandle_t ringBufferSemaphore = NULL;
-const char *ringBufferSemaphoreHolder = "None";
 
 // Display used/free space in menu and config page
 uint64_t sdCardSize;
@@ -426,6 +421,7 @@ const int sdSizeCheckStackSize = 3000;
 char logFileName[sizeof("SFE_Reference_Station_230101_120101.ubx_plusExtraSpace")] = {0};
 
 bool savePossibleSettings = true; // Save possible vs. available settings. See recordSystemSettingsToFile for details
+bool settingsSnapshotImport; // A clear text settings file was imported, record the settings snapshots
 
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
 
@@ -536,6 +532,8 @@ bool usbSerialIncomingRtcm; // Incoming RTCM over the USB serial port
 #define RTCM_CORRECTION_INPUT_TIMEOUT (2 * 1000)
 #define RTCM_CORRECTION_WRITE_TIMEOUT (3 * 1000)
 
+#include "RtcmMsm.h" // RTCM message fields and the MSM7 to MSM4 conversion used by the RTCM link rules
+
 //=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 // Extensible Message Parser
@@ -545,6 +543,7 @@ SEMP_PARSE_STATE *rtkParse = nullptr;
 SEMP_PARSE_STATE *sbfParse = nullptr;    // mosaic-X5
 SEMP_PARSE_STATE *spartnParse = nullptr; // mosaic-X5
 SEMP_PARSE_STATE *rtcmParse = nullptr;   // Parse incoming corrections for RTCM1005 / 1006 base locations
+volatile uint32_t rtcmParseMessages;     // Number of messages found by rtcmParse
 
 //=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
@@ -618,12 +617,21 @@ volatile bool inDirectConnectMode = false; // Global state to indicate if GNSS/L
 #define SERIAL_SIZE_TX 512
 uint8_t wBuffer[SERIAL_SIZE_TX]; // Buffer for writing from incoming SPP to F9P
 const int btReadTaskStackSize = 3000;
+const int correctionMuxTaskStackSize = 3000;
+const int loraTxTaskStackSize = 3000;
+const int sdLogTaskStackSize = 3000;
+
+#include "RingBuffer.h" // Lock-free head and tail publication between processUart1Message and the consumers
 
 // Array of start-of-sentence offsets into the ring buffer
-#define AMOUNT_OF_RING_BUFFER_DATA_TO_DISCARD (settings.gnssHandlerBufferSize >> 2)
+#define AMOUNT_OF_RING_BUFFER_DATA_TO_DISCARD (ringBufferSize >> 2)
 #define AVERAGE_SENTENCE_LENGTH_IN_BYTES 32
 RING_BUFFER_OFFSET *rbOffsetArray = nullptr;
+uint8_t *rbConsumerArray; // Consumers (1 << RBC_xxx) receiving the message ending at rbOffsetArray[index]
 uint16_t rbOffsetEntries;
+int ringBufferSize; // Size of ringBuffer, settings.gnssHandlerBufferSize unless sized by ringBufferAutoSize
+int gnssUartReceiveBufferSize; // Size of the GNSS UART receive buffer, settings.uartReceiveBufferSize unless enlarged
+                               // by ringBufferAutoSize
 
 uint8_t *ringBuffer; // Buffer for reading from GNSS receiver. At 230400bps, 23040 bytes/s. If SD blocks for 250ms, we
                      // need 23040
@@ -632,6 +640,7 @@ const int gnssReadTaskStackSize = 8000;
 const size_t sempGnssReadBufferSize = 8000; // Make the SEMP buffer size the ~same
 
 const int handleGnssDataTaskStackSize = 4000;
+const int ntripServerTaskStackSize = 4000;
 
 TaskHandle_t pinBluetoothTaskHandle; // Dummy task to start hardware on an assigned core
 volatile bool bluetoothPinned;       // This variable is touched by core 0 but checked by core 1. Must be volatile.
@@ -962,6 +971,7 @@ unsigned long lastSpartnReception = 0; // Timestamp of last SPARTN reception
 
 TaskHandle_t idleTaskHandle[MAX_CPU_CORES];
 uint32_t max_idle_count = MAX_IDLE_TIME_COUNT;
+uint8_t cpuIdlePercent[MAX_CPU_CORES]; // Updated by idleTask every IDLE_TIME_DISPLAY_SECONDS
 
 bool bluetoothIncomingRTCM;
 bool bluetoothOutgoingRTCM;
@@ -997,6 +1007,10 @@ unsigned long lastSpartnToPpl = 0;
 // Command processing
 int commandCount;
 int16_t *commandIndex;
+int commandPrioritySettingsEnd; // Start of the sorted commands in commandIndex, set by commandIndexFill
+int16_t *commandSortedIndex;    // Commands following the priority settings, sorted once for all platforms
+int commandSortedCount;         // Number of entries in commandSortedIndex
+int commandSortedPriorityEnd;   // Number of priority settings in rtkSettingsEntries
 
 bool usbSerialIsSelected = true;      // Goes false when switch U18 is moved from CH34x to LoRa
 unsigned long loraLastIncomingSerial; // Last time a user sent a serial command. Used in LoRa timeouts.
@@ -1580,6 +1594,9 @@ void loop()
     DMW_l("logUpdate");
     logUpdate(); // Record any new data. Create or close files as needed.
 
+    DMW_l("ringBufferUpdateWorstStall");
+    ringBufferUpdateWorstStall(); // Record the worst SD card stall for the ring buffer auto size
+
     DMW_l("reportHeap");
     reportHeap(); // If debug enabled, report free heap
 
@@ -0,0 +1,134 @@
+/*=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+RingBuffer.h
+
+  Lock-free head and tail publication for the GNSS ring buffer.  There is a
+  single producer (processUart1Message) and one tail per ring buffer consumer.
+
+  The producer owns dataHead and the rbOffsetArray.  It publishes dataHead
+  after the message is copied into the ring buffer.
+
+  Each consumer owns a tail word containing the ring buffer offset of the
+  oldest data it still needs and a busy flag.  The consumer sets the busy
+  flag before reading the ring buffer and clears it when it publishes its
+  new tail.
+
+  When the ring buffer is full, the producer moves the tails of the idle
+  consumers forward to a message boundary using compare and swap.  The
+  producer never moves a busy tail, it drops the new message instead.  Upon
+  claiming its tail, the consumer detects the trim by comparing the tail
+  with the value it released.
+
+  This file is also compiled on Linux by Tools/Ring_Buffer_Stress.c, keep it
+  free of ESP32 and Arduino dependencies.
+
+=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=*/
+
+#ifndef __RING_BUFFER_H__
+#define __RING_BUFFER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Consumer tail word: offset in the low 16 bits, busy flag in bit 31
+typedef volatile uint32_t RING_BUFFER_TAIL;
+
+#define RING_BUFFER_TAIL_BUSY       0x80000000  // Consumer is reading the ring buffer
+#define RING_BUFFER_TAIL_OFFSET     0x0000ffff  // Offset of the oldest data needed by the consumer
+
+// Determine if a tail is within the region of the ring buffer being discarded
+static inline bool ringBufferTailInRange(uint16_t tail, uint16_t previousTail, uint16_t newTail)
+{
+    // Determine if the trimmed data wraps the end of the buffer
+    if (previousTail < newTail)
+        // No buffer wrap occurred
+        return (tail >= previousTail) && (tail < newTail);
+
+    // Buffer wrap occurred
+    return (tail >= previousTail) || (tail < newTail);
+}
+
+//----------------------------------------
+// Producer routines
+//----------------------------------------
+
+// Publish the new head after the data is in the ring buffer
+static inline void ringBufferHeadSet(volatile uint16_t *head, uint16_t offset)
+{
+    __atomic_store_n(head, offset, __ATOMIC_RELEASE);
+}
+
+// Get the offset of the oldest data needed by a consumer
+static inline uint16_t ringBufferTailGet(RING_BUFFER_TAIL *tail)
+{
+    return (uint16_t)(__atomic_load_n(tail, __ATOMIC_ACQUIRE) & RING_BUFFER_TAIL_OFFSET);
+}
+
+// Determine if a consumer is reading data in the region being discarded
+static inline bool ringBufferTailBusyInRange(RING_BUFFER_TAIL *tail, uint16_t previousTail, uint16_t newTail)
+{
+    uint32_t value;
+
+    value = __atomic_load_n(tail, __ATOMIC_ACQUIRE);
+    return (value & RING_BUFFER_TAIL_BUSY)
+        && ringBufferTailInRange(value & RING_BUFFER_TAIL_OFFSET, previousTail, newTail);
+}
+
+// Move an idle consumer tail out of the region being discarded
+// Returns false if the consumer is reading the data, the data must not be overwritten
+static inline bool ringBufferTailTrim(RING_BUFFER_TAIL *tail, uint16_t previousTail, uint16_t newTail)
+{
+    uint32_t value;
+
+    value = __atomic_load_n(tail, __ATOMIC_ACQUIRE);
+    do
+    {
+        // Only discard the data from long and medium tails
+        if (!ringBufferTailInRange(value & RING_BUFFER_TAIL_OFFSET, previousTail, newTail))
+            return true;
+
+        // Don't discard data while the consumer is reading it
+        if (value & RING_BUFFER_TAIL_BUSY)
+            return false;
+
+        // The consumer may claim the tail or publish a new tail at any time
+    } while (!__atomic_compare_exchange_n(tail, &value, (uint32_t)newTail, false,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    return true;
+}
+
+// Publish the number of messages described by the offset array after publishing the head
+static inline void ringBufferCountSet(volatile uint32_t *count, uint32_t value)
+{
+    __atomic_store_n(count, value, __ATOMIC_RELEASE);
+}
+
+//----------------------------------------
+// Consumer routines
+//----------------------------------------
+
+// Get the number of messages described by the offset array, the head covers these messages
+static inline uint32_t ringBufferCountGet(volatile uint32_t *count)
+{
+    return __atomic_load_n(count, __ATOMIC_ACQUIRE);
+}
+
+// Get the head offset, the data before the head is in the ring buffer
+static inline uint16_t ringBufferHeadGet(volatile uint16_t *head)
+{
+    return __atomic_load_n(head, __ATOMIC_ACQUIRE);
+}
+
+// Prevent the producer from discarding the consumer's data
+// Returns the offset of the oldest data available to the consumer
+static inline uint16_t ringBufferTailClaim(RING_BUFFER_TAIL *tail)
+{
+    return (uint16_t)(__atomic_fetch_or(tail, RING_BUFFER_TAIL_BUSY, __ATOMIC_ACQ_REL) & RING_BUFFER_TAIL_OFFSET);
+}
+
+// Publish the consumer's new tail and allow the producer to discard its data
+static inline void ringBufferTailRelease(RING_BUFFER_TAIL *tail, uint16_t offset)
+{
+    __atomic_store_n(tail, (uint32_t)offset, __ATOMIC_RELEASE);
+}
+
+#endif  // __RING_BUFFER_H__
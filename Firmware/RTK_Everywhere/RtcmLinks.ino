@@ -0,0 +1,335 @@
+/*=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+RtcmLinks.ino
+
+  Select the RTCM messages sent to each link: the NTRIP servers, LoRa and
+  ESP-NOW.  The GNSS produces a single RTCM stream, however the radio links
+  are not able to carry the full set of messages that a caster accepts.
+  sendRTCMToConsumers passes each message to rtcmLinkSend which applies the
+  rules for each link:
+
+    * rtcmLinkStationInterval - Seconds between the station messages
+      (1005, 1006, 1007, 1008, 1033 and 1230)
+    * rtcmLinkObservationInterval - Seconds between the MSM epochs
+    * rtcmLinkGlonassInterval - Seconds between the GLONASS MSM
+    * rtcmLinkMsm4 - Send the MSM7 messages as MSM4 messages
+    * rtcmLinkBudget - Bytes per second, messages and whole epochs are
+      dropped while the link is over its budget
+
+  The MSM messages are grouped into epochs using the multiple message bit.
+  The observation, GLONASS and budget decisions for the MSM messages are made
+  once at the start of the epoch, so the link receives all or none of the
+  constellations of an epoch.
+
+    GNSS --> Ring buffer --> sendRTCMToConsumers --> rtcmLinkSend
+                                                         |
+                    .------------------------------------+----------------.
+                    |                 |                  |                |
+                 Rules 0    ...    Rules 3            Rules LoRa    Rules ESP-NOW
+                    |                 |                  |                |
+              NTRIP Server 1    NTRIP Server 4         LoRa           ESP-NOW
+
+  The intervals allow for the arrival jitter of the messages, a 10 second
+  interval selects one of every 10 messages arriving at 1 Hz.
+
+=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=*/
+
+#define RTCM_LINK_INTERVAL_SLACK_MSEC 500 // Allow for the arrival jitter
+#define RTCM_LINK_BUDGET_BURST_SECONDS 2  // Budget saved while the link is idle
+
+// Names of the links, indexed by RTCM_LINK_xxx
+const char *const rtcmLinkNames[] = {
+    "NTRIP Server 1", "NTRIP Server 2", "NTRIP Server 3", "NTRIP Server 4", "LoRa", "ESP-NOW",
+};
+const int rtcmLinkNamesEntries = sizeof(rtcmLinkNames) / sizeof(rtcmLinkNames[0]);
+
+typedef struct
+{
+    uint32_t stationMillis; // Last station message sent, zero = never
+    uint32_t epochMillis;   // Start of the last MSM epoch sent, zero = never
+    uint32_t glonassMillis; // Start of the last epoch with GLONASS sent, zero = never
+    uint32_t budgetMillis;  // Last budget update
+    int32_t budget;         // Bytes * 1000 available to send
+    bool sendEpoch;         // Send the MSM messages of this epoch
+    bool sendGlonass;       // Send the GLONASS MSM messages of this epoch
+
+    // Statistics
+    uint32_t bytesSent;
+    uint32_t messagesSent;
+    uint32_t messagesConverted;  // MSM7 messages sent as MSM4
+    uint32_t messagesSkipped;    // Removed by the interval rules
+    uint32_t messagesOverBudget; // Removed by the budget
+} RTCM_LINK_STATE;
+
+static RTCM_LINK_STATE rtcmLinkState[RTCM_LINK_MAX];
+static bool rtcmLinkInEpoch;         // Between the first MSM and the MSM with the multiple message bit clear
+static uint32_t rtcmLinkEpochMillis; // Arrival of the first MSM of the epoch
+
+// Contiguous copies of the MSM7 message and its MSM4 conversion
+static uint8_t rtcmLinkMsm7Frame[RTCM_FRAME_MAX_LENGTH];
+static uint8_t rtcmLinkMsm4Frame[RTCM_FRAME_MAX_LENGTH];
+
+//----------------------------------------
+// Get the name of the link
+//----------------------------------------
+const char *rtcmLinkName(int link)
+{
+    if ((link < 0) || (link >= RTCM_LINK_MAX))
+        return "Unknown";
+    return rtcmLinkNames[link];
+}
+
+//----------------------------------------
+// Determine if the message describes the station: location, antenna, receiver or biases
+//----------------------------------------
+bool rtcmLinkIsStation(uint16_t messageNumber)
+{
+    return (messageNumber == 1005) || (messageNumber == 1006) || (messageNumber == 1007) ||
+           (messageNumber == 1008) || (messageNumber == 1033) || (messageNumber == 1230);
+}
+
+//----------------------------------------
+// Determine if the interval has elapsed since the last message was sent
+//----------------------------------------
+bool rtcmLinkIntervalElapsed(uint32_t lastMillis, uint16_t intervalSeconds, uint32_t currentMillis)
+{
+    if ((intervalSeconds == 0) || (lastMillis == 0))
+        return true;
+    return (currentMillis - lastMillis) >= ((intervalSeconds * 1000) - RTCM_LINK_INTERVAL_SLACK_MSEC);
+}
+
+//----------------------------------------
+// Add the budget accumulated since the last message
+//----------------------------------------
+void rtcmLinkBudgetUpdate(int link, uint32_t currentMillis)
+{
+    RTCM_LINK_STATE *state = &rtcmLinkState[link];
+    uint32_t budget = settings.rtcmLinkBudget[link];
+    uint32_t elapsed;
+    int32_t maximum;
+
+    if (budget == 0)
+    {
+        state->budget = 0;
+        return;
+    }
+
+    // Limit the budget saved while the link is idle
+    elapsed = currentMillis - state->budgetMillis;
+    state->budgetMillis = currentMillis;
+    if (elapsed > (RTCM_LINK_BUDGET_BURST_SECONDS * 1000))
+        elapsed = RTCM_LINK_BUDGET_BURST_SECONDS * 1000;
+    maximum = budget * 1000 * RTCM_LINK_BUDGET_BURST_SECONDS;
+    state->budget += budget * elapsed;
+    if (state->budget > maximum)
+        state->budget = maximum;
+}
+
+//----------------------------------------
+// Account for the message sent on the link
+//----------------------------------------
+void rtcmLinkAccount(int link, uint16_t length)
+{
+    RTCM_LINK_STATE *state = &rtcmLinkState[link];
+
+    if (settings.rtcmLinkBudget[link])
+        state->budget -= length * 1000;
+    state->bytesSent += length;
+    state->messagesSent++;
+}
+
+//----------------------------------------
+// Select the MSM messages sent to the link during this epoch
+//----------------------------------------
+void rtcmLinkEpochStart(int link)
+{
+    RTCM_LINK_STATE *state = &rtcmLinkState[link];
+
+    state->sendEpoch = rtcmLinkIntervalElapsed(state->epochMillis, settings.rtcmLinkObservationInterval[link],
+                                               rtcmLinkEpochMillis) &&
+                       ((settings.rtcmLinkBudget[link] == 0) || (state->budget >= 0));
+    if (state->sendEpoch)
+        state->epochMillis = rtcmLinkEpochMillis;
+
+    state->sendGlonass =
+        state->sendEpoch &&
+        rtcmLinkIntervalElapsed(state->glonassMillis, settings.rtcmLinkGlonassInterval[link], rtcmLinkEpochMillis);
+    if (state->sendGlonass)
+        state->glonassMillis = rtcmLinkEpochMillis;
+}
+
+//----------------------------------------
+// Send the RTCM message to the links
+// Called by sendRTCMToConsumers, the message arrives in two pieces when it wraps in the ring buffer
+//----------------------------------------
+void rtcmLinkSend(uint8_t *data, uint16_t length, uint8_t *wrapData, uint16_t wrapLength)
+{
+    bool converted;
+    uint32_t currentMillis;
+    bool epochStart;
+    bool glonass;
+    uint8_t header[RTCM_FRAME_HEADER_LENGTH + 7];
+    bool lastMsm;
+    uint16_t messageLength;
+    uint16_t messageNumber;
+    bool msm;
+    size_t msm4Length;
+    bool send;
+    RTCM_LINK_STATE *state;
+    bool station;
+
+    // Get the start of the message, through the MSM multiple message bit
+    messageLength = length + wrapLength;
+    for (int index = 0; index < (int)sizeof(header); index++)
+    {
+        if (index < length)
+            header[index] = data[index];
+        else if ((index - length) < wrapLength)
+            header[index] = wrapData[index - length];
+        else
+            header[index] = 0;
+    }
+
+    // Classify the message
+    messageNumber = rtcmGetBits(&header[RTCM_FRAME_HEADER_LENGTH], 0, 12);
+    msm = (messageLength >= sizeof(header)) && rtcmIsMsm(messageNumber);
+    glonass = msm && rtcmIsGlonassMsm(messageNumber);
+    lastMsm = msm && (rtcmGetBits(&header[RTCM_FRAME_HEADER_LENGTH], RTCM_MSM_MULTIPLE_BIT, 1) == 0);
+    station = rtcmLinkIsStation(messageNumber);
+
+    // The first MSM starts the epoch
+    currentMillis = millis();
+    epochStart = msm && (rtcmLinkInEpoch == false);
+    if (epochStart)
+    {
+        rtcmLinkInEpoch = true;
+        rtcmLinkEpochMillis = currentMillis;
+    }
+
+    converted = false;
+    msm4Length = 0;
+    for (int link = 0; link < RTCM_LINK_MAX; link++)
+    {
+        state = &rtcmLinkState[link];
+        rtcmLinkBudgetUpdate(link, currentMillis);
+        if (epochStart)
+            rtcmLinkEpochStart(link);
+
+        // Apply the rules
+        if (msm)
+        {
+            send = state->sendEpoch && ((!glonass) || state->sendGlonass);
+            if (!send)
+            {
+                if (state->sendEpoch || (settings.rtcmLinkBudget[link] == 0) || (state->budget >= 0))
+                    state->messagesSkipped++;
+                else
+                    state->messagesOverBudget++;
+            }
+        }
+        else if (station &&
+                 !rtcmLinkIntervalElapsed(state->stationMillis, settings.rtcmLinkStationInterval[link], currentMillis))
+        {
+            send = false;
+            state->messagesSkipped++;
+        }
+        else
+        {
+            send = (settings.rtcmLinkBudget[link] == 0) || (state->budget >= 0);
+            if (!send)
+                state->messagesOverBudget++;
+            else if (station)
+                state->stationMillis = currentMillis;
+        }
+        if (!send)
+            continue;
+
+        // Convert the MSM7 message once for all of the links
+        if (msm && settings.rtcmLinkMsm4[link] && ((messageNumber % 10) == 7))
+        {
+            if (!converted)
+            {
+                converted = true;
+                memcpy(rtcmLinkMsm7Frame, data, length);
+                if (wrapLength)
+                    memcpy(&rtcmLinkMsm7Frame[length], wrapData, wrapLength);
+                msm4Length = rtcmMsm7ToMsm4(rtcmLinkMsm7Frame, messageLength, rtcmLinkMsm4Frame);
+            }
+            if (msm4Length)
+            {
+                rtcmConsumerMessageBegin(link, msm4Length);
+                rtcmConsumerWrite(link, rtcmLinkMsm4Frame, msm4Length);
+                rtcmLinkAccount(link, msm4Length);
+                state->messagesConverted++;
+                continue;
+            }
+        }
+
+        // Send the message directly from the ring buffer
+        rtcmConsumerMessageBegin(link, messageLength);
+        rtcmConsumerWrite(link, data, length);
+        if (wrapLength)
+            rtcmConsumerWrite(link, wrapData, wrapLength);
+        rtcmLinkAccount(link, messageLength);
+    }
+
+    // The MSM with the multiple message bit clear ends the epoch
+    if (lastMsm)
+        rtcmLinkInEpoch = false;
+}
+
+//----------------------------------------
+// Restart the epoch after the oldest RTCM messages were discarded
+// The message ending the epoch may have been discarded
+//----------------------------------------
+void rtcmLinkEpochLost()
+{
+    rtcmLinkInEpoch = false;
+}
+
+//----------------------------------------
+// Display the rules for the link
+//----------------------------------------
+void rtcmLinkPrintRules(int link)
+{
+    systemPrintf("%s:", rtcmLinkName(link));
+    if (settings.rtcmLinkStationInterval[link])
+        systemPrintf(" station %ds", settings.rtcmLinkStationInterval[link]);
+    if (settings.rtcmLinkObservationInterval[link])
+        systemPrintf(" MSM %ds", settings.rtcmLinkObservationInterval[link]);
+    if (settings.rtcmLinkGlonassInterval[link])
+        systemPrintf(" GLONASS %ds", settings.rtcmLinkGlonassInterval[link]);
+    if (settings.rtcmLinkMsm4[link])
+        systemPrint(" MSM7->MSM4");
+    if (settings.rtcmLinkBudget[link])
+        systemPrintf(" budget %d bytes/s", settings.rtcmLinkBudget[link]);
+    if ((settings.rtcmLinkStationInterval[link] | settings.rtcmLinkObservationInterval[link] |
+         settings.rtcmLinkGlonassInterval[link] | settings.rtcmLinkMsm4[link] | settings.rtcmLinkBudget[link]) == 0)
+        systemPrint(" all messages");
+    systemPrintln();
+}
+
+//----------------------------------------
+// Display the message counts for each link
+//----------------------------------------
+void rtcmLinkPrintStats()
+{
+    RTCM_LINK_STATE *state;
+
+    systemPrintln("      Bytes    Messages   Converted     Skipped  OverBudget  Link");
+    systemPrintln("  ---------  ----------  ----------  ----------  ----------  --------------");
+    for (int link = 0; link < RTCM_LINK_MAX; link++)
+    {
+        state = &rtcmLinkState[link];
+        systemPrintf("  %9lu  %10lu  %10lu  %10lu  %10lu  %s\r\n", state->bytesSent, state->messagesSent,
+                     state->messagesConverted, state->messagesSkipped, state->messagesOverBudget, rtcmLinkName(link));
+    }
+}
+
+//----------------------------------------
+// Verify the RTCM link tables
+//----------------------------------------
+void rtcmLinkVerifyTables()
+{
+    if (rtcmLinkNamesEntries != RTCM_LINK_MAX)
+        reportFatalError("Fix rtcmLinkNames to match RTCM_LINK list");
+}
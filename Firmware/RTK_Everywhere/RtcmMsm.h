@@ -0,0 +1,281 @@
+/*=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+RtcmMsm.h
+
+  Decode the RTCM 3 message fields used by the RTCM link rules (RtcmLinks.ino)
+  and convert MSM7 messages into MSM4 messages for the low bandwidth links.
+
+  The RTCM frame is: preamble (0xd3), 6 reserved bits, 10 bit payload length,
+  the payload and the 24 bit CRC.  The MSM payload is the MSM header, the
+  satellite data and the signal data (RTCM 10403.3 section 3.5.6).
+
+                    MSM4                            MSM7
+  Satellite data    DF397 8, DF398 10               DF397 8, Extended info 4, DF398 10, DF399 14
+  Signal data       DF400 15, DF401 22, DF402 4,    DF405 20, DF406 24, DF407 10,
+                    DF420 1, DF403 6                DF420 1, DF408 10, DF404 15
+
+  The conversion drops the extended satellite information (the GLONASS
+  frequency channel number) and the phase range rates, then reduces the
+  resolution of the remaining signal fields.
+
+  This file is free of ESP32 and Arduino dependencies.
+
+=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=*/
+
+#ifndef __RTCM_MSM_H__
+#define __RTCM_MSM_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define RTCM_FRAME_HEADER_LENGTH    3    // Preamble, reserved and length
+#define RTCM_FRAME_CRC_LENGTH       3
+#define RTCM_FRAME_MAX_LENGTH       (RTCM_FRAME_HEADER_LENGTH + 1023 + RTCM_FRAME_CRC_LENGTH)
+#define RTCM_MSM_HEADER_BITS        169  // Through the signal mask, the cell mask follows
+#define RTCM_MSM_MULTIPLE_BIT       54   // Multiple message bit, 0 = last MSM of the epoch
+
+// Get an unsigned field from the payload, bitCount <= 32
+static inline uint32_t rtcmGetBits(const uint8_t *payload, uint32_t bitOffset, int bitCount)
+{
+    uint32_t value;
+
+    value = 0;
+    while (bitCount--)
+    {
+        value = (value << 1) | ((payload[bitOffset >> 3] >> (7 - (bitOffset & 7))) & 1);
+        bitOffset++;
+    }
+    return value;
+}
+
+// Get a two's complement field from the payload
+static inline int32_t rtcmGetSignedBits(const uint8_t *payload, uint32_t bitOffset, int bitCount)
+{
+    uint32_t value;
+
+    value = rtcmGetBits(payload, bitOffset, bitCount);
+    if (value & (1ul << (bitCount - 1)))
+        return (int32_t)(value | (0xfffffffful << (bitCount - 1)));
+    return (int32_t)value;
+}
+
+// Set a field in the payload, bitCount <= 32
+static inline void rtcmSetBits(uint8_t *payload, uint32_t bitOffset, int bitCount, uint32_t value)
+{
+    uint8_t mask;
+
+    while (bitCount--)
+    {
+        mask = 0x80 >> (bitOffset & 7);
+        if ((value >> bitCount) & 1)
+            payload[bitOffset >> 3] |= mask;
+        else
+            payload[bitOffset >> 3] &= ~mask;
+        bitOffset++;
+    }
+}
+
+// Add more of the frame header and payload to the CRC-24Q, start with zero
+static inline uint32_t rtcmCrc24qUpdate(uint32_t crc, const uint8_t *data, size_t length)
+{
+    while (length--)
+    {
+        crc ^= ((uint32_t)*data++) << 16;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc <<= 1;
+            if (crc & 0x1000000)
+                crc ^= 0x1864cfb;
+        }
+    }
+    return crc & 0xffffff;
+}
+
+// Compute the CRC-24Q over the frame header and payload
+static inline uint32_t rtcmCrc24q(const uint8_t *data, size_t length)
+{
+    return rtcmCrc24qUpdate(0, data, length);
+}
+
+// Determine if the message number is an MSM (1071 - 1137, MSM1 - MSM7)
+static inline bool rtcmIsMsm(uint16_t messageNumber)
+{
+    return (messageNumber >= 1071) && (messageNumber <= 1137) && ((messageNumber % 10) >= 1) &&
+           ((messageNumber % 10) <= 7);
+}
+
+// Determine if the message number is a GLONASS MSM
+static inline bool rtcmIsGlonassMsm(uint16_t messageNumber)
+{
+    return (messageNumber >= 1081) && (messageNumber <= 1087);
+}
+
+// Count the bits set in the mask
+static inline int rtcmBitCount(uint64_t mask)
+{
+    int count;
+
+    for (count = 0; mask; count++)
+        mask &= mask - 1;
+    return count;
+}
+
+// Convert the MSM7 lock time indicator (DF407) into milliseconds
+static inline uint32_t rtcmMsm7LockTimeMsec(uint32_t indicator)
+{
+    uint32_t shift;
+
+    if (indicator < 64)
+        return indicator;
+    if (indicator > 704)
+        indicator = 704;
+    shift = (indicator >> 5) - 1;
+    return (indicator << shift) - (shift << (shift + 5));
+}
+
+// Convert the lock time in milliseconds into the MSM4 lock time indicator (DF402)
+static inline uint32_t rtcmMsm4LockTimeIndicator(uint32_t milliseconds)
+{
+    uint32_t indicator;
+
+    if (milliseconds < 32)
+        return 0;
+    for (indicator = 1; (indicator < 15) && (milliseconds >= (64ul << (indicator - 1))); indicator++)
+        ;
+    return indicator;
+}
+
+// Reduce the resolution of a signed field, keeping the invalid value
+static inline int32_t rtcmMsmRescale(int32_t value, int shift, int bitCount, int32_t invalidIn)
+{
+    int32_t limit;
+
+    if (value == invalidIn)
+        return -(1l << (bitCount - 1));
+    value = (value + (1l << (shift - 1))) >> shift;
+    limit = (1l << (bitCount - 1)) - 1;
+    if (value > limit)
+        value = limit;
+    if (value < -limit)
+        value = -limit;
+    return value;
+}
+
+// Convert the MSM7 frame into an MSM4 frame, returns the MSM4 frame length or zero when the
+// frame is not an MSM7 message
+static inline size_t rtcmMsm7ToMsm4(const uint8_t *msm7, size_t length, uint8_t *msm4)
+{
+    uint32_t bitIn;
+    uint32_t bitOut;
+    uint32_t cellBase;
+    int cells;
+    uint32_t crc;
+    const uint8_t *in;
+    uint16_t messageNumber;
+    uint8_t *out;
+    uint32_t payloadBits;
+    size_t payloadLength;
+    int satellites;
+    int signals;
+    uint32_t value;
+
+    if (length < (RTCM_FRAME_HEADER_LENGTH + ((RTCM_MSM_HEADER_BITS + 7) >> 3) + RTCM_FRAME_CRC_LENGTH))
+        return 0;
+    in = &msm7[RTCM_FRAME_HEADER_LENGTH];
+    messageNumber = rtcmGetBits(in, 0, 12);
+    if ((!rtcmIsMsm(messageNumber)) || ((messageNumber % 10) != 7))
+        return 0;
+
+    // Validate the MSM7 length
+    satellites = rtcmBitCount(((uint64_t)rtcmGetBits(in, 73, 32) << 32) | rtcmGetBits(in, 105, 32));
+    signals = rtcmBitCount(rtcmGetBits(in, 137, 32));
+    if ((satellites * signals) > 64)
+        return 0;
+    cellBase = RTCM_MSM_HEADER_BITS;
+    cells = 0;
+    for (int cell = 0; cell < (satellites * signals); cell++)
+        cells += rtcmGetBits(in, cellBase + cell, 1);
+    cellBase += satellites * signals;
+    payloadLength = length - RTCM_FRAME_HEADER_LENGTH - RTCM_FRAME_CRC_LENGTH;
+    if ((payloadLength << 3) < (cellBase + (36 * satellites) + (80 * cells)))
+        return 0;
+
+    // Copy the MSM header and cell mask, then change the message number
+    out = &msm4[RTCM_FRAME_HEADER_LENGTH];
+    payloadBits = cellBase + (18 * satellites) + (48 * cells);
+    payloadLength = (payloadBits + 7) >> 3;
+    for (size_t index = 0; index < payloadLength; index++)
+        out[index] = 0;
+    for (bitIn = 0; bitIn < cellBase; bitIn += 8)
+    {
+        int bits = ((cellBase - bitIn) < 8) ? (cellBase - bitIn) : 8;
+        rtcmSetBits(out, bitIn, bits, rtcmGetBits(in, bitIn, bits));
+    }
+    rtcmSetBits(out, 0, 12, messageNumber - 3);
+
+    // Satellite data: rough range integer milliseconds and rough range modulo 1 millisecond
+    bitIn = cellBase;
+    bitOut = cellBase;
+    for (int sat = 0; sat < satellites; sat++)
+        rtcmSetBits(out, bitOut + (8 * sat), 8, rtcmGetBits(in, bitIn + (8 * sat), 8));
+    bitIn += 12 * satellites;
+    bitOut += 8 * satellites;
+    for (int sat = 0; sat < satellites; sat++)
+        rtcmSetBits(out, bitOut + (10 * sat), 10, rtcmGetBits(in, bitIn + (10 * sat), 10));
+    bitIn += 24 * satellites;
+    bitOut += 10 * satellites;
+
+    // Fine pseudorange: 2^-29 ms to 2^-24 ms
+    for (int cell = 0; cell < cells; cell++)
+    {
+        value = rtcmMsmRescale(rtcmGetSignedBits(in, bitIn + (20 * cell), 20), 5, 15, -(1l << 19));
+        rtcmSetBits(out, bitOut + (15 * cell), 15, value);
+    }
+    bitIn += 20 * cells;
+    bitOut += 15 * cells;
+
+    // Fine phase range: 2^-31 ms to 2^-29 ms
+    for (int cell = 0; cell < cells; cell++)
+    {
+        value = rtcmMsmRescale(rtcmGetSignedBits(in, bitIn + (24 * cell), 24), 2, 22, -(1l << 23));
+        rtcmSetBits(out, bitOut + (22 * cell), 22, value);
+    }
+    bitIn += 24 * cells;
+    bitOut += 22 * cells;
+
+    // Lock time indicator
+    for (int cell = 0; cell < cells; cell++)
+    {
+        value = rtcmMsm4LockTimeIndicator(rtcmMsm7LockTimeMsec(rtcmGetBits(in, bitIn + (10 * cell), 10)));
+        rtcmSetBits(out, bitOut + (4 * cell), 4, value);
+    }
+    bitIn += 10 * cells;
+    bitOut += 4 * cells;
+
+    // Half-cycle ambiguity indicator
+    for (int cell = 0; cell < cells; cell++)
+        rtcmSetBits(out, bitOut + cell, 1, rtcmGetBits(in, bitIn + cell, 1));
+    bitIn += cells;
+    bitOut += cells;
+
+    // CNR: 2^-4 dB-Hz to 1 dB-Hz
+    for (int cell = 0; cell < cells; cell++)
+    {
+        value = (rtcmGetBits(in, bitIn + (10 * cell), 10) + 8) >> 4;
+        if (value > 63)
+            value = 63;
+        rtcmSetBits(out, bitOut + (6 * cell), 6, value);
+    }
+
+    // Build the frame
+    msm4[0] = 0xd3;
+    msm4[1] = (payloadLength >> 8) & 0x03;
+    msm4[2] = payloadLength & 0xff;
+    crc = rtcmCrc24q(msm4, RTCM_FRAME_HEADER_LENGTH + payloadLength);
+    msm4[RTCM_FRAME_HEADER_LENGTH + payloadLength] = crc >> 16;
+    msm4[RTCM_FRAME_HEADER_LENGTH + payloadLength + 1] = crc >> 8;
+    msm4[RTCM_FRAME_HEADER_LENGTH + payloadLength + 2] = crc;
+    return RTCM_FRAME_HEADER_LENGTH + payloadLength + RTCM_FRAME_CRC_LENGTH;
+}
+
+#endif  // __RTCM_MSM_H__
@@ -0,0 +1,110 @@
+/*=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+SbfBlock.h
+
+  Validate the SBF blocks found in the mosaic-X5 COM1 stream.  The stream is
+  mostly raw L-Band data which can manifest as SBF.  gnssReadTask checks the
+  block ID and length once the SBF header is complete (8 bytes) and the
+  EncapsulatedOutput payload length once its header is complete (18 bytes).
+
+  The expected blocks are sorted by ID and found with a binary search.
+  Between the checks, and while waiting for the next SBF sync characters,
+  gnssReadTask passes the data to the parsers in bulk.
+
+  This file is also compiled on Linux by Tools/SBF_Parse_Benchmark.c, keep it
+  free of ESP32 and Arduino dependencies.
+
+=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=*/
+
+#ifndef __SBF_BLOCK_H__
+#define __SBF_BLOCK_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SBF_SYNC_1                      '$'
+#define SBF_HEADER_LENGTH               8   // Sync, CRC, ID and length
+#define SBF_ENCAPSULATED_OUTPUT_ID      4097
+#define SBF_ENCAPSULATED_HEADER_LENGTH  18  // SBF header, time stamp, mode, reserved and N
+#define SBF_ENCAPSULATED_MODE_RTCMV3    2
+#define SBF_ENCAPSULATED_MODE_NMEA      4
+#define SPARTN_PREAMBLE                 0x73 // First byte of the SPARTN messages in the L-Band data
+
+typedef struct
+{
+    const uint16_t ID;
+    const bool fixedLength;
+    const uint16_t length; // Padded to modulo-4
+    const char name[19];
+} mosaicExpectedID;
+
+// Sorted by ID for mosaicExpectedIdLookup
+const mosaicExpectedID mosaicExpectedIDs[] = {
+    {4007, true, 96, "PVTGeodetic"},  {4013, false, 0, "ChannelStatus"}, {4014, false, 0, "ReceiverStatus"},
+    {4059, false, 0, "DiskStatus"},   {4090, false, 0, "InputLink"},     {4097, false, 0, "EncapsulatedOutput"},
+    {5914, true, 24, "ReceiverTime"},
+};
+
+#define MAX_MOSAIC_EXPECTED_SBF (sizeof(mosaicExpectedIDs) / sizeof(mosaicExpectedID))
+
+// Locate the expected block, returns NULL when the block is not expected
+static inline const mosaicExpectedID *mosaicExpectedIdLookup(uint16_t id)
+{
+    size_t high;
+    size_t low;
+    size_t middle;
+
+    low = 0;
+    high = MAX_MOSAIC_EXPECTED_SBF;
+    while (low < high)
+    {
+        middle = (low + high) >> 1;
+        if (mosaicExpectedIDs[middle].ID == id)
+            return &mosaicExpectedIDs[middle];
+        if (mosaicExpectedIDs[middle].ID < id)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return NULL;
+}
+
+// Determine if the block is expected, called once the SBF header is complete
+static inline bool mosaicSbfHeaderValid(uint16_t id, uint16_t blockLength)
+{
+    const mosaicExpectedID *expected;
+
+    expected = mosaicExpectedIdLookup(id);
+    return expected && ((!expected->fixedLength) || (expected->length == blockLength));
+}
+
+// Determine if the EncapsulatedOutput block is valid, called once its header is complete
+static inline bool mosaicSbfEncapsulatedValid(const uint8_t *block, uint16_t blockLength)
+{
+    uint16_t expectedLength;
+    uint16_t n;
+
+    // Check Mode for RTCMv3 and NMEA
+    if ((block[14] != SBF_ENCAPSULATED_MODE_RTCMV3) && (block[14] != SBF_ENCAPSULATED_MODE_NMEA))
+        return false;
+
+    // SBF block length should be 20 more than N (payload length) - with padding
+    n = block[16] | (((uint16_t)block[17]) << 8);
+    expectedLength = (n + 20 + 3) & ~3;
+    return blockLength == expectedLength;
+}
+
+// Determine the number of bytes to pass to the SBF parser before the next check
+// The length is the number of block bytes received, zero when searching for the sync
+static inline size_t mosaicSbfBytesToCheck(size_t length, uint16_t id, uint16_t blockLength)
+{
+    if (length < SBF_HEADER_LENGTH)
+        return SBF_HEADER_LENGTH - length;
+    if ((id == SBF_ENCAPSULATED_OUTPUT_ID) && (length < SBF_ENCAPSULATED_HEADER_LENGTH))
+        return SBF_ENCAPSULATED_HEADER_LENGTH - length;
+    if (length < blockLength)
+        return blockLength - length;
+    return 1;
+}
+
+#endif  // __SBF_BLOCK_H__
@@ -26,11 +26,13 @@ Tasks.ino
                                     | handleGnssDataTask
                                     |
                                     v
-            .---------------+-------+--------+---------------+
-            |               |                |               |
-            |               |                |               |
-            v               v                v               v
-        Bluetooth      TCP Client     TCP/UDP Server      SD Card
+            .---------------+-------+--------+---------------+---------------.
+            |               |                |               |               |
+            |               |                |               |               |
+            v               v                v               v               v
+        Bluetooth      TCP Client     TCP/UDP Server      SD Card           RTCM
+                                                                    (NTRIP Server, LoRa,
+                                                                         ESP-NOW)
 
 =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=*/
 
@@ -57,16 +59,48 @@ enum RingBufferConsumers
     RBC_SD_CARD,
     RBC_UDP_SERVER,
     RBC_USB_SERIAL,
-    // Insert new consumers here
+    RBC_RTCM,
+    RBC_BLE,
+    // Insert new consumers here, rbConsumerArray holds one bit for each consumer
     RBC_MAX
 };
 
-const char *const ringBufferConsumer[] = {
-    "Bluetooth", "TCP Client", "TCP Server", "SD Card", "UDP Server", "USB Serial",
+// rbConsumerArray and gnssDataFilterEnabled are uint8_t masks, widen them before adding a consumer
+static_assert(RBC_MAX <= 8, "Too many ring buffer consumers for the uint8_t consumer masks");
+
+// Send data from the ring buffer to a consumer
+// Returns the amount of data remaining in the ring buffer for this consumer
+typedef int32_t (*RING_BUFFER_SEND_DATA)(RING_BUFFER_OFFSET dataHead);
+
+// Move the consumer's tails that are within the data discarded by processUart1Message
+typedef void (*RING_BUFFER_DISCARD_BYTES)(RING_BUFFER_OFFSET previousTail, RING_BUFFER_OFFSET newTail);
+
+typedef struct _RING_BUFFER_CONSUMER
+{
+    const char *name;                       // Consumer name for display
+    const char *taskName;                   // Name of the consumer task, 15 characters max
+    RING_BUFFER_SEND_DATA sendData;         // Routine to send the ring buffer data to the consumer
+    RING_BUFFER_DISCARD_BYTES discardBytes; // Routine to trim the consumer's tails
+    const char *filter;                     // Setting selecting the messages sent to the consumer
+} RING_BUFFER_CONSUMER;
+
+const RING_BUFFER_CONSUMER ringBufferConsumer[] = {
+    // Name          Task Name         Send Data              Discard Bytes             Filter
+    {"Bluetooth",  "gnssDataBT",     gnssDataSendBluetooth, gnssDataDiscardBluetooth, settings.gnssDataFilterBluetooth}, // SPP
+    {"TCP Client", "gnssDataTcpCli", tcpClientSendData,     tcpClientDiscardBytes,    settings.gnssDataFilterTcpClient},
+    {"TCP Server", "gnssDataTcpSrv", gnssDataSendTcpServer, tcpServerDiscardBytes,    settings.gnssDataFilterTcpServer},
+    {"SD Card",    "gnssDataSD",     gnssDataSendSdCard,    gnssDataDiscardSdCard,    settings.gnssDataFilterSdCard},
+    {"UDP Server", "gnssDataUdpSrv", udpServerSendData,     udpServerDiscardBytes,    settings.gnssDataFilterUdpServer},
+    {"USB Serial", "gnssDataUSB",    gnssDataSendUsbSerial, gnssDataDiscardUsbSerial, settings.gnssDataFilterUsbSerial},
+    {"RTCM",       "gnssDataRTCM",   sendRTCMToConsumers,   rtcmConsumerDiscardBytes, ""}, // Base.ino selects the RTCM
+    {"BLE",        "gnssDataBLE",    gnssDataSendBle,       gnssDataDiscardBle,       settings.gnssDataFilterBle},
 };
 
 const int ringBufferConsumerEntries = sizeof(ringBufferConsumer) / sizeof(ringBufferConsumer[0]);
 
+// Maximum time a consumer task waits for new data before checking its connection
+#define GNSS_DATA_CONSUMER_POLL_MSEC 10
+
 // Define the index values into the parserTable
 #define RTK_NMEA_PARSER_INDEX 0
 #define RTK_UNICORE_HASH_PARSER_INDEX 1
@@ -74,6 +108,28 @@ const int ringBufferConsumerEntries = sizeof(ringBufferConsumer) / sizeof(ringBu
 #define RTK_UBLOX_PARSER_INDEX 3
 #define RTK_UNICORE_BINARY_PARSER_INDEX 4
 
+// Parser names used by the gnssDataFilter settings, indexed by the parserTable index
+const char *const gnssDataFilterParserName[] = {
+    "NMEA",           // 0
+    "UNICORE",        // 1
+    "RTCM",           // 2
+    "UBX",            // 3
+    "UNICORE_BINARY", // 4
+};
+const int gnssDataFilterParserNameEntries = sizeof(gnssDataFilterParserName) / sizeof(gnssDataFilterParserName[0]);
+
+// Maximum number of message IDs in a consumer's filter
+#define GNSS_DATA_FILTER_IDS 16
+
+// Compiled version of a gnssDataFilter setting, see gnssDataFilterCompile
+typedef struct _GNSS_DATA_FILTER
+{
+    uint8_t parserMask;                     // Send all messages from these parsers (1 << parser index)
+    uint8_t idCount;                        // Number of valid entries in parser and id
+    uint8_t parser[GNSS_DATA_FILTER_IDS];   // Parser index for each message ID
+    uint32_t id[GNSS_DATA_FILTER_IDS];      // Message ID, see gnssDataMessageId
+} GNSS_DATA_FILTER;
+
 // List the parsers to be included
 const SEMP_PARSER_DESCRIPTION *parserTable[] = {
     &sempNmeaParserDescription,          // 0
@@ -100,18 +156,106 @@ const int rtcmParserCount = sizeof(rtcmParserTable) / sizeof(rtcmParserTable[0])
 //----------------------------------------
 
 volatile static RING_BUFFER_OFFSET dataHead; // Head advances as data comes in from GNSS's UART
-volatile int32_t availableHandlerSpace;      // settings.gnssHandlerBufferSize - usedSpace
+volatile int32_t availableHandlerSpace;      // ringBufferSize - usedSpace
 volatile const char *slowConsumer;
 
 // Buffer the incoming Bluetooth stream so that it can be passed in bulk over I2C
 uint8_t bluetoothOutgoingToGnss[100];
 uint16_t bluetoothOutgoingToGnssHead;
 unsigned long lastGnssSend; // Timestamp of the last time we sent RTCM to GNSS
+#define BT_GNSS_SEND_FALLBACK_MSEC 100 // Data that does not end in an RTCM message, UBX config, etc.
+
+static uint8_t btReadBuffer[128]; // Blocks read from the Bluetooth device by btReadTask
+
+// BLE output, the data is held briefly to fill the notifications
+#define BLE_NOTIFY_BATCH_MSEC 20
+static uint32_t bleLastWriteMillis;
 
 // Ring buffer tails
-static RING_BUFFER_OFFSET btRingBufferTail;  // BT Tail advances as it is sent over BT
-static RING_BUFFER_OFFSET sdRingBufferTail;  // SD Tail advances as it is recorded to SD
-static RING_BUFFER_OFFSET usbRingBufferTail; // USB Tail advances as it is sent over USB serial
+// Only accessed by the consumer, processUart1Message trims the ringBufferConsumerTail instead
+static volatile RING_BUFFER_OFFSET btRingBufferTail;  // BT Tail advances as it is sent over BT SPP
+static volatile RING_BUFFER_OFFSET bleRingBufferTail; // BLE Tail advances as it is sent over BLE
+static volatile RING_BUFFER_OFFSET sdRingBufferTail;  // SD Tail advances as it is recorded to SD
+static volatile RING_BUFFER_OFFSET usbRingBufferTail; // USB Tail advances as it is sent over USB serial
+
+// Oldest tail and busy flag of each consumer, see RingBuffer.h.  Released by the consumer
+// after sending its data, trimmed by processUart1Message when the ring buffer is full.
+static RING_BUFFER_TAIL ringBufferConsumerTail[RBC_MAX];
+
+// Tail last released by each consumer, used to detect the trimming
+static RING_BUFFER_OFFSET ringBufferConsumerReleased[RBC_MAX];
+
+// Message filtering, consumers with a filter walk the rbOffsetArray entries to
+// skip the messages without their bit set in rbConsumerArray
+// rbOffsetEntries is a power of two, so the entry index of a message count,
+// (count & (rbOffsetEntries - 1)), continues across the uint32_t count wrap
+static GNSS_DATA_FILTER gnssDataFilter[RBC_MAX];
+static volatile uint8_t gnssDataFilterEnabled;      // Consumers with a filter (1 << RBC_xxx)
+static volatile uint32_t rbMessageCount;            // Messages added to the ring buffer, published after dataHead
+static uint32_t ringBufferConsumerMessage[RBC_MAX]; // Messages classified by each filtered consumer
+static RING_BUFFER_OFFSET ringBufferConsumerLimit[RBC_MAX]; // End of the messages to send to the consumer
+
+// Maximum transfer time for each of the consumers
+static uint32_t ringBufferMaxMillis[RBC_MAX];
+
+// Upper limits in milliseconds for the ring buffer write latency histogram,
+// the last bucket holds the writes taking longer than the last limit
+const uint16_t ringBufferLatencyLimitMsec[] = {1, 2, 5, 10, 20, 50, 100, 250, 500, 1000};
+const int ringBufferLatencyLimitMsecEntries = sizeof(ringBufferLatencyLimitMsec) / sizeof(ringBufferLatencyLimitMsec[0]);
+#define RING_BUFFER_LATENCY_BUCKETS (ringBufferLatencyLimitMsecEntries + 1)
+
+// Ring buffer health telemetry for a consumer, only updated by the consumer
+typedef struct _RING_BUFFER_CONSUMER_STATS
+{
+    uint64_t bytesSent;      // Bytes sent to the consumer
+    uint64_t bytesFiltered;  // Bytes skipped by the consumer's gnssDataFilter
+    uint64_t bytesDropped;   // Bytes discarded by processUart1Message before the consumer sent them
+    uint32_t highWater;      // Maximum bytes waiting in the ring buffer for this consumer
+    uint32_t maxMillis;      // Maximum write time
+    uint32_t latency[RING_BUFFER_LATENCY_BUCKETS]; // Write time histogram, see ringBufferLatencyLimitMsec
+} RING_BUFFER_CONSUMER_STATS;
+
+// Ring buffer health telemetry, used to size gnssHandlerBufferSize and uartReceiveBufferSize
+// Read with $SPEXE,STATS or $SPGET,rbStats..., cleared with $SPEXE,STATSRESET
+typedef struct _RING_BUFFER_STATS
+{
+    uint32_t startMillis;         // Time of the last reset
+    uint64_t rxBytes;             // Bytes read from the GNSS UART
+    uint32_t uartReads;           // Reads returning GNSS UART data, rxBytes / uartReads is the burst size
+    uint32_t parserFailures;      // Invalid data reported by the parser (bad CRC or framing)
+    uint64_t parserFailureBytes;  // Number of invalid bytes
+    uint32_t messagesDropped;     // Messages dropped by processUart1Message, a consumer was writing the oldest data
+    RING_BUFFER_CONSUMER_STATS consumer[RBC_MAX];
+} RING_BUFFER_STATS;
+
+static RING_BUFFER_STATS ringBufferStats;
+
+// Automatic ring buffer sizing, see ringBufferAutoSize and ringBufferGrow
+#define RING_BUFFER_AUTO_SIZE_MINIMUM       (1024 * 4)  // Default gnssHandlerBufferSize
+#define RING_BUFFER_AUTO_SIZE_MAXIMUM_RAM   (1024 * 16) // Limit the use of internal RAM
+#define RING_BUFFER_AUTO_SIZE_MAXIMUM_PSRAM 65535       // Limited by RING_BUFFER_OFFSET
+#define RING_BUFFER_AUTO_SIZE_MESSAGE_BYTES 128         // Estimated average message length
+#define RING_BUFFER_AUTO_SIZE_STALL_MSEC    250         // Minimum SD card stall to buffer
+#define RING_BUFFER_AUTO_SIZE_UART_MSEC     50          // Data held by the UART while gnssReadTask is not reading
+#define RING_BUFFER_AUTO_SIZE_UART_MAXIMUM  (1024 * 16) // Maximum uartReceiveBufferSize
+#define RING_BUFFER_PAUSE_TIMEOUT_MSEC      100         // Time for gnssReadTask to pause during a resize
+#define RING_BUFFER_STALL_CHECK_MSEC        (60 * 1000) // Interval between the worst SD card stall checks
+#define RING_BUFFER_RATE_MEASURE_MSEC       (10 * 1000) // Minimum time to measure the GNSS data rate
+
+// Runtime growth of the ring buffer, PSRAM only
+static volatile bool ringBufferGrowRequest;    // Set by processUart1Message when data is discarded
+static volatile bool ringBufferPauseRequest;   // Set by handleGnssDataTask while replacing the ring buffer
+static volatile bool ringBufferProducerPaused; // gnssReadTask is waiting for the ring buffer replacement
+static bool ringBufferGrowFailed;              // Stop growing after an allocation failure
+
+// gnssReadTask, notified by gnssReadUartEvent when the GNSS UART receives data
+#define GNSS_READ_BURST_BYTES       1024 // Maximum bytes passed to the parser at once
+#define GNSS_READ_TASK_WAIT_MSEC    10   // Maximum sleep time between UART reads
+static TaskHandle_t gnssReadTaskHandle;
+
+// Consumer tasks, notified by processUart1Message when dataHead advances
+static TaskHandle_t gnssDataConsumerTaskHandle[RBC_MAX];
+static volatile bool gnssDataConsumerTaskRunning[RBC_MAX];
 
 // Ring buffer offsets
 static uint16_t rbOffsetHead;
@@ -122,8 +266,16 @@ static uint16_t rbOffsetHead;
 
 // If the phone has any new data (NTRIP RTCM, etc), read it in over Bluetooth and pass it along to GNSS
 // Scan for escape characters to enter the config menu
+//
+// Escape characters are only recognized after the Bluetooth traffic stops for
+// btMinEscapeTime.  During the traffic the data is read in blocks and passed
+// along to GNSS without looking at the individual characters.  Once the traffic
+// stops, the data is read one byte at a time so that the data following the
+// escape sequence remains in the Bluetooth device for the command processor.
 void btReadTask(void *e)
 {
+    int bytesRead;
+    int index;
     int rxBytes;
 
     unsigned long btLastByteReceived = 0; // Track when the last BT transmission was received.
@@ -153,6 +305,36 @@ void btReadTask(void *e)
         {
             while (btPrintEcho == false && (bluetoothRxDataAvailable() > 0))
             {
+                // Pass the Bluetooth traffic along in blocks
+                // Allow escape characters received within the first 2 seconds of power on
+                if ((btEscapeCharsReceived == 0) && ((millis() - btLastByteReceived) <= btMinEscapeTime) &&
+                    (millis() >= btMinEscapeTime))
+                {
+                    bytesRead = bluetoothRead(btReadBuffer, sizeof(btReadBuffer));
+                    if (bytesRead <= 0)
+                        break;
+                    rxBytes += bytesRead;
+
+                    // Escape characters within the traffic are data and do not extend the traffic
+                    for (index = 0; index < bytesRead; index++)
+                        if (btReadBuffer[index] != btEscapeCharacter)
+                        {
+                            btLastByteReceived = millis();
+                            break;
+                        }
+
+                    // UART RX can be corrupted by UART TX
+                    // See issue: https://github.com/sparkfun/SparkFun_RTK_Firmware/issues/469
+                    addToGnssBuffer(btReadBuffer, bytesRead);
+
+                    bluetoothIncomingRTCM = true;
+
+                    // Record the arrival of RTCM from the Bluetooth connection (a phone or tablet is providing the RTCM
+                    // via NTRIP). This resets the RTCM timeout used on the L-Band.
+                    rtcmLastPacketReceived = millis();
+                    continue;
+                }
+
                 // Check stream for command characters
                 byte incoming = bluetoothRead();
                 rxBytes += 1;
@@ -178,25 +360,22 @@ void btReadTask(void *e)
                     else
                     {
                         // Ignore this escape character, pass it along to the output
-                        addToGnssBuffer(btEscapeCharacter);
+                        addToGnssBuffer(&btEscapeCharacter, 1);
                     }
                 }
 
                 else // This character is not a command character, pass along to GNSS
                 {
                     // Pass any escape characters that turned out to not be a complete escape sequence
-                    while (btEscapeCharsReceived-- > 0)
+                    while (btEscapeCharsReceived > 0)
                     {
-                        addToGnssBuffer(btEscapeCharacter);
+                        addToGnssBuffer(&btEscapeCharacter, 1);
+                        btEscapeCharsReceived--;
                     }
 
                     // Pass byte to GNSS receiver or to system
                     // TODO - control if this RTCM source should be listened to or not
-
-                    // UART RX can be corrupted by UART TX
-                    // See issue: https://github.com/sparkfun/SparkFun_RTK_Firmware/issues/469
-                    // serialGNSS->write(incoming);
-                    addToGnssBuffer(incoming);
+                    addToGnssBuffer(&incoming, 1);
 
                     btLastByteReceived = millis();
                     btEscapeCharsReceived = 0; // Update timeout check for escape char and partial frame
@@ -218,9 +397,10 @@ void btReadTask(void *e)
             }
         } // End bluetoothGetState() == BT_CONNECTED
 
-        if (bluetoothOutgoingToGnssHead > 0 && ((millis() - lastGnssSend) > 100))
+        // The RTCM messages are sent as they complete, send anything else that is left over
+        if (bluetoothOutgoingToGnssHead > 0 && ((millis() - lastGnssSend) > BT_GNSS_SEND_FALLBACK_MSEC))
         {
-            sendGnssBuffer(); // Send any outstanding RTCM
+            sendGnssBuffer();
         }
 
         if ((settings.enableTaskReports == true) && (!inMainMenu))
@@ -237,41 +417,49 @@ void btReadTask(void *e)
     vTaskDelete(NULL);
 }
 
-// Add byte to buffer that will be sent to GNSS
+// Add data to the buffer that will be sent to GNSS
 // We cannot write single characters to the ZED over I2C (as this will change the address pointer)
-void addToGnssBuffer(uint8_t incoming)
+// The data is run through rtcmParse as it arrives and the buffer is sent as soon as an RTCM message
+// completes, or when the buffer fills
+void addToGnssBuffer(const uint8_t *data, int length)
 {
-    bluetoothOutgoingToGnss[bluetoothOutgoingToGnssHead] = incoming;
+    uint32_t messages;
+
+    if (correctionLastSeen(CORR_BLUETOOTH) == false)
+    {
+        if ((settings.debugCorrections || PERIODIC_DISPLAY(PD_GNSS_DATA_TX)) && !inMainMenu)
+        {
+            PERIODIC_CLEAR(PD_GNSS_DATA_TX);
+            systemPrintf("%d BT bytes NOT sent due to priority\r\n", bluetoothOutgoingToGnssHead + length);
+        }
+
+        // Discard the data
+        bluetoothOutgoingToGnssHead = 0;
+        lastGnssSend = millis();
+        return;
+    }
 
-    bluetoothOutgoingToGnssHead++;
-    if (bluetoothOutgoingToGnssHead == sizeof(bluetoothOutgoingToGnss))
+    while (length-- > 0)
     {
-        sendGnssBuffer();
+        bluetoothOutgoingToGnss[bluetoothOutgoingToGnssHead++] = *data;
+
+        // Parse the data for RTCM1005/1006 and the end of the message
+        messages = rtcmParseMessages;
+        sempParseNextByte(rtcmParse, *data++);
+        if ((rtcmParseMessages != messages) || (bluetoothOutgoingToGnssHead == sizeof(bluetoothOutgoingToGnss)))
+            sendGnssBuffer();
     }
 }
 
 // Push the buffered data in bulk to the GNSS
 void sendGnssBuffer()
 {
-    if (correctionLastSeen(CORR_BLUETOOTH))
-    {
-        sempParseNextBytes(rtcmParse, bluetoothOutgoingToGnss,
-                           bluetoothOutgoingToGnssHead); // Parse the data for RTCM1005/1006
-        if (gnss->pushRawData(bluetoothOutgoingToGnss, bluetoothOutgoingToGnssHead))
-        {
-            if ((settings.debugCorrections || PERIODIC_DISPLAY(PD_GNSS_DATA_TX)) && !inMainMenu)
-            {
-                PERIODIC_CLEAR(PD_GNSS_DATA_TX);
-                systemPrintf("Sent %d BT bytes to GNSS\r\n", bluetoothOutgoingToGnssHead);
-            }
-        }
-    }
-    else
+    if (correctionPushRawData(CORR_BLUETOOTH, bluetoothOutgoingToGnss, bluetoothOutgoingToGnssHead, true))
     {
         if ((settings.debugCorrections || PERIODIC_DISPLAY(PD_GNSS_DATA_TX)) && !inMainMenu)
         {
             PERIODIC_CLEAR(PD_GNSS_DATA_TX);
-            systemPrintf("%d BT bytes NOT sent due to priority\r\n", bluetoothOutgoingToGnssHead);
+            systemPrintf("Sent %d BT bytes to GNSS\r\n", bluetoothOutgoingToGnssHead);
         }
     }
 
@@ -289,12 +477,17 @@ void feedWdt()
 //----------------------------------------------------------------------
 // The ESP32<->GNSS serial connection is default 230,400bps to facilitate
 // 10Hz fix rate with PPP Logging Defaults (NMEAx5 + RXMx2) messages enabled.
-// ESP32's UART used for GNSS  is begun with settings.uartReceiveBufferSize size buffer. The circular buffer
+// ESP32's UART used for GNSS  is begun with gnssUartReceiveBufferSize size buffer. The circular buffer
 // is 1024*6. At approximately 46.1K characters/second, a 6144 * 2
 // byte buffer should hold 267ms worth of serial data. Assuming SD writes are
 // 250ms worst case, we should record incoming all data. Bluetooth congestion
 // or conflicts with the SD card semaphore should clear within this time.
 //
+// When settings.gnssHandlerBufferAutoSize is set, ringBufferAutoSize computes
+// these sizes at boot from the baud rate, the enabled messages and the worst
+// SD card stall of the previous session (settings.gnssHandlerWorstStallMsec).
+// With PSRAM, ringBufferGrow doubles the ring buffer when data is discarded.
+//
 // Ring buffer empty when all the tails == dataHead
 //
 //        +---------+
@@ -320,7 +513,7 @@ void feedWdt()
 //        |         |
 //        +---------+ <-- dataHead
 //
-// Maximum ring buffer fill is settings.gnssHandlerBufferSize - 1
+// Maximum ring buffer fill is ringBufferSize - 1
 //----------------------------------------------------------------------
 
 // Read bytes from GNSS into ESP32 circular buffer
@@ -364,6 +557,14 @@ void gnssReadTask(void *e)
     sempNmeaAbortOnNonPrintable(rtkParse);
     sempUnicoreHashAbortOnNonPrintable(rtkParse);
 
+    // Count the messages failing the CRC and the other invalid data
+    sempSetInvalidDataCallback(rtkParse, gnssReadInvalidData);
+
+    // Wake this task when the UART RX FIFO reaches the full threshold or the
+    // receive line goes idle, instead of polling serialGNSS->available()
+    gnssReadTaskHandle = xTaskGetCurrentTaskHandle();
+    serialGNSS->onReceive(gnssReadUartEvent, false);
+
     bool sbfParserNeeded = present.gnss_mosaicX5;
     bool spartnParserNeeded = present.gnss_mosaicX5 && (productVariant != RTK_FACET_FP);
 
@@ -417,6 +618,19 @@ void gnssReadTask(void *e)
             systemPrintln("gnssReadTask running");
         }
 
+        // Stay out of processUart1Message while handleGnssDataTask replaces the
+        // ring buffer, the UART receive buffer holds the incoming data
+        if (ringBufferPauseRequest)
+        {
+            ringBufferProducerPaused = true;
+            while (ringBufferPauseRequest && (task.gnssReadTaskStopRequest == false))
+            {
+                feedWdt();
+                delay(1);
+            }
+            ringBufferProducerPaused = false;
+        }
+
         if ((settings.enableTaskReports == true) && (!inMainMenu))
             systemPrintf("SerialReadTask High watermark: %d\r\n", uxTaskGetStackHighWaterMark(nullptr));
 
@@ -448,7 +662,8 @@ void gnssReadTask(void *e)
         // happens, it can cause sbfParse to 'stick' - parsing a long ghost SBF block. This prevents RTCM
         // from being parsed from valid SBF blocks and causes the NTRIP server connection to break. We need
         // to add extra checks, above and beyond the invalidDataCallback, to make sure that doesn't happen.
-        // Here we check that the SBF ID and length are expected / valid too.
+        // Here we check that the SBF ID and length are expected / valid too. The checks are made once per
+        // block header and the data between the checks is parsed in bulk, see gnssReadSbfData.
         //
         // For Facet FP mosaic, we need the SBF parser but not the SPARTN parser
 
@@ -457,117 +672,46 @@ void gnssReadTask(void *e)
             // Determine if serial data is available
             while (serialGNSS->available())
             {
-                // Read the data from UART1
-                static uint8_t incomingData[256];
+                // Read a burst of data from UART1
+                static uint8_t incomingData[GNSS_READ_BURST_BYTES];
                 int bytesIncoming = serialGNSS->read(incomingData, sizeof(incomingData));
                 totalRxByteCount += bytesIncoming;
+                if (bytesIncoming > 0)
+                {
+                    ringBufferStats.rxBytes += bytesIncoming;
+                    ringBufferStats.uartReads += 1;
+                }
 
                 if ((bytesIncoming < 0) || (bytesIncoming > sizeof(incomingData)))
                 {
                     if (settings.debugGnss)
                         systemPrintf("gnssReadTask: bytesIncoming = %d\r\n", bytesIncoming);
+                    continue;
                 }
 
-                for (int x = 0; x < bytesIncoming; x++)
-                {
-                    // Update the parser state based on the incoming byte
-                    // On mosaic-X5, pass the byte to sbfParse. On all other platforms, pass it straight to rtkParse
-                    if (!sbfParserNeeded)
-                    {
-                        sempParseNextByte(rtkParse, incomingData[x]);
-                    }
-
-                    // See notes above. On the mosaic-X5, check that the incoming SBF blocks have expected IDs and
-                    // lengths to help prevent raw L-Band data being misidentified as SBF
-                    else // if (sbfParserNeeded)
-                    {
-                        sempParseNextByte(sbfParse, incomingData[x]);
-
-                        // Check if this is Length MSB
-                        // Also check parser is running - as invalidDataCallback may have just been called
-                        if ((sbfParse->state != sempFirstByte) && (sbfParse->type == 0) && (sbfParse->length == 8))
-                        {
-                            bool expected = false;
-                            for (int b = 0; b < MAX_MOSAIC_EXPECTED_SBF; b++) // For each expected SBF block
-                            {
-                                if (mosaicExpectedIDs[b].ID == sempSbfGetId(sbfParse)) // Check for ID match
-                                {
-                                    expected = true;
-                                    if (mosaicExpectedIDs[b].fixedLength)
-                                    {
-                                        // Check for length match if fixed
-                                        if (mosaicExpectedIDs[b].length != sempSbfGetLength(sbfParse))
-                                            expected = false;
-                                    }
-                                }
-                            }
-                            if (!expected) // SBF is not expected so restart the parsers
-                            {
-                                sbfParse->state = sempFirstByte;
-                                if (spartnParserNeeded)
-                                    spartnParse->state = sempFirstByte;
-                                if (settings.debugGnss)
-                                    systemPrintf("Unexpected SBF block %d - rejected on ID or length\r\n",
-                                                 sempSbfGetId(sbfParse));
-                                // We could pass the rejected bytes to the SPARTN parser but this is ~risky
-                                // as the L-Band data could overlap the start of actual SBF. I think it's
-                                // probably safer to discard the data and let both parsers re-sync?
-                                // for (uint32_t dataOffset = 0; dataOffset < 8; dataOffset++)
-                                // {
-                                //     // Update the SPARTN parser state based on the non-SBF byte
-                                //     sempParseNextByte(spartnParse, sbfParse->buffer[dataOffset]);
-                                // }
-                            }
-                        }
+                // On all platforms except the mosaic-X5, pass the burst straight to rtkParse
+                if (!sbfParserNeeded)
+                    sempParseNextBytes(rtkParse, incomingData, bytesIncoming);
 
-                        // Extra checks for EncapsulatedOutput - length is variable but we can compare the length to the
-                        // payload length
-                        if ((sbfParse->type == 0) && (sbfParse->length == 18) && (sempSbfGetId(sbfParse) == 4097))
-                        {
-                            bool expected = true;
-                            if ((sbfParse->buffer[14] != 2) &&
-                                (sbfParse->buffer[14] != 4)) // Check Mode for RTCMv3 and NMEA
-                                expected = false;
-
-                            // SBF block length should be 20 more than N (payload length) - with padding
-                            if (expected)
-                            {
-                                uint16_t N = sbfParse->buffer[16];
-                                N |= ((uint16_t)sbfParse->buffer[17]) << 8;
-                                uint16_t expectedLength = N + 20; // Expected length
-                                uint16_t remainder = ((N + 20) % 4);
-                                if (remainder > 0)
-                                    expectedLength += 4 - remainder; // Include the padding
-                                if (sempSbfGetLength(sbfParse) != expectedLength)
-                                    expected = false;
-                            }
-
-                            if (!expected) // SBF is not expected so restart the parsers
-                            {
-                                sbfParse->state = sempFirstByte;
-                                if (spartnParserNeeded)
-                                    spartnParse->state = sempFirstByte;
-                                if (settings.debugGnss)
-                                    systemPrintf("Unexpected EncapsulatedOutput block - rejected\r\n");
-                                // We could pass the rejected bytes to the SPARTN parser but this is ~risky
-                                // as the L-Band data could overlap the start of actual SBF. I think it's
-                                // probably safer to discard the data and let both parsers re-sync?
-                                // for (uint32_t dataOffset = 0; dataOffset < 18; dataOffset++)
-                                // {
-                                //     // Update the SPARTN parser state based on the non-SBF byte
-                                //     sempParseNextByte(spartnParse, sbfParse->buffer[dataOffset]);
-                                // }
-                            }
-                        }
-                    }
-                }
+                // See notes above. On the mosaic-X5, check that the incoming SBF blocks have expected IDs and
+                // lengths to help prevent raw L-Band data being misidentified as SBF
+                else
+                    gnssReadSbfData(incomingData, bytesIncoming, spartnParserNeeded);
             }
         }
 
         feedWdt();
-        taskYIELD();
+
+        // Sleep until gnssReadUartEvent signals the arrival of more data.  The
+        // timeout polls the UART while a GNSS library is reading it and handles
+        // the stop and pause requests.
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(GNSS_READ_TASK_WAIT_MSEC));
     }
 
+    // Stop the UART notifications
+    serialGNSS->onReceive(nullptr);
+    gnssReadTaskHandle = nullptr;
+
     // Done parsing incoming data, free the parse buffer
     if (rtkBuffer)
         rtkFree(rtkBuffer, "SEMP rtkBuffer");
@@ -876,6 +1020,162 @@ void utcAdjust(double offsetSeconds, char *msg, size_t maxLen)
     sprintf(&msg[len], "%02X", csum); // null-terminate after csum
 }
 
+// Save a copy of the NMEA sentence for the Apple accessory
+// Returns true when the sentence was saved
+bool accessorySaveSentence(SEMP_PARSE_STATE *parse, char *latestSentence)
+{
+    if (parse->length >= latestNmeaMaxLen)
+    {
+        systemPrintf("Increase latestNmeaMaxLen to > %d\r\n", parse->length);
+        return false;
+    }
+
+    memcpy(latestSentence, parse->buffer, parse->length);
+    latestSentence[parse->length] = 0; // NULL terminate
+    if ((strlen(latestSentence) > 10) && (latestSentence[strlen(latestSentence) - 2] == '\r'))
+        latestSentence[strlen(latestSentence) - 2] = 0; // Truncate the \r\n
+    forceTalkerId("P", latestSentence, latestNmeaMaxLen);
+    return true;
+}
+
+// Save the GGA sentence for the Apple accessory
+void accessorySaveGGA(SEMP_PARSE_STATE *parse)
+{
+    if (accessorySaveSentence(parse, latestGPGGA))
+        utcAdjust(settings.accessoryTimeOffset_s, latestGPGGA, latestNmeaMaxLen);
+}
+
+// Save the GST sentence for the Apple accessory
+void accessorySaveGST(SEMP_PARSE_STATE *parse)
+{
+    if (accessorySaveSentence(parse, latestGPGST))
+        utcAdjust(settings.accessoryTimeOffset_s, latestGPGST, latestNmeaMaxLen);
+}
+
+// Save the RMC sentence for the Apple accessory
+void accessorySaveRMC(SEMP_PARSE_STATE *parse)
+{
+    if (accessorySaveSentence(parse, latestGPRMC))
+    {
+        forceRmcCog(latestGPRMC, latestNmeaMaxLen);
+        replaceRmcModeIndicator(latestGPRMC, latestNmeaMaxLen);
+        removeRmcNavStat(latestGPRMC, latestNmeaMaxLen);
+        utcAdjust(settings.accessoryTimeOffset_s, latestGPRMC, latestNmeaMaxLen);
+    }
+}
+
+// Save the VTG sentence for the Apple accessory
+void accessorySaveVTG(SEMP_PARSE_STATE *parse)
+{
+    accessorySaveSentence(parse, latestGPVTG);
+}
+
+// Add the GSA or GSV sentence to the EA session data for the Apple accessory
+void accessorySaveEASession(SEMP_PARSE_STATE *parse)
+{
+    // If the Apple Accessory is sending the data to the EA Session,
+    // discard this GSA / GSV. Bad things would happen if we were to
+    // manipulate latestEASessionData while appleAccessory is using it.
+#ifdef COMPILE_AUTHENTICATION
+    if (appleAccessory->latestEASessionDataIsBlocking() == false)
+    {
+        do // Use a do loop so we can break out if needed
+        {
+            // Check the buffer is large enough. Include room for the CR, LF and NULL
+            if (latestEASessionDataMaxLen < (parse->length + 3))
+            {
+                if (settings.debugNetworkLayer && !inMainMenu)
+                    systemPrintf("Increase latestEASessionDataMaxLen to > %d\r\n", parse->length);
+                break;
+            }
+
+            // Use strnlen to get the length of the stored EA session data
+            size_t latestEASessionDataLen = strnlen(latestEASessionData, latestEASessionDataMaxLen);
+            if (latestEASessionDataLen == latestEASessionDataMaxLen)
+            {
+                if (settings.debugNetworkLayer && !inMainMenu)
+                    systemPrintln(
+                        "latestEASessionData is full and not NULL-terminated. Discarding buffer contents...");
+                *latestEASessionData = 0;
+                latestEASessionDataLen = 0;
+            }
+
+            size_t spaceAvailable = latestEASessionDataMaxLen - latestEASessionDataLen;
+
+            // If the buffer is full, delete the oldest message(s). Include room for the CR, LF and NULL
+            while (spaceAvailable < (parse->length + 3))
+            {
+                const char *lfPtr = strstr(latestEASessionData, "\n"); // Find the first LF
+                if (lfPtr == nullptr)
+                {
+                    // LF not found. Something has gone badly wrong...
+                    if (settings.debugNetworkLayer && !inMainMenu)
+                        systemPrintln("latestEASessionData does not contain LF. Discarding buffer contents...");
+                    *latestEASessionData = 0;
+                    latestEASessionDataLen = 0;
+                    spaceAvailable = latestEASessionDataMaxLen;
+                }
+                else
+                {
+                    lfPtr++;                                         // Point at the byte after the LF
+                    size_t oldLen = lfPtr - latestEASessionData;     // This much data is old
+                    size_t newLen = latestEASessionDataLen - oldLen; // This much is new (not old)
+                    // Move the new data over the old. Include the NULL
+                    memmove(latestEASessionData, &latestEASessionData[oldLen], newLen + 1);
+                    spaceAvailable += oldLen;
+                    latestEASessionDataLen = newLen;
+                    // if (settings.debugNetworkLayer && !inMainMenu)
+                    //     systemPrintf("latestEASessionData is full. Discarding %d bytes...\r\n", oldLen);
+                }
+            }
+
+            memcpy(&latestEASessionData[latestEASessionDataLen], parse->buffer,
+                   parse->length); // Add the new NMEA data
+            latestEASessionDataLen += parse->length;
+            if (latestEASessionData[latestEASessionDataLen - 1] != '\n') // Check for LF
+            {
+                latestEASessionData[latestEASessionDataLen++] = '\r'; // Add CR
+                latestEASessionData[latestEASessionDataLen++] = '\n'; // Add LF
+            }
+            latestEASessionData[latestEASessionDataLen] = 0; // NULL terminate
+            // if (settings.debugNetworkLayer && !inMainMenu)
+            //     systemPrintf("latestEASessionData: added %d bytes...\r\n", parse->length);
+        } while (0);
+    }
+    else if (settings.debugNetworkLayer && !inMainMenu)
+        systemPrintf("Discarding %d GSA/GSV bytes - latestEASessionDataIsBlocking\r\n", parse->length);
+#endif // COMPILE_AUTHENTICATION
+}
+
+// Function to save a NMEA sentence for the Apple accessory
+typedef void (*NMEA_ACCESSORY_SAVE)(SEMP_PARSE_STATE *parse);
+
+// Processing needed by each NMEA sentence, see processUart1Message
+typedef struct _NMEA_SENTENCE_HANDLER
+{
+    const char *formatter;             // Three character sentence formatter
+    NMEA_ACCESSORY_SAVE accessorySave; // Save the sentence for the Apple accessory, nullptr if not needed
+    bool passToPpl;                    // Pass the sentence to the PointPerfect Library
+} NMEA_SENTENCE_HANDLER;
+
+// Indexed by NMEA_SENTENCE_ID
+const NMEA_SENTENCE_HANDLER nmeaSentenceHandler[] = {
+    {"", nullptr, false},                    // NMEA_SENTENCE_UNKNOWN
+    {"GBS", nullptr, false},                 // NMEA_SENTENCE_GBS
+    {"GGA", accessorySaveGGA, true},         // NMEA_SENTENCE_GGA
+    {"GLL", nullptr, false},                 // NMEA_SENTENCE_GLL
+    {"GNS", nullptr, false},                 // NMEA_SENTENCE_GNS
+    {"GSA", accessorySaveEASession, false},  // NMEA_SENTENCE_GSA
+    {"GST", accessorySaveGST, false},        // NMEA_SENTENCE_GST
+    {"GSV", accessorySaveEASession, false},  // NMEA_SENTENCE_GSV
+    {"HDT", nullptr, false},                 // NMEA_SENTENCE_HDT
+    {"RMC", accessorySaveRMC, false},        // NMEA_SENTENCE_RMC
+    {"THS", nullptr, false},                 // NMEA_SENTENCE_THS
+    {"VTG", accessorySaveVTG, false},        // NMEA_SENTENCE_VTG
+    {"ZDA", nullptr, true},                  // NMEA_SENTENCE_ZDA
+};
+const int nmeaSentenceHandlerEntries = sizeof(nmeaSentenceHandler) / sizeof(nmeaSentenceHandler[0]);
+
 // Call back from within parser, for end of message
 // Process a complete message incoming from parser
 // If we get a complete NMEA/UBX/RTCM message, pass on to SD/BT/TCP/UDP interfaces
@@ -885,9 +1185,19 @@ void processUart1Message(SEMP_PARSE_STATE *parse, uint16_t type)
     const char *consumer;
     uint16_t message;
     RING_BUFFER_OFFSET remainingBytes;
+    uint16_t rtcmMessageNumber;
+    NMEA_SENTENCE_ID sentenceId;
     int32_t space;
     int32_t use;
 
+    // Classify the message once, the handlers below dispatch on the sentence ID and RTCM message number
+    sentenceId = NMEA_SENTENCE_UNKNOWN;
+    rtcmMessageNumber = 0;
+    if (type == RTK_NMEA_PARSER_INDEX)
+        sentenceId = nmeaSentenceId(sempNmeaGetSentenceName(parse));
+    else if (type == RTK_RTCM_PARSER_INDEX)
+        rtcmMessageNumber = sempRtcmGetMessageNumber(parse);
+
     // Display the message
     if ((settings.enablePrintLogFileMessages || PERIODIC_DISPLAY(PD_GNSS_DATA_RX)) && (!inMainMenu))
     {
@@ -914,7 +1224,7 @@ void processUart1Message(SEMP_PARSE_STATE *parse, uint16_t type)
 
         case RTK_RTCM_PARSER_INDEX:
             systemPrintf("%s %s %d, 0x%04x (%d) bytes\r\n", parse->parserName, parse->parsers[type]->parserName,
-                         sempRtcmGetMessageNumber(parse), parse->length, parse->length);
+                         rtcmMessageNumber, parse->length, parse->length);
             break;
 
         case RTK_UBLOX_PARSER_INDEX:
@@ -930,145 +1240,9 @@ void processUart1Message(SEMP_PARSE_STATE *parse, uint16_t type)
         }
     }
 
-    // Save GGA / RMC / GST for the Apple device
-    // We should optimse this with a Lee table... TODO
-    if ((online.authenticationCoPro) && (type == RTK_NMEA_PARSER_INDEX))
-    {
-        if (strstr(sempNmeaGetSentenceName(parse), "GGA") != nullptr)
-        {
-            if (parse->length < latestNmeaMaxLen)
-            {
-                memcpy(latestGPGGA, parse->buffer, parse->length);
-                latestGPGGA[parse->length] = 0; // NULL terminate
-                if ((strlen(latestGPGGA) > 10) && (latestGPGGA[strlen(latestGPGGA) - 2] == '\r'))
-                    latestGPGGA[strlen(latestGPGGA) - 2] = 0; // Truncate the \r\n
-                forceTalkerId("P", latestGPGGA, latestNmeaMaxLen);
-                utcAdjust(settings.accessoryTimeOffset_s, latestGPGGA, latestNmeaMaxLen);
-            }
-            else
-                systemPrintf("Increase latestNmeaMaxLen to > %d\r\n", parse->length);
-        }
-        else if (strstr(sempNmeaGetSentenceName(parse), "RMC") != nullptr)
-        {
-            if (parse->length < latestNmeaMaxLen)
-            {
-                memcpy(latestGPRMC, parse->buffer, parse->length);
-                latestGPRMC[parse->length] = 0; // NULL terminate
-                if ((strlen(latestGPRMC) > 10) && (latestGPRMC[strlen(latestGPRMC) - 2] == '\r'))
-                    latestGPRMC[strlen(latestGPRMC) - 2] = 0; // Truncate the \r\n
-                forceTalkerId("P", latestGPRMC, latestNmeaMaxLen);
-                forceRmcCog(latestGPRMC, latestNmeaMaxLen);
-                replaceRmcModeIndicator(latestGPRMC, latestNmeaMaxLen);
-                removeRmcNavStat(latestGPRMC, latestNmeaMaxLen);
-                utcAdjust(settings.accessoryTimeOffset_s, latestGPRMC, latestNmeaMaxLen);
-            }
-            else
-                systemPrintf("Increase latestNmeaMaxLen to > %d\r\n", parse->length);
-        }
-        else if (strstr(sempNmeaGetSentenceName(parse), "GST") != nullptr)
-        {
-            if (parse->length < latestNmeaMaxLen)
-            {
-                memcpy(latestGPGST, parse->buffer, parse->length);
-                latestGPGST[parse->length] = 0; // NULL terminate
-                if ((strlen(latestGPGST) > 10) && (latestGPGST[strlen(latestGPGST) - 2] == '\r'))
-                    latestGPGST[strlen(latestGPGST) - 2] = 0; // Truncate the \r\n
-                forceTalkerId("P", latestGPGST, latestNmeaMaxLen);
-                utcAdjust(settings.accessoryTimeOffset_s, latestGPGST, latestNmeaMaxLen);
-            }
-            else
-                systemPrintf("Increase latestNmeaMaxLen to > %d\r\n", parse->length);
-        }
-        else if (strstr(sempNmeaGetSentenceName(parse), "VTG") != nullptr)
-        {
-            if (parse->length < latestNmeaMaxLen)
-            {
-                memcpy(latestGPVTG, parse->buffer, parse->length);
-                latestGPVTG[parse->length] = 0; // NULL terminate
-                if ((strlen(latestGPVTG) > 10) && (latestGPVTG[strlen(latestGPVTG) - 2] == '\r'))
-                    latestGPVTG[strlen(latestGPVTG) - 2] = 0; // Truncate the \r\n
-                forceTalkerId("P", latestGPVTG, latestNmeaMaxLen);
-            }
-            else
-                systemPrintf("Increase latestNmeaMaxLen to > %d\r\n", parse->length);
-        }
-        else if ((strstr(sempNmeaGetSentenceName(parse), "GSA") != nullptr) ||
-                 (strstr(sempNmeaGetSentenceName(parse), "GSV") != nullptr))
-        {
-            // If the Apple Accessory is sending the data to the EA Session,
-            // discard this GSA / GSV. Bad things would happen if we were to
-            // manipulate latestEASessionData while appleAccessory is using it.
-#ifdef COMPILE_AUTHENTICATION
-            if (appleAccessory->latestEASessionDataIsBlocking() == false)
-            {
-                do // Use a do loop so we can break out if needed
-                {
-                    // Check the buffer is large enough. Include room for the CR, LF and NULL
-                    if (latestEASessionDataMaxLen < (parse->length + 3))
-                    {
-                        if (settings.debugNetworkLayer && !inMainMenu)
-                            systemPrintf("Increase latestEASessionDataMaxLen to > %d\r\n", parse->length);
-                        break;
-                    }
-
-                    // Use strnlen to get the length of the stored EA session data
-                    size_t latestEASessionDataLen = strnlen(latestEASessionData, latestEASessionDataMaxLen);
-                    if (latestEASessionDataLen == latestEASessionDataMaxLen)
-                    {
-                        if (settings.debugNetworkLayer && !inMainMenu)
-                            systemPrintln(
-                                "latestEASessionData is full and not NULL-terminated. Discarding buffer contents...");
-                        *latestEASessionData = 0;
-                        latestEASessionDataLen = 0;
-                    }
-
-                    size_t spaceAvailable = latestEASessionDataMaxLen - latestEASessionDataLen;
-
-                    // If the buffer is full, delete the oldest message(s). Include room for the CR, LF and NULL
-                    while (spaceAvailable < (parse->length + 3))
-                    {
-                        const char *lfPtr = strstr(latestEASessionData, "\n"); // Find the first LF
-                        if (lfPtr == nullptr)
-                        {
-                            // LF not found. Something has gone badly wrong...
-                            if (settings.debugNetworkLayer && !inMainMenu)
-                                systemPrintln("latestEASessionData does not contain LF. Discarding buffer contents...");
-                            *latestEASessionData = 0;
-                            latestEASessionDataLen = 0;
-                            spaceAvailable = latestEASessionDataMaxLen;
-                        }
-                        else
-                        {
-                            lfPtr++;                                         // Point at the byte after the LF
-                            size_t oldLen = lfPtr - latestEASessionData;     // This much data is old
-                            size_t newLen = latestEASessionDataLen - oldLen; // This much is new (not old)
-                            // Move the new data over the old. Include the NULL
-                            memmove(latestEASessionData, &latestEASessionData[oldLen], newLen + 1);
-                            spaceAvailable += oldLen;
-                            latestEASessionDataLen = newLen;
-                            // if (settings.debugNetworkLayer && !inMainMenu)
-                            //     systemPrintf("latestEASessionData is full. Discarding %d bytes...\r\n", oldLen);
-                        }
-                    }
-
-                    memcpy(&latestEASessionData[latestEASessionDataLen], parse->buffer,
-                           parse->length); // Add the new NMEA data
-                    latestEASessionDataLen += parse->length;
-                    if (latestEASessionData[latestEASessionDataLen - 1] != '\n') // Check for LF
-                    {
-                        latestEASessionData[latestEASessionDataLen++] = '\r'; // Add CR
-                        latestEASessionData[latestEASessionDataLen++] = '\n'; // Add LF
-                    }
-                    latestEASessionData[latestEASessionDataLen] = 0; // NULL terminate
-                    // if (settings.debugNetworkLayer && !inMainMenu)
-                    //     systemPrintf("latestEASessionData: added %d bytes...\r\n", parse->length);
-                } while (0);
-            }
-            else if (settings.debugNetworkLayer && !inMainMenu)
-                systemPrintf("Discarding %d GSA/GSV bytes - latestEASessionDataIsBlocking\r\n", parse->length);
-#endif // COMPILE_AUTHENTICATION
-        }
-    }
+    // Save GGA / RMC / GST / VTG / GSA / GSV for the Apple device
+    if ((online.authenticationCoPro) && (nmeaSentenceHandler[sentenceId].accessorySave))
+        nmeaSentenceHandler[sentenceId].accessorySave(parse);
 
     // Determine if this message should be processed by the Unicore library
     // Pass NMEA to um980 before applying compensation
@@ -1092,7 +1266,7 @@ void processUart1Message(SEMP_PARSE_STATE *parse, uint16_t type)
         if (type == RTK_NMEA_PARSER_INDEX)
         {
             // Suppress PQTM/NMEA messages as needed
-            if (lg290pMessageEnabled((char *)parse->buffer, parse->length) == false)
+            if (lg290pMessageEnabled((char *)parse->buffer, parse->length, sentenceId) == false)
             {
                 if (settings.enableNtripClient == true && settings.ntripClient_TransmitGGA == true)
                 {
@@ -1112,7 +1286,7 @@ void processUart1Message(SEMP_PARSE_STATE *parse, uint16_t type)
     // Handle LLA compensation due to tilt or outputTipAltitude setting
     if (type == RTK_NMEA_PARSER_INDEX)
     {
-        nmeaApplyCompensation((char *)parse->buffer, parse->length);
+        nmeaApplyCompensation((char *)parse->buffer, parse->length, sentenceId);
     }
 
     // Handle GST - extract the lat and lon standard deviations - on mosaic-X5 only
@@ -1121,12 +1295,8 @@ void processUart1Message(SEMP_PARSE_STATE *parse, uint16_t type)
         nmeaExtractStdDeviations((char *)parse->buffer, parse->length);
     }
 
-    // Determine where to send RTCM data
-    if (inBaseMode() && type == RTK_RTCM_PARSER_INDEX)
-    {
-        // Pass data along to NTRIP Server, ESP-NOW radio, or LoRa
-        processRTCM(parse->buffer, parse->length);
-    }
+    // Determine where to send RTCM data, processRTCM is called after the message is copied into the ring buffer
+    bool rtcmForConsumers = inBaseMode() && (type == RTK_RTCM_PARSER_INDEX);
 
     // Determine if we are using the PPL - UM980, LG290P, or mosaic-X5
     bool usingPPL = false;
@@ -1146,22 +1316,18 @@ void processUart1Message(SEMP_PARSE_STATE *parse, uint16_t type)
 
         // Only messages GPGGA/ZDA, and RTCM1019/1020/1042/1046 need to be passed to PPL
         if (type == RTK_NMEA_PARSER_INDEX)
-        {
-            if (strstr(sempNmeaGetSentenceName(parse), "GGA") != nullptr)
-                passToPpl = true;
-            else if (strstr(sempNmeaGetSentenceName(parse), "ZDA") != nullptr)
-                passToPpl = true;
-        }
+            passToPpl = nmeaSentenceHandler[sentenceId].passToPpl;
         else if (type == RTK_RTCM_PARSER_INDEX)
         {
-            if (sempRtcmGetMessageNumber(parse) == 1019)
-                passToPpl = true;
-            else if (sempRtcmGetMessageNumber(parse) == 1020)
-                passToPpl = true;
-            else if (sempRtcmGetMessageNumber(parse) == 1042)
-                passToPpl = true;
-            else if (sempRtcmGetMessageNumber(parse) == 1046)
+            switch (rtcmMessageNumber)
+            {
+            case 1019:
+            case 1020:
+            case 1042:
+            case 1046:
                 passToPpl = true;
+                break;
+            }
         }
 
         if (passToPpl == true)
@@ -1175,25 +1341,9 @@ void processUart1Message(SEMP_PARSE_STATE *parse, uint16_t type)
 
                 // Only messages GPGGA/ZDA, and RTCM1019/1020/1042/1046 need to be passed to PPL
                 if (type == RTK_NMEA_PARSER_INDEX)
-                {
-                    systemPrint("GN");
-                    if (strstr(sempNmeaGetSentenceName(parse), "GGA") != nullptr)
-                        systemPrint("GGA");
-                    else if (strstr(sempNmeaGetSentenceName(parse), "ZDA") != nullptr)
-                        systemPrint("ZDA");
-                }
+                    systemPrintf("GN%s", nmeaSentenceHandler[sentenceId].formatter);
                 else if (type == RTK_RTCM_PARSER_INDEX)
-                {
-                    systemPrint("RTCM");
-                    if (sempRtcmGetMessageNumber(parse) == 1019)
-                        systemPrint("1019");
-                    else if (sempRtcmGetMessageNumber(parse) == 1020)
-                        systemPrint("1020");
-                    else if (sempRtcmGetMessageNumber(parse) == 1042)
-                        systemPrint("1042");
-                    else if (sempRtcmGetMessageNumber(parse) == 1046)
-                        systemPrint("1046");
-                }
+                    systemPrintf("RTCM%d", rtcmMessageNumber);
 
                 systemPrintf(": %d bytes\r\n", parse->length);
             }
@@ -1214,7 +1364,7 @@ void processUart1Message(SEMP_PARSE_STATE *parse, uint16_t type)
     }
 
     // Push GGA to Caster if enabled
-    if (type == RTK_NMEA_PARSER_INDEX && strstr(sempNmeaGetSentenceName(parse), "GGA") != nullptr)
+    if (sentenceId == NMEA_SENTENCE_GGA)
     {
         pushGPGGA((char *)parse->buffer);
     }
@@ -1241,188 +1391,188 @@ void processUart1Message(SEMP_PARSE_STATE *parse, uint16_t type)
     if (parse->length == 0)
         return;
 
-    // Use a semaphore to prevent handleGnssDataTask from gatecrashing
-    if (ringBufferSemaphore == NULL)
-        ringBufferSemaphore = xSemaphoreCreateMutex(); // Create the mutex
-
-    // Take the semaphore. Long wait. handleGnssDataTask could block
-    // Enable printing of the ring buffer offsets (s d 10) and the SD buffer sizes (s h 7)
-    // to see this in action. No more gatecrashing!
-    if (xSemaphoreTake(ringBufferSemaphore, ringBuffer_longWait_ms) == pdPASS)
-    {
-        ringBufferSemaphoreHolder = "processUart1Message";
-
-        // Determine if this message will fit into the ring buffer
-        int32_t discardedBytes = 0;
-        bytesToCopy = parse->length;
-        space = availableHandlerSpace; // Take a copy of availableHandlerSpace here
-        use = settings.gnssHandlerBufferSize - space;
-        consumer = (char *)slowConsumer;
-        if (bytesToCopy > space) // Paul removed the && (!inMainMenu)) check 7-25-25
-        {
-            int32_t bufferedData;
-            int32_t bytesToDiscard;
-            int32_t listEnd;
-            int32_t messageLength;
-            int32_t previousTail;
-            int32_t rbOffsetTail;
-
-            // Determine the tail of the ring buffer
-            previousTail = dataHead + space + 1;
-            if (previousTail >= settings.gnssHandlerBufferSize)
-                previousTail -= settings.gnssHandlerBufferSize;
-
-            /*  The rbOffsetArray holds the offsets into the ring buffer of the
-             *  start of each of the parsed messages.  A head (rbOffsetHead) and
-             *  tail (rbOffsetTail) offsets are used for this array to insert and
-             *  remove entries.  Typically this task only manipulates the head as
-             *  new messages are placed into the ring buffer.  The handleGnssDataTask
-             *  normally manipulates the tail as data is removed from the buffer.
-             *  However this task will manipulate the tail under two conditions:
-             *
-             *  1.  The ring buffer gets full and data must be discarded
-             *
-             *  2.  The rbOffsetArray is too small to hold all of the message
-             *      offsets for the data in the ring buffer.  The array is full
-             *      when (Head + 1) == Tail
-             *
-             *  Notes:
-             *      The rbOffsetArray is allocated along with the ring buffer in
-             *      Begin.ino
-             *
-             *      The first entry rbOffsetArray[0] is initialized to zero (0)
-             *      in Begin.ino
-             *
-             *      The array always has one entry in it containing the head offset
-             *      which contains a valid offset into the ringBuffer, handled below
-             *
-             *      The empty condition is Tail == Head
-             *
-             *      The amount of data described by the rbOffsetArray is
-             *      rbOffsetArray[Head] - rbOffsetArray[Tail]
-             *
-             *              rbOffsetArray                  ringBuffer
-             *           .-----------------.           .-----------------.
-             *           |                 |           |                 |
-             *           +-----------------+           |                 |
-             *  Tail --> |   Msg 1 Offset  |---------->+-----------------+ <-- Tail n
-             *           +-----------------+           |      Msg 1      |
-             *           |   Msg 2 Offset  |--------.  |                 |
-             *           +-----------------+        |  |                 |
-             *           |   Msg 3 Offset  |------. '->+-----------------+
-             *           +-----------------+      |    |      Msg 2      |
-             *  Head --> |   Head Offset   |--.   |    |                 |
-             *           +-----------------+  |   |    |                 |
-             *           |                 |  |   |    |                 |
-             *           +-----------------+  |   |    |                 |
-             *           |                 |  |   '--->+-----------------+
-             *           +-----------------+  |        |      Msg 3      |
-             *           |                 |  |        |                 |
-             *           +-----------------+  '------->+-----------------+ <-- dataHead
-             *           |                 |           |                 |
-             */
-
-            // Determine the index for the end of the circular ring buffer
-            // offset list
-            listEnd = rbOffsetHead;
-            WRAP_OFFSET(listEnd, 1, rbOffsetEntries);
-
-            // Update the tail, walk newest message to oldest message
-            rbOffsetTail = rbOffsetHead;
-            bufferedData = 0;
-            messageLength = 0;
-            while ((rbOffsetTail != listEnd) && (bufferedData < use))
-            {
-                // Determine the amount of data in the ring buffer up until
-                // either the tail or the end of the rbOffsetArray
-                //
-                //                      |           |
-                //                      |           | Valid, still in ring buffer
-                //                      |  Newest   |
-                //                      +-----------+ <-- rbOffsetHead
-                //                      |           |
-                //                      |           | free space
-                //                      |           |
-                //     rbOffsetTail --> +-----------+ <-- bufferedData
-                //                      |   ring    |
-                //                      |  buffer   | <-- used
-                //                      |   data    |
-                //                      +-----------+ Valid, still in ring buffer
-                //                      |           |
-                //
-                messageLength = rbOffsetArray[rbOffsetTail];
-                WRAP_OFFSET(rbOffsetTail, rbOffsetEntries - 1, rbOffsetEntries);
-                messageLength -= rbOffsetArray[rbOffsetTail];
-                if (messageLength < 0)
-                    messageLength += settings.gnssHandlerBufferSize;
-                bufferedData += messageLength;
-            }
-
-            // Account for any data in the ring buffer not described by the array
+    // Determine if this message will fit into the ring buffer
+    // The consumers publish their tails without locking, see RingBuffer.h
+    bool dropMessage = false;
+    int32_t discardedBytes = 0;
+    bytesToCopy = parse->length;
+    space = ringBufferUpdateAvailableSpace();
+    use = ringBufferSize - space;
+    consumer = (char *)slowConsumer;
+    if (bytesToCopy > space) // Paul removed the && (!inMainMenu)) check 7-25-25
+    {
+        int32_t bufferedData;
+        int32_t bytesToDiscard;
+        int32_t listEnd;
+        int32_t messageLength;
+        int32_t previousTail;
+        int32_t rbOffsetTail;
+
+        // Ask handleGnssDataTask to grow the ring buffer
+        if (settings.gnssHandlerBufferAutoSize && online.psram && (ringBufferGrowFailed == false))
+            ringBufferGrowRequest = true;
+
+        // Determine the tail of the ring buffer
+        previousTail = dataHead + space + 1;
+        if (previousTail >= ringBufferSize)
+            previousTail -= ringBufferSize;
+
+        /*  The rbOffsetArray holds the offsets into the ring buffer of the
+         *  start of each of the parsed messages.  A head (rbOffsetHead) and
+         *  tail (rbOffsetTail) offsets are used for this array to insert and
+         *  remove entries.  Typically this task only manipulates the head as
+         *  new messages are placed into the ring buffer.  The handleGnssDataTask
+         *  normally manipulates the tail as data is removed from the buffer.
+         *  However this task will manipulate the tail under two conditions:
+         *
+         *  1.  The ring buffer gets full and data must be discarded
+         *
+         *  2.  The rbOffsetArray is too small to hold all of the message
+         *      offsets for the data in the ring buffer.  The array is full
+         *      when (Head + 1) == Tail
+         *
+         *  Notes:
+         *      The rbOffsetArray is allocated along with the ring buffer in
+         *      Begin.ino
+         *
+         *      The first entry rbOffsetArray[0] is initialized to zero (0)
+         *      in Begin.ino
+         *
+         *      The array always has one entry in it containing the head offset
+         *      which contains a valid offset into the ringBuffer, handled below
+         *
+         *      The empty condition is Tail == Head
+         *
+         *      The amount of data described by the rbOffsetArray is
+         *      rbOffsetArray[Head] - rbOffsetArray[Tail]
+         *
+         *              rbOffsetArray                  ringBuffer
+         *           .-----------------.           .-----------------.
+         *           |                 |           |                 |
+         *           +-----------------+           |                 |
+         *  Tail --> |   Msg 1 Offset  |---------->+-----------------+ <-- Tail n
+         *           +-----------------+           |      Msg 1      |
+         *           |   Msg 2 Offset  |--------.  |                 |
+         *           +-----------------+        |  |                 |
+         *           |   Msg 3 Offset  |------. '->+-----------------+
+         *           +-----------------+      |    |      Msg 2      |
+         *  Head --> |   Head Offset   |--.   |    |                 |
+         *           +-----------------+  |   |    |                 |
+         *           |                 |  |   |    |                 |
+         *           +-----------------+  |   |    |                 |
+         *           |                 |  |   '--->+-----------------+
+         *           +-----------------+  |        |      Msg 3      |
+         *           |                 |  |        |                 |
+         *           +-----------------+  '------->+-----------------+ <-- dataHead
+         *           |                 |           |                 |
+         */
+
+        // Determine the index for the end of the circular ring buffer
+        // offset list
+        listEnd = rbOffsetHead;
+        WRAP_OFFSET(listEnd, 1, rbOffsetEntries);
+
+        // Update the tail, walk newest message to oldest message
+        rbOffsetTail = rbOffsetHead;
+        bufferedData = 0;
+        messageLength = 0;
+        while ((rbOffsetTail != listEnd) && (bufferedData < use))
+        {
+            // Determine the amount of data in the ring buffer up until
+            // either the tail or the end of the rbOffsetArray
             //
             //                      |           |
-            //                      +-----------+
-            //                      |  Oldest   |
-            //                      |           |
-            //                      |   ring    |
-            //                      |  buffer   | <-- used
-            //                      |   data    |
-            //                      +-----------+ Valid, still in ring buffer
-            //                      |           |
-            //     rbOffsetTail --> +-----------+ <-- bufferedData
-            //                      |           |
+            //                      |           | Valid, still in ring buffer
             //                      |  Newest   |
             //                      +-----------+ <-- rbOffsetHead
             //                      |           |
-            //
-            if (bufferedData < use)
-                discardedBytes = use - bufferedData;
-
-            // Writing to the SD card, the network or Bluetooth, a partial
-            // message may be written leaving the tail pointer mid-message
-            //
-            //                      |           |
-            //     rbOffsetTail --> +-----------+
-            //                      |  Oldest   |
+            //                      |           | free space
             //                      |           |
+            //     rbOffsetTail --> +-----------+ <-- bufferedData
             //                      |   ring    |
             //                      |  buffer   | <-- used
-            //                      |   data    | Valid, still in ring buffer
-            //                      +-----------+ <--
-            //                      |           |
-            //                      +-----------+
-            //                      |           |
-            //                      |  Newest   |
-            //                      +-----------+ <-- rbOffsetHead
+            //                      |   data    |
+            //                      +-----------+ Valid, still in ring buffer
             //                      |           |
             //
-            else if (bufferedData > use)
-            {
-                // Remove the remaining portion of the oldest entry in the array
-                discardedBytes = messageLength + use - bufferedData;
-                WRAP_OFFSET(rbOffsetTail, 1, rbOffsetEntries);
-            }
+            messageLength = rbOffsetArray[rbOffsetTail];
+            WRAP_OFFSET(rbOffsetTail, rbOffsetEntries - 1, rbOffsetEntries);
+            messageLength -= rbOffsetArray[rbOffsetTail];
+            if (messageLength < 0)
+                messageLength += ringBufferSize;
+            bufferedData += messageLength;
+        }
 
-            // rbOffsetTail now points to the beginning of a message in the
-            // ring buffer
-            // Determine the amount of data to discard
-            bytesToDiscard = discardedBytes;
-            if (bytesToDiscard < bytesToCopy)
-                bytesToDiscard = bytesToCopy;
-            if (bytesToDiscard < AMOUNT_OF_RING_BUFFER_DATA_TO_DISCARD)
-                bytesToDiscard = AMOUNT_OF_RING_BUFFER_DATA_TO_DISCARD;
-
-            // Walk the ring buffer messages from oldest to newest
-            while ((discardedBytes < bytesToDiscard) && (rbOffsetTail != rbOffsetHead))
-            {
-                // Determine the length of the oldest message
-                WRAP_OFFSET(rbOffsetTail, 1, rbOffsetEntries);
-                discardedBytes = rbOffsetArray[rbOffsetTail] - previousTail;
-                if (discardedBytes < 0)
-                    discardedBytes += settings.gnssHandlerBufferSize;
-            }
+        // Account for any data in the ring buffer not described by the array
+        //
+        //                      |           |
+        //                      +-----------+
+        //                      |  Oldest   |
+        //                      |           |
+        //                      |   ring    |
+        //                      |  buffer   | <-- used
+        //                      |   data    |
+        //                      +-----------+ Valid, still in ring buffer
+        //                      |           |
+        //     rbOffsetTail --> +-----------+ <-- bufferedData
+        //                      |           |
+        //                      |  Newest   |
+        //                      +-----------+ <-- rbOffsetHead
+        //                      |           |
+        //
+        if (bufferedData < use)
+            discardedBytes = use - bufferedData;
+
+        // Writing to the SD card, the network or Bluetooth, a partial
+        // message may be written leaving the tail pointer mid-message
+        //
+        //                      |           |
+        //     rbOffsetTail --> +-----------+
+        //                      |  Oldest   |
+        //                      |           |
+        //                      |   ring    |
+        //                      |  buffer   | <-- used
+        //                      |   data    | Valid, still in ring buffer
+        //                      +-----------+ <--
+        //                      |           |
+        //                      +-----------+
+        //                      |           |
+        //                      |  Newest   |
+        //                      +-----------+ <-- rbOffsetHead
+        //                      |           |
+        //
+        else if (bufferedData > use)
+        {
+            // Remove the remaining portion of the oldest entry in the array
+            discardedBytes = messageLength + use - bufferedData;
+            WRAP_OFFSET(rbOffsetTail, 1, rbOffsetEntries);
+        }
+
+        // rbOffsetTail now points to the beginning of a message in the
+        // ring buffer
+        // Determine the amount of data to discard
+        bytesToDiscard = discardedBytes;
+        if (bytesToDiscard < bytesToCopy)
+            bytesToDiscard = bytesToCopy;
+        if (bytesToDiscard < AMOUNT_OF_RING_BUFFER_DATA_TO_DISCARD)
+            bytesToDiscard = AMOUNT_OF_RING_BUFFER_DATA_TO_DISCARD;
+
+        // Walk the ring buffer messages from oldest to newest
+        while ((discardedBytes < bytesToDiscard) && (rbOffsetTail != rbOffsetHead))
+        {
+            // Determine the length of the oldest message
+            WRAP_OFFSET(rbOffsetTail, 1, rbOffsetEntries);
+            discardedBytes = rbOffsetArray[rbOffsetTail] - previousTail;
+            if (discardedBytes < 0)
+                discardedBytes += ringBufferSize;
+        }
 
-            // Discard the oldest data from the ring buffer
+        // Discard the oldest data from the ring buffer.  A consumer may be
+        // writing the oldest data.  That data must not be overwritten, drop
+        // this message instead.
+        const char *writer = updateRingBufferTails(previousTail, rbOffsetArray[rbOffsetTail]);
+        if (writer == nullptr)
+        {
             // Printing the slow consumer is not that useful as any consumer will be
             // considered 'slow' if its data wraps over the end of the buffer and
             // needs a second write to clear...
@@ -1434,645 +1584,1622 @@ void processUart1Message(SEMP_PARSE_STATE *parse, uint16_t type)
                 else
                     systemPrintf("Ring buffer full: discarding %d bytes\r\n", discardedBytes);
             }
+        }
+        else
+        {
+            dropMessage = true;
+            ringBufferStats.messagesDropped += 1;
+            if (!inMainMenu)
+                systemPrintf("Ring buffer full: %s write in progress, discarding %d byte message\r\n", writer,
+                             bytesToCopy);
+        }
+    }
+
+    // Skip the copy when a consumer write is holding the oldest data
+    if (dropMessage)
+        return;
+
+    if (bytesToCopy > (space + discardedBytes - 1)) // Sanity check
+    {
+        systemPrintf("Ring buffer update error %s: bytesToCopy (%d) is > space (%d) + discardedBytes (%d) - 1\r\n",
+                     getTimeStamp(), bytesToCopy, space, discardedBytes);
+        systemFlush(); // Flush Serial - the code is about to go bang...!
+    }
+
+    // Add another message to the ring buffer
+    // Account for this message
+    // Diagnostic prints are provided by settings.enablePrintSDBuffers and the handleGnssDataTask
+    availableHandlerSpace = space + discardedBytes - bytesToCopy;
+
+    // Copy dataHead so we can publish it with a single write
+    RING_BUFFER_OFFSET newDataHead = dataHead;
+    RING_BUFFER_OFFSET messageStart = newDataHead;
+
+    // Fill the buffer to the end and then start at the beginning
+    if ((newDataHead + bytesToCopy) > ringBufferSize)
+        bytesToCopy = ringBufferSize - newDataHead;
+
+    // Display the dataHead offset
+    if (settings.enablePrintRingBufferOffsets && (!inMainMenu))
+        systemPrintf("DH: %4d --> ", newDataHead);
+
+    // Copy the data into the ring buffer
+    memcpy(&ringBuffer[newDataHead], parse->buffer, bytesToCopy);
+    newDataHead = newDataHead + bytesToCopy;
+    if (newDataHead >= ringBufferSize)
+        newDataHead = newDataHead - ringBufferSize;
+
+    // Determine the remaining bytes
+    remainingBytes = parse->length - bytesToCopy;
+    if (remainingBytes)
+    {
+        // Copy the remaining bytes into the beginning of the ring buffer
+        memcpy(ringBuffer, &parse->buffer[bytesToCopy], remainingBytes);
+        newDataHead = newDataHead + remainingBytes;
+        if (newDataHead >= ringBufferSize)
+            newDataHead = newDataHead - ringBufferSize;
+    }
+
+    // Add the head offset to the offset array along with the consumers for this message
+    WRAP_OFFSET(rbOffsetHead, 1, rbOffsetEntries);
+    rbOffsetArray[rbOffsetHead] = newDataHead;
+    rbConsumerArray[rbOffsetHead] = gnssDataFilterMessage(parse, type);
+
+    // Display the dataHead offset
+    if (settings.enablePrintRingBufferOffsets && (!inMainMenu))
+        systemPrintf("%4d @ %s\r\n", newDataHead, getTimeStamp());
+
+    // Pass data along to NTRIP Server, ESP-NOW radio, or LoRa, sent from the ring buffer
+    // Store the reference before publishing dataHead, sendRTCMToConsumers expects
+    // a reference for every RTCM message before the head
+    if (rtcmForConsumers)
+        processRTCM(messageStart, parse->length);
+
+    // Publish dataHead after the data is in the ring buffer
+    // handleGnssDataTask will use it as soon as it updates
+    ringBufferHeadSet(&dataHead, newDataHead);
+    ringBufferCountSet(&rbMessageCount, rbMessageCount + 1);
+
+    // Wake the consumer tasks, gnssDataConsumerTasksStop clears the handles
+    for (int index = 0; index < RBC_MAX; index++)
+    {
+        TaskHandle_t taskHandle = gnssDataConsumerTaskHandle[index];
+        if (taskHandle)
+            xTaskNotifyGive(taskHandle);
+    }
+}
+
+// Remove previous messages from the ring buffer
+// Returns the name of the consumer writing the data or nullptr when the data was discarded
+const char *updateRingBufferTails(RING_BUFFER_OFFSET previousTail, RING_BUFFER_OFFSET newTail)
+{
+    const char *writer;
+
+    // Check all of the consumers before moving any tail, a consumer writing
+    // the oldest data causes the message to be dropped instead
+    writer = ringBufferBusyConsumerInRange(previousTail, newTail);
+    if (writer)
+        return writer;
+
+    // Trim any long or medium tails.  The consumers trim their own tails when
+    // they detect that their ringBufferConsumerTail was moved.  A consumer
+    // may claim its tail after the check above, continue trimming the other
+    // tails so that they all move past the discarded data.
+    for (int index = 0; index < RBC_MAX; index++)
+        if (!ringBufferTailTrim(&ringBufferConsumerTail[index], previousTail, newTail))
+            writer = ringBufferConsumer[index].name;
+    return writer;
+}
+
+// Determine if a consumer is writing the data in the region being discarded
+// Returns the name of the consumer or nullptr if the data may be discarded
+const char *ringBufferBusyConsumerInRange(RING_BUFFER_OFFSET previousTail, RING_BUFFER_OFFSET newTail)
+{
+    for (int index = 0; index < RBC_MAX; index++)
+        if (ringBufferTailBusyInRange(&ringBufferConsumerTail[index], previousTail, newTail))
+            return ringBufferConsumer[index].name;
+    return nullptr;
+}
+
+// Determine the space available in the ring buffer using the oldest consumer tails
+// Called by processUart1Message, also updates availableHandlerSpace and slowConsumer
+int32_t ringBufferUpdateAvailableSpace()
+{
+    int32_t bytesToSend;
+    int32_t freeSpace;
+    RING_BUFFER_OFFSET head;
+    int32_t usedSpace;
+
+    // Locate the consumer with the most data in the ring buffer
+    head = dataHead;
+    usedSpace = 0;
+    for (int index = 0; index < RBC_MAX; index++)
+    {
+        bytesToSend = head - ringBufferTailGet(&ringBufferConsumerTail[index]);
+        if (bytesToSend < 0)
+            bytesToSend += ringBufferSize;
+        if (usedSpace < bytesToSend)
+        {
+            usedSpace = bytesToSend;
+            slowConsumer = ringBufferConsumer[index].name;
+        }
+    }
+
+    // Don't fill the last byte to prevent buffer overflow
+    freeSpace = ringBufferSize - usedSpace;
+    if (freeSpace)
+        freeSpace -= 1;
+    availableHandlerSpace = freeSpace;
+    return freeSpace;
+}
+
+// Remove previous messages from the ring buffer
+void discardRingBufferBytes(volatile RING_BUFFER_OFFSET *tail, RING_BUFFER_OFFSET previousTail,
+                            RING_BUFFER_OFFSET newTail)
+{
+    // The longest tail is being trimmed.  Medium length tails may contain
+    // some data within the region begin trimmed.  The shortest tails will
+    // be trimmed.
+    //
+    // Devices that get their tails trimmed, may output a partial message
+    // prior to the buffer trimming.  After the trimming, the tail of the
+    // ring buffer points to the beginning of a new message.
+    //
+    //                 previousTail                newTail
+    //                      |                         |
+    //  Before trimming     v         Discarded       v   After trimming
+    //  ----+-----------------  ...  -----+--  ..  ---+-----------+------
+    //      | Partial message             |           |           |
+    //  ----+-----------------  ...  -----+--  ..  ---+-----------+------
+    //                      ^          ^                     ^
+    //                      |          |                     |
+    //        long tail ----'          '--- medium tail      '-- short tail
+    //
+    // Only discard the data from long and medium tails
+    if (ringBufferTailInRange(*tail, previousTail, newTail))
+        *tail = newTail;
+}
+
+// Trim the Bluetooth tail
+void gnssDataDiscardBluetooth(RING_BUFFER_OFFSET previousTail, RING_BUFFER_OFFSET newTail)
+{
+    discardRingBufferBytes(&btRingBufferTail, previousTail, newTail);
+}
+
+// Trim the BLE tail
+void gnssDataDiscardBle(RING_BUFFER_OFFSET previousTail, RING_BUFFER_OFFSET newTail)
+{
+    discardRingBufferBytes(&bleRingBufferTail, previousTail, newTail);
+}
+
+// Trim the SD card tail
+void gnssDataDiscardSdCard(RING_BUFFER_OFFSET previousTail, RING_BUFFER_OFFSET newTail)
+{
+    discardRingBufferBytes(&sdRingBufferTail, previousTail, newTail);
+}
+
+// Trim the USB serial tail
+void gnssDataDiscardUsbSerial(RING_BUFFER_OFFSET previousTail, RING_BUFFER_OFFSET newTail)
+{
+    discardRingBufferBytes(&usbRingBufferTail, previousTail, newTail);
+}
+
+// Compute the message ID used by the gnssDataFilter settings
+uint32_t gnssDataMessageId(SEMP_PARSE_STATE *parse, uint16_t type)
+{
+    const char *name;
+
+    switch (type)
+    {
+    case RTK_NMEA_PARSER_INDEX:
+        // Remove the talker ID from the standard sentences: GNGGA --> GGA
+        name = sempNmeaGetSentenceName(parse);
+        if ((name[0] != 'P') && (strlen(name) > 3))
+            name += 2;
+        return gnssDataFilterHash(name);
+
+    case RTK_UNICORE_HASH_PARSER_INDEX:
+        return gnssDataFilterHash(sempUnicoreHashGetSentenceName(parse));
+
+    case RTK_RTCM_PARSER_INDEX:
+        return sempRtcmGetMessageNumber(parse);
+
+    case RTK_UBLOX_PARSER_INDEX:
+        // Class << 8 | ID
+        return sempUbloxGetMessageNumber(parse);
+    }
+    return 0;
+}
+
+// Hash a sentence name, FNV-1a
+uint32_t gnssDataFilterHash(const char *name)
+{
+    uint32_t hash;
+
+    hash = 2166136261;
+    while (*name)
+        hash = (hash ^ (uint8_t)toupper(*name++)) * 16777619;
+    return hash;
+}
+
+// Determine which consumers receive this message
+// Called once per message by processUart1Message, the result is saved in rbConsumerArray
+uint8_t gnssDataFilterMessage(SEMP_PARSE_STATE *parse, uint16_t type)
+{
+    uint8_t consumers;
+    uint8_t enabled;
+    GNSS_DATA_FILTER *filter;
+    uint32_t id;
+
+    // Consumers without a filter receive all of the messages
+    enabled = gnssDataFilterEnabled;
+    consumers = ~enabled;
+    if (enabled == 0)
+        return consumers;
+
+    id = gnssDataMessageId(parse, type);
+    for (int index = 0; index < RBC_MAX; index++)
+    {
+        if ((enabled & (1 << index)) == 0)
+            continue;
+
+        // Check for all messages from this parser
+        filter = &gnssDataFilter[index];
+        if (filter->parserMask & (1 << type))
+        {
+            consumers |= 1 << index;
+            continue;
+        }
+
+        // Check for this message
+        for (int entry = 0; entry < filter->idCount; entry++)
+            if ((filter->parser[entry] == type) && (filter->id[entry] == id))
+            {
+                consumers |= 1 << index;
+                break;
+            }
+    }
+    return consumers;
+}
+
+// Convert a consumer's gnssDataFilter setting into a GNSS_DATA_FILTER
+// The setting is a comma separated list of parser names and parser name with message ID:
+//     NMEA, NMEA_GGA, RTCM, RTCM_1005, UBX, UBX_02_15 (class_ID in hex), UNICORE, UNICORE_BESTNAVB,
+//     UNICORE_BINARY
+// An empty setting sends all of the messages to the consumer
+void gnssDataFilterCompile(int consumer)
+{
+    char *end;
+    GNSS_DATA_FILTER filter;
+    char *id;
+    int parser;
+    char *save;
+    char string[GNSS_DATA_FILTER_LENGTH];
+    char *token;
+    uint32_t value = 0;
+
+    memset(&filter, 0, sizeof(filter));
+    strlcpy(string, ringBufferConsumer[consumer].filter, sizeof(string));
+    for (token = strtok_r(string, ", ", &save); token; token = strtok_r(nullptr, ", ", &save))
+    {
+        // Look for all messages from a parser
+        for (parser = 0; parser < gnssDataFilterParserNameEntries; parser++)
+            if (strcasecmp(token, gnssDataFilterParserName[parser]) == 0)
+                break;
+        if (parser < gnssDataFilterParserNameEntries)
+        {
+            filter.parserMask |= 1 << parser;
+            continue;
+        }
+
+        // Split the parser name from the message ID
+        id = strchr(token, '_');
+        if (id)
+            *id++ = 0;
+        for (parser = 0; id && (parser < gnssDataFilterParserNameEntries); parser++)
+            if (strcasecmp(token, gnssDataFilterParserName[parser]) == 0)
+                break;
+
+        // Convert the message ID
+        end = nullptr;
+        if (id && *id)
+            switch (parser)
+            {
+            case RTK_NMEA_PARSER_INDEX:
+            case RTK_UNICORE_HASH_PARSER_INDEX:
+                value = gnssDataFilterHash(id);
+                end = &id[strlen(id)];
+                break;
+
+            case RTK_RTCM_PARSER_INDEX:
+                value = strtoul(id, &end, 10);
+                break;
+
+            case RTK_UBLOX_PARSER_INDEX:
+                value = strtoul(id, &end, 16) << 8;
+                if (*end == '_')
+                    value |= strtoul(&end[1], &end, 16);
+                else
+                    end = nullptr;
+                break;
+            }
+        if ((end == nullptr) || *end || (filter.idCount >= GNSS_DATA_FILTER_IDS))
+        {
+            systemPrintf("WARNING: %s filter, ignoring %s%s%s\r\n", ringBufferConsumer[consumer].name, token,
+                         id ? "_" : "", id ? id : "");
+            continue;
+        }
+        filter.parser[filter.idCount] = parser;
+        filter.id[filter.idCount++] = value;
+    }
+
+    // Update the filter used by processUart1Message
+    gnssDataFilterEnabled &= ~(1 << consumer);
+    gnssDataFilter[consumer] = filter;
+    if (filter.parserMask || filter.idCount)
+        gnssDataFilterEnabled |= 1 << consumer;
+}
+
+// Compile all of the gnssDataFilter settings
+void gnssDataFilterCompileAll()
+{
+    for (int index = 0; index < RBC_MAX; index++)
+        gnssDataFilterCompile(index);
+}
+
+// Called when a gnssDataFilter setting is changed
+bool gnssDataFilterAfterCommand(const char *settingName, void *settingData, int settingType)
+{
+    gnssDataFilterCompileAll();
+    return true;
+}
+
+// Send the messages selected by the consumer's filter
+// Returns the amount of data remaining in the ring buffer for this consumer and the
+// offset following the last message sent or skipped in head
+int32_t gnssDataFilterSendData(int consumer, RING_BUFFER_OFFSET tail, RING_BUFFER_OFFSET *head)
+{
+    uint8_t bit;
+    int32_t bytesRemaining;
+    uint32_t count;
+    RING_BUFFER_OFFSET dataEnd;
+    RING_BUFFER_OFFSET limit;
+    uint32_t message;
+    RING_BUFFER_OFFSET start;
+
+    bit = 1 << consumer;
+    count = ringBufferCountGet(&rbMessageCount);
+    dataEnd = ringBufferHeadGet(&dataHead);
+    message = ringBufferConsumerMessage[consumer];
+    limit = ringBufferConsumerLimit[consumer];
+
+    // Resynchronize with the rbOffsetArray when processUart1Message discarded
+    // the data or when the offsets of the unclassified messages were reused
+    if (((count - message) >= (uint32_t)(rbOffsetEntries - 1)) ||
+        (ringBufferBytes(tail, limit) > ringBufferBytes(tail, dataEnd)))
+    {
+        // Locate the message starting at the tail, the discard is done at a message boundary
+        limit = dataEnd;
+        for (message = count; (count - message) < (uint32_t)(rbOffsetEntries - 1); message--)
+            if (rbOffsetArray[message & (rbOffsetEntries - 1)] == tail)
+            {
+                limit = tail;
+                break;
+            }
+
+        // Send the unclassified data when the message is not found
+        if (limit != tail)
+            message = count;
+    }
+
+    do
+    {
+        // Extend the limit over the messages selected for this consumer
+        while (message != count)
+        {
+            if ((rbConsumerArray[(message + 1) & (rbOffsetEntries - 1)] & bit) == 0)
+                break;
+            message += 1;
+            limit = rbOffsetArray[message & (rbOffsetEntries - 1)];
+        }
+
+        // Send the selected data
+        bytesRemaining = ringBufferConsumer[consumer].sendData(limit);
+        if (bytesRemaining || (message == count))
+            break;
+
+        // Skip the messages not selected for this consumer
+        start = limit;
+        while (message != count)
+        {
+            if (rbConsumerArray[(message + 1) & (rbOffsetEntries - 1)] & bit)
+                break;
+            message += 1;
+            limit = rbOffsetArray[message & (rbOffsetEntries - 1)];
+        }
+        ringBufferConsumer[consumer].discardBytes(start, limit);
+        ringBufferStats.consumer[consumer].bytesFiltered += ringBufferBytes(start, limit);
+    } while (message != count);
+
+    // Save the filter state
+    ringBufferConsumerMessage[consumer] = message;
+    ringBufferConsumerLimit[consumer] = limit;
+    *head = limit;
+    return bytesRemaining;
+}
+
+// Determine the number of rbOffsetArray entries for the ring buffer size
+// Rounded down to a power of two so that the rbMessageCount wrap does not
+// move the entry index, see gnssDataFilterSendData
+uint16_t ringBufferOffsetEntries(int size)
+{
+    uint32_t entries;
+
+    entries = (size >> 1) / AVERAGE_SENTENCE_LENGTH_IN_BYTES;
+    while (entries & (entries - 1))
+        entries &= entries - 1;
+    return entries;
+}
+
+// Determine the amount of data between the tail and the head
+int32_t ringBufferBytes(RING_BUFFER_OFFSET tail, RING_BUFFER_OFFSET head)
+{
+    int32_t bytes;
+
+    bytes = head - tail;
+    if (bytes < 0)
+        bytes += ringBufferSize;
+    return bytes;
+}
+
+// If new data is in the ringBuffer, dole it out to appropriate interface
+// Send data out Bluetooth, record to SD, or send to network clients
+// Each device (Bluetooth, SD and network client) gets its own tail.  If the
+// device is running too slowly then data for that device is dropped.
+// processUart1Message determines the space in use from the consumer tails.
+// When settings.enableGnssDataConsumerTasks is set, each device is serviced by
+// its own gnssDataConsumerTask.  RTCM is sent to the NTRIP servers, LoRa and
+// ESP-NOW by the RTCM consumer (RBC_RTCM) directly from the ring buffer.
+void handleGnssDataTask(void *e)
+{
+    bool consumerTasks;
+
+    // Start notification
+    task.handleGnssDataTaskRunning = true;
+    if (settings.printTaskStartStop)
+        systemPrintln("Task handleGnssDataTask started");
+
+    // Initialize the tails
+    ringBufferZeroTails();
+
+    // Select the messages for each consumer
+    gnssDataFilterCompileAll();
+
+    // Start the consumer tasks if requested
+    consumerTasks = settings.enableGnssDataConsumerTasks && gnssDataConsumerTasksStart();
+
+    // Run task until a request is raised
+    task.handleGnssDataTaskStopRequest = false;
+    while (task.handleGnssDataTaskStopRequest == false)
+    {
+        // Display an alive message
+        if (PERIODIC_DISPLAY(PD_TASK_HANDLE_GNSS_DATA) && !inMainMenu)
+        {
+            PERIODIC_CLEAR(PD_TASK_HANDLE_GNSS_DATA);
+            systemPrintln("handleGnssDataTask running");
+        }
+
+        //----------------------------------------------------------------------
+        // Display the millisecond values for the different ring buffer consumers
+        //----------------------------------------------------------------------
+
+        ringBufferDisplayMaxMillis(consumerTasks);
+
+        //----------------------------------------------------------------------
+        // Grow the ring buffer after processUart1Message discarded data
+        //----------------------------------------------------------------------
+
+        if (ringBufferGrowRequest)
+            consumerTasks = ringBufferGrow(consumerTasks);
+
+        // The consumer tasks are moving the ring buffer data
+        if (consumerTasks)
+        {
+            feedWdt();
+            vTaskDelay(GNSS_DATA_CONSUMER_POLL_MSEC / portTICK_PERIOD_MS);
+            continue;
+        }
+
+        //----------------------------------------------------------------------
+        // Send data over Bluetooth, USB serial, to the network clients, log
+        // the data to the SD card and send RTCM to its consumers
+        //
+        // processUart1Message keeps adding data to the ring buffer during the
+        // writes, see RingBuffer.h
+        //----------------------------------------------------------------------
+
+        for (int index = 0; index < RBC_MAX; index++)
+            ringBufferSendData(index);
+
+        //----------------------------------------------------------------------
+        // Let other tasks run, prevent watch dog timer (WDT) resets
+        //----------------------------------------------------------------------
+
+        feedWdt();
+        taskYIELD();
+    }
+
+    // Stop the consumer tasks
+    if (consumerTasks)
+        gnssDataConsumerTasksStop();
+
+    // Stop notification
+    if (settings.printTaskStartStop)
+        systemPrintln("Task handleGnssDataTask stopped");
+    task.handleGnssDataTaskRunning = false;
+    vTaskDelete(NULL);
+}
+
+// Initialize the consumer tails, all of the ring buffer data is discarded
+void ringBufferZeroTails()
+{
+    btRingBufferTail = 0;
+    bleRingBufferTail = 0;
+    tcpClientZeroTail();
+    tcpServerZeroTail();
+    udpServerZeroTail();
+    sdRingBufferTail = 0;
+    usbRingBufferTail = 0;
+    rtcmConsumerZeroTail();
+    for (int index = 0; index < RBC_MAX; index++)
+    {
+        ringBufferTailRelease(&ringBufferConsumerTail[index], 0);
+        ringBufferConsumerReleased[index] = 0;
+        ringBufferConsumerMessage[index] = rbMessageCount;
+        ringBufferConsumerLimit[index] = dataHead;
+    }
+}
+
+// Estimate the GNSS data rate from the enabled messages, limited by the UART
+uint32_t ringBufferEstimatedBytesPerSecond()
+{
+    uint32_t baudRate;
+    uint32_t bytesPerSecond;
+    uint32_t messageBytesPerSecond;
+
+    // The UART limits the data rate, 10 bits per byte
+    baudRate = settings.dataPortBaud;
+    forceGnssCommunicationRate(baudRate);
+    bytesPerSecond = baudRate / 10;
+
+    // Estimate the data rate from the enabled messages
+    if (gnss && settings.measurementRateMs)
+    {
+        messageBytesPerSecond = gnss->getActiveMessageCount() * RING_BUFFER_AUTO_SIZE_MESSAGE_BYTES * 1000
+                              / settings.measurementRateMs;
+        if (messageBytesPerSecond && (messageBytesPerSecond < bytesPerSecond))
+            bytesPerSecond = messageBytesPerSecond;
+    }
+    return bytesPerSecond;
+}
+
+// Determine the GNSS data rate, measured once enough data was received
+uint32_t ringBufferBytesPerSecond()
+{
+    uint32_t elapsedMillis;
+
+    elapsedMillis = millis() - ringBufferStats.startMillis;
+    if ((elapsedMillis >= RING_BUFFER_RATE_MEASURE_MSEC) && ringBufferStats.rxBytes)
+        return (uint32_t)((ringBufferStats.rxBytes * MILLISECONDS_IN_A_SECOND) / elapsedMillis);
+    return ringBufferEstimatedBytesPerSecond();
+}
+
+// Size the ring buffer from the GNSS data rate and the worst SD card stall of
+// the previous session.  Called by beginGnssUart before the ring buffer is
+// allocated.  The UART receive buffer is sized to hold the data arriving while
+// gnssReadTask is not reading the UART.
+void ringBufferAutoSize()
+{
+    uint32_t bytesPerSecond;
+    uint32_t maximumSize;
+    uint32_t size;
+    uint32_t stallMsec;
+
+    if (settings.gnssHandlerBufferAutoSize == false)
+        return;
+
+    // Estimate the data rate from the enabled messages
+    bytesPerSecond = ringBufferEstimatedBytesPerSecond();
+
+    // Use the worst SD card stall from the previous session
+    stallMsec = settings.gnssHandlerWorstStallMsec;
+    if (stallMsec < RING_BUFFER_AUTO_SIZE_STALL_MSEC)
+        stallMsec = RING_BUFFER_AUTO_SIZE_STALL_MSEC;
+
+    // Buffer twice the data arriving during the stall since processUart1Message
+    // discards at least a quarter of the ring buffer when it fills
+    size = (uint32_t)(((uint64_t)bytesPerSecond * stallMsec * 2) / 1000);
+    maximumSize = online.psram ? RING_BUFFER_AUTO_SIZE_MAXIMUM_PSRAM : RING_BUFFER_AUTO_SIZE_MAXIMUM_RAM;
+    if (size < RING_BUFFER_AUTO_SIZE_MINIMUM)
+        size = RING_BUFFER_AUTO_SIZE_MINIMUM;
+    if (size > maximumSize)
+        size = maximumSize;
+    ringBufferSize = size;
+
+    // Hold the data arriving while gnssReadTask is paused or not running
+    size = (bytesPerSecond * RING_BUFFER_AUTO_SIZE_UART_MSEC) / 1000;
+    if (size > RING_BUFFER_AUTO_SIZE_UART_MAXIMUM)
+        size = RING_BUFFER_AUTO_SIZE_UART_MAXIMUM;
+    // Only the runtime size changes, settings.uartReceiveBufferSize is saved to NVM
+    if (gnssUartReceiveBufferSize < (int)size)
+        gnssUartReceiveBufferSize = size;
+
+    systemPrintf("Ring buffer auto size: %d bytes (%lu bytes/sec, %lu mSec stall), UART buffer: %d bytes\r\n",
+                 ringBufferSize, bytesPerSecond, stallMsec, gnssUartReceiveBufferSize);
+}
+
+// Double the size of the ring buffer after processUart1Message discarded data, PSRAM only
+// Called by handleGnssDataTask between passes, the data waiting in the ring buffer is discarded
+// Returns true when the consumer tasks are running
+bool ringBufferGrow(bool consumerTasks)
+{
+    uint16_t offsetEntries;
+    RING_BUFFER_OFFSET *offsetArray;
+    RING_BUFFER_OFFSET *previousOffsetArray;
+    RING_BUFFER_OFFSET head;
+    int size;
+
+    ringBufferGrowRequest = false;
+
+    // Determine the new size
+    if (ringBufferSize >= RING_BUFFER_AUTO_SIZE_MAXIMUM_PSRAM)
+        return consumerTasks;
+    size = ringBufferSize * 2;
+    if (size > RING_BUFFER_AUTO_SIZE_MAXIMUM_PSRAM)
+        size = RING_BUFFER_AUTO_SIZE_MAXIMUM_PSRAM;
+
+    // Allocate the new ring buffer, see beginGnssUart
+    offsetEntries = ringBufferOffsetEntries(size);
+    offsetArray = (RING_BUFFER_OFFSET *)rtkMalloc(
+        size + (offsetEntries * (sizeof(RING_BUFFER_OFFSET) + sizeof(uint8_t))), "Ring buffer (rbOffsetArray)");
+    if (!offsetArray)
+    {
+        ringBufferGrowFailed = true;
+        return consumerTasks;
+    }
+
+    // Wait for gnssReadTask to leave processUart1Message
+    if (ringBufferProducerPause(RING_BUFFER_PAUSE_TIMEOUT_MSEC) == false)
+    {
+        // Keep the current ring buffer
+        rtkFree(offsetArray, "Ring buffer (rbOffsetArray)");
+        return consumerTasks;
+    }
+
+    // Stop the consumers while processUart1Message is not waking them
+    if (consumerTasks)
+        gnssDataConsumerTasksStop();
+
+    // Account for the data still waiting for the consumers
+    head = dataHead;
+    for (int index = 0; index < RBC_MAX; index++)
+        ringBufferStats.consumer[index].bytesDropped += ringBufferBytes(ringBufferConsumerReleased[index], head);
+
+    // Switch to the new ring buffer
+    previousOffsetArray = rbOffsetArray;
+    rbOffsetArray = offsetArray;
+    rbOffsetEntries = offsetEntries;
+    rbConsumerArray = (uint8_t *)&rbOffsetArray[rbOffsetEntries];
+    ringBuffer = &rbConsumerArray[rbOffsetEntries];
+    rbOffsetArray[0] = 0;
+    rbOffsetHead = 0;
+    ringBufferSize = size;
+    availableHandlerSpace = size;
+    slowConsumer = nullptr;
+    ringBufferHeadSet(&dataHead, 0);
+    ringBufferCountSet(&rbMessageCount, 0);
+    ringBufferZeroTails();
+    rtkFree(previousOffsetArray, "Ring buffer (rbOffsetArray)");
+
+    // Restart the consumers
+    if (consumerTasks)
+        consumerTasks = gnssDataConsumerTasksStart();
+
+    // Resume processUart1Message
+    ringBufferProducerResume();
+    if (!inMainMenu)
+        systemPrintf("Ring buffer grown to %d bytes\r\n", size);
+    return consumerTasks;
+}
+
+// Wait for gnssReadTask to leave processUart1Message, a timeout of zero waits until it pauses
+// Returns true when gnssReadTask is paused or not running, call ringBufferProducerResume when done
+bool ringBufferProducerPause(uint32_t timeoutMsec)
+{
+    uint32_t startMillis;
+
+    ringBufferPauseRequest = true;
+    startMillis = millis();
+    while (task.gnssReadTaskRunning && (ringBufferProducerPaused == false))
+    {
+        if (timeoutMsec && ((millis() - startMillis) >= timeoutMsec))
+        {
+            ringBufferPauseRequest = false;
+            return false;
+        }
+        delay(1);
+    }
+    return true;
+}
+
+// Allow gnssReadTask to call processUart1Message again
+void ringBufferProducerResume()
+{
+    ringBufferPauseRequest = false;
+}
+
+// Save the worst SD card stall of this session, used by ringBufferAutoSize during the next boot
+// The first measurement replaces the previous session's value, later only significant increases
+// are saved to limit the flash writes
+void ringBufferUpdateWorstStall()
+{
+    static uint32_t lastCheckMillis;
+    static bool sessionSaved;
+    uint32_t stallMsec;
+
+    if (settings.gnssHandlerBufferAutoSize == false)
+        return;
+
+    if ((millis() - lastCheckMillis) < RING_BUFFER_STALL_CHECK_MSEC)
+        return;
+    lastCheckMillis = millis();
+
+    // Wait until data is logged to the SD card
+    if (ringBufferStats.consumer[RBC_SD_CARD].bytesSent == 0)
+        return;
+
+    stallMsec = ringBufferStats.consumer[RBC_SD_CARD].maxMillis;
+    if (stallMsec > 0xffff)
+        stallMsec = 0xffff;
+    if (sessionSaved && (stallMsec <= (settings.gnssHandlerWorstStallMsec + (settings.gnssHandlerWorstStallMsec >> 2))))
+        return;
+    sessionSaved = true;
+    if (stallMsec == settings.gnssHandlerWorstStallMsec)
+        return;
+
+    settings.gnssHandlerWorstStallMsec = stallMsec;
+    recordSystemSettings();
+}
+
+// Send data from the ring buffer to a consumer and remember the maximum transfer time
+// Returns the amount of data remaining in the ring buffer for this consumer
+int32_t ringBufferSendData(int consumer)
+{
+    int32_t bytesRemaining;
+    int32_t bytesWaiting;
+    uint64_t bytesFiltered;
+    uint32_t deltaMillis;
+    RING_BUFFER_OFFSET head;
+    int bucket;
+    unsigned long startMillis;
+    RING_BUFFER_CONSUMER_STATS *stats;
+    int32_t tail;
+    int32_t previousTail;
+
+    stats = &ringBufferStats.consumer[consumer];
+
+    // Prevent processUart1Message from discarding this consumer's data
+    tail = ringBufferTailClaim(&ringBufferConsumerTail[consumer]);
+
+    // Trim the consumer's tails when processUart1Message discarded data
+    if (tail != ringBufferConsumerReleased[consumer])
+    {
+        ringBufferConsumer[consumer].discardBytes(ringBufferConsumerReleased[consumer], tail);
+        stats->bytesDropped += ringBufferBytes(ringBufferConsumerReleased[consumer], tail);
+    }
+
+    // Remember the maximum amount of data waiting for this consumer
+    bytesWaiting = ringBufferBytes(tail, ringBufferHeadGet(&dataHead));
+    if (stats->highWater < (uint32_t)bytesWaiting)
+        stats->highWater = bytesWaiting;
+
+    // Send the data
+    previousTail = tail;
+    bytesFiltered = stats->bytesFiltered;
+    startMillis = millis();
+    if ((gnssDataFilterEnabled & (1 << consumer)) && rbOffsetEntries)
+        bytesRemaining = gnssDataFilterSendData(consumer, tail, &head);
+    else
+    {
+        head = ringBufferHeadGet(&dataHead);
+        bytesRemaining = ringBufferConsumer[consumer].sendData(head);
+    }
+
+    // Remember the maximum transfer time
+    deltaMillis = millis() - startMillis;
+    if (ringBufferMaxMillis[consumer] < deltaMillis)
+        ringBufferMaxMillis[consumer] = deltaMillis;
+
+    // Publish the oldest tail for this consumer, then release the data
+    tail = head - bytesRemaining;
+    if (tail < 0)
+        tail += ringBufferSize;
+    ringBufferConsumerReleased[consumer] = tail;
+    ringBufferTailRelease(&ringBufferConsumerTail[consumer], tail);
+
+    // Account for the data sent and the write time
+    if (bytesWaiting)
+    {
+        stats->bytesSent += ringBufferBytes(previousTail, tail) - (stats->bytesFiltered - bytesFiltered);
+        if (stats->maxMillis < deltaMillis)
+            stats->maxMillis = deltaMillis;
+        for (bucket = 0; bucket < ringBufferLatencyLimitMsecEntries; bucket++)
+            if (deltaMillis < ringBufferLatencyLimitMsec[bucket])
+                break;
+        stats->latency[bucket] += 1;
+    }
+    return bytesRemaining;
+}
+
+// Wake gnssReadTask, called by the HardwareSerial event task when the GNSS UART receives data
+void gnssReadUartEvent()
+{
+    TaskHandle_t taskHandle;
+
+    taskHandle = gnssReadTaskHandle;
+    if (taskHandle)
+        xTaskNotifyGive(taskHandle);
+}
 
-            // Update the tails. This needs semaphore protection
-            updateRingBufferTails(previousTail, rbOffsetArray[rbOffsetTail]);
-        }
+// Count the invalid data reported by the parser
+void gnssReadInvalidData(const uint8_t *buffer, size_t length)
+{
+    ringBufferStats.parserFailures += 1;
+    ringBufferStats.parserFailureBytes += length;
+}
+
+// Clear the ring buffer health telemetry
+void ringBufferStatsReset()
+{
+    memset(&ringBufferStats, 0, sizeof(ringBufferStats));
+    ringBufferStats.startMillis = millis();
+}
 
-        if (bytesToCopy > (space + discardedBytes - 1)) // Sanity check
+// Get a ring buffer health telemetry value by index
+// Returns false when the index is past the end of the values
+bool ringBufferStatsEntry(int index, char *name, size_t nameLength, char *value, size_t valueLength,
+                          bool *isString)
+{
+    static const char *const consumerValue[] = {"Sent", "Filtered", "Dropped", "HighWater", "MaxMsec", "Latency"};
+    const int consumerValues = sizeof(consumerValue) / sizeof(consumerValue[0]);
+    const int globalValues = 10;
+    int consumer;
+    size_t offset;
+    RING_BUFFER_CONSUMER_STATS *stats;
+
+    *isString = false;
+    switch (index)
+    {
+    case 0:
+        snprintf(name, nameLength, "rbStatsSeconds");
+        snprintf(value, valueLength, "%lu", (millis() - ringBufferStats.startMillis) / MILLISECONDS_IN_A_SECOND);
+        return true;
+    case 1:
+        snprintf(name, nameLength, "rbStatsRxBytes");
+        snprintf(value, valueLength, "%llu", ringBufferStats.rxBytes);
+        return true;
+    case 2:
+        snprintf(name, nameLength, "rbStatsParserFailures");
+        snprintf(value, valueLength, "%lu", ringBufferStats.parserFailures);
+        return true;
+    case 3:
+        snprintf(name, nameLength, "rbStatsParserFailureBytes");
+        snprintf(value, valueLength, "%llu", ringBufferStats.parserFailureBytes);
+        return true;
+    case 4:
+        snprintf(name, nameLength, "rbStatsMessagesDropped");
+        snprintf(value, valueLength, "%lu", ringBufferStats.messagesDropped);
+        return true;
+    case 5:
+        snprintf(name, nameLength, "rbStatsBufferSize");
+        snprintf(value, valueLength, "%d", ringBufferSize);
+        return true;
+    case 6:
+        snprintf(name, nameLength, "rbStatsUartBufferSize");
+        snprintf(value, valueLength, "%d", gnssUartReceiveBufferSize);
+        return true;
+    case 7:
+        // Histogram bucket limits separated by slashes
+        snprintf(name, nameLength, "rbStatsLatencyLimitsMsec");
+        offset = 0;
+        value[0] = 0;
+        for (int bucket = 0; bucket < ringBufferLatencyLimitMsecEntries; bucket++)
+            offset += snprintf(&value[offset], (offset < valueLength) ? valueLength - offset : 0, "%s%d",
+                               bucket ? "/" : "", ringBufferLatencyLimitMsec[bucket]);
+        *isString = true;
+        return true;
+    case 8:
+        snprintf(name, nameLength, "rbStatsUartReads");
+        snprintf(value, valueLength, "%lu", ringBufferStats.uartReads);
+        return true;
+    case 9:
+        // CPU idle percentage of each core, measured by the idle tasks
+        snprintf(name, nameLength, "rbStatsCpuIdlePercent");
+        offset = 0;
+        value[0] = 0;
+        for (int cpu = 0; cpu < MAX_CPU_CORES; cpu++)
         {
-            systemPrintf("Ring buffer update error %s: bytesToCopy (%d) is > space (%d) + discardedBytes (%d) - 1\r\n",
-                         getTimeStamp(), bytesToCopy, space, discardedBytes);
-            systemFlush(); // Flush Serial - the code is about to go bang...!
+            if (idleTaskHandle[cpu])
+                offset += snprintf(&value[offset], (offset < valueLength) ? valueLength - offset : 0, "%s%d",
+                                   cpu ? "/" : "", cpuIdlePercent[cpu]);
+            else
+                offset += snprintf(&value[offset], (offset < valueLength) ? valueLength - offset : 0, "%s-",
+                                   cpu ? "/" : "");
         }
+        *isString = true;
+        return true;
+    }
 
-        // Add another message to the ring buffer
-        // Account for this message
-        // Diagnostic prints are provided by settings.enablePrintSDBuffers and the handleGnssDataTask
-        // The semaphore prevents badness here. Previously availableHandlerSpace may have been updated
-        // by handleGnssDataTask
-        availableHandlerSpace = availableHandlerSpace + discardedBytes - bytesToCopy;
-
-        // Copy dataHead so we can update with a single write - redundant with the semaphore
-        RING_BUFFER_OFFSET newDataHead = dataHead;
-
-        // Fill the buffer to the end and then start at the beginning
-        if ((newDataHead + bytesToCopy) > settings.gnssHandlerBufferSize)
-            bytesToCopy = settings.gnssHandlerBufferSize - newDataHead;
-
-        // Display the dataHead offset
-        if (settings.enablePrintRingBufferOffsets && (!inMainMenu))
-            systemPrintf("DH: %4d --> ", newDataHead);
-
-        // Copy the data into the ring buffer
-        memcpy(&ringBuffer[newDataHead], parse->buffer, bytesToCopy);
-        newDataHead = newDataHead + bytesToCopy;
-        if (newDataHead >= settings.gnssHandlerBufferSize)
-            newDataHead = newDataHead - settings.gnssHandlerBufferSize;
-
-        // Determine the remaining bytes
-        remainingBytes = parse->length - bytesToCopy;
-        if (remainingBytes)
-        {
-            // Copy the remaining bytes into the beginning of the ring buffer
-            memcpy(ringBuffer, &parse->buffer[bytesToCopy], remainingBytes);
-            newDataHead = newDataHead + remainingBytes;
-            if (newDataHead >= settings.gnssHandlerBufferSize)
-                newDataHead = newDataHead - settings.gnssHandlerBufferSize;
-        }
+    // Values for each of the consumers
+    index -= globalValues;
+    consumer = index / consumerValues;
+    if ((index < 0) || (consumer >= RBC_MAX))
+        return false;
+    index -= consumer * consumerValues;
+
+    // Build the name from the consumer name without the spaces
+    offset = snprintf(name, nameLength, "rbStats");
+    for (const char *text = ringBufferConsumer[consumer].name; *text && (offset < (nameLength - 1)); text++)
+        if (*text != ' ')
+            name[offset++] = *text;
+    name[offset] = 0;
+    strlcat(name, consumerValue[index], nameLength);
+
+    stats = &ringBufferStats.consumer[consumer];
+    switch (index)
+    {
+    case 0:
+        snprintf(value, valueLength, "%llu", stats->bytesSent);
+        break;
+    case 1:
+        snprintf(value, valueLength, "%llu", stats->bytesFiltered);
+        break;
+    case 2:
+        snprintf(value, valueLength, "%llu", stats->bytesDropped);
+        break;
+    case 3:
+        snprintf(value, valueLength, "%lu", stats->highWater);
+        break;
+    case 4:
+        snprintf(value, valueLength, "%lu", stats->maxMillis);
+        break;
+    case 5:
+        // Histogram counts separated by slashes
+        offset = 0;
+        value[0] = 0;
+        for (int bucket = 0; bucket < RING_BUFFER_LATENCY_BUCKETS; bucket++)
+            offset += snprintf(&value[offset], (offset < valueLength) ? valueLength - offset : 0, "%s%lu",
+                               bucket ? "/" : "", stats->latency[bucket]);
+        *isString = true;
+        break;
+    }
+    return true;
+}
 
-        // Add the head offset to the offset array
-        WRAP_OFFSET(rbOffsetHead, 1, rbOffsetEntries);
-        rbOffsetArray[rbOffsetHead] = newDataHead;
+// Get a ring buffer health telemetry value by name, Ex: rbStatsBluetoothSent
+// Returns true when the name was found
+bool ringBufferStatsGet(const char *settingName, char *settingValueStr, size_t valueLength, bool *isString)
+{
+    char name[48];
+
+    for (int index = 0; ringBufferStatsEntry(index, name, sizeof(name), settingValueStr, valueLength, isString);
+         index++)
+        if (strcmp(settingName, name) == 0)
+            return true;
+    return false;
+}
 
-        // Display the dataHead offset
-        if (settings.enablePrintRingBufferOffsets && (!inMainMenu))
-            systemPrintf("%4d @ %s\r\n", newDataHead, getTimeStamp());
+// Send the ring buffer health telemetry to the command interface, one list response per value
+void ringBufferStatsList()
+{
+    bool isString;
+    char name[48];
+    char value[100];
 
-        // Update dataHead in a single write - redundant with the semaphore
-        // handleGnssDataTask will use it as soon as it updates
-        dataHead = newDataHead;
+    for (int index = 0; ringBufferStatsEntry(index, name, sizeof(name), value, sizeof(value), &isString); index++)
+        commandSendExecuteListResponse(name, isString ? "char[]" : "int", value);
+}
 
-        // handleGnssDataTask will be chomping at the bit. Let it fly!
-        xSemaphoreGive(ringBufferSemaphore);
+// Send the ring buffer health telemetry to the web config page as name,value pairs
+void ringBufferStatsSendToWebServer()
+{
+    char *buffer;
+    const size_t bufferLength = 4096;
+    bool isString;
+    char name[48];
+    size_t offset;
+    char value[100];
+
+    buffer = (char *)rtkMalloc(bufferLength, "Ring buffer stats");
+    if (buffer == nullptr)
+    {
+        systemPrintln("ERROR: Failed to allocate the ring buffer stats buffer!");
+        return;
     }
-    else
+
+    offset = 0;
+    buffer[0] = 0;
+    for (int index = 0; ringBufferStatsEntry(index, name, sizeof(name), value, sizeof(value), &isString); index++)
     {
-        if (settings.debugGnss && (!inMainMenu))
-            systemPrintf("processUart1Message could not get ringBuffer semaphore - held by %s\r\n",
-                         ringBufferSemaphoreHolder);
+        offset += snprintf(&buffer[offset], bufferLength - offset, "%s,%s,", name, value);
+        if (offset >= bufferLength)
+        {
+            systemPrintln("ERROR: Ring buffer stats buffer too small!");
+            break;
+        }
     }
+    if (offset < bufferLength)
+        webServerSendString(buffer);
+    rtkFree(buffer, "Ring buffer stats");
 }
 
-// Remove previous messages from the ring buffer
-void updateRingBufferTails(RING_BUFFER_OFFSET previousTail, RING_BUFFER_OFFSET newTail)
+// Display the maximum transfer time for the different ring buffer consumers
+void ringBufferDisplayMaxMillis(bool consumerTasks)
 {
-    // Trim any long or medium tails
-    discardRingBufferBytes(&btRingBufferTail, previousTail, newTail);
-    tcpClientDiscardBytes(previousTail, newTail);
-    tcpServerDiscardBytes(previousTail, newTail);
-    udpServerDiscardBytes(previousTail, newTail);
-    discardRingBufferBytes(&sdRingBufferTail, previousTail, newTail);
-    discardRingBufferBytes(&usbRingBufferTail, previousTail, newTail);
+    int milliseconds;
+    int seconds;
+
+    if (PERIODIC_DISPLAY(PD_RING_BUFFER_MILLIS) && !inMainMenu)
+    {
+        PERIODIC_CLEAR(PD_RING_BUFFER_MILLIS);
+        for (int index = 0; index < RBC_MAX; index++)
+        {
+            milliseconds = ringBufferMaxMillis[index];
+            if (milliseconds > 1)
+            {
+                seconds = milliseconds / MILLISECONDS_IN_A_SECOND;
+                milliseconds %= MILLISECONDS_IN_A_SECOND;
+                if (consumerTasks)
+                    systemPrintf("%s (%s): %d:%03d Sec\r\n", ringBufferConsumer[index].name,
+                                 ringBufferConsumer[index].taskName, seconds, milliseconds);
+                else
+                    systemPrintf("%s: %d:%03d Sec\r\n", ringBufferConsumer[index].name, seconds, milliseconds);
+            }
+        }
+    }
 }
 
-// Remove previous messages from the ring buffer
-void discardRingBufferBytes(RING_BUFFER_OFFSET *tail, RING_BUFFER_OFFSET previousTail, RING_BUFFER_OFFSET newTail)
+// Send data over Bluetooth SPP
+int32_t gnssDataSendBluetooth(RING_BUFFER_OFFSET head)
 {
-    // The longest tail is being trimmed.  Medium length tails may contain
-    // some data within the region begin trimmed.  The shortest tails will
-    // be trimmed.
-    //
-    // Devices that get their tails trimmed, may output a partial message
-    // prior to the buffer trimming.  After the trimming, the tail of the
-    // ring buffer points to the beginning of a new message.
-    //
-    //                 previousTail                newTail
-    //                      |                         |
-    //  Before trimming     v         Discarded       v   After trimming
-    //  ----+-----------------  ...  -----+--  ..  ---+-----------+------
-    //      | Partial message             |           |           |
-    //  ----+-----------------  ...  -----+--  ..  ---+-----------+------
-    //                      ^          ^                     ^
-    //                      |          |                     |
-    //        long tail ----'          '--- medium tail      '-- short tail
-    //
-    // Determine if the trimmed data wraps the end of the buffer
-    if (previousTail < newTail)
+    int32_t bytesToSend;
+
+    // Determine SPP connection state
+    // Note: BLE is a separate consumer (RBC_BLE), BLE writes continue when
+    // the Accessory needs exclusive access to SPP
+    if ((bluetoothGetState() != BT_CONNECTED) || (bluetoothSppIsConnected() == false))
     {
-        // No buffer wrap occurred
-        // Only discard the data from long and medium tails
-        if ((*tail >= previousTail) && (*tail < newTail))
-            *tail = newTail;
+        // Discard the data
+        btRingBufferTail = head;
+        return 0;
     }
-    else
+
+    // Determine the amount of Bluetooth data in the buffer
+    bytesToSend = head - btRingBufferTail;
+    if (bytesToSend < 0)
+        bytesToSend += ringBufferSize;
+    if (bytesToSend > 0)
     {
-        // Buffer wrap occurred
-        if ((*tail >= previousTail) || (*tail < newTail))
-            *tail = newTail;
+        // Reduce bytes to send if we have more to send then the end of
+        // the buffer, we'll wrap next loop
+        if ((btRingBufferTail + bytesToSend) > ringBufferSize)
+            bytesToSend = ringBufferSize - btRingBufferTail;
+
+        // If we are in the config menu, suppress data flowing from GNSS to cell phone
+        if (btPrintEcho == false)
+        {
+            // Push new data over Bluetooth
+            bytesToSend = bluetoothWriteSpp(&ringBuffer[btRingBufferTail], bytesToSend);
+        }
+
+        // Account for the data that was sent
+        if (bytesToSend > 0)
+        {
+            // If we are in base mode, assume part of the outgoing data is RTCM
+            if (inBaseMode() == true)
+                bluetoothOutgoingRTCM = true;
+
+            // Account for the sent or dropped data
+            RING_BUFFER_OFFSET tail = btRingBufferTail + bytesToSend;
+            if (tail >= ringBufferSize)
+                tail -= ringBufferSize;
+            btRingBufferTail = tail;
+
+            // Display the data movement
+            if (PERIODIC_DISPLAY(PD_BLUETOOTH_DATA_TX) && !inMainMenu)
+            {
+                PERIODIC_CLEAR(PD_BLUETOOTH_DATA_TX);
+                systemPrintf("Bluetooth: %d bytes written\r\n", bytesToSend);
+            }
+        }
+        else
+            log_w("BT failed to send");
+
+        // Determine the amount of data that remains in the buffer
+        bytesToSend = head - btRingBufferTail;
+        if (bytesToSend < 0)
+            bytesToSend += ringBufferSize;
     }
+    return bytesToSend;
 }
 
-// If new data is in the ringBuffer, dole it out to appropriate interface
-// Send data out Bluetooth, record to SD, or send to network clients
-// Each device (Bluetooth, SD and network client) gets its own tail.  If the
-// device is running too slowly then data for that device is dropped.
-// The usedSpace variable tracks the total space in use in the buffer.
-void handleGnssDataTask(void *e)
+// Send data over BLE
+// Partial notifications are held for up to BLE_NOTIFY_BATCH_MSEC waiting for more data
+int32_t gnssDataSendBle(RING_BUFFER_OFFSET head)
 {
     int32_t bytesToSend;
-    uint32_t deltaMillis;
-    int32_t freeSpace;
-    static uint32_t maxMillis[RBC_MAX];
-    unsigned long startMillis;
-    int32_t usedSpace;
+    int32_t bytesWaiting;
+    int32_t notifyBytes;
 
-    // Start notification
-    task.handleGnssDataTaskRunning = true;
-    if (settings.printTaskStartStop)
-        systemPrintln("Task handleGnssDataTask started");
+    // Determine BLE connection state
+    if ((bluetoothGetState() != BT_CONNECTED) || (bluetoothBleIsConnected() == false))
+    {
+        // Discard the data
+        bleRingBufferTail = head;
+        return 0;
+    }
 
-    // Initialize the tails
-    btRingBufferTail = 0;
-    tcpClientZeroTail();
-    tcpServerZeroTail();
-    udpServerZeroTail();
-    sdRingBufferTail = 0;
-    usbRingBufferTail = 0;
+    // Determine the amount of BLE data in the buffer
+    bytesWaiting = ringBufferBytes(bleRingBufferTail, head);
+    if (bytesWaiting == 0)
+        return 0;
 
-    // Run task until a request is raised
-    task.handleGnssDataTaskStopRequest = false;
-    while (task.handleGnssDataTaskStopRequest == false)
+    // Wait for a full notification
+    notifyBytes = bluetoothBleNotifyBytes();
+    if ((bytesWaiting < notifyBytes) && ((millis() - bleLastWriteMillis) < BLE_NOTIFY_BATCH_MSEC))
+        return bytesWaiting;
+
+    // Reduce bytes to send if we have more to send then the end of
+    // the buffer, we'll wrap next loop
+    bytesToSend = bytesWaiting;
+    if ((bleRingBufferTail + bytesToSend) > ringBufferSize)
+        bytesToSend = ringBufferSize - bleRingBufferTail;
+
+    // Send full notifications, the remainder waits for more data
+    if (bytesToSend > notifyBytes)
+        bytesToSend -= bytesToSend % notifyBytes;
+
+    // If we are in the config menu, suppress data flowing from GNSS to cell phone
+    if (btPrintEcho == false)
     {
-        // Display an alive message
-        if (PERIODIC_DISPLAY(PD_TASK_HANDLE_GNSS_DATA) && !inMainMenu)
+        // Push new data over BLE
+        bytesToSend = bluetoothWriteBle(&ringBuffer[bleRingBufferTail], bytesToSend);
+        bleLastWriteMillis = millis();
+    }
+
+    // Account for the sent or dropped data
+    if (bytesToSend > 0)
+    {
+        // If we are in base mode, assume part of the outgoing data is RTCM
+        if (inBaseMode() == true)
+            bluetoothOutgoingRTCM = true;
+
+        RING_BUFFER_OFFSET tail = bleRingBufferTail + bytesToSend;
+        if (tail >= ringBufferSize)
+            tail -= ringBufferSize;
+        bleRingBufferTail = tail;
+
+        // Display the data movement
+        if (PERIODIC_DISPLAY(PD_BLUETOOTH_DATA_TX) && !inMainMenu)
         {
-            PERIODIC_CLEAR(PD_TASK_HANDLE_GNSS_DATA);
-            systemPrintln("handleGnssDataTask running");
+            PERIODIC_CLEAR(PD_BLUETOOTH_DATA_TX);
+            systemPrintf("BLE: %d bytes written\r\n", bytesToSend);
         }
+    }
+    else
+        log_w("BLE failed to send");
 
-        //----------------------------------------------------------------------
-        // Send RTCM to consumers
-        //
-        // RTCM has its own storage in rtcmConsumerBuffer (Base.ino)
-        // It does not use the main ringBuffer
-        // But we do the writing here so all traffic generated in the same place
-        //----------------------------------------------------------------------
+    // Determine the amount of data that remains in the buffer
+    return ringBufferBytes(bleRingBufferTail, head);
+}
+
+// Send data over USB serial
+int32_t gnssDataSendUsbSerial(RING_BUFFER_OFFSET head)
+{
+    int32_t bytesToSend;
 
-        startMillis = millis();
+    // Determine USB serial connection state
+    if (forwardGnssDataToUsbSerial == false)
+    {
+        // Discard the data
+        usbRingBufferTail = head;
+        return 0;
+    }
+
+    // Determine the amount of USB serial data in the buffer
+    bytesToSend = head - usbRingBufferTail;
+    if (bytesToSend < 0)
+        bytesToSend += ringBufferSize;
+    if (bytesToSend > 0)
+    {
+        // Reduce bytes to send if we have more to send then the end of
+        // the buffer, we'll wrap next loop
+        if ((usbRingBufferTail + bytesToSend) > ringBufferSize)
+            bytesToSend = ringBufferSize - usbRingBufferTail;
 
-        sendRTCMToConsumers();
+        // Send data over USB serial to the PC
+        bytesToSend = systemWriteGnssDataToUsbSerial(&ringBuffer[usbRingBufferTail], bytesToSend);
 
-        if ((millis() - startMillis) > RTCM_CORRECTION_WRITE_TIMEOUT)
+        // Account for the data that was sent
+        if (bytesToSend > 0)
         {
-            uint32_t milliseconds = millis() - startMillis;
-            uint32_t seconds = milliseconds / MILLISECONDS_IN_A_SECOND;
-            milliseconds -= seconds * MILLISECONDS_IN_A_SECOND;
-            systemPrintf("\aWARNING: RTCM writes took %d.%03d seconds!\r\n", seconds, milliseconds);
+            // Account for the sent or dropped data
+            RING_BUFFER_OFFSET tail = usbRingBufferTail + bytesToSend;
+            if (tail >= ringBufferSize)
+                tail -= ringBufferSize;
+            usbRingBufferTail = tail;
         }
 
-        usedSpace = 0;
+        // Determine the amount of data that remains in the buffer
+        bytesToSend = head - usbRingBufferTail;
+        if (bytesToSend < 0)
+            bytesToSend += ringBufferSize;
+    }
+    return bytesToSend;
+}
+
+// Send data to the TCP server clients
+int32_t gnssDataSendTcpServer(RING_BUFFER_OFFSET head)
+{
+    // If a remote client is in config mode, suppress GNSS data flowing to the client
+    if (tcpServerInRemoteConfig())
+        return 0;
+    return tcpServerSendData(head);
+}
+
+// Record data to the SD card
+int32_t gnssDataSendSdCard(RING_BUFFER_OFFSET head)
+{
+    int32_t bytesToSend;
 
-        // Use a semaphore to prevent handleGnssDataTask from gatecrashing
-        if (ringBufferSemaphore == NULL)
-            ringBufferSemaphore = xSemaphoreCreateMutex(); // Create the mutex
+    bytesToSend = sdRingBufferBytes(head);
 
-        // Take the semaphore. Short wait. processUart1Message shouldn't block for long
-        if (xSemaphoreTake(ringBufferSemaphore, ringBuffer_shortWait_ms) == pdPASS)
-        {
-            ringBufferSemaphoreHolder = "handleGnssDataTask";
+    // Copy the data into the log buffers for sdLogTask, called without data
+    // to hand the partial buffer to sdLogTask
+    if (sdLogTaskIsRunning())
+        return sdLogCopyRingBufferData(bytesToSend);
 
-            //----------------------------------------------------------------------
-            // Send data over Bluetooth
-            //----------------------------------------------------------------------
+    if (bytesToSend > 0)
+    {
+        sdWriteRingBufferData(bytesToSend);
 
-            startMillis = millis();
+        // Determine the amount of data that remains in the buffer
+        bytesToSend = head - sdRingBufferTail;
+        if (bytesToSend < 0)
+            bytesToSend += ringBufferSize;
+    }
+    return bytesToSend;
+}
 
-            // Determine BT connection state
-            // Note: we don't check sppAccessoryMode here. BLE writes can continue when
-            // the Accessory needs exclusive access to SPP. The SPP writes are skipped
-            // inside bluetoothWrite
-            bool connected = (bluetoothGetState() == BT_CONNECTED);
+// Determine the amount of SD card logging data in the ring buffer
+int32_t sdRingBufferBytes(RING_BUFFER_OFFSET head)
+{
+    int32_t bytesToSend;
+    bool connected;
 
-            if (!connected)
-                // Discard the data
-                btRingBufferTail = dataHead;
-            else
-            {
-                // Determine the amount of Bluetooth data in the buffer
-                bytesToSend = dataHead - btRingBufferTail;
-                if (bytesToSend < 0)
-                    bytesToSend += settings.gnssHandlerBufferSize;
-                if (bytesToSend > 0)
-                {
-                    // Reduce bytes to send if we have more to send then the end of
-                    // the buffer, we'll wrap next loop
-                    if ((btRingBufferTail + bytesToSend) > settings.gnssHandlerBufferSize)
-                        bytesToSend = settings.gnssHandlerBufferSize - btRingBufferTail;
+    // Determine if the SD card is enabled for logging
+    connected = online.logging && (!logTimeExceeded());
 
-                    // If we are in the config menu, suppress data flowing from GNSS to cell phone
-                    if (btPrintEcho == false)
-                    {
-                        // Push new data over Bluetooth
-                        bytesToSend = bluetoothWrite(&ringBuffer[btRingBufferTail], bytesToSend);
-                    }
+    // Block logging during Web Config to avoid SD collisions
+    // See issue: https://github.com/sparkfun/SparkFun_RTK_Everywhere_Firmware/issues/693
+    if (webServerIsRunning() == true)
+        connected = false;
 
-                    // Account for the data that was sent
-                    if (bytesToSend > 0)
-                    {
-                        // If we are in base mode, assume part of the outgoing data is RTCM
-                        if (inBaseMode() == true)
-                            bluetoothOutgoingRTCM = true;
-
-                        // Account for the sent or dropped data
-                        btRingBufferTail += bytesToSend;
-                        if (btRingBufferTail >= settings.gnssHandlerBufferSize)
-                            btRingBufferTail -= settings.gnssHandlerBufferSize;
-
-                        // Remember the maximum transfer time
-                        deltaMillis = millis() - startMillis;
-                        if (maxMillis[RBC_BLUETOOTH] < deltaMillis)
-                            maxMillis[RBC_BLUETOOTH] = deltaMillis;
-
-                        // Display the data movement
-                        if (PERIODIC_DISPLAY(PD_BLUETOOTH_DATA_TX) && !inMainMenu)
-                        {
-                            PERIODIC_CLEAR(PD_BLUETOOTH_DATA_TX);
-                            systemPrintf("Bluetooth: %d bytes written\r\n", bytesToSend);
-                        }
-                    }
-                    else
-                        log_w("BT failed to send");
+    // If user wants to log, record to SD
+    if (!connected)
+    {
+        // Discard the data
+        sdRingBufferTail = head;
+        return 0;
+    }
 
-                    // Determine the amount of data that remains in the buffer
-                    bytesToSend = dataHead - btRingBufferTail;
-                    if (bytesToSend < 0)
-                        bytesToSend += settings.gnssHandlerBufferSize;
-                    if (usedSpace < bytesToSend)
-                    {
-                        usedSpace = bytesToSend;
-                        slowConsumer = "Bluetooth";
-                    }
-                }
-            }
+    // Determine the amount of microSD card logging data in the buffer
+    bytesToSend = head - sdRingBufferTail;
+    if (bytesToSend < 0)
+        bytesToSend += ringBufferSize;
+    return bytesToSend;
+}
 
-            //----------------------------------------------------------------------
-            // Send data over USB serial
-            //----------------------------------------------------------------------
+// Write the ring buffer data to the log file
+// processUart1Message keeps adding data to the ring buffer during the write and does
+// not discard the data at sdRingBufferTail, see ringBufferSendData.
+void sdWriteRingBufferData(int32_t bytesToSend)
+{
+    uint32_t deltaMillis;
+    RING_BUFFER_OFFSET sdTail;
+    unsigned long startMillis;
 
-            startMillis = millis();
+    sdTail = sdRingBufferTail;
 
-            // Determine USB serial connection state
-            if (forwardGnssDataToUsbSerial == false)
-                // Discard the data
-                usbRingBufferTail = dataHead;
-            else
-            {
-                // Determine the amount of USB serial data in the buffer
-                bytesToSend = dataHead - usbRingBufferTail;
-                if (bytesToSend < 0)
-                    bytesToSend += settings.gnssHandlerBufferSize;
-                if (bytesToSend > 0)
-                {
-                    // Reduce bytes to send if we have more to send then the end of
-                    // the buffer, we'll wrap next loop
-                    if ((usbRingBufferTail + bytesToSend) > settings.gnssHandlerBufferSize)
-                        bytesToSend = settings.gnssHandlerBufferSize - usbRingBufferTail;
+    // Attempt to gain access to the SD card, avoids collisions with file
+    // writing from other functions like recordSystemSettingsToFile()
+    if (xSemaphoreTake(sdCardSemaphore, loggingSemaphoreWait_ms) == pdPASS)
+    {
+        markSemaphore(FUNCTION_WRITESD);
 
-                    // Send data over USB serial to the PC
-                    bytesToSend = systemWriteGnssDataToUsbSerial(&ringBuffer[usbRingBufferTail], bytesToSend);
+        // pinDebugOn();
 
-                    // Account for the data that was sent
-                    if (bytesToSend > 0)
-                    {
-                        // Account for the sent or dropped data
-                        usbRingBufferTail += bytesToSend;
-                        if (usbRingBufferTail >= settings.gnssHandlerBufferSize)
-                            usbRingBufferTail -= settings.gnssHandlerBufferSize;
-
-                        // Remember the maximum transfer time
-                        deltaMillis = millis() - startMillis;
-                        if (maxMillis[RBC_USB_SERIAL] < deltaMillis)
-                            maxMillis[RBC_USB_SERIAL] = deltaMillis;
-                    }
+        do // Do the SD write in a do loop so we can break out if needed
+        {
+            if (settings.enablePrintSDBuffers && (!inMainMenu))
+            {
+                int bufferAvailable = serialGNSS->available();
 
-                    // Determine the amount of data that remains in the buffer
-                    bytesToSend = dataHead - usbRingBufferTail;
-                    if (bytesToSend < 0)
-                        bytesToSend += settings.gnssHandlerBufferSize;
-                    if (usedSpace < bytesToSend)
-                    {
-                        usedSpace = bytesToSend;
-                        slowConsumer = "USB Serial";
-                    }
-                }
+                int availableUARTSpace = gnssUartReceiveBufferSize - bufferAvailable;
+
+                systemPrintf(
+                    "SD Incoming Serial @ %s: %04d\tToRead: %04d\tMovedToBuffer: "
+                    "%04d\tavailableUARTSpace: "
+                    "%04d\tavailableHandlerSpace: %04d\tToRecord: %04d\tRecorded: %04d\tBO: %d\r\n",
+                    getTimeStamp(), bufferAvailable, 0, 0, availableUARTSpace, availableHandlerSpace,
+                    bytesToSend, 0, bufferOverruns);
             }
 
-            //----------------------------------------------------------------------
-            // Send data to the network clients
-            //----------------------------------------------------------------------
+            // For the SD card, we need to write everything we've got
+            // to prevent the ARP Write and Events from gatecrashing...
+
+            int32_t sendTheseBytes = bytesToSend;
+
+            // Reduce bytes to record if we have more then the end of the buffer
+            if ((sdTail + sendTheseBytes) > ringBufferSize)
+                sendTheseBytes = ringBufferSize - sdTail;
 
             startMillis = millis();
 
-            // Update space available for use in UART task
-            bytesToSend = tcpClientSendData(dataHead);
-            if (usedSpace < bytesToSend)
+            // Write the data to the file
+            int32_t bytesSent = logWriterWrite(&ringBuffer[sdTail], sendTheseBytes);
+
+            // Account for the sent data or dropped
+            sdTail += bytesSent;
+            if (sdTail >= ringBufferSize)
+                sdTail -= ringBufferSize;
+
+            if (bytesSent != sendTheseBytes)
             {
-                usedSpace = bytesToSend;
-                slowConsumer = "TCP client";
+                systemPrintf("SD write mismatch (1) @ %s: wrote %d bytes of %d\r\n", getTimeStamp(),
+                             bytesSent, sendTheseBytes);
+                break; // Exit the do loop
             }
 
-            // Remember the maximum transfer time
-            deltaMillis = millis() - startMillis;
-            if (maxMillis[RBC_TCP_CLIENT] < deltaMillis)
-                maxMillis[RBC_TCP_CLIENT] = deltaMillis;
+            // If we have more data to write - and the first write was successful
+            if (bytesToSend > sendTheseBytes)
+            {
+                sendTheseBytes = bytesToSend - sendTheseBytes;
 
-            startMillis = millis();
+                bytesSent = logWriterWrite(&ringBuffer[sdTail], sendTheseBytes);
 
-            // If a remote client is in config mode, suppress GNSS data flowing to the client
-            if (tcpServerInRemoteConfig() == false)
-            {
-                // Update space available for use in UART task
-                bytesToSend = tcpServerSendData(dataHead);
-                if (usedSpace < bytesToSend)
+                // Account for the sent data or dropped
+                sdTail += bytesSent;
+                if (sdTail >= ringBufferSize) // Should be redundant
+                    sdTail -= ringBufferSize;
+
+                if (bytesSent != sendTheseBytes)
                 {
-                    usedSpace = bytesToSend;
-                    slowConsumer = "TCP server";
+                    systemPrintf("SD write mismatch (2) @ %s: wrote %d bytes of %d\r\n", getTimeStamp(),
+                                 bytesSent, sendTheseBytes);
+                    break; // Exit the do loop
                 }
             }
 
+            // Record the events and sync the log file
+            sdLogUpdate(bytesToSend);
+
             // Remember the maximum transfer time
             deltaMillis = millis() - startMillis;
-            if (maxMillis[RBC_TCP_SERVER] < deltaMillis)
-                maxMillis[RBC_TCP_SERVER] = deltaMillis;
-
-            startMillis = millis();
+            if (ringBufferMaxMillis[RBC_SD_CARD] < deltaMillis)
+                ringBufferMaxMillis[RBC_SD_CARD] = deltaMillis;
 
-            // Update space available for use in UART task
-            bytesToSend = udpServerSendData(dataHead);
-            if (usedSpace < bytesToSend)
+            if (settings.enablePrintBufferOverrun)
             {
-                usedSpace = bytesToSend;
-                slowConsumer = "UDP server";
+                if (deltaMillis > 150)
+                    systemPrintf("Long Write! Time: %ld ms / Location: %ld / Recorded %d bytes / "
+                                 "spaceRemaining %d bytes\r\n",
+                                 deltaMillis, logFileSize, bytesToSend, combinedSpaceRemaining);
             }
+        } while (0);
 
-            // Remember the maximum transfer time
-            deltaMillis = millis() - startMillis;
-            if (maxMillis[RBC_UDP_SERVER] < deltaMillis)
-                maxMillis[RBC_UDP_SERVER] = deltaMillis;
+        xSemaphoreGive(sdCardSemaphore);
+    } // End sdCardSemaphore
+    else
+    {
+        char semaphoreHolder[50];
+        getSemaphoreFunction(semaphoreHolder);
+        log_w("sdCardSemaphore failed to yield for SD write, held by %s, Tasks.ino line %d",
+              semaphoreHolder, __LINE__);
+
+        feedWdt();
+        taskYIELD();
+    }
 
-            //----------------------------------------------------------------------
-            // Log data to the SD card
-            //----------------------------------------------------------------------
+    // Publish the new tail with a single write
+    sdRingBufferTail = sdTail;
+}
 
-            // Determine if the SD card is enabled for logging
-            connected = online.logging && (!logTimeExceeded());
+// Account for the data written to the log file, record the pending events and
+// sync the log file.  Called with the sdCardSemaphore.
+void sdLogUpdate(int32_t bytesWritten)
+{
+    if (PERIODIC_DISPLAY(PD_SD_LOG_WRITE) && (bytesWritten > 0) && (!inMainMenu))
+    {
+        PERIODIC_CLEAR(PD_SD_LOG_WRITE);
+        systemPrintf("SD %d bytes written to log file\r\n", bytesWritten);
+    }
 
-            // Block logging during Web Config to avoid SD collisions
-            // See issue: https://github.com/sparkfun/SparkFun_RTK_Everywhere_Firmware/issues/693
-            if (webServerIsRunning() == true)
-                connected = false;
+    sdFreeSpace -= bytesWritten; // Update remaining space on SD
 
-            // If user wants to log, record to SD
-            if (!connected)
-                // Discard the data
-                sdRingBufferTail = dataHead;
-            else
-            {
-                // Determine the amount of microSD card logging data in the buffer
-                bytesToSend = dataHead - sdRingBufferTail;
-                if (bytesToSend < 0)
-                    bytesToSend += settings.gnssHandlerBufferSize;
-                if (bytesToSend > 0)
-                {
-                    // Attempt to gain access to the SD card, avoids collisions with file
-                    // writing from other functions like recordSystemSettingsToFile()
-                    if (xSemaphoreTake(sdCardSemaphore, loggingSemaphoreWait_ms) == pdPASS)
-                    {
-                        markSemaphore(FUNCTION_WRITESD);
+    // Record any pending trigger events
+    if (newEventToRecord == true)
+    {
+        newEventToRecord = false;
 
-                        // pinDebugOn();
+        if ((settings.enablePrintLogFileStatus) && (!inMainMenu))
+            systemPrintln("Log file: recording event");
 
-                        do // Do the SD write in a do loop so we can break out if needed
-                        {
-                            if (settings.enablePrintSDBuffers && (!inMainMenu))
-                            {
-                                int bufferAvailable = serialGNSS->available();
-
-                                int availableUARTSpace = settings.uartReceiveBufferSize - bufferAvailable;
-
-                                systemPrintf(
-                                    "SD Incoming Serial @ %s: %04d\tToRead: %04d\tMovedToBuffer: "
-                                    "%04d\tavailableUARTSpace: "
-                                    "%04d\tavailableHandlerSpace: %04d\tToRecord: %04d\tRecorded: %04d\tBO: %d\r\n",
-                                    getTimeStamp(), bufferAvailable, 0, 0, availableUARTSpace, availableHandlerSpace,
-                                    bytesToSend, 0, bufferOverruns);
-                            }
-
-                            // For the SD card, we need to write everything we've got
-                            // to prevent the ARP Write and Events from gatecrashing...
-
-                            int32_t sendTheseBytes = bytesToSend;
-
-                            // Reduce bytes to record if we have more then the end of the buffer
-                            if ((sdRingBufferTail + sendTheseBytes) > settings.gnssHandlerBufferSize)
-                                sendTheseBytes = settings.gnssHandlerBufferSize - sdRingBufferTail;
-
-                            startMillis = millis();
-
-                            // Write the data to the file
-                            int32_t bytesSent = logFile->write(&ringBuffer[sdRingBufferTail], sendTheseBytes);
-
-                            // Account for the sent data or dropped
-                            sdRingBufferTail += bytesSent;
-                            if (sdRingBufferTail >= settings.gnssHandlerBufferSize)
-                                sdRingBufferTail -= settings.gnssHandlerBufferSize;
-
-                            if (bytesSent != sendTheseBytes)
-                            {
-                                systemPrintf("SD write mismatch (1) @ %s: wrote %d bytes of %d\r\n", getTimeStamp(),
-                                             bytesSent, sendTheseBytes);
-                                break; // Exit the do loop
-                            }
-
-                            // If we have more data to write - and the first write was successful
-                            if (bytesToSend > sendTheseBytes)
-                            {
-                                sendTheseBytes = bytesToSend - sendTheseBytes;
-
-                                bytesSent = logFile->write(&ringBuffer[sdRingBufferTail], sendTheseBytes);
-
-                                // Account for the sent data or dropped
-                                sdRingBufferTail += bytesSent;
-                                if (sdRingBufferTail >= settings.gnssHandlerBufferSize) // Should be redundant
-                                    sdRingBufferTail -= settings.gnssHandlerBufferSize;
-
-                                if (bytesSent != sendTheseBytes)
-                                {
-                                    systemPrintf("SD write mismatch (2) @ %s: wrote %d bytes of %d\r\n", getTimeStamp(),
-                                                 bytesSent, sendTheseBytes);
-                                    break; // Exit the do loop
-                                }
-                            }
-
-                            if (PERIODIC_DISPLAY(PD_SD_LOG_WRITE) && (bytesSent > 0) && (!inMainMenu))
-                            {
-                                PERIODIC_CLEAR(PD_SD_LOG_WRITE);
-                                systemPrintf("SD %d bytes written to log file\r\n", bytesToSend);
-                            }
-
-                            sdFreeSpace -= bytesToSend; // Update remaining space on SD
-
-                            // Record any pending trigger events
-                            if (newEventToRecord == true)
-                            {
-                                newEventToRecord = false;
-
-                                if ((settings.enablePrintLogFileStatus) && (!inMainMenu))
-                                    systemPrintln("Log file: recording event");
-
-                                // Record trigger count with Time Of Week of rising edge (ms), Millisecond fraction of
-                                // Time Of Week of rising edge (ns), and accuracy estimate (ns)
-                                char eventData[82]; // Max NMEA sentence length is 82
-                                snprintf(eventData, sizeof(eventData), "%lu,%lu,%lu,%lu", triggerCount, triggerTowMsR,
-                                         triggerTowSubMsR, triggerAccEst);
-
-                                char nmeaMessage[82]; // Max NMEA sentence length is 82
-                                createNMEASentence(CUSTOM_NMEA_TYPE_EVENT, nmeaMessage, sizeof(nmeaMessage),
-                                                   eventData); // textID, buffer, sizeOfBuffer, text
-
-                                logFile->write(nmeaMessage, strlen(nmeaMessage));
-                                const char *crlf = "\r\n";
-                                logFile->write(crlf, 2);
-
-                                sdFreeSpace -= strlen(nmeaMessage) + 2; // Update remaining space on SD
-                            }
-
-                            // Record the Antenna Reference Position - if available
-                            if (newARPAvailable == true && settings.enableARPLogging &&
-                                ((millis() - lastARPLog) > (settings.ARPLoggingInterval_s * 1000)))
-                            {
-                                lastARPLog = millis();
-                                newARPAvailable = false; // Clear flag. It doesn't matter if the ARP cannot be logged
-
-                                double x = ARPECEFX;
-                                x /= 10000.0; // Convert to m
-                                double y = ARPECEFY;
-                                y /= 10000.0; // Convert to m
-                                double z = ARPECEFZ;
-                                z /= 10000.0; // Convert to m
-                                double h = ARPECEFH;
-                                h /= 10000.0;     // Convert to m
-                                char ARPData[82]; // Max NMEA sentence length is 82
-                                snprintf(ARPData, sizeof(ARPData), "%.4f,%.4f,%.4f,%.4f", x, y, z, h);
-
-                                if ((settings.enablePrintLogFileStatus) && (!inMainMenu))
-                                    systemPrintf("Log file: recording Antenna Reference Position %s\r\n", ARPData);
-
-                                char nmeaMessage[82]; // Max NMEA sentence length is 82
-                                createNMEASentence(CUSTOM_NMEA_TYPE_ARP_ECEF_XYZH, nmeaMessage, sizeof(nmeaMessage),
-                                                   ARPData); // textID, buffer, sizeOfBuffer, text
-
-                                logFile->write(nmeaMessage, strlen(nmeaMessage));
-                                const char *crlf = "\r\n";
-                                logFile->write(crlf, 2);
-
-                                sdFreeSpace -= strlen(nmeaMessage) + 2; // Update remaining space on SD
-                            }
-
-                            logFileSize = logFile->fileSize(); // Update file size
-
-                            // Force file sync every 60s - or every two seconds if the size is not increasing
-                            if (((logFileSize == lastLogSize) && ((millis() - lastUBXLogSyncTime) > 2000)) ||
-                                ((millis() - lastUBXLogSyncTime) > 60000))
-                            {
-                                baseStatusLedBlink(); // Blink LED to indicate logging activity
-
-                                logFile->sync();
-                                sdUpdateFileAccessTimestamp(logFile); // Update the file access time & date
-
-                                baseStatusLedBlink(); // Blink LED to indicate logging activity
-
-                                lastUBXLogSyncTime = millis();
-                            }
-
-                            // Remember the maximum transfer time
-                            deltaMillis = millis() - startMillis;
-                            if (maxMillis[RBC_SD_CARD] < deltaMillis)
-                                maxMillis[RBC_SD_CARD] = deltaMillis;
-
-                            if (settings.enablePrintBufferOverrun)
-                            {
-                                if (deltaMillis > 150)
-                                    systemPrintf("Long Write! Time: %ld ms / Location: %ld / Recorded %d bytes / "
-                                                 "spaceRemaining %d bytes\r\n",
-                                                 deltaMillis, logFileSize, bytesToSend, combinedSpaceRemaining);
-                            }
-                        } while (0);
-
-                        xSemaphoreGive(sdCardSemaphore);
-                    } // End sdCardSemaphore
-                    else
-                    {
-                        char semaphoreHolder[50];
-                        getSemaphoreFunction(semaphoreHolder);
-                        log_w("sdCardSemaphore failed to yield for SD write, held by %s, Tasks.ino line %d",
-                              semaphoreHolder, __LINE__);
+        // Record trigger count with Time Of Week of rising edge (ms), Millisecond fraction of
+        // Time Of Week of rising edge (ns), and accuracy estimate (ns)
+        char eventData[82]; // Max NMEA sentence length is 82
+        snprintf(eventData, sizeof(eventData), "%lu,%lu,%lu,%lu", triggerCount, triggerTowMsR,
+                 triggerTowSubMsR, triggerAccEst);
 
-                        feedWdt();
-                        taskYIELD();
-                    }
+        char nmeaMessage[82]; // Max NMEA sentence length is 82
+        createNMEASentence(CUSTOM_NMEA_TYPE_EVENT, nmeaMessage, sizeof(nmeaMessage),
+                           eventData); // textID, buffer, sizeOfBuffer, text
 
-                    // Update space available for use in UART task
-                    bytesToSend = dataHead - sdRingBufferTail;
-                    if (bytesToSend < 0)
-                        bytesToSend += settings.gnssHandlerBufferSize;
-                    if (usedSpace < bytesToSend)
-                    {
-                        usedSpace = bytesToSend;
-                        slowConsumer = "SD card";
-                    }
-                } // bytesToSend
-            } // End connected
+        logWriterPrintln(nmeaMessage);
 
-            //----------------------------------------------------------------------
-            // Update the available space in the ring buffer
-            //----------------------------------------------------------------------
+        sdFreeSpace -= strlen(nmeaMessage) + 2; // Update remaining space on SD
+    }
 
-            freeSpace = settings.gnssHandlerBufferSize - usedSpace;
+    // Record the Antenna Reference Position - if available
+    if (newARPAvailable == true && settings.enableARPLogging &&
+        ((millis() - lastARPLog) > (settings.ARPLoggingInterval_s * 1000)))
+    {
+        lastARPLog = millis();
+        newARPAvailable = false; // Clear flag. It doesn't matter if the ARP cannot be logged
+
+        double x = ARPECEFX;
+        x /= 10000.0; // Convert to m
+        double y = ARPECEFY;
+        y /= 10000.0; // Convert to m
+        double z = ARPECEFZ;
+        z /= 10000.0; // Convert to m
+        double h = ARPECEFH;
+        h /= 10000.0;     // Convert to m
+        char ARPData[82]; // Max NMEA sentence length is 82
+        snprintf(ARPData, sizeof(ARPData), "%.4f,%.4f,%.4f,%.4f", x, y, z, h);
+
+        if ((settings.enablePrintLogFileStatus) && (!inMainMenu))
+            systemPrintf("Log file: recording Antenna Reference Position %s\r\n", ARPData);
+
+        char nmeaMessage[82]; // Max NMEA sentence length is 82
+        createNMEASentence(CUSTOM_NMEA_TYPE_ARP_ECEF_XYZH, nmeaMessage, sizeof(nmeaMessage),
+                           ARPData); // textID, buffer, sizeOfBuffer, text
+
+        logWriterPrintln(nmeaMessage);
+
+        sdFreeSpace -= strlen(nmeaMessage) + 2; // Update remaining space on SD
+    }
 
-            // Don't fill the last byte to prevent buffer overflow
-            if (freeSpace)
-                freeSpace -= 1;
-            availableHandlerSpace = freeSpace;
+    // Force file sync every 60s - or every two seconds if the size is not increasing
+    if (((logFileSize == lastLogSize) && ((millis() - lastUBXLogSyncTime) > 2000)) ||
+        ((millis() - lastUBXLogSyncTime) > 60000))
+    {
+        baseStatusLedBlink(); // Blink LED to indicate logging activity
 
-            //----------------------------------------------------------------------
-            // Display the millisecond values for the different ring buffer consumers
-            //----------------------------------------------------------------------
+        logWriterSync();
+        sdUpdateFileAccessTimestamp(logFile); // Update the file access time & date
 
-            if (PERIODIC_DISPLAY(PD_RING_BUFFER_MILLIS) && !inMainMenu)
-            {
-                int milliseconds;
-                int seconds;
+        baseStatusLedBlink(); // Blink LED to indicate logging activity
 
-                PERIODIC_CLEAR(PD_RING_BUFFER_MILLIS);
-                for (int index = 0; index < RBC_MAX; index++)
-                {
-                    milliseconds = maxMillis[index];
-                    if (milliseconds > 1)
-                    {
-                        seconds = milliseconds / MILLISECONDS_IN_A_SECOND;
-                        milliseconds %= MILLISECONDS_IN_A_SECOND;
-                        systemPrintf("%s: %d:%03d Sec\r\n", ringBufferConsumer[index], seconds, milliseconds);
-                    }
-                }
-            }
+        lastUBXLogSyncTime = millis();
+    }
+}
 
-            //----------------------------------------------------------------------
-            // processUart1Message will be chomping at the bit. Let it fly!
-            //----------------------------------------------------------------------
+// Start the consumer tasks, one per ring buffer consumer
+bool gnssDataConsumerTasksStart()
+{
+    TaskHandle_t taskHandle;
 
-            xSemaphoreGive(ringBufferSemaphore);
-        }
-        else
+    task.gnssDataConsumerTaskStopRequest = false;
+    for (int index = 0; index < RBC_MAX; index++)
+    {
+        if (gnssDataConsumerTaskRunning[index])
+            continue;
+
+        // The task index is passed as the task parameter
+        gnssDataConsumerTaskRunning[index] = true;
+        if (xTaskCreatePinnedToCore(gnssDataConsumerTask,                  // Function to call
+                                    ringBufferConsumer[index].taskName,    // Just for humans
+                                    handleGnssDataTaskStackSize,           // Stack Size
+                                    (void *)(intptr_t)index,               // Task input parameter
+                                    settings.gnssDataConsumerTaskPriority, // Priority
+                                    &taskHandle,                           // Task handle
+                                    settings.gnssDataConsumerTaskCore) != pdPASS)
         {
-            if (settings.debugGnss && (!inMainMenu))
-                systemPrintf("handleGnssDataTask could not get ringBuffer semaphore - held by %s\r\n",
-                             ringBufferSemaphoreHolder);
+            gnssDataConsumerTaskRunning[index] = false;
+            systemPrintf("ERROR: Failed to start %s task!\r\n", ringBufferConsumer[index].taskName);
+
+            // Fall back to servicing the consumers from handleGnssDataTask
+            gnssDataConsumerTasksStop();
+            return false;
         }
+        gnssDataConsumerTaskHandle[index] = taskHandle;
+    }
+    return true;
+}
 
-        //----------------------------------------------------------------------
-        // Let other tasks run, prevent watch dog timer (WDT) resets
-        //----------------------------------------------------------------------
+// Stop the consumer tasks
+void gnssDataConsumerTasksStop()
+{
+    bool pauseProducer;
+    bool running;
+
+    // Stop waking the tasks.  Pause processUart1Message so that it is not
+    // using a handle while the tasks exit, ringBufferGrow already paused it.
+    pauseProducer = (ringBufferPauseRequest == false);
+    if (pauseProducer)
+        ringBufferProducerPause(0);
+    for (int index = 0; index < RBC_MAX; index++)
+        gnssDataConsumerTaskHandle[index] = nullptr;
+    if (pauseProducer)
+        ringBufferProducerResume();
+
+    // Wait for the tasks to stop
+    task.gnssDataConsumerTaskStopRequest = true;
+    do
+    {
+        running = false;
+        for (int index = 0; index < RBC_MAX; index++)
+            running |= gnssDataConsumerTaskRunning[index];
+        if (running)
+            delay(10);
+    } while (running);
+}
 
-        feedWdt();
-        taskYIELD();
+// Send the ring buffer data to a single consumer
+// Started by handleGnssDataTask when settings.enableGnssDataConsumerTasks is set.  The task
+// is woken by processUart1Message when dataHead advances.  A slow consumer only delays itself.
+void gnssDataConsumerTask(void *e)
+{
+    int consumer;
+    int32_t usedSpace;
+
+    consumer = (int)(intptr_t)e;
+
+    // Start notification
+    if (settings.printTaskStartStop)
+        systemPrintf("Task %s started\r\n", ringBufferConsumer[consumer].taskName);
+
+    // Run task until a request is raised
+    usedSpace = 0;
+    while (task.gnssDataConsumerTaskStopRequest == false)
+    {
+        // Wait for new data.  Poll to finish sending the remaining data and
+        // to discard the data when the consumer is not connected.
+        ulTaskNotifyTake(pdTRUE, usedSpace ? 1 : (GNSS_DATA_CONSUMER_POLL_MSEC / portTICK_PERIOD_MS));
+
+        // Send the data
+        usedSpace = ringBufferSendData(consumer);
+
+        if ((settings.enableTaskReports == true) && (!inMainMenu))
+            systemPrintf("%s High watermark: %d\r\n", ringBufferConsumer[consumer].taskName,
+                         uxTaskGetStackHighWaterMark(nullptr));
     }
 
     // Stop notification
     if (settings.printTaskStartStop)
-        systemPrintln("Task handleGnssDataTask stopped");
-    task.handleGnssDataTaskRunning = false;
+        systemPrintf("Task %s stopped\r\n", ringBufferConsumer[consumer].taskName);
+    gnssDataConsumerTaskRunning[consumer] = false;
     vTaskDelete(NULL);
 }
 
@@ -2733,11 +3860,12 @@ void idleTask(void *e)
             // Get the idle time
             if (idleCount > max_idle_count)
                 max_idle_count = idleCount;
+            cpuIdlePercent[cpu] = idleCount * 100 / max_idle_count;
 
             // Display the idle times
             if (settings.enablePrintIdleTime)
             {
-                systemPrintf("CPU %d idle time: %d%% (%d/%d)\r\n", cpu, idleCount * 100 / max_idle_count, idleCount,
+                systemPrintf("CPU %d idle time: %d%% (%d/%d)\r\n", cpu, cpuIdlePercent[cpu], idleCount,
                              max_idle_count);
 
                 // Print the task count
@@ -2785,7 +3913,7 @@ bool tasksStartGnssUart()
         return false;
     }
 
-    availableHandlerSpace = settings.gnssHandlerBufferSize;
+    availableHandlerSpace = ringBufferSize;
 
     // Reads data from GNSS and stores data into circular buffer
     if (!task.gnssReadTaskRunning)
@@ -2816,6 +3944,12 @@ bool tasksStartGnssUart()
                                 settings.btReadTaskPriority, // Priority
                                 &taskHandle,                 // Task handle
                                 settings.btReadTaskCore);    // Core where task should run, 0=core, 1=Arduino
+
+    // Writes the correction data to the GNSS
+    correctionMuxTaskStart();
+
+    // Writes the GNSS data to the SD card
+    sdLogTaskStart();
     return true;
 }
 
@@ -2826,12 +3960,16 @@ void tasksStopGnssUart()
     task.gnssReadTaskStopRequest = true;
     task.handleGnssDataTaskStopRequest = true;
     task.btReadTaskStopRequest = true;
+    correctionMuxTaskStop();
 
     // Give the other CPU time to finish
     // Eliminates CPU bus hang condition
     do
         delay(10);
     while (task.gnssReadTaskRunning || task.handleGnssDataTaskRunning || task.btReadTaskRunning);
+
+    // Write the buffered GNSS data after handleGnssDataTask stops
+    sdLogTaskStop();
 }
 
 // Checking the number of available clusters on the SD card can take multiple seconds
@@ -2911,6 +4049,13 @@ void tasksValidateTables()
 {
     if (ringBufferConsumerEntries != RBC_MAX)
         reportFatalError("Fix ringBufferConsumer table to match RingBufferConsumers");
+    if (gnssDataFilterParserNameEntries != parserCount)
+        reportFatalError("Fix gnssDataFilterParserName table to match parserTable");
+    if (nmeaSentenceHandlerEntries != NMEA_SENTENCE_MAX)
+        reportFatalError("Fix nmeaSentenceHandler table to match NMEA_SENTENCE_ID");
+    for (int index = 1; index < nmeaSentenceHandlerEntries; index++)
+        if (nmeaSentenceFormatterId(nmeaSentenceHandler[index].formatter) != index)
+            reportFatalError("Fix nmeaSentenceHandler table order to match NMEA_SENTENCE_ID");
 }
 
 // Monitor the 2nd BleSerial port (bluetoothSerialBleCommands) for incoming serial
@@ -3000,6 +4145,8 @@ void beginRtcmParse()
 // Check and record the base location in RTCM1005/1006
 void processRTCMMessage(SEMP_PARSE_STATE *parse, uint16_t type)
 {
+    rtcmParseMessages++;
+
     if (sempRtcmGetMessageNumber(parse) == 1005)
     {
         ARPECEFX = sempRtcmGetSignedBits(parse, 34, 38);
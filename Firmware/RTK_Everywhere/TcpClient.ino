@@ -223,13 +223,13 @@ int32_t tcpClientSendData(uint16_t dataHead)
         // Determine the amount of data in the buffer
         bytesToSend = dataHead - tcpClientTail;
         if (bytesToSend < 0)
-            bytesToSend += settings.gnssHandlerBufferSize;
+            bytesToSend += ringBufferSize;
         if (bytesToSend > 0)
         {
             // Reduce bytes to send if we have more to send then the end of the buffer
             // We'll wrap next loop
-            if ((tcpClientTail + bytesToSend) > settings.gnssHandlerBufferSize)
-                bytesToSend = settings.gnssHandlerBufferSize - tcpClientTail;
+            if ((tcpClientTail + bytesToSend) > ringBufferSize)
+                bytesToSend = ringBufferSize - tcpClientTail;
 
             // Send the data to the NMEA server
             bytesSent = tcpClient->write(&ringBuffer[tcpClientTail], bytesToSend);
@@ -243,13 +243,13 @@ int32_t tcpClientSendData(uint16_t dataHead)
 
                 // Assume all data was sent, wrap the buffer pointer
                 tcpClientTail = tcpClientTail + bytesSent;
-                if (tcpClientTail >= settings.gnssHandlerBufferSize)
-                    tcpClientTail = tcpClientTail - settings.gnssHandlerBufferSize;
+                if (tcpClientTail >= ringBufferSize)
+                    tcpClientTail = tcpClientTail - ringBufferSize;
 
                 // Update space available for use in UART task
                 bytesToSend = dataHead - tcpClientTail;
                 if (bytesToSend < 0)
-                    bytesToSend += settings.gnssHandlerBufferSize;
+                    bytesToSend += ringBufferSize;
 
                 while(tcpClient->available())
                     tcpClient->read(); // Absorb any unwanted incoming traffic
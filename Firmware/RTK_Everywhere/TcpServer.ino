@@ -325,26 +325,26 @@ int32_t tcpServerSendData(uint16_t dataHead)
             // Determine the amount of TCP data in the buffer
             bytesToSend = dataHead - tail;
             if (bytesToSend < 0)
-                bytesToSend += settings.gnssHandlerBufferSize;
+                bytesToSend += ringBufferSize;
             if (bytesToSend > 0)
             {
                 // Reduce bytes to send if we have more to send then the end of the buffer
                 // We'll wrap next loop
-                if ((tail + bytesToSend) > settings.gnssHandlerBufferSize)
-                    bytesToSend = settings.gnssHandlerBufferSize - tail;
+                if ((tail + bytesToSend) > ringBufferSize)
+                    bytesToSend = ringBufferSize - tail;
 
                 // Send the data to the TCP server clients
                 bytesToSend = tcpServerClientSendData(index, &ringBuffer[tail], bytesToSend);
 
                 // Assume all data was sent, wrap the buffer pointer
                 tail += bytesToSend;
-                if (tail >= settings.gnssHandlerBufferSize)
-                    tail -= settings.gnssHandlerBufferSize;
+                if (tail >= ringBufferSize)
+                    tail -= ringBufferSize;
 
                 // Update space available for use in UART task
                 bytesToSend = dataHead - tail;
                 if (bytesToSend < 0)
-                    bytesToSend += settings.gnssHandlerBufferSize;
+                    bytesToSend += ringBufferSize;
                 if (usedSpace < bytesToSend)
                     usedSpace = bytesToSend;
             }
@@ -433,7 +433,7 @@ void tiltSensorFactoryReset()
 
 // Given a NMEA sentence, modify the sentence to use the latest tilt-compensated lat/lon/alt
 // Modifies the sentence directly. Updates sentence CRC.
-// Auto-detects sentence type and will only modify sentences that have lat/lon/alt (ie GGA yes, GSV no)
+// Only modifies the sentences (identified by sentenceId) that have lat/lon/alt (ie GGA yes, GSV no)
 // Which sentences have altitude? Yes: GGA, GNS No: RMC, GLL
 // Which sentences have undulation? Yes: GGA, GNS No: RMC, GLL
 // Four possible compensations:
@@ -443,38 +443,35 @@ void tiltSensorFactoryReset()
 // and outputTipAltitude is disabled, then pass GNSS data without modification. See issues:
 //   https://github.com/sparkfun/SparkFun_RTK_Everywhere_Firmware/issues/334
 //   https://github.com/sparkfun/SparkFun_RTK_Everywhere_Firmware/issues/343
-void nmeaApplyCompensation(char *nmeaSentence, int sentenceLength)
+void nmeaApplyCompensation(char *nmeaSentence, int sentenceLength, NMEA_SENTENCE_ID sentenceId)
 {
     // If tilt is off, and outputTipAltitude is disabled, then pass GNSS data without modification
     if (tiltIsCorrecting() == false && settings.outputTipAltitude == false)
         return;
 
-    // Identify sentence type
-    char sentenceType[strlen("GGA") + 1] = {0};
-    strncpy(sentenceType, &nmeaSentence[3],
-            3); // Copy three letters, starting in spot 3. Null terminated from array initializer.
+    // The sentence type was identified by processUart1Message
+    switch (sentenceId)
+    {
+    default:
+        // This type of sentence does not have lat/lon/alt that needs modification
+        break;
 
     // GGA and GNS sentences get modified in the same way
-    if (strncmp(sentenceType, "GGA", sizeof(sentenceType)) == 0)
-    {
+    case NMEA_SENTENCE_GGA:
         applyCompensationGGA(nmeaSentence, sentenceLength);
-    }
-    else if (strncmp(sentenceType, "GNS", sizeof(sentenceType)) == 0)
-    {
+        break;
+
+    case NMEA_SENTENCE_GNS:
         applyCompensationGNS(nmeaSentence, sentenceLength);
-    }
-    else if (strncmp(sentenceType, "RMC", sizeof(sentenceType)) == 0)
-    {
+        break;
+
+    case NMEA_SENTENCE_RMC:
         applyCompensationRMC(nmeaSentence, sentenceLength);
-    }
-    else if (strncmp(sentenceType, "GLL", sizeof(sentenceType)) == 0)
-    {
+        break;
+
+    case NMEA_SENTENCE_GLL:
         applyCompensationGLL(nmeaSentence, sentenceLength);
-    }
-    else
-    {
-        // This type of sentence does not have lat/lon/alt that needs modification
-        return;
+        break;
     }
 }
 
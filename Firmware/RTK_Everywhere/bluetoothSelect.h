@@ -14,6 +14,8 @@ bluetoothSelect.h
 
 #include "esp_sdp_api.h"
 
+#define BLE_NOTIFY_DEFAULT_BYTES 20 // Default ATT MTU (23) less the notification header
+
 class BTSerialInterface : public virtual Stream
 {
   public:
@@ -27,12 +29,15 @@ class BTSerialInterface : public virtual Stream
 
     virtual int available() = 0;
     virtual size_t readBytes(uint8_t *buffer, size_t bufferSize) = 0;
+    virtual size_t read(uint8_t *buffer, size_t bufferSize) = 0; // Available bytes only, does not wait
     virtual int read() = 0;
     virtual int peek() = 0;
+    virtual uint32_t rxOverflow() = 0; // Received bytes discarded because the RX buffer was full
 
     // virtual bool isCongested() = 0;
     virtual size_t write(const uint8_t *buffer, size_t size) = 0;
     virtual size_t write(uint8_t value) = 0;
+    virtual int maxWriteSize() = 0; // Largest write sent in a single packet
     virtual void flush() = 0;
     virtual bool connect(uint8_t remoteAddress[], int channel,
                          esp_spp_sec_t sec_mask = (ESP_SPP_SEC_ENCRYPT | ESP_SPP_SEC_AUTHENTICATE),
@@ -92,6 +97,11 @@ class BTClassicSerial : public virtual BTSerialInterface, public BluetoothSerial
         return BluetoothSerial::readBytes(buffer, bufferSize);
     }
 
+    size_t read(uint8_t *buffer, size_t bufferSize)
+    {
+        return BluetoothSerial::read(buffer, bufferSize);
+    }
+
     int read()
     {
         return BluetoothSerial::read();
@@ -102,6 +112,11 @@ class BTClassicSerial : public virtual BTSerialInterface, public BluetoothSerial
         return BluetoothSerial::peek();
     }
 
+    uint32_t rxOverflow()
+    {
+        return BluetoothSerial::rxOverflow();
+    }
+
     size_t write(const uint8_t *buffer, size_t size)
     {
         return BluetoothSerial::write(buffer, size);
@@ -112,6 +127,11 @@ class BTClassicSerial : public virtual BTSerialInterface, public BluetoothSerial
         return BluetoothSerial::write(value);
     }
 
+    int maxWriteSize()
+    {
+        return 330; // SPP_TX_MAX
+    }
+
     void flush()
     {
         BluetoothSerial::flush();
@@ -225,6 +245,17 @@ class BTLESerial : public virtual BTSerialInterface, public BleBufferedSerial
         // return BleSerial::readBytes(buffer, bufferSize);
     }
 
+    size_t read(uint8_t *buffer, size_t bufferSize)
+    {
+        // readBytes waits for the timeout when asked for more than is available
+        size_t bytesAvailable = BleBufferedSerial::available();
+        if (bytesAvailable > bufferSize)
+            bytesAvailable = bufferSize;
+        if (bytesAvailable == 0)
+            return 0;
+        return BleBufferedSerial::readBytes(buffer, bytesAvailable);
+    }
+
     int read()
     {
         return BleBufferedSerial::read();
@@ -237,6 +268,11 @@ class BTLESerial : public virtual BTSerialInterface, public BleBufferedSerial
         // return BleSerial::peek();
     }
 
+    uint32_t rxOverflow()
+    {
+        return 0;
+    }
+
     size_t write(const uint8_t *buffer, size_t size)
     {
         return BleBufferedSerial::write(buffer, size);
@@ -249,6 +285,18 @@ class BTLESerial : public virtual BTSerialInterface, public BleBufferedSerial
         // return BleSerial::write(value);
     }
 
+    int maxWriteSize()
+    {
+        // Notification payload using the MTU negotiated with the phone
+        if (Server && Server->getConnectedCount())
+        {
+            uint16_t mtu = Server->getPeerMTU(Server->getConnId());
+            if (mtu > 3)
+                return mtu - 3;
+        }
+        return BLE_NOTIFY_DEFAULT_BYTES;
+    }
+
     void flush()
     {
         BleBufferedSerial::flush();
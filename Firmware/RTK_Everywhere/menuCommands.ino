@@ -313,6 +313,19 @@ t_cliResult processCommand(char *cmdBuffer)
                 commandSendExecuteOkResponse(tokens[0], tokens[1]);
                 return (CLI_OK);
             }
+            else if (strcmp(tokens[1], "STATS") == 0)
+            {
+                // Respond with a list of the ring buffer health telemetry values
+                ringBufferStatsList();
+                commandSendExecuteOkResponse(tokens[0], tokens[1]);
+                return (CLI_OK);
+            }
+            else if (strcmp(tokens[1], "STATSRESET") == 0)
+            {
+                ringBufferStatsReset();
+                commandSendExecuteOkResponse(tokens[0], tokens[1]);
+                return (CLI_OK);
+            }
             else if (strcmp(tokens[1], "UPDATEFIRMWARE") == 0)
             {
                 // Begin a firmware update. WiFi networks and enableRCFirmware should previously be set.
@@ -633,60 +646,82 @@ int commandLookupSettingName(bool inCommands, const char *settingName, char *tru
 int commandLookupSettingNameSelective(bool inCommands, const char *settingName, char *truncatedName,
                                       int truncatedNameLen, char *suffix, int suffixLen, bool usePrioritySettingsEnd)
 {
-    const char *command;
+    int i;
 
-    int prioritySettingsEnd = 0;
-    if (usePrioritySettingsEnd)
-        // Find "endOfPrioritySettings"
-        prioritySettingsEnd = findEndOfPrioritySettings();
-    // If "endOfPrioritySettings" is not found, prioritySettingsEnd will be zero
+    // Look for the complete name, then split the name and look for the
+    // setting name with the suffix removed
+    i = commandLookupName(inCommands, settingName, false, usePrioritySettingsEnd);
+    if (i == COMMAND_UNKNOWN)
+    {
+        // Split a settingName into a truncatedName and a suffix
+        commandSplitName(settingName, truncatedName, truncatedNameLen, suffix, suffixLen);
+        i = commandLookupName(inCommands, truncatedName, true, usePrioritySettingsEnd);
+    }
 
-    // Adjust prioritySettingsEnd if needed - depending on platform type
-    prioritySettingsEnd = adjustEndOfPrioritySettings(prioritySettingsEnd);
+    // Command not found
+    if ((i == COMMAND_UNKNOWN) && (settings.debugCLI == true))
+        systemPrintf("commandLookupSettingName: Setting not found: %s\r\n", settingName);
 
-    // Loop through the valid command entries - starting at prioritySettingsEnd
-    for (int i = prioritySettingsEnd; i < commandCount; i++)
-    {
-        // Verify that this command does not get split
-        if ((commandIndex[i] >= 0) && (!rtkSettingsEntries[commandIndex[i]].useSuffix) &&
-            ((!inCommands) || (inCommands && rtkSettingsEntries[commandIndex[i]].inCommands)))
-        {
-            command = commandGetName(0, commandIndex[i]);
+    return i;
+}
 
-            // For speed, compare the first letter, then the whole string
-            if ((command[0] == settingName[0]) && (strcmp(command, settingName) == 0))
-            {
-                return commandIndex[i];
-            }
-        }
-    }
+// Determine if the command entry matches the name
+bool commandLookupMatch(int rtkIndex, const char *name, bool useSuffix, bool inCommands)
+{
+    // Only the settings are looked up by name
+    if (rtkIndex < 0)
+        return false;
 
-    // Split a settingName into a truncatedName and a suffix
-    commandSplitName(settingName, truncatedName, truncatedNameLen, suffix, suffixLen);
+    // Verify that this command is split, or not split, as requested
+    if (rtkSettingsEntries[rtkIndex].useSuffix != useSuffix)
+        return false;
 
-    // Loop through the settings entries
-    // This could be speeded up by
-    // E.g. by storing the previous value of i and starting there.
-    // Most of the time, the match will be i+1.
-    for (int i = prioritySettingsEnd; i < commandCount; i++)
+    // The suffix settings are found even when they are not in the command interface
+    if (inCommands && (!useSuffix) && (!rtkSettingsEntries[rtkIndex].inCommands))
+        return false;
+    return (strcmp(rtkSettingsEntries[rtkIndex].name, name) == 0);
+}
+
+// Using the name, return the index of the setting within rtkSettingsEntries
+// The priority settings are searched linearly, the rest of commandIndex is sorted
+// by commandIndexFill and is searched with a binary search
+int commandLookupName(bool inCommands, const char *name, bool useSuffix, bool usePrioritySettingsEnd)
+{
+    int high;
+    int low;
+    int middle;
+
+    // Search the priority settings
+    if (!usePrioritySettingsEnd)
     {
-        // Verify that this command gets split
-        if ((commandIndex[i] >= 0) && rtkSettingsEntries[commandIndex[i]].useSuffix)
+        for (int i = 0; i < commandPrioritySettingsEnd; i++)
         {
-            command = commandGetName(0, commandIndex[i]);
-
-            // For speed, compare the first letter, then the whole string
-            if ((command[0] == truncatedName[0]) && (strcmp(command, truncatedName) == 0))
-            {
+            if (commandLookupMatch(commandIndex[i], name, useSuffix, inCommands))
                 return commandIndex[i];
-            }
         }
     }
 
-    // Command not found
-    if (settings.debugCLI == true)
-        systemPrintf("commandLookupSettingName: Setting not found: %s\r\n", settingName);
+    // Locate the first sorted command that matches the name, ignoring case
+    low = commandPrioritySettingsEnd;
+    high = commandCount;
+    while (low < high)
+    {
+        middle = (low + high) / 2;
+        if (strcasecmp(commandGetName(0, commandIndex[middle]), name) < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
 
+    // The sort ignores case, look for the exact match in the entries that
+    // differ only in case
+    for (int i = low; i < commandCount; i++)
+    {
+        if (strcasecmp(commandGetName(0, commandIndex[i]), name))
+            break;
+        if (commandLookupMatch(commandIndex[i], name, useSuffix, inCommands))
+            return commandIndex[i];
+    }
     return COMMAND_UNKNOWN;
 }
 
@@ -1043,6 +1078,16 @@ SettingValueResponse updateSettingWithValue(bool inCommands, const char *setting
             knownSetting = true;
         }
         break;
+        case tRtcmLnk: {
+            int link;
+            if ((sscanf(suffix, "%d", &link) == 1) && (link >= 0) && (link < qualifier))
+            {
+                uint16_t *ptr = (uint16_t *)var;
+                ptr[link] = (uint16_t)settingValue;
+                knownSetting = true;
+            }
+        }
+        break;
         }
 
         // Handle the GNSS specific types
@@ -1305,6 +1350,16 @@ SettingValueResponse updateSettingWithValue(bool inCommands, const char *setting
         // Inform the OTA state machine that it is needed
         otaRequestFirmwareVersionCheck = true;
     }
+    else if (strcmp(settingName, "getRingBufferStats") == 0)
+    {
+        ringBufferStatsSendToWebServer(); // Send rbStats...,value, pairs to the config page
+        knownSetting = true;
+    }
+    else if (strcmp(settingName, "resetRingBufferStats") == 0)
+    {
+        ringBufferStatsReset();
+        knownSetting = true;
+    }
     else if (strcmp(settingName, "getNewFirmware") == 0)
     {
         if (settings.debugWebServer == true)
@@ -1718,6 +1773,16 @@ void createSettingsString(char *newSettings)
                 stringRecord(newSettings, rtkSettingsEntries[i].name, (int)*ptr);
             }
             break;
+            case tRtcmLnk: {
+                uint16_t *ptr = (uint16_t *)rtkSettingsEntries[i].var;
+                for (int x = 0; x < rtkSettingsEntries[i].qualifier; x++)
+                {
+                    char tempString[50];
+                    snprintf(tempString, sizeof(tempString), "%s%d,%d,", rtkSettingsEntries[i].name, x, ptr[x]);
+                    stringRecord(newSettings, tempString);
+                }
+            }
+            break;
             }
         }
     }
@@ -2394,6 +2459,16 @@ SettingValueResponse getSettingValue(bool inCommands, const char *settingName, c
                 knownSetting = true;
             }
             break;
+            case tRtcmLnk: {
+                int link;
+                if ((sscanf(suffix, "%d", &link) == 1) && (link >= 0) && (link < qualifier))
+                {
+                    uint16_t *ptr = (uint16_t *)var;
+                    writeToString(settingValueStr, ptr[link]);
+                    knownSetting = true;
+                }
+            }
+            break;
             }
         }
     }
@@ -2489,6 +2564,12 @@ SettingValueResponse getSettingValue(bool inCommands, const char *settingName, c
         knownSetting = true;
     }
 
+    // Ring buffer health telemetry, Ex: rbStatsBluetoothDropped. The callers use 100 byte value buffers.
+    else if (strncmp(settingName, "rbStats", strlen("rbStats")) == 0)
+    {
+        knownSetting = ringBufferStatsGet(settingName, settingValueStr, 100, &settingIsString);
+    }
+
     // Unused variables - read to avoid errors
     // TODO: check this! Is this really what we want?
     else
@@ -2511,12 +2592,14 @@ SettingValueResponse getSettingValue(bool inCommands, const char *settingName, c
             "fixedLongText",
             "forgetEspNowPeers",
             "getNewFirmware",
+            "getRingBufferStats",
             "measurementRateHz",
             "measurementRateSec",
             "minCN0",
             "nicknameECEF",
             "nicknameGeodetic",
             "resetProfile",
+            "resetRingBufferStats",
             "saveToArduino",
             "setProfile",
             "startNewLog",
@@ -2796,6 +2879,16 @@ void commandList(bool inCommands, int i)
             commandSendExecuteListResponse(rtkSettingsEntries[i].name, "gnssReceiverType_e", settingValue);
         }
         break;
+        case tRtcmLnk: {
+            for (int x = 0; x < rtkSettingsEntries[i].qualifier; x++)
+            {
+                snprintf(settingName, sizeof(settingName), "%s%d", rtkSettingsEntries[i].name, x);
+
+                getSettingValue(inCommands, settingName, settingValue);
+                commandSendExecuteListResponse(settingName, "uint16_t", settingValue);
+            }
+        }
+        break;
         }
     }
 }
@@ -2967,61 +3060,95 @@ int findEndOfPrioritySettings()
     return prioritySettingsEnd;
 }
 
-int adjustEndOfPrioritySettings(int prioritySettingsEnd)
+// Allocate and fill the commandIndex table
+bool commandIndexFillPossible()
 {
-    // If prioritySettingsEnd is zero, don't adjust
-    if (prioritySettingsEnd == 0)
-        return 0;
+    return commandIndexFill(true);
+}
+bool commandIndexFillActual()
+{
+    return commandIndexFill(false);
+}
+// Compare two commands ignoring case, equal names remain in table order
+int commandSortCompare(const void *a, const void *b)
+{
+    int16_t aIndex;
+    int16_t bIndex;
+    int result;
+
+    aIndex = *(const int16_t *)a;
+    bIndex = *(const int16_t *)b;
+    result = strcasecmp(commandGetName(0, aIndex), commandGetName(1, bIndex));
+    if (result == 0)
+        result = aIndex - bIndex;
+    return result;
+}
 
-    int adjustedPrioritySettingsEnd = prioritySettingsEnd;
+// Allocate and sort the commands that follow the priority settings, done once
+// for all platforms.  commandIndexFill filters this list for the platform.
+bool commandSortedIndexBegin()
+{
+    int i;
+    int length;
+
+    // Determine if the sorted index already exists
+    if (commandSortedIndex)
+        return true;
 
-    // Check which of the priority settings are possible on this platform
-    // Deduct the ones which are not
-    for (int i = 0; i < prioritySettingsEnd; i++)
+    // Find "endOfPrioritySettings"
+    commandSortedPriorityEnd = findEndOfPrioritySettings();
+    // If "endOfPrioritySettings" is not found, commandSortedPriorityEnd will be zero
+    // and all settings will be sorted. Just like the good old days...
+
+    // Allocate the sorted index array. Never freed
+    commandSortedCount = numRtkSettingsEntries - commandSortedPriorityEnd + COMMAND_COUNT - 1;
+    length = commandSortedCount * sizeof(*commandSortedIndex);
+    commandSortedIndex = (int16_t *)rtkMalloc(length, "Sorted command index array (commandSortedIndex)");
+    if (!commandSortedIndex)
     {
-        if (!settingPossibleOnPlatform(i))
-            adjustedPrioritySettingsEnd--;
+        systemPrintln("ERROR: Failed to allocate commandSortedIndex!");
+        return false;
     }
 
-    return adjustedPrioritySettingsEnd;
+    // Add the settings and the human-machine-interface commands, then sort them
+    commandSortedCount = 0;
+    for (i = commandSortedPriorityEnd; i < numRtkSettingsEntries; i++)
+        commandSortedIndex[commandSortedCount++] = i;
+    for (i = 1; i < COMMAND_COUNT; i++)
+        commandSortedIndex[commandSortedCount++] = -i;
+    qsort(commandSortedIndex, commandSortedCount, sizeof(*commandSortedIndex), commandSortCompare);
+    return true;
 }
 
-// Allocate and fill the commandIndex table
-bool commandIndexFillPossible()
+// Determine if the setting belongs in commandIndex
+bool commandIndexInclude(int i, bool usePossibleSettings)
 {
-    return commandIndexFill(true);
-}
-bool commandIndexFillActual()
-{
-    return commandIndexFill(false);
+    // commandIndexFill is called after identifyBoard. On Facet FP, we don't yet know
+    // the detectedGnssReceiver, so we have to use settingPossibleOnPlatform
+    if (usePossibleSettings)
+        return settingPossibleOnPlatform(i);
+    return settingAvailableOnPlatform(i);
 }
+
 bool commandIndexFill(bool usePossibleSettings)
 {
     savePossibleSettings = usePossibleSettings; // Update savePossibleSettings
 
     int i;
-    const char *iCommandName;
-    int j;
-    const char *jCommandName;
     int length;
-    int16_t temp;
+    int prioritySettingsEnd;
+    int16_t rtkIndex;
+
+    // Sort the commands once, each fill only selects the commands for the platform
+    if (!commandSortedIndexBegin())
+        return false;
 
     // Count the commands
     commandCount = 0;
     for (i = 0; i < numRtkSettingsEntries; i++)
     {
-        if (usePossibleSettings)
-        {
-            // commandIndexFill is called after identifyBoard. On Facet FP, we don't yet know
-            // the detectedGnssReceiver, so we have to use settingPossibleOnPlatform
-            if (settingPossibleOnPlatform(i))
-                commandCount += 1;
-        }
-        else
-        {
-            if (settingAvailableOnPlatform(i))
-                commandCount += 1;
-        }
+        if (commandIndexInclude(i, usePossibleSettings))
+            commandCount += 1;
     }
     commandCount += COMMAND_COUNT - 1;
 
@@ -3042,33 +3169,24 @@ bool commandIndexFill(bool usePossibleSettings)
         return false;
     }
 
-    // Initialize commandIndex with index values into rtkSettingsEntries
+    // Add the priority settings in table order
     commandCount = 0;
-    for (i = 0; i < numRtkSettingsEntries; i++)
+    for (i = 0; i < commandSortedPriorityEnd; i++)
     {
-        if (usePossibleSettings)
-        {
-            if (settingPossibleOnPlatform(i))
-                commandIndex[commandCount++] = i;
-        }
-        else
-        {
-            if (settingAvailableOnPlatform(i))
-                commandIndex[commandCount++] = i;
-        }
+        if (commandIndexInclude(i, usePossibleSettings))
+            commandIndex[commandCount++] = i;
     }
+    prioritySettingsEnd = commandCount;
+    commandPrioritySettingsEnd = prioritySettingsEnd;
 
-    // Add the human-machine-interface commands to the list
-    for (i = 1; i < COMMAND_COUNT; i++)
-        commandIndex[commandCount++] = -i;
-
-    // Find "endOfPrioritySettings"
-    int prioritySettingsEnd = findEndOfPrioritySettings();
-    // If "endOfPrioritySettings" is not found, prioritySettingsEnd will be zero
-    // and all settings will be sorted. Just like the good old days...
-
-    // Adjust prioritySettingsEnd if needed - depending on platform type
-    prioritySettingsEnd = adjustEndOfPrioritySettings(prioritySettingsEnd);
+    // Add the remaining settings and the human-machine-interface commands in
+    // sorted order
+    for (i = 0; i < commandSortedCount; i++)
+    {
+        rtkIndex = commandSortedIndex[i];
+        if ((rtkIndex < 0) || commandIndexInclude(rtkIndex, usePossibleSettings))
+            commandIndex[commandCount++] = rtkIndex;
+    }
 
     if (settings.debugSettings || settings.debugCLI)
     {
@@ -3079,29 +3197,6 @@ bool commandIndexFill(bool usePossibleSettings)
         else
             systemPrintln("endOfPrioritySettings not found!");
     }
-
-    // Sort the commands - starting at prioritySettingsEnd
-    for (i = prioritySettingsEnd; i < commandCount - 1; i++)
-    {
-        iCommandName = commandGetName(0, commandIndex[i]);
-        for (j = i + 1; j < commandCount; j++)
-        {
-            jCommandName = commandGetName(1, commandIndex[j]);
-
-            // Determine if the commands are out of order
-            if (strncasecmp(iCommandName, jCommandName, strlen(iCommandName) + 1) > 0)
-            {
-                // Out of order, switch the two entries
-                temp = commandIndex[i];
-                commandIndex[i] = commandIndex[j];
-                commandIndex[j] = temp;
-
-                // Get the updated names
-                iCommandName = commandGetName(0, commandIndex[i]);
-                jCommandName = commandGetName(1, commandIndex[j]);
-            }
-        }
-    }
     return true;
 }
 
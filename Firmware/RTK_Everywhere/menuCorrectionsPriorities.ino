@@ -309,6 +309,9 @@ void menuCorrectionsPriorities()
 
         correctionDisplayPriorityTable(true);
 
+        systemPrintln();
+        correctionMuxPrintStats();
+
         systemPrintln();
         systemPrintln("x) Exit");
 
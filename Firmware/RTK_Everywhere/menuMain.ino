@@ -294,6 +294,7 @@ void menuUserProfiles()
                             systemPrintf("Failed to deleted LFS file %s\r\n", settingsFileName);
                     }
                 }
+                settingsSnapshotRemoveLFS(settingsFileName);
                 if (LittleFS.exists(stationCoordinateECEFFileName))
                 {
                     if (LittleFS.remove(stationCoordinateECEFFileName))
@@ -337,6 +338,7 @@ void menuUserProfiles()
                                 systemPrintf("Failed to deleted SD card file %s\r\n", settingsFileName);
                         }
                     }
+                    settingsSnapshotRemoveSD(settingsFileName);
                     if (sd->exists(stationCoordinateECEFFileName))
                     {
                         if (sd->remove(stationCoordinateECEFFileName))
@@ -388,7 +390,8 @@ void menuUserProfiles()
                 char printFileName[60];
                 snprintf(printFileName, sizeof(printFileName), "/%s_Settings_%d.txt", platformFilePrefix,
                          printThis - 1);
-                printSystemSettingsFromFileLFS(printFileName);
+                if ((printSystemSettingsFromFileLFS(printFileName) == false) && (settings.settingsTextExport == false))
+                    systemPrintln("Set settingsTextExport to record the clear text settings files");
             }
         }
 
@@ -457,6 +460,8 @@ void menuRadio()
             else
                 systemPrintln("  No Paired Radios - Broadcast Enabled");
 
+            espNowPrintRxStats();
+
             if (espNowState == ESPNOW_BROADCASTING || espNowState == ESPNOW_PAIRED)
                 systemPrintf("2) Pairing: %s\r\n", espnowRequestPair ? "Requested" : "Not requested");
             else if (espNowState == ESPNOW_PAIRING)
@@ -477,6 +482,9 @@ void menuRadio()
                 systemPrintln("6) Send dummy data");
                 systemPrintln("7) Broadcast dummy data");
             }
+
+            systemPrintf("8) RTCM framing: %s\r\n",
+                         settings.espnowRtcmFraming ? "Enabled" : "Disabled - for radios with older firmware");
         }
 #endif // COMPILE_ESPNOW
 
@@ -508,6 +516,13 @@ void menuRadio()
                     systemPrintf("14) Seconds without user serial that must elapse before LoRa radio goes "
                                  "into dedicated listening mode: %d\r\n",
                                  settings.loraSerialInteractionTimeout_s);
+                if (present.loraDedicatedUart == false)
+                {
+                    if (settings.loraAirDataRate_bps)
+                        systemPrintf("15) LoRa Air Data Rate: %d bps\r\n", settings.loraAirDataRate_bps);
+                    else
+                        systemPrintln("15) LoRa Air Data Rate: Not paced");
+                }
             }
         }
 
@@ -654,6 +669,10 @@ void menuRadio()
 #endif
         }
 
+        else if (settings.enableEspNow == true && incoming == 8)
+        {
+            settings.espnowRtcmFraming ^= 1;
+        }
         else if (present.radio_lora == true && incoming == 10)
         {
             settings.enableLora ^= 1;
@@ -679,6 +698,12 @@ void menuRadio()
                           "into dedicated listening mode",
                           10, 600, &settings.loraSerialInteractionTimeout_s);
         }
+        else if (present.radio_lora == true && settings.enableLora == true
+                 && present.loraDedicatedUart == false && incoming == 15)
+        {
+            getNewSetting("Enter the radio's over-the-air data rate in bps, 0 to send without pacing",
+                          0, 100000, &settings.loraAirDataRate_bps);
+        }
 
         else if (incoming == 'x')
             break;
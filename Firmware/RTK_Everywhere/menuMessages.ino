@@ -22,6 +22,8 @@ void menuMessagesBaseRTCM()
         if (namedSettingAvailableOnPlatform("rtcmMinElev"))
             systemPrintf("5) Minimum Elevation for RTCM: %d\r\n", settings.rtcmMinElev);
 
+        systemPrintln("6) Set RTCM Rules for each Link");
+
         systemPrintln("x) Exit");
 
         int incoming = getUserInputNumber(); // Returns EXIT, TIMEOUT, or long
@@ -61,7 +63,109 @@ void menuMessagesBaseRTCM()
                 gnssConfigure(GNSS_CONFIG_ELEVATION); // Request receiver to use new settings
             }
         }
+        else if (incoming == 6)
+        {
+            menuRtcmLinks();
+        }
+
+        else if (incoming == INPUT_RESPONSE_GETNUMBER_EXIT)
+            break;
+        else if (incoming == INPUT_RESPONSE_GETNUMBER_TIMEOUT)
+            break;
+        else
+            printUnknown(incoming);
+    }
+
+    clearBuffer(); // Empty buffer of any newline chars
+}
+
+// Select the link for the RTCM rules
+void menuRtcmLinks()
+{
+    while (1)
+    {
+        systemPrintln();
+        systemPrintln("Menu: RTCM Link Rules");
+        systemPrintln();
+        rtcmLinkPrintStats();
+        rtcmConsumerPrintStats();
+        systemPrintln();
+
+        for (int link = 0; link < RTCM_LINK_MAX; link++)
+        {
+            systemPrintf("%d) ", link + 1);
+            rtcmLinkPrintRules(link);
+        }
+
+        systemPrintln("x) Exit");
+
+        int incoming = getUserInputNumber(); // Returns EXIT, TIMEOUT, or long
+
+        if ((incoming >= 1) && (incoming <= RTCM_LINK_MAX))
+            menuRtcmLinkRules(incoming - 1);
+        else if (incoming == INPUT_RESPONSE_GETNUMBER_EXIT)
+            break;
+        else if (incoming == INPUT_RESPONSE_GETNUMBER_TIMEOUT)
+            break;
+        else
+            printUnknown(incoming);
+    }
+
+    clearBuffer(); // Empty buffer of any newline chars
+}
+
+// Set the RTCM rules for a link
+void menuRtcmLinkRules(int link)
+{
+    while (1)
+    {
+        systemPrintln();
+        systemPrintf("Menu: RTCM Rules for %s\r\n", rtcmLinkName(link));
+
+        systemPrint("1) Station message (1005, 1006, 1007, 1008, 1033, 1230) interval: ");
+        if (settings.rtcmLinkStationInterval[link])
+            systemPrintf("%d seconds\r\n", settings.rtcmLinkStationInterval[link]);
+        else
+            systemPrintln("Every message");
+
+        systemPrint("2) MSM epoch interval: ");
+        if (settings.rtcmLinkObservationInterval[link])
+            systemPrintf("%d seconds\r\n", settings.rtcmLinkObservationInterval[link]);
+        else
+            systemPrintln("Every epoch");
+
+        systemPrint("3) GLONASS MSM interval: ");
+        if (settings.rtcmLinkGlonassInterval[link])
+            systemPrintf("%d seconds\r\n", settings.rtcmLinkGlonassInterval[link]);
+        else
+            systemPrintln("Every epoch");
+
+        systemPrintf("4) Send MSM7 as MSM4: %s\r\n", settings.rtcmLinkMsm4[link] ? "Enabled" : "Disabled");
+
+        systemPrint("5) Bandwidth budget: ");
+        if (settings.rtcmLinkBudget[link])
+            systemPrintf("%d bytes per second\r\n", settings.rtcmLinkBudget[link]);
+        else
+            systemPrintln("Unlimited");
 
+        systemPrintln("x) Exit");
+
+        int incoming = getUserInputNumber(); // Returns EXIT, TIMEOUT, or long
+
+        if (incoming == 1)
+            getNewSetting("Enter the seconds between station messages, 0 to send every message", 0, 3600,
+                          &settings.rtcmLinkStationInterval[link]);
+        else if (incoming == 2)
+            getNewSetting("Enter the seconds between MSM epochs, 0 to send every epoch", 0, 3600,
+                          &settings.rtcmLinkObservationInterval[link]);
+        else if (incoming == 3)
+            getNewSetting("Enter the seconds between GLONASS MSM epochs, 0 to send every epoch", 0, 3600,
+                          &settings.rtcmLinkGlonassInterval[link]);
+        else if (incoming == 4)
+            settings.rtcmLinkMsm4[link] ^= 1;
+        else if (incoming == 5)
+            getNewSetting("Enter the bandwidth budget in bytes per second, 0 for unlimited", 0, 65535,
+                          &settings.rtcmLinkBudget[link]);
         else if (incoming == INPUT_RESPONSE_GETNUMBER_EXIT)
             break;
         else if (incoming == INPUT_RESPONSE_GETNUMBER_TIMEOUT)
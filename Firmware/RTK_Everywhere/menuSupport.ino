@@ -14,8 +14,8 @@ void changeProfileNumber(byte newProfileNumber, bool recordSettings)
     setSettingsFileName(); // Load the settings file name into memory (enabled profile name delete)
 
     // We need to load these settings from file so that we can record a profile name change correctly
-    bool responseLFS = loadSystemSettingsFromFileLFS(settingsFileName);
-    bool responseSD = loadSystemSettingsFromFileSD(settingsFileName);
+    bool responseLFS = loadSystemSettingsLFS(settingsFileName);
+    bool responseSD = loadSystemSettingsSD(settingsFileName);
 
     // If this is an empty/new profile slot, overwrite our current settings with defaults
     if (responseLFS == false && responseSD == false)
@@ -343,6 +343,7 @@ void factoryReset(bool alreadyHasSemaphore)
         {
             // Remove this specific settings file. Don't remove the other profiles.
             sd->remove(settingsFileName);
+            settingsSnapshotRemoveSD(settingsFileName);
 
             sd->remove(stationCoordinateECEFFileName); // Remove station files
             sd->remove(stationCoordinateGeodeticFileName);
@@ -966,7 +967,7 @@ void terminalUpdate()
             // Push RTCM to GNSS module over I2C / SPI
             if (correctionLastSeen(CORR_USB))
             {
-                gnss->pushRawData((uint8_t *)buffer, length);
+                correctionPushRawData(CORR_USB, (uint8_t *)buffer, length, true);
                 sempParseNextBytes(rtcmParse, (uint8_t *)buffer, length); // Parse the data for RTCM1005/1006
             }
         }
@@ -988,7 +989,7 @@ void terminalUpdate()
             // Push RTCM to GNSS module over I2C / SPI
             if (correctionLastSeen(CORR_USB))
             {
-                gnss->pushRawData((uint8_t *)buffer, length);
+                correctionPushRawData(CORR_USB, (uint8_t *)buffer, length, true);
                 sempParseNextBytes(rtcmParse, (uint8_t *)buffer, length); // Parse the data for RTCM1005/1006
             }
         }
@@ -1213,11 +1213,17 @@ void menuOperation()
         systemPrintln(settings.serialTimeoutGNSS);
 
         systemPrint("3) GNSS Handler Buffer Size: ");
-        systemPrintln(settings.gnssHandlerBufferSize);
+        systemPrint(settings.gnssHandlerBufferSize);
+        if (ringBufferSize && (ringBufferSize != settings.gnssHandlerBufferSize))
+            systemPrintf(" (using %d)", ringBufferSize);
+        systemPrintln();
 
         systemPrint("4) GNSS Serial RX Full Threshold: ");
         systemPrintln(settings.serialGNSSRxFullThreshold);
 
+        systemPrintf("5) GNSS Handler Buffer Auto Size: %s (worst SD stall %d ms)\r\n",
+                     settings.gnssHandlerBufferAutoSize ? "Enabled" : "Disabled", settings.gnssHandlerWorstStallMsec);
+
         // SPI
         systemPrint("6) SPI/SD Interface Frequency: ");
         systemPrint(settings.spiFrequency);
@@ -1234,6 +1240,10 @@ void menuOperation()
         systemPrint("9) UART Receive Buffer Size: ");
         systemPrintln(settings.uartReceiveBufferSize);
 
+        // RTCM
+        systemPrint("10) RTCM Buffer Entries: ");
+        systemPrintln(settings.rtcmConsumerBufferEntries);
+
         // PPL Float Lock timeout
         systemPrint("11) Set PPL RTK Fix Timeout (seconds): ");
         if (settings.pplFixTimeoutS > 0)
@@ -1268,6 +1278,33 @@ void menuOperation()
         systemPrint("55) GNSS Read Task Priority: ");
         systemPrintln(settings.gnssReadTaskPriority);
 
+        systemPrintf("56) GNSS Data Consumer Tasks: %s\r\n",
+                     settings.enableGnssDataConsumerTasks ? "Enabled" : "Disabled");
+        systemPrint("57) GNSS Data Consumer Task Core: ");
+        systemPrintln(settings.gnssDataConsumerTaskCore);
+        systemPrint("58) GNSS Data Consumer Task Priority: ");
+        systemPrintln(settings.gnssDataConsumerTaskPriority);
+
+        systemPrint("59) NTRIP Server Task Core: ");
+        systemPrintln(settings.ntripServerTaskCore);
+        systemPrint("60) NTRIP Server Task Priority: ");
+        systemPrintln(settings.ntripServerTaskPriority);
+
+        systemPrint("61) Correction Mux Task Core: ");
+        systemPrintln(settings.correctionMuxTaskCore);
+        systemPrint("62) Correction Mux Task Priority: ");
+        systemPrintln(settings.correctionMuxTaskPriority);
+
+        systemPrint("63) LoRa TX Task Core: ");
+        systemPrintln(settings.loraTxTaskCore);
+        systemPrint("64) LoRa TX Task Priority: ");
+        systemPrintln(settings.loraTxTaskPriority);
+
+        systemPrint("65) SD Log Task Core: ");
+        systemPrintln(settings.sdLogTaskCore);
+        systemPrint("66) SD Log Task Priority: ");
+        systemPrintln(settings.sdLogTaskPriority);
+
         systemPrintln("x) Exit");
 
         byte incoming = getUserInputCharacterNumber();
@@ -1304,6 +1341,19 @@ void menuOperation()
         {
             getNewSetting("Enter Serial GNSS RX Full Threshold", 1, 127, &settings.serialGNSSRxFullThreshold);
         }
+        else if (incoming == 5)
+        {
+            systemPrintln("Warning: changing the Handler Buffer Auto Size will restart the device.");
+            settings.gnssHandlerBufferAutoSize ^= 1;
+
+            // Stop the GNSS UART tasks to prevent the system from crashing
+            tasksStopGnssUart();
+
+            recordSystemSettings();
+
+            // Reboot the system
+            ESP.restart();
+        }
 
         else if (incoming == 6)
         {
@@ -1328,6 +1378,20 @@ void menuOperation()
                 ESP.restart();
             }
         }
+        else if (incoming == 10)
+        {
+            systemPrintln("Warning: changing the RTCM Buffer Entries will restart the device.");
+
+            if (getNewSetting("Enter number of RTCM Buffer Entries", 8, 1024, &settings.rtcmConsumerBufferEntries) ==
+                INPUT_RESPONSE_VALID)
+            {
+                // Stop the GNSS UART tasks to prevent the system from crashing
+                tasksStopGnssUart();
+
+                recordSystemSettings();
+                ESP.restart();
+            }
+        }
         else if (incoming == 11)
         {
             getNewSetting("Enter number of seconds in RTK float using PPL, before reset", 0, 3600,
@@ -1373,6 +1437,51 @@ void menuOperation()
         {
             getNewSetting("Enter GNSS Read Task Priority", 0, 3, &settings.gnssReadTaskPriority);
         }
+        else if (incoming == 56)
+        {
+            settings.enableGnssDataConsumerTasks ^= 1;
+            systemPrintln("GNSS data consumer task changes take effect after a restart");
+        }
+        else if (incoming == 57)
+        {
+            getNewSetting("Enter GNSS Data Consumer Task Core", 0, 1, &settings.gnssDataConsumerTaskCore);
+        }
+        else if (incoming == 58)
+        {
+            getNewSetting("Enter GNSS Data Consumer Task Priority", 0, 3, &settings.gnssDataConsumerTaskPriority);
+        }
+        else if (incoming == 59)
+        {
+            getNewSetting("Enter NTRIP Server Task Core", 0, 1, &settings.ntripServerTaskCore);
+        }
+        else if (incoming == 60)
+        {
+            getNewSetting("Enter NTRIP Server Task Priority", 0, 3, &settings.ntripServerTaskPriority);
+        }
+        else if (incoming == 61)
+        {
+            getNewSetting("Enter Correction Mux Task Core", 0, 1, &settings.correctionMuxTaskCore);
+        }
+        else if (incoming == 62)
+        {
+            getNewSetting("Enter Correction Mux Task Priority", 0, 3, &settings.correctionMuxTaskPriority);
+        }
+        else if (incoming == 63)
+        {
+            getNewSetting("Enter LoRa TX Task Core", 0, 1, &settings.loraTxTaskCore);
+        }
+        else if (incoming == 64)
+        {
+            getNewSetting("Enter LoRa TX Task Priority", 0, 3, &settings.loraTxTaskPriority);
+        }
+        else if (incoming == 65)
+        {
+            getNewSetting("Enter SD Log Task Core", 0, 1, &settings.sdLogTaskCore);
+        }
+        else if (incoming == 66)
+        {
+            getNewSetting("Enter SD Log Task Priority", 0, 3, &settings.sdLogTaskPriority);
+        }
 
         // Menu exit control
         else if (incoming == 'x')
@@ -63,6 +63,7 @@ typedef enum {
     tCnRtRtR,
 
     tNSCEn,
+    tRtcmLnk,
 
     // Add new settings types above <---------------->
     // (Maintain the enum of existing settings types!)
@@ -516,6 +517,8 @@ typedef struct WiFiNetwork
 
 typedef uint16_t RING_BUFFER_OFFSET;
 
+#define GNSS_DATA_FILTER_LENGTH 64 // Per-consumer message filter string, see gnssDataFilterCompile
+
 // Radio status LED goes from off (LED off), no connection (blinking), to connected (solid)
 typedef enum
 {
@@ -716,6 +719,18 @@ enum
 };
 
 typedef uint8_t NETCONSUMER_t;
+
+// RTCM consumers with their own message rules, see RtcmLinks.ino
+enum
+{
+    RTCM_LINK_NTRIP_SERVER = 0,
+    RTCM_LINK_NTRIP_SERVER_MAX = RTCM_LINK_NTRIP_SERVER + NTRIP_SERVER_MAX,
+    RTCM_LINK_LORA = RTCM_LINK_NTRIP_SERVER_MAX,
+    RTCM_LINK_ESPNOW,
+    // Add new links just before this line
+    // Also add them to rtcmLinkNames
+    RTCM_LINK_MAX
+};
 typedef uint16_t NETCONSUMER_MASK_t;
 
 enum PP_NickName
@@ -769,6 +784,13 @@ struct Settings
     bool useMSM7 = false;
     int rtcmMinElev = -90; // LG290P - minimum elevation for RTCM (PQTMCFGRTCM)
 
+    // RTCM rules for each link (NTRIP servers, LoRa, ESP-NOW), indexed by RTCM_LINK_xxx
+    uint16_t rtcmLinkBudget[RTCM_LINK_MAX] = {0};              // Bytes per second, 0 = no limit
+    uint16_t rtcmLinkGlonassInterval[RTCM_LINK_MAX] = {0};     // Seconds between GLONASS MSM, 0 = every epoch
+    uint16_t rtcmLinkMsm4[RTCM_LINK_MAX] = {0};                // 1 = Send MSM7 as MSM4
+    uint16_t rtcmLinkObservationInterval[RTCM_LINK_MAX] = {0}; // Seconds between MSM epochs, 0 = every epoch
+    uint16_t rtcmLinkStationInterval[RTCM_LINK_MAX] = {0};     // Seconds between station messages, 0 = all
+
     // Battery
     bool enablePrintBatteryMessages = true;
     uint32_t shutdownNoChargeTimeoutMinutes = 0; // If > 0, shut down unit after timeout if not charging
@@ -798,6 +820,7 @@ struct Settings
     bool enableEspNow = false;
     uint8_t espnowPeerCount = 0;
     uint8_t espnowPeers[ESPNOW_MAX_PEERS][6] = {0}; // Contains the MAC addresses (6 bytes) of paired units
+    bool espnowRtcmFraming = false; // Send the RTCM header, set by pairing when all paired radios support it
 
     // Ethernet
     bool enablePrintEthernetDiag = false;
@@ -842,6 +865,7 @@ struct Settings
     bool enablePrintLogFileStatus = true;
     int maxLogLength_minutes = 60 * 24; // Default to 24 hours
     int maxLogTime_minutes = 60 * 24;   // Default to 24 hours
+    int sdLogBufferSize = 1024 * 32;    // Each of the two PSRAM buffers used by sdLogTask, 0 = write from the ring buffer
 
     // MQTT
     bool debugMqttClientData = false;  // Debug the MQTT SPARTAN data flow
@@ -945,11 +969,23 @@ struct Settings
         1;                         // Core where hardware is started and interrupts are assigned to, 0=core, 1=Arduino
     uint8_t btReadTaskCore = 1;             // Core where task should run, 0=core, 1=Arduino
     uint8_t btReadTaskPriority = 1; // Read from BT SPP and Write to GNSS. 3 being the highest, and 0 being the lowest
+    uint8_t correctionMuxTaskCore = 1;     // Core where task should run, 0=core, 1=Arduino
+    uint8_t correctionMuxTaskPriority = 1; // Write the selected correction source to the GNSS
     bool debugMalloc = false;
+    bool enableGnssDataConsumerTasks = false; // Service each ring buffer consumer (SD, TCP, BT) from its own task
     bool enableHeapReport = false; // Turn on to display free heap
     bool enablePrintIdleTime = false;
     bool enablePsram = true; // Control the use on onboard PSRAM. Used for testing behavior when PSRAM is not available.
     bool enableTaskReports = false;                       // Turn on to display task high water marks
+    uint8_t gnssDataConsumerTaskCore = 1;     // Core where the consumer tasks should run, 0=core, 1=Arduino
+    uint8_t gnssDataConsumerTaskPriority = 1; // Read from the circular buffer and write to a single end point
+    char gnssDataFilterBle[GNSS_DATA_FILTER_LENGTH] = "";       // Messages sent to each consumer, empty = all, see
+    char gnssDataFilterBluetooth[GNSS_DATA_FILTER_LENGTH] = ""; // gnssDataFilterCompile, Ex: NMEA,RTCM_1005,UBX_02_15
+    char gnssDataFilterSdCard[GNSS_DATA_FILTER_LENGTH] = "";
+    char gnssDataFilterTcpClient[GNSS_DATA_FILTER_LENGTH] = "";
+    char gnssDataFilterTcpServer[GNSS_DATA_FILTER_LENGTH] = "";
+    char gnssDataFilterUdpServer[GNSS_DATA_FILTER_LENGTH] = "";
+    char gnssDataFilterUsbSerial[GNSS_DATA_FILTER_LENGTH] = "";
     uint8_t gnssReadTaskCore = 1;           // Core where task should run, 0=core, 1=Arduino
     uint8_t gnssReadTaskPriority =
         1; // Read from GNSS and Write to circular buffer (SD, TCP, BT). 3 being the highest, and 0 being the lowest
@@ -959,13 +995,19 @@ struct Settings
     uint8_t handleGnssDataTaskCore = 1;     // Core where task should run, 0=core, 1=Arduino
     uint8_t handleGnssDataTaskPriority = 1; // Read from the circular buffer and dole out to end points (SD, TCP, BT).
     uint8_t i2cInterruptsCore = 1; // Core where hardware is started and interrupts are assigned to, 0=core, 1=Arduino
+    uint8_t loraTxTaskCore = 1;     // Core where task should run, 0=core, 1=Arduino
+    uint8_t loraTxTaskPriority = 1; // Send the RTCM epoch to the LoRa radio on Torch
     uint8_t measurementScale = MEASUREMENT_UNITS_METERS;
+    uint8_t ntripServerTaskCore = 1;     // Core where the NTRIP server writer tasks should run, 0=core, 1=Arduino
+    uint8_t ntripServerTaskPriority = 1; // Write the RTCM backlog to a single NTRIP caster
     bool printBootTimes = false; // Print times and deltas during boot
     bool printPartitionTable = false;
     bool printTaskStartStop = false;
     uint16_t psramMallocLevel = 40; // By default, push as much as possible to PSRAM. Needed to do secure WiFi (MQTT) + BT + PPL
     uint32_t rebootMinutes = 0; // Disabled, reboots after uptime reaches this number of minutes
     int resetCount = 0;
+    uint8_t sdLogTaskCore = 1;     // Core where task should run, 0=core, 1=Arduino
+    uint8_t sdLogTaskPriority = 1; // Write the GNSS data from the PSRAM log buffers to the SD card
 
     // Periodic Display
     PeriodicDisplay_t periodicDisplay = (PeriodicDisplay_t)0; //Turn off all periodic debug displays by default.
@@ -1014,6 +1056,9 @@ struct Settings
     bool enablePrintRingBufferOffsets = false;
     int gnssHandlerBufferSize =
         1024 * 4; // This buffer is filled from the UART receive buffer, and is then written to SD
+    bool gnssHandlerBufferAutoSize = false; // Size the ring buffer from the GNSS data rate and the worst SD card stall
+    uint16_t gnssHandlerWorstStallMsec = 0; // Longest SD card write during the previous session, used by auto size
+    uint16_t rtcmConsumerBufferEntries = 64; // References to the RTCM messages in the ring buffer, rounded to a power of 2
 
     // Rover operation
     uint8_t dynamicModel = 254; // Default will be applied by checkGNSSArrayDefaults
@@ -1161,6 +1206,7 @@ struct Settings
 
     bool debugLora = false;
     bool enableLora = false;
+    int loraAirDataRate_bps = 0; // Pace the RTCM bursts to the radio's over-the-air data rate, 0 = no pacing
     float loraCoordinationFrequency = 910.000;
     int loraSerialInteractionTimeout_s = 30; // Seconds without user serial that must elapse before LoRa radio goes into dedicated listening mode
     bool loraSaveSettingsToFlash = false; // Passed to LoRa (>= 3.0.1) as AT+SAVE= . When true, updated settings are saved at each AT+TRANS
@@ -1180,6 +1226,7 @@ struct Settings
 #endif // COMPILE_LG290P
 
     bool debugSettings = false;
+    bool settingsTextExport = true; // Write the clear text settings file along with the binary settings snapshot
     bool enableNtripCaster = false; //When true, respond as a faux NTRIP Caster to incoming TCP connections
     bool baseCasterOverride = false; //When true, user has put device into 'BaseCast' mode. Change settings, but don't save to NVM.
     bool debugCLI = false; //When true, output BLE CLI interactions over serial
@@ -1224,6 +1271,7 @@ typedef enum
 typedef bool (* AFTER_CMD)(const char *settingName, void *settingData, int settingType);
 
 // Forward routines
+bool gnssDataFilterAfterCommand(const char *settingName, void *settingData, int settingType);
 bool wifiAfterCommand(const char *settingName, void *settingData, int settingType);
 
 typedef struct
@@ -1357,6 +1405,11 @@ const RTK_Settings_Entry rtkSettingsEntries[] =
     { 0, 1, 0, 1, 0, 1, 1, ALL, 1, _float,    1, & settings.surveyInStartingAccuracy, "surveyInStartingAccuracy", nullptr, },
     { 1, 1, 0, 0, 0, 0, 1, MSM, 1, _bool,     0, & settings.useMSM7, "useMSM7",  nullptr, },
     { 1, 1, 0, 0, 0, 0, 1, MSM, 1, _int,      0, & settings.rtcmMinElev, "rtcmMinElev",  nullptr, },
+    { 0, 1, 1, 1, 1, 1, 1, ALL, 1, tRtcmLnk,  RTCM_LINK_MAX, & settings.rtcmLinkBudget[0], "rtcmLinkBudget_", nullptr, },
+    { 0, 1, 1, 1, 1, 1, 1, ALL, 1, tRtcmLnk,  RTCM_LINK_MAX, & settings.rtcmLinkGlonassInterval[0], "rtcmLinkGlonassInterval_", nullptr, },
+    { 0, 1, 1, 1, 1, 1, 1, ALL, 1, tRtcmLnk,  RTCM_LINK_MAX, & settings.rtcmLinkMsm4[0], "rtcmLinkMsm4_", nullptr, },
+    { 0, 1, 1, 1, 1, 1, 1, ALL, 1, tRtcmLnk,  RTCM_LINK_MAX, & settings.rtcmLinkObservationInterval[0], "rtcmLinkObservationInterval_", nullptr, },
+    { 0, 1, 1, 1, 1, 1, 1, ALL, 1, tRtcmLnk,  RTCM_LINK_MAX, & settings.rtcmLinkStationInterval[0], "rtcmLinkStationInterval_", nullptr, },
 
     // Battery
     { 0, 0, 0, 0, 1, 1, 1, ALL, 1, _bool,     0, & settings.enablePrintBatteryMessages, "enablePrintBatteryMessages", nullptr, },
@@ -1417,6 +1470,7 @@ const RTK_Settings_Entry rtkSettingsEntries[] =
     { 1, 1, 0, 1, 1, 1, 1, ALL, 1, _bool,     0, & settings.enableEspNow, "enableEspNow", nullptr, },
     { 1, 1, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.espnowPeerCount, "espnowPeerCount", nullptr, },
     { 1, 1, 1, 1, 1, 1, 1, ALL, 1, tEspNowPr, ESPNOW_MAX_PEERS, & settings.espnowPeers[0][0], "espnowPeer_", nullptr, },
+    { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _bool,     0, & settings.espnowRtcmFraming, "espnowRtcmFraming", nullptr, },
 
 //                F
 //    i           a
@@ -1487,6 +1541,7 @@ const RTK_Settings_Entry rtkSettingsEntries[] =
     { 0, 0, 0, 1, 1, 0, 1, ALL, 0, _bool,     0, & settings.enablePrintLogFileStatus, "enablePrintLogFileStatus", nullptr, },
     { 1, 1, 0, 1, 1, 0, 1, ALL, 0, _int,      0, & settings.maxLogLength_minutes, "maxLogLength", nullptr, },
     { 1, 1, 0, 1, 1, 0, 1, ALL, 0, _int,      0, & settings.maxLogTime_minutes, "maxLogTime", nullptr, },
+    { 0, 1, 0, 1, 1, 0, 1, ALL, 0, _int,      0, & settings.sdLogBufferSize, "sdLogBufferSize", nullptr, },
 
     // Mosaic
 #ifdef  COMPILE_MOSAICX5
@@ -1584,11 +1639,23 @@ const RTK_Settings_Entry rtkSettingsEntries[] =
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.bluetoothInterruptsCore, "bluetoothInterruptsCore", nullptr, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.btReadTaskCore, "btReadTaskCore", nullptr, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.btReadTaskPriority, "btReadTaskPriority", nullptr, },
+    { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.correctionMuxTaskCore, "correctionMuxTaskCore", nullptr, },
+    { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.correctionMuxTaskPriority, "correctionMuxTaskPriority", nullptr, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _bool,     0, & settings.debugMalloc, "debugMalloc", nullptr, },
+    { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _bool,     0, & settings.enableGnssDataConsumerTasks, "enableGnssDataConsumerTasks", nullptr, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _bool,     0, & settings.enableHeapReport, "enableHeapReport", nullptr, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _bool,     0, & settings.enablePrintIdleTime, "enablePrintIdleTime", nullptr, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _bool,     0, & settings.enablePsram, "enablePsram", nullptr, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _bool,     0, & settings.enableTaskReports, "enableTaskReports", nullptr, },
+    { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.gnssDataConsumerTaskCore, "gnssDataConsumerTaskCore", nullptr, },
+    { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.gnssDataConsumerTaskPriority, "gnssDataConsumerTaskPriority", nullptr, },
+    { 0, 1, 0, 1, 1, 1, 1, ALL, 1, tCharArry, sizeof(settings.gnssDataFilterBle), & settings.gnssDataFilterBle, "gnssDataFilterBle", gnssDataFilterAfterCommand, },
+    { 0, 1, 0, 1, 1, 1, 1, ALL, 1, tCharArry, sizeof(settings.gnssDataFilterBluetooth), & settings.gnssDataFilterBluetooth, "gnssDataFilterBluetooth", gnssDataFilterAfterCommand, },
+    { 0, 1, 0, 1, 1, 1, 1, ALL, 1, tCharArry, sizeof(settings.gnssDataFilterSdCard), & settings.gnssDataFilterSdCard, "gnssDataFilterSdCard", gnssDataFilterAfterCommand, },
+    { 0, 1, 0, 1, 1, 1, 1, ALL, 1, tCharArry, sizeof(settings.gnssDataFilterTcpClient), & settings.gnssDataFilterTcpClient, "gnssDataFilterTcpClient", gnssDataFilterAfterCommand, },
+    { 0, 1, 0, 1, 1, 1, 1, ALL, 1, tCharArry, sizeof(settings.gnssDataFilterTcpServer), & settings.gnssDataFilterTcpServer, "gnssDataFilterTcpServer", gnssDataFilterAfterCommand, },
+    { 0, 1, 0, 1, 1, 1, 1, ALL, 1, tCharArry, sizeof(settings.gnssDataFilterUdpServer), & settings.gnssDataFilterUdpServer, "gnssDataFilterUdpServer", gnssDataFilterAfterCommand, },
+    { 0, 1, 0, 1, 1, 1, 1, ALL, 1, tCharArry, sizeof(settings.gnssDataFilterUsbSerial), & settings.gnssDataFilterUsbSerial, "gnssDataFilterUsbSerial", gnssDataFilterAfterCommand, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.gnssReadTaskCore, "gnssReadTaskCore", nullptr, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.gnssReadTaskPriority, "gnssReadTaskPriority", nullptr, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.gnssUartInterruptsCore, "gnssUartInterruptsCore", nullptr, },
@@ -1596,13 +1663,19 @@ const RTK_Settings_Entry rtkSettingsEntries[] =
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.handleGnssDataTaskCore, "handleGnssDataTaskCore", nullptr, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.handleGnssDataTaskPriority, "handleGnssDataTaskPriority", nullptr, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.i2cInterruptsCore, "i2cInterruptsCore", nullptr, },
+    { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.loraTxTaskCore, "loraTxTaskCore", nullptr, },
+    { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.loraTxTaskPriority, "loraTxTaskPriority", nullptr, },
     { 0, 1, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.measurementScale, "measurementScale", nullptr, }, //Don't show on Config
+    { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.ntripServerTaskCore, "ntripServerTaskCore", nullptr, },
+    { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.ntripServerTaskPriority, "ntripServerTaskPriority", nullptr, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _bool,     0, & settings.printBootTimes, "printBootTimes", nullptr, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _bool,     0, & settings.printPartitionTable, "printPartitionTable", nullptr, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _bool,     0, & settings.printTaskStartStop, "printTaskStartStop", nullptr, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint16_t, 0, & settings.psramMallocLevel, "psramMallocLevel", nullptr, },
     { 1, 1, 0, 1, 1, 1, 1, ALL, 1, _uint32_t, 0, & settings.rebootMinutes, "rebootMinutes", nullptr, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _int,      0, & settings.resetCount, "resetCount", nullptr, },
+    { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.sdLogTaskCore, "sdLogTaskCore", nullptr, },
+    { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint8_t,  0, & settings.sdLogTaskPriority, "sdLogTaskPriority", nullptr, },
 
     // Periodic Display
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, tPerDisp,  0, & settings.periodicDisplay, "periodicDisplay", nullptr, },
@@ -1652,6 +1725,9 @@ const RTK_Settings_Entry rtkSettingsEntries[] =
     // Ring Buffer
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _bool,     0, & settings.enablePrintRingBufferOffsets, "enablePrintRingBufferOffsets", nullptr, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _int,      0, & settings.gnssHandlerBufferSize, "gnssHandlerBufferSize", nullptr, },
+    { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _bool,     0, & settings.gnssHandlerBufferAutoSize, "gnssHandlerBufferAutoSize", nullptr, },
+    { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint16_t, 0, & settings.gnssHandlerWorstStallMsec, "gnssHandlerWorstStallMsec", nullptr, },
+    { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _uint16_t, 0, & settings.rtcmConsumerBufferEntries, "rtcmConsumerBufferEntries", nullptr, },
 
     // Rover operation
     { 1, 1, 0, 1, 1, 1, 0, ALL, 0, _uint8_t,  0, & settings.dynamicModel, "dynamicModel", nullptr, },
@@ -1805,6 +1881,7 @@ const RTK_Settings_Entry rtkSettingsEntries[] =
     // LoRa
     { 0, 0, 0, 0, 0, 1, 0, ALL, 0, _bool,     3, & settings.debugLora, "debugLora", nullptr, },
     { 1, 1, 0, 0, 0, 1, 0, ALL, 0, _bool,     0, & settings.enableLora, "enableLora", nullptr, },
+    { 0, 1, 0, 0, 0, 1, 0, ALL, 0, _int,      0, & settings.loraAirDataRate_bps, "loraAirDataRate", nullptr, },
     { 1, 1, 0, 0, 0, 1, 0, ALL, 0, _float,    3, & settings.loraCoordinationFrequency, "loraCoordinationFrequency", nullptr, },
     { 0, 1, 0, 0, 0, 1, 0, ALL, 0, _bool,     0, & settings.loraSaveSettingsToFlash, "loraSaveSettingsToFlash", nullptr, },
     { 1, 1, 0, 0, 0, 1, 0, NON, 0, _int,      0, & settings.loraSerialInteractionTimeout_s, "loraSerialInteractionTimeout", nullptr, },
@@ -1831,6 +1908,7 @@ const RTK_Settings_Entry rtkSettingsEntries[] =
 #endif  // COMPILE_LG290P
 
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _bool,     0, & settings.debugSettings, "debugSettings", nullptr, },
+    { 0, 1, 0, 1, 1, 1, 1, ALL, 1, _bool,     0, & settings.settingsTextExport, "settingsTextExport", nullptr, },
     { 1, 1, 0, 1, 1, 1, 1, ALL, 1, _bool,     0, & settings.enableNtripCaster, "enableNtripCaster", nullptr, },
     { 0, 1, 0, 1, 1, 1, 1, ALL, 1, _bool,     0, & settings.baseCasterOverride, "baseCasterOverride", nullptr, },
     { 0, 0, 0, 1, 1, 1, 1, ALL, 1, _bool,     0, & settings.debugCLI, "debugCLI", nullptr, },
@@ -2079,10 +2157,13 @@ struct struct_tasks
     volatile bool bluetoothCommandTaskRunning = false;
     volatile bool btReadTaskRunning = false;
     volatile bool buttonCheckTaskRunning = false;
+    volatile bool correctionMuxTaskRunning = false;
     volatile bool gnssReadTaskRunning = false;
     volatile bool handleGnssDataTaskRunning = false;
     volatile bool idleTask0Running = false;
     volatile bool idleTask1Running = false;
+    volatile bool loraTxTaskRunning = false;
+    volatile bool sdLogTaskRunning = false;
     volatile bool sdSizeCheckTaskRunning = false;
     volatile bool updatePplTaskRunning = false;
     volatile bool updateWebServerTaskRunning = false;
@@ -2090,8 +2171,12 @@ struct struct_tasks
     bool bluetoothCommandTaskStopRequest = false;
     bool btReadTaskStopRequest = false;
     bool buttonCheckTaskStopRequest = false;
+    bool correctionMuxTaskStopRequest = false;
+    bool gnssDataConsumerTaskStopRequest = false;
     bool gnssReadTaskStopRequest = false;
     bool handleGnssDataTaskStopRequest = false;
+    bool loraTxTaskStopRequest = false;
+    bool sdLogTaskStopRequest = false;
     bool sdSizeCheckTaskStopRequest = false;
     bool updatePplTaskStopRequest = false;
     bool updateWebServerTaskStopRequest = false;
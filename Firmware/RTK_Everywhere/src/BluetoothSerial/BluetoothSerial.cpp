@@ -28,6 +28,8 @@
   * Add aclConnected() and aclGetAddress()
   * Remove ARDUHAL_LOG_LEVEL guards from bda2str. 
   * Remove static from bda2str.
+  * Replace the per-byte _spp_rx_queue with the _spp_rx_buffer byte ring, add read(buffer, size) and rxOverflow()
+  * Replace the malloc in _spp_queue_packet with the _spp_tx_pool packets
 */
 
 #include "freertos/FreeRTOS.h"
@@ -65,8 +67,8 @@ const char *_spp_server_name = "ESP32SPP";
 #define SPP_CONGESTED_TIMEOUT 1000
 
 static uint32_t _spp_client = 0;
-static QueueHandle_t _spp_rx_queue = NULL;
 static QueueHandle_t _spp_tx_queue = NULL;
+static QueueHandle_t _spp_tx_free_queue = NULL; // Unused packets from _spp_tx_pool
 static SemaphoreHandle_t _spp_tx_done = NULL;
 static TaskHandle_t _spp_task_handle = NULL;
 static EventGroupHandle_t _spp_event_group = NULL;
@@ -124,12 +126,122 @@ static uint8_t _aclAddress[ESP_BD_ADDR_LEN];
 #define BT_SDP_RUNNING 0x04
 #define BT_SDP_COMPLETED 0x08
 
+const uint16_t SPP_TX_MAX = 330;
+
 typedef struct
 {
     size_t len;
-    uint8_t data[];
+    uint8_t data[SPP_TX_MAX];
 } spp_packet_t;
 
+// TX packets are allocated once in _init_bt, the writes larger than
+// SPP_TX_MAX are split across multiple packets.  txQueueSize is a byte
+// count, the pool holds txQueueSize / SPP_TX_MAX packets within the limits.
+#define SPP_TX_POOL_MINIMUM 8  // Packets, 2640 bytes
+#define SPP_TX_POOL_MAXIMUM 50 // Packets, 16500 bytes
+static spp_packet_t *_spp_tx_pool = NULL;
+
+// RX byte ring, written by esp_spp_cb and read by the application.  The head
+// and tail are published with __atomic operations so the single producer and
+// single consumer do not need a lock.
+static uint8_t *_spp_rx_buffer = NULL;
+static size_t _spp_rx_buffer_size = 0;          // One byte more than the ring holds
+static volatile size_t _spp_rx_head = 0;        // Next byte written by esp_spp_cb
+static volatile size_t _spp_rx_tail = 0;        // Next byte read by the application
+static volatile uint32_t _spp_rx_overflow = 0;  // Bytes discarded because the ring was full
+static SemaphoreHandle_t _spp_rx_ready = NULL;  // Given when data is added to the ring
+
+// Determine the number of bytes in the RX ring
+static size_t _spp_rx_available()
+{
+    size_t head = __atomic_load_n(&_spp_rx_head, __ATOMIC_ACQUIRE);
+    size_t tail = _spp_rx_tail;
+    if (!_spp_rx_buffer)
+    {
+        return 0;
+    }
+    return (head >= tail) ? head - tail : head + _spp_rx_buffer_size - tail;
+}
+
+// Add the received data to the RX ring, returns the number of bytes added
+static size_t _spp_rx_write(const uint8_t *data, size_t len)
+{
+    size_t head = _spp_rx_head;
+    size_t tail = __atomic_load_n(&_spp_rx_tail, __ATOMIC_ACQUIRE);
+    size_t space = (tail > head) ? tail - head - 1 : _spp_rx_buffer_size - head + tail - 1;
+    size_t bytes;
+
+    if (len > space)
+    {
+        len = space;
+    }
+    bytes = _spp_rx_buffer_size - head;
+    if (bytes > len)
+    {
+        bytes = len;
+    }
+    memcpy(&_spp_rx_buffer[head], data, bytes);
+    memcpy(_spp_rx_buffer, &data[bytes], len - bytes);
+    head += len;
+    if (head >= _spp_rx_buffer_size)
+    {
+        head -= _spp_rx_buffer_size;
+    }
+    __atomic_store_n(&_spp_rx_head, head, __ATOMIC_RELEASE);
+    return len;
+}
+
+// Copy data from the RX ring, remove the data from the ring unless peeking
+static size_t _spp_rx_read(uint8_t *buffer, size_t size, bool peek)
+{
+    size_t tail = _spp_rx_tail;
+    size_t len = _spp_rx_available();
+    size_t bytes;
+
+    if (len > size)
+    {
+        len = size;
+    }
+    if (len == 0)
+    {
+        return 0;
+    }
+    bytes = _spp_rx_buffer_size - tail;
+    if (bytes > len)
+    {
+        bytes = len;
+    }
+    memcpy(buffer, &_spp_rx_buffer[tail], bytes);
+    memcpy(&buffer[bytes], _spp_rx_buffer, len - bytes);
+    if (!peek)
+    {
+        tail += len;
+        if (tail >= _spp_rx_buffer_size)
+        {
+            tail -= _spp_rx_buffer_size;
+        }
+        __atomic_store_n(&_spp_rx_tail, tail, __ATOMIC_RELEASE);
+    }
+    return len;
+}
+
+// Wait for data to arrive in the RX ring
+static bool _spp_rx_wait(TickType_t ticks)
+{
+    TickType_t start = xTaskGetTickCount();
+    TickType_t elapsed;
+
+    while (_spp_rx_available() == 0)
+    {
+        elapsed = xTaskGetTickCount() - start;
+        if (!_spp_rx_ready || (elapsed >= ticks) || (xSemaphoreTake(_spp_rx_ready, ticks - elapsed) != pdTRUE))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 char *bda2str(esp_bd_addr_t bda, char *str, size_t size)
 {
     if (bda == NULL || str == NULL || size < 18)
@@ -168,31 +280,41 @@ static bool get_name_from_eir(uint8_t *eir, char *bdname, uint8_t *bdname_len)
     return false;
 }
 
-static esp_err_t _spp_queue_packet(uint8_t *data, size_t len)
+// Queue the data in pool packets, returns the number of bytes queued
+static size_t _spp_queue_packet(const uint8_t *data, size_t len)
 {
+    spp_packet_t *packet;
+    size_t queued = 0;
+
     if (!data || !len)
     {
         log_w("No data provided");
-        return ESP_OK;
-    }
-    spp_packet_t *packet = (spp_packet_t *)malloc(sizeof(spp_packet_t) + len);
-    if (!packet)
-    {
-        log_e("SPP TX Packet Malloc Failed!");
-        return ESP_FAIL;
+        return 0;
     }
-    packet->len = len;
-    memcpy(packet->data, data, len);
-    if (!_spp_tx_queue || xQueueSend(_spp_tx_queue, &packet, SPP_TX_QUEUE_TIMEOUT) != pdPASS)
+    while (queued < len)
     {
-        log_e("SPP TX Queue Send Failed!");
-        free(packet);
-        return ESP_FAIL;
+        if (!_spp_tx_free_queue || xQueueReceive(_spp_tx_free_queue, &packet, SPP_TX_QUEUE_TIMEOUT) != pdTRUE)
+        {
+            log_e("SPP TX Packet Pool Empty!");
+            break;
+        }
+        packet->len = len - queued;
+        if (packet->len > SPP_TX_MAX)
+        {
+            packet->len = SPP_TX_MAX;
+        }
+        memcpy(packet->data, &data[queued], packet->len);
+        if (!_spp_tx_queue || xQueueSend(_spp_tx_queue, &packet, SPP_TX_QUEUE_TIMEOUT) != pdPASS)
+        {
+            log_e("SPP TX Queue Send Failed!");
+            xQueueSend(_spp_tx_free_queue, &packet, 0);
+            break;
+        }
+        queued += packet->len;
     }
-    return ESP_OK;
+    return queued;
 }
 
-const uint16_t SPP_TX_MAX = 330;
 static uint8_t _spp_tx_buffer[SPP_TX_MAX];
 static uint16_t _spp_tx_buffer_len = 0;
 
@@ -238,7 +360,7 @@ static void _spp_tx_task(void *arg)
             {
                 memcpy(_spp_tx_buffer + _spp_tx_buffer_len, packet->data, packet->len);
                 _spp_tx_buffer_len += packet->len;
-                free(packet);
+                xQueueSend(_spp_tx_free_queue, &packet, 0);
                 packet = NULL;
                 if (SPP_TX_MAX == _spp_tx_buffer_len || uxQueueMessagesWaiting(_spp_tx_queue) == 0)
                 {
@@ -279,7 +401,7 @@ static void _spp_tx_task(void *arg)
                         _spp_send_buffer();
                     }
                 }
-                free(packet);
+                xQueueSend(_spp_tx_free_queue, &packet, 0);
                 packet = NULL;
             }
         }
@@ -423,15 +545,17 @@ static void esp_spp_cb(esp_spp_cb_event_t event, esp_spp_cb_param_t *param)
         {
             custom_data_callback(param->data_ind.data, param->data_ind.len);
         }
-        else if (_spp_rx_queue != NULL)
+        else if (_spp_rx_buffer != NULL)
         {
-            for (int i = 0; i < param->data_ind.len; i++)
+            size_t added = _spp_rx_write(param->data_ind.data, param->data_ind.len);
+            if (added < param->data_ind.len)
             {
-                if (xQueueSend(_spp_rx_queue, param->data_ind.data + i, (TickType_t)0) != pdTRUE)
-                {
-                    Serial.printf("BluetoothSerial RX Full! Discarding %u bytes\r\n", param->data_ind.len - i);
-                    break;
-                }
+                _spp_rx_overflow += param->data_ind.len - added;
+                Serial.printf("BluetoothSerial RX Full! Discarding %u bytes\r\n", param->data_ind.len - added);
+            }
+            if (added)
+            {
+                xSemaphoreGive(_spp_rx_ready);
             }
         }
         break;
@@ -804,26 +928,63 @@ static bool _init_bt(const char *deviceName, bt_mode mode, uint16_t rxQueueSize,
         xEventGroupSetBits(_spp_event_group, SPP_DISCONNECTED);
         xEventGroupSetBits(_spp_event_group, SPP_CLOSED);
     }
-    if (_spp_rx_queue == NULL)
+    if (_spp_rx_buffer == NULL)
+    {
+        // The ring holds rxQueueSize bytes
+        _spp_rx_buffer_size = rxQueueSize + 1;
+        _spp_rx_head = 0;
+        _spp_rx_tail = 0;
+        _spp_rx_buffer = (uint8_t *)malloc(_spp_rx_buffer_size);
+        if (_spp_rx_buffer == NULL)
+        {
+            log_e("RX Buffer Malloc Failed");
+            return false;
+        }
+    }
+    if (_spp_rx_ready == NULL)
     {
-        //_spp_rx_queue = xQueueCreate(RX_QUEUE_SIZE, sizeof(uint8_t));  //initialize the queue
-        _spp_rx_queue = xQueueCreate(rxQueueSize, sizeof(uint8_t)); // initialize the queue
-        if (_spp_rx_queue == NULL)
+        _spp_rx_ready = xSemaphoreCreateBinary();
+        if (_spp_rx_ready == NULL)
         {
-            log_e("RX Queue Create Failed");
+            log_e("RX Semaphore Create Failed");
             return false;
         }
     }
+    // Convert the TX queue size in bytes into the number of pool packets
+    uint16_t txPackets = (txQueueSize + SPP_TX_MAX - 1) / SPP_TX_MAX;
+    if (txPackets < SPP_TX_POOL_MINIMUM)
+    {
+        txPackets = SPP_TX_POOL_MINIMUM;
+    }
+    if (txPackets > SPP_TX_POOL_MAXIMUM)
+    {
+        txPackets = SPP_TX_POOL_MAXIMUM;
+    }
     if (_spp_tx_queue == NULL)
     {
         //_spp_tx_queue = xQueueCreate(TX_QUEUE_SIZE, sizeof(spp_packet_t *));  //initialize the queue
-        _spp_tx_queue = xQueueCreate(txQueueSize, sizeof(spp_packet_t *)); // initialize the queue
+        _spp_tx_queue = xQueueCreate(txPackets, sizeof(spp_packet_t *)); // initialize the queue
         if (_spp_tx_queue == NULL)
         {
             log_e("TX Queue Create Failed");
             return false;
         }
     }
+    if (_spp_tx_free_queue == NULL)
+    {
+        _spp_tx_pool = (spp_packet_t *)malloc(txPackets * sizeof(spp_packet_t));
+        _spp_tx_free_queue = xQueueCreate(txPackets, sizeof(spp_packet_t *));
+        if ((_spp_tx_pool == NULL) || (_spp_tx_free_queue == NULL))
+        {
+            log_e("TX Packet Pool Create Failed");
+            return false;
+        }
+        for (int i = 0; i < txPackets; i++)
+        {
+            spp_packet_t *packet = &_spp_tx_pool[i];
+            xQueueSend(_spp_tx_free_queue, &packet, 0);
+        }
+    }
     if (_spp_tx_done == NULL)
     {
         _spp_tx_done = xSemaphoreCreateBinary();
@@ -974,22 +1135,33 @@ static bool _stop_bt()
         vEventGroupDelete(_spp_event_group);
         _spp_event_group = NULL;
     }
-    if (_spp_rx_queue)
+    if (_spp_rx_buffer)
+    {
+        free(_spp_rx_buffer);
+        _spp_rx_buffer = NULL;
+        _spp_rx_head = 0;
+        _spp_rx_tail = 0;
+    }
+    if (_spp_rx_ready)
     {
-        vQueueDelete(_spp_rx_queue);
-        // ToDo: clear RX queue when in packet mode
-        _spp_rx_queue = NULL;
+        vSemaphoreDelete(_spp_rx_ready);
+        _spp_rx_ready = NULL;
     }
     if (_spp_tx_queue)
     {
-        spp_packet_t *packet = NULL;
-        while (xQueueReceive(_spp_tx_queue, &packet, 0) == pdTRUE)
-        {
-            free(packet);
-        }
         vQueueDelete(_spp_tx_queue);
         _spp_tx_queue = NULL;
     }
+    if (_spp_tx_free_queue)
+    {
+        vQueueDelete(_spp_tx_free_queue);
+        _spp_tx_free_queue = NULL;
+    }
+    if (_spp_tx_pool)
+    {
+        free(_spp_tx_pool);
+        _spp_tx_pool = NULL;
+    }
     if (_spp_tx_done)
     {
         vSemaphoreDelete(_spp_tx_done);
@@ -1070,17 +1242,13 @@ bool BluetoothSerial::begin(String localName, bool isMaster, bool disableBLE, ui
 
 int BluetoothSerial::available(void)
 {
-    if (_spp_rx_queue == NULL)
-    {
-        return 0;
-    }
-    return uxQueueMessagesWaiting(_spp_rx_queue);
+    return _spp_rx_available();
 }
 
 int BluetoothSerial::peek(void)
 {
     uint8_t c;
-    if (_spp_rx_queue && xQueuePeek(_spp_rx_queue, &c, this->timeoutTicks))
+    if (_spp_rx_wait(this->timeoutTicks) && _spp_rx_read(&c, 1, true))
     {
         return c;
     }
@@ -1096,13 +1264,29 @@ int BluetoothSerial::read()
 {
 
     uint8_t c = 0;
-    if (_spp_rx_queue && xQueueReceive(_spp_rx_queue, &c, this->timeoutTicks))
+    if (_spp_rx_wait(this->timeoutTicks) && _spp_rx_read(&c, 1, false))
     {
         return c;
     }
     return -1;
 }
 
+/**
+ * Read the available bytes without waiting, returns the number of bytes read
+ */
+size_t BluetoothSerial::read(uint8_t *buffer, size_t size)
+{
+    return _spp_rx_read(buffer, size, false);
+}
+
+/**
+ * Number of received bytes discarded because the RX buffer was full
+ */
+uint32_t BluetoothSerial::rxOverflow(void)
+{
+    return _spp_rx_overflow;
+}
+
 /**
  * Set timeout for read / peek
  */
@@ -1123,7 +1307,7 @@ size_t BluetoothSerial::write(const uint8_t *buffer, size_t size)
     {
         return 0;
     }
-    return (_spp_queue_packet((uint8_t *)buffer, size) == ESP_OK) ? size : 0;
+    return _spp_queue_packet(buffer, size);
 }
 
 void BluetoothSerial::flush()
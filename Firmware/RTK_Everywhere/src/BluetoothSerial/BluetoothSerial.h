@@ -47,6 +47,8 @@ public:
   int peek(void);
   bool hasClient(void);
   int read(void);
+  size_t read(uint8_t *buffer, size_t size);
+  uint32_t rxOverflow(void);
   size_t write(uint8_t c);
   size_t write(const uint8_t *buffer, size_t size);
   void flush();
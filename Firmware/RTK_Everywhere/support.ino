@@ -47,7 +47,9 @@ void systemWrite(const uint8_t *buffer, uint16_t length)
         // Suppress output to USB serial if we are forwarding GNSS data to it
         if (forwardGnssDataToUsbSerial == false)
         {
-            if (usbSerialIsSelected == true) // Only use UART0 if we have the mux on the ESP's UART pointed at the CH34x
+            // Only use UART0 if we have the mux on the ESP's UART pointed at the CH34x
+            // Hold the output while loraTxTask has the mux pointed at the LoRa radio
+            if ((loraConsoleHold(buffer, length) == false) && (usbSerialIsSelected == true))
                 Serial.write(buffer, length);
         }
     }
@@ -75,7 +77,9 @@ void systemWrite(const uint8_t *buffer, uint16_t length)
     {
         if (forwardGnssDataToUsbSerial == false)
         {
-            if (usbSerialIsSelected == true) // Only use UART0 if we have the mux on the ESP's UART pointed at the CH34x
+            // Only use UART0 if we have the mux on the ESP's UART pointed at the CH34x
+            // Hold the output while loraTxTask has the mux pointed at the LoRa radio
+            if ((loraConsoleHold(buffer, length) == false) && (usbSerialIsSelected == true))
                 Serial.write(buffer, length);
         }
 
@@ -107,8 +111,8 @@ size_t systemWriteGnssDataToUsbSerial(const uint8_t *buffer, uint16_t length)
         return length;
     }
 
-    // Output GNSS data to USB serial
-    return Serial.write(buffer, length);
+    // Output GNSS data to USB serial, hold the data in the ring buffer during a LoRa burst
+    return loraUsbSerialWrite(buffer, length);
 }
 
 // Ensure all serial output has been transmitted, FIFOs are empty
@@ -769,6 +773,7 @@ void verifyTables()
     provisioningVerifyTables();
     mosaicVerifyTables();
     correctionVerifyTables();
+    rtcmLinkVerifyTables();
     webServerVerifyTables();
     pointPerfectVerifyTables();
     wifiVerifyTables();
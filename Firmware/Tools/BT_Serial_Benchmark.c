@@ -0,0 +1,479 @@
+//------------------------------------------------------------------------------
+// BT_Serial_Benchmark.c
+//
+// Program to compare the cost of moving Bluetooth SPP data through the
+// BluetoothSerial library on Linux.
+//
+// RX: The producer thread mimics esp_spp_cb, it delivers the RTCM stream in
+// ESP_SPP_DATA_IND_EVT sized pieces.  The consumer thread mimics btReadTask.
+// The queue method passes each byte through a mutex protected queue, like
+// the previous xQueueSend / xQueueReceive per byte.  The ring method uses the
+// single producer, single consumer byte ring from BluetoothSerial.cpp and
+// reads up to 128 bytes at a time.  The consumer verifies every byte.
+//
+// TX: The malloc method allocates and frees a packet for each write, like
+// the previous _spp_queue_packet.  The pool method takes the packets from a
+// preallocated pool and returns them after the send.
+//
+// The results are scaled to the CPU time needed for a 115200 baud RTCM feed.
+//
+// Usage: BT_Serial_Benchmark [megabytes [RX buffer size]]
+//
+//      The defaults pass 16 MB of data through a 2048 byte RX buffer
+//      (sppRxQueueSize).
+//
+// Returns zero when all of the data is received correctly.
+//------------------------------------------------------------------------------
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_MEGABYTES           16
+#define DEFAULT_RX_BUFFER_SIZE      (512 * 4)
+#define FEED_BYTES_PER_SECOND       (115200 / 10)
+#define NANOSECONDS_IN_A_SECOND     1000000000ull
+#define READ_BLOCK_SIZE             128     // btReadBuffer
+#define SPP_DATA_IND_MAX            990     // Largest ESP_SPP_DATA_IND_EVT payload
+#define SPP_TX_MAX                  330
+#define TX_POOL_PACKETS             8       // SPP_TX_POOL_MINIMUM, default sppTxQueueSize of 32 bytes
+
+typedef struct _METHOD
+{
+    const char *name;
+    void (*begin)(size_t size);
+    size_t (*write)(const uint8_t *data, size_t length);
+    size_t (*read)(uint8_t *buffer, size_t length);
+    void (*end)(void);
+} METHOD;
+
+typedef struct
+{
+    size_t len;
+    uint8_t data[SPP_TX_MAX];
+} spp_packet_t;
+
+static size_t totalBytes;
+static volatile bool producerDone;
+static uint32_t rxErrors;
+
+//----------------------------------------
+// Support routines
+//----------------------------------------
+
+static uint64_t nanoseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * NANOSECONDS_IN_A_SECOND + now.tv_nsec;
+}
+
+// Simple pseudo random generator, repeatable between the methods
+static uint32_t nextRandom(uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 16;
+}
+
+// Data pattern verified by the consumer
+static uint8_t dataByte(size_t offset)
+{
+    return (uint8_t)(offset ^ (offset >> 8) ^ (offset >> 16));
+}
+
+//----------------------------------------
+// Queue method: one mutex protected operation per byte
+//----------------------------------------
+
+static pthread_mutex_t queueMutex = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t *queueBuffer;
+static size_t queueSize;
+static size_t queueHead;
+static size_t queueTail;
+static size_t queueCount;
+
+static void queueBegin(size_t size)
+{
+    queueBuffer = malloc(size);
+    queueSize = size;
+    queueHead = 0;
+    queueTail = 0;
+    queueCount = 0;
+}
+
+static bool queueSendByte(const uint8_t *data)
+{
+    bool sent = false;
+
+    pthread_mutex_lock(&queueMutex);
+    if (queueCount < queueSize)
+    {
+        queueBuffer[queueHead] = *data;
+        queueHead = (queueHead + 1) % queueSize;
+        queueCount++;
+        sent = true;
+    }
+    pthread_mutex_unlock(&queueMutex);
+    return sent;
+}
+
+static bool queueReceiveByte(uint8_t *data)
+{
+    bool received = false;
+
+    pthread_mutex_lock(&queueMutex);
+    if (queueCount)
+    {
+        *data = queueBuffer[queueTail];
+        queueTail = (queueTail + 1) % queueSize;
+        queueCount--;
+        received = true;
+    }
+    pthread_mutex_unlock(&queueMutex);
+    return received;
+}
+
+static size_t queueWrite(const uint8_t *data, size_t length)
+{
+    size_t index;
+
+    for (index = 0; index < length; index++)
+        if (!queueSendByte(&data[index]))
+            break;
+    return index;
+}
+
+// Previous btReadTask: available() then read() for each byte
+static size_t queueRead(uint8_t *buffer, size_t length)
+{
+    size_t index;
+
+    for (index = 0; index < length; index++)
+        if (!queueReceiveByte(&buffer[index]))
+            break;
+    return index;
+}
+
+static void queueEnd(void)
+{
+    free(queueBuffer);
+}
+
+//----------------------------------------
+// Ring method: copy of the RX ring in BluetoothSerial.cpp
+//----------------------------------------
+
+static uint8_t *ringBuffer;
+static size_t ringBufferSize;
+static volatile size_t ringHead;
+static volatile size_t ringTail;
+
+static void ringBegin(size_t size)
+{
+    ringBufferSize = size + 1;
+    ringBuffer = malloc(ringBufferSize);
+    ringHead = 0;
+    ringTail = 0;
+}
+
+static size_t ringAvailable(void)
+{
+    size_t head = __atomic_load_n(&ringHead, __ATOMIC_ACQUIRE);
+    size_t tail = ringTail;
+
+    return (head >= tail) ? head - tail : head + ringBufferSize - tail;
+}
+
+static size_t ringWrite(const uint8_t *data, size_t len)
+{
+    size_t head = ringHead;
+    size_t tail = __atomic_load_n(&ringTail, __ATOMIC_ACQUIRE);
+    size_t space = (tail > head) ? tail - head - 1 : ringBufferSize - head + tail - 1;
+    size_t bytes;
+
+    if (len > space)
+        len = space;
+    bytes = ringBufferSize - head;
+    if (bytes > len)
+        bytes = len;
+    memcpy(&ringBuffer[head], data, bytes);
+    memcpy(ringBuffer, &data[bytes], len - bytes);
+    head += len;
+    if (head >= ringBufferSize)
+        head -= ringBufferSize;
+    __atomic_store_n(&ringHead, head, __ATOMIC_RELEASE);
+    return len;
+}
+
+static size_t ringRead(uint8_t *buffer, size_t size)
+{
+    size_t tail = ringTail;
+    size_t len = ringAvailable();
+    size_t bytes;
+
+    if (len > size)
+        len = size;
+    if (len == 0)
+        return 0;
+    bytes = ringBufferSize - tail;
+    if (bytes > len)
+        bytes = len;
+    memcpy(buffer, &ringBuffer[tail], bytes);
+    memcpy(&buffer[bytes], ringBuffer, len - bytes);
+    tail += len;
+    if (tail >= ringBufferSize)
+        tail -= ringBufferSize;
+    __atomic_store_n(&ringTail, tail, __ATOMIC_RELEASE);
+    return len;
+}
+
+static void ringEnd(void)
+{
+    free(ringBuffer);
+}
+
+static const METHOD rxMethods[] = {
+    {"Queue", queueBegin, queueWrite, queueRead, queueEnd},
+    {"Ring", ringBegin, ringWrite, ringRead, ringEnd},
+};
+
+#define RX_METHODS      (sizeof(rxMethods) / sizeof(rxMethods[0]))
+
+//----------------------------------------
+// RX threads
+//----------------------------------------
+
+// Mimic esp_spp_cb, the Bluetooth stack retries instead of discarding the data
+static void *producer(void *arg)
+{
+    uint8_t data[SPP_DATA_IND_MAX];
+    size_t index;
+    size_t length;
+    const METHOD *method = arg;
+    size_t offset;
+    uint32_t seed;
+    size_t written;
+
+    seed = 1;
+    offset = 0;
+    while (offset < totalBytes)
+    {
+        length = 1 + nextRandom(&seed) % SPP_DATA_IND_MAX;
+        if (length > (totalBytes - offset))
+            length = totalBytes - offset;
+        for (index = 0; index < length; index++)
+            data[index] = dataByte(offset + index);
+        index = 0;
+        while (index < length)
+        {
+            written = method->write(&data[index], length - index);
+            if (!written)
+                sched_yield();
+            index += written;
+        }
+        offset += length;
+    }
+    producerDone = true;
+    return NULL;
+}
+
+// Mimic btReadTask
+static void *consumer(void *arg)
+{
+    uint8_t buffer[READ_BLOCK_SIZE];
+    size_t bytesRead;
+    size_t index;
+    const METHOD *method = arg;
+    size_t offset;
+
+    offset = 0;
+    while (offset < totalBytes)
+    {
+        bytesRead = method->read(buffer, sizeof(buffer));
+        if (!bytesRead)
+        {
+            if (producerDone && (method->read(buffer, 1) == 0))
+                break;
+            sched_yield();
+            continue;
+        }
+        for (index = 0; index < bytesRead; index++)
+            if (buffer[index] != dataByte(offset + index))
+                rxErrors++;
+        offset += bytesRead;
+    }
+    if (offset != totalBytes)
+        rxErrors++;
+    return NULL;
+}
+
+static uint64_t timeRx(const METHOD *method, size_t rxBufferSize)
+{
+    pthread_t consumerThread;
+    pthread_t producerThread;
+    uint64_t start;
+
+    method->begin(rxBufferSize);
+    producerDone = false;
+    start = nanoseconds();
+    pthread_create(&consumerThread, NULL, consumer, (void *)method);
+    pthread_create(&producerThread, NULL, producer, (void *)method);
+    pthread_join(producerThread, NULL);
+    pthread_join(consumerThread, NULL);
+    start = nanoseconds() - start;
+    method->end();
+    return start;
+}
+
+//----------------------------------------
+// TX methods, single threaded: queue the write then send it like _spp_tx_task
+//----------------------------------------
+
+static uint8_t txBuffer[SPP_TX_MAX];
+static size_t txBufferLength;
+static uint32_t txChecksum;
+
+// Mimic _spp_send_buffer
+static void txSendPacket(const spp_packet_t *packet)
+{
+    size_t index;
+
+    memcpy(txBuffer, packet->data, packet->len);
+    txBufferLength = packet->len;
+    for (index = 0; index < txBufferLength; index += 32)
+        txChecksum += txBuffer[index];
+}
+
+static size_t txMalloc(const uint8_t *data, size_t length)
+{
+    size_t bytes;
+    spp_packet_t *packet;
+    size_t queued;
+
+    for (queued = 0; queued < length; queued += bytes)
+    {
+        bytes = length - queued;
+        if (bytes > SPP_TX_MAX)
+            bytes = SPP_TX_MAX;
+        packet = malloc(sizeof(size_t) + bytes);
+        packet->len = bytes;
+        memcpy(packet->data, &data[queued], bytes);
+        txSendPacket(packet);
+        free(packet);
+    }
+    return queued;
+}
+
+static spp_packet_t txPool[TX_POOL_PACKETS];
+static spp_packet_t *txFree[TX_POOL_PACKETS];
+static size_t txFreeCount;
+
+static size_t txPoolWrite(const uint8_t *data, size_t length)
+{
+    size_t bytes;
+    spp_packet_t *packet;
+    size_t queued;
+
+    for (queued = 0; queued < length; queued += bytes)
+    {
+        bytes = length - queued;
+        if (bytes > SPP_TX_MAX)
+            bytes = SPP_TX_MAX;
+        pthread_mutex_lock(&queueMutex);
+        packet = txFree[--txFreeCount];
+        pthread_mutex_unlock(&queueMutex);
+        packet->len = bytes;
+        memcpy(packet->data, &data[queued], bytes);
+        txSendPacket(packet);
+        pthread_mutex_lock(&queueMutex);
+        txFree[txFreeCount++] = packet;
+        pthread_mutex_unlock(&queueMutex);
+    }
+    return queued;
+}
+
+static uint64_t timeTx(size_t (*method)(const uint8_t *data, size_t length))
+{
+    uint8_t data[SPP_DATA_IND_MAX];
+    size_t length;
+    size_t offset;
+    uint32_t seed;
+    uint64_t start;
+
+    for (offset = 0; offset < sizeof(data); offset++)
+        data[offset] = dataByte(offset);
+    for (txFreeCount = 0; txFreeCount < TX_POOL_PACKETS; txFreeCount++)
+        txFree[txFreeCount] = &txPool[txFreeCount];
+
+    seed = 1;
+    start = nanoseconds();
+    for (offset = 0; offset < totalBytes; offset += length)
+    {
+        length = 1 + nextRandom(&seed) % SPP_DATA_IND_MAX;
+        if (length > (totalBytes - offset))
+            length = totalBytes - offset;
+        method(data, length);
+    }
+    return nanoseconds() - start;
+}
+
+//----------------------------------------
+// Display the results
+//----------------------------------------
+
+static void printResult(const char *name, uint64_t nsec)
+{
+    double feedUsec;
+    double mbPerSecond;
+
+    mbPerSecond = (double)totalBytes * NANOSECONDS_IN_A_SECOND / nsec / (1024 * 1024);
+    feedUsec = (double)nsec * FEED_BYTES_PER_SECOND / totalBytes / 1000.;
+    printf("%-12s %8.3f Sec  %8.2f MB/Sec  %8.1f uSec per second of 115200 baud\n",
+           name, (double)nsec / NANOSECONDS_IN_A_SECOND, mbPerSecond, feedUsec);
+}
+
+int main(int argc, char **argv)
+{
+    size_t index;
+    int megabytes;
+    uint64_t nsec;
+    int rxBufferSize;
+
+    megabytes = DEFAULT_MEGABYTES;
+    rxBufferSize = DEFAULT_RX_BUFFER_SIZE;
+    if (argc > 1)
+        megabytes = atoi(argv[1]);
+    if (argc > 2)
+        rxBufferSize = atoi(argv[2]);
+    if ((argc > 3) || (megabytes <= 0) || (rxBufferSize < 32))
+    {
+        fprintf(stderr, "%s [megabytes [RX buffer size]]\n", argv[0]);
+        return -1;
+    }
+    totalBytes = (size_t)megabytes * 1024 * 1024;
+    printf("%d MB, %d byte RX buffer\n", megabytes, rxBufferSize);
+
+    // Receive the data
+    for (index = 0; index < RX_METHODS; index++)
+    {
+        rxErrors = 0;
+        nsec = timeRx(&rxMethods[index], rxBufferSize);
+        printResult(rxMethods[index].name, nsec);
+        if (rxErrors)
+        {
+            fprintf(stderr, "ERROR: %s method, %u bytes received incorrectly\n", rxMethods[index].name, rxErrors);
+            return -1;
+        }
+    }
+
+    // Transmit the data
+    printResult("TX malloc", timeTx(txMalloc));
+    printResult("TX pool", timeTx(txPoolWrite));
+    return 0;
+}
@@ -0,0 +1,298 @@
+//------------------------------------------------------------------------------
+// Log_Writer_Check.c
+//
+// Program to verify the log writer in Logging.ino on Linux.  The log file is
+// opened like beginLogging and written like logWriterBegin, logWriterWrite
+// and logWriterEnd.  The SdFat preAllocate call is modeled with ftruncate,
+// which also sets the file size to the preallocated length.
+//
+// Each pass writes random length blocks of random data to the log, ends the
+// log and reads the file back to verify that the file contains exactly the
+// data written.  The passes are:
+//
+//      1. New log, preallocated, opened without O_APPEND
+//      2. The log from pass 1 is reused, opened with O_APPEND
+//      3. New log, preallocated, opened with O_APPEND - the original open
+//         flags, which write the data after the preallocated length.  This
+//         pass must fail the read back, verifying the check.
+//
+// Usage: Log_Writer_Check [log file [bytes]]
+//
+//      The defaults write /tmp/Log_Writer_Check.txt with 1000000 bytes per
+//      pass.
+//
+// Returns zero when the read back matches for passes 1 and 2 and fails for
+// pass 3.
+//------------------------------------------------------------------------------
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define DEFAULT_BYTES               1000000
+#define DEFAULT_LOG_FILE            "/tmp/Log_Writer_Check.txt"
+#define LOG_WRITER_SECTOR_SIZE      512
+#define LOG_WRITER_PREALLOCATE_MARGIN   125     // Percent of the expected log length
+#define MAX_BLOCK                   2000
+
+static int logFile;
+static uint8_t logWriterBuffer[LOG_WRITER_SECTOR_SIZE];
+static uint16_t logWriterStaged;
+static uint64_t logWriterCommitted;
+static uint64_t logWriterPreallocated;
+
+//----------------------------------------
+// Log writer, see Logging.ino
+//----------------------------------------
+
+// Open the log file like beginLogging
+bool logOpen(const char *fileName, bool appendLog)
+{
+    logFile = open(fileName, O_CREAT | O_RDWR | (appendLog ? O_APPEND : 0), 0644);
+    if (logFile < 0)
+    {
+        fprintf(stderr, "ERROR: Failed to open %s, errno: %d\n", fileName, errno);
+        return false;
+    }
+    return true;
+}
+
+// Start the sector aligned writes, preallocate an empty file
+bool logWriterBegin(uint64_t bytes)
+{
+    struct stat status;
+
+    if (fstat(logFile, &status))
+        return false;
+    logWriterStaged = 0;
+    logWriterCommitted = status.st_size;
+    logWriterPreallocated = 0;
+
+    // Only an empty file may be preallocated, data is added to the end of an existing log
+    if (logWriterCommitted)
+        return (lseek(logFile, logWriterCommitted, SEEK_SET) >= 0);
+
+    // Model SdFat preAllocate, the file size becomes the preallocated length
+    bytes = bytes * LOG_WRITER_PREALLOCATE_MARGIN / 100;
+    bytes &= ~(uint64_t)(LOG_WRITER_SECTOR_SIZE - 1);
+    if (ftruncate(logFile, bytes))
+        return false;
+    logWriterPreallocated = bytes;
+    return (lseek(logFile, 0, SEEK_SET) >= 0);
+}
+
+// Write the staged bytes to the log file
+bool logWriterCommit()
+{
+    ssize_t bytesWritten;
+
+    if (logWriterStaged == 0)
+        return true;
+    bytesWritten = write(logFile, logWriterBuffer, logWriterStaged);
+    if (bytesWritten <= 0)
+        return false;
+    logWriterCommitted += bytesWritten;
+    logWriterStaged -= bytesWritten;
+    if (logWriterStaged)
+        memmove(logWriterBuffer, &logWriterBuffer[bytesWritten], logWriterStaged);
+    return (logWriterStaged == 0);
+}
+
+// Add data to the log file, only whole sectors are written
+int32_t logWriterWrite(const uint8_t *data, int32_t length)
+{
+    int32_t bytes;
+    int32_t bytesAccepted;
+    ssize_t bytesWritten;
+
+    bytesAccepted = 0;
+
+    // Complete the partial sector
+    if (logWriterStaged || (logWriterCommitted % LOG_WRITER_SECTOR_SIZE))
+    {
+        bytes = (LOG_WRITER_SECTOR_SIZE - ((logWriterCommitted + logWriterStaged) % LOG_WRITER_SECTOR_SIZE))
+              % LOG_WRITER_SECTOR_SIZE;
+        if (bytes > length)
+            bytes = length;
+        memcpy(&logWriterBuffer[logWriterStaged], data, bytes);
+        logWriterStaged += bytes;
+        data += bytes;
+        length -= bytes;
+        bytesAccepted += bytes;
+
+        // Wait for the rest of the sector
+        if ((logWriterCommitted + logWriterStaged) % LOG_WRITER_SECTOR_SIZE)
+            return bytesAccepted;
+        if (logWriterCommit() == false)
+            return bytesAccepted;
+    }
+
+    // Write the whole sectors directly from the caller's buffer
+    bytes = length & ~(LOG_WRITER_SECTOR_SIZE - 1);
+    if (bytes)
+    {
+        bytesWritten = write(logFile, data, bytes);
+        if (bytesWritten > 0)
+        {
+            logWriterCommitted += bytesWritten;
+            bytesAccepted += bytesWritten;
+        }
+        if (bytesWritten != bytes)
+            return bytesAccepted;
+        data += bytes;
+        length -= bytes;
+    }
+
+    // Hold the start of the next sector
+    memcpy(logWriterBuffer, data, length);
+    logWriterStaged = length;
+    return bytesAccepted + length;
+}
+
+// Write the partial sector and release the unused preallocated space
+void logWriterEnd()
+{
+    logWriterCommit();
+    if (logWriterPreallocated && (logWriterCommitted < logWriterPreallocated))
+    {
+        if (ftruncate(logFile, logWriterCommitted))
+            fprintf(stderr, "ERROR: Failed to truncate the log file, errno: %d\n", errno);
+    }
+    fsync(logFile);
+    close(logFile);
+    logWriterPreallocated = 0;
+}
+
+//----------------------------------------
+// Check
+//----------------------------------------
+
+// Write the data to the log in random length blocks
+bool writeLog(const char *fileName, bool appendLog, const uint8_t *data, int32_t length)
+{
+    int32_t block;
+    int32_t offset;
+
+    if (logOpen(fileName, appendLog) == false)
+        return false;
+    if (logWriterBegin(length) == false)
+    {
+        fprintf(stderr, "ERROR: Failed to start the log writer, errno: %d\n", errno);
+        close(logFile);
+        return false;
+    }
+    for (offset = 0; offset < length; offset += block)
+    {
+        block = 1 + (rand() % MAX_BLOCK);
+        if (block > (length - offset))
+            block = length - offset;
+        if (logWriterWrite(&data[offset], block) != block)
+        {
+            fprintf(stderr, "ERROR: Failed to write the log file, errno: %d\n", errno);
+            logWriterEnd();
+            return false;
+        }
+    }
+    logWriterEnd();
+    return true;
+}
+
+// Read the log file and compare it with the expected data
+bool readBack(const char *fileName, const uint8_t *expected, int32_t length)
+{
+    uint8_t *data;
+    FILE *file;
+    int32_t index;
+    size_t bytesRead;
+    bool match;
+
+    file = fopen(fileName, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "ERROR: Failed to open %s for read, errno: %d\n", fileName, errno);
+        return false;
+    }
+    data = malloc(length + 1);
+    if (data == NULL)
+    {
+        fclose(file);
+        fprintf(stderr, "ERROR: Failed to allocate the read buffer\n");
+        return false;
+    }
+
+    // The file must contain exactly the data written
+    bytesRead = fread(data, 1, length + 1, file);
+    fclose(file);
+    match = (bytesRead == (size_t)length);
+    if (match == false)
+        printf("    File length %ld bytes, expected %d bytes\n", (long)bytesRead, length);
+    else
+    {
+        for (index = 0; index < length; index++)
+            if (data[index] != expected[index])
+                break;
+        match = (index == length);
+        if (match == false)
+            printf("    Data mismatch at offset %d\n", index);
+    }
+    free(data);
+    return match;
+}
+
+int main(int argc, char **argv)
+{
+    int32_t bytes;
+    uint8_t *data;
+    const char *fileName;
+    int32_t index;
+    bool newLog;
+    bool oldFlags;
+    bool reuseLog;
+
+    fileName = DEFAULT_LOG_FILE;
+    bytes = DEFAULT_BYTES;
+    if (argc > 1)
+        fileName = argv[1];
+    if (argc > 2)
+        bytes = atoi(argv[2]);
+    if ((argc > 3) || (bytes <= 0))
+    {
+        fprintf(stderr, "Usage: %s [log file [bytes]]\n", argv[0]);
+        return -1;
+    }
+
+    // Build the data for two passes
+    data = malloc(2 * bytes);
+    if (data == NULL)
+    {
+        fprintf(stderr, "ERROR: Failed to allocate the data buffer\n");
+        return -1;
+    }
+    srand(1);
+    for (index = 0; index < (2 * bytes); index++)
+        data[index] = rand();
+
+    // Pass 1: New preallocated log
+    unlink(fileName);
+    newLog = writeLog(fileName, false, data, bytes) && readBack(fileName, data, bytes);
+    printf("New preallocated log: %s\n", newLog ? "Pass" : "FAIL");
+
+    // Pass 2: Reuse the last log
+    reuseLog = writeLog(fileName, true, &data[bytes], bytes) && readBack(fileName, data, 2 * bytes);
+    printf("Reused log: %s\n", reuseLog ? "Pass" : "FAIL");
+
+    // Pass 3: Original open flags, appending after the preallocated length
+    unlink(fileName);
+    oldFlags = writeLog(fileName, true, data, bytes) && readBack(fileName, data, bytes);
+    printf("New preallocated log opened with O_APPEND: %s\n", oldFlags ? "Data kept (unexpected)" : "Data lost (expected)");
+    unlink(fileName);
+    free(data);
+
+    return (newLog && reuseLog && (oldFlags == false)) ? 0 : -1;
+}
@@ -0,0 +1,344 @@
+//------------------------------------------------------------------------------
+// NMEA_Classify_Benchmark.c
+//
+// Program to compare the cost of identifying NMEA sentences in
+// processUart1Message on Linux.
+//
+// The string method repeats the strstr and strncmp searches previously done
+// by the Apple accessory, LG290P message filter, tilt compensation, PPL feed
+// and GGA push for each sentence.  The classify method identifies the
+// sentence once with RTK_Everywhere/NmeaSentence.h and uses table lookups.
+// Both methods compute the same handler actions and the results are compared.
+//
+// Usage: NMEA_Classify_Benchmark [capture_file [passes]]
+//
+//      The capture file contains the raw GNSS receiver output, binary data
+//      between the NMEA sentences is skipped.  A built-in stream is used
+//      when the capture file is not specified.  The default is 10000 passes
+//      through the stream.
+//
+// Returns zero when both methods produce the same results.
+//------------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../RTK_Everywhere/NmeaSentence.h"
+
+#define DEFAULT_PASSES              10000
+#define NANOSECONDS_IN_A_SECOND     1000000000ull
+#define SENTENCE_NAME_MAX           20
+
+// Handler actions, the accessory save uses the low bits
+#define ACTION_ACCESSORY_GGA        1
+#define ACTION_ACCESSORY_RMC        2
+#define ACTION_ACCESSORY_GST        3
+#define ACTION_ACCESSORY_VTG        4
+#define ACTION_ACCESSORY_EA_SESSION 5
+#define ACTION_ACCESSORY_MASK       0x0007
+#define ACTION_TILT                 0x0008
+#define ACTION_PPL                  0x0010
+#define ACTION_PUSH_GGA             0x0020
+#define ACTION_LG290P_SHIFT         8       // lgMessagesNMEA index + 1
+
+typedef struct _SENTENCE
+{
+    char name[SENTENCE_NAME_MAX + 1];   // Ex: GNGGA
+    const char *sentence;               // Ex: $GNGGA,...
+} SENTENCE;
+
+// Same order as lgMessagesNMEA in GNSS_LG290P.h
+static const char *const lgMessagesNMEA[] = {
+    "RMC", "GGA", "GSV", "GSA", "VTG", "GLL", "GBS", "GNS", "GST", "ZDA", "HDT", "THS",
+};
+#define MAX_LG290P_NMEA_MSG     (sizeof(lgMessagesNMEA) / sizeof(lgMessagesNMEA[0]))
+
+// Handler actions indexed by NMEA_SENTENCE_ID, mirrors nmeaSentenceHandler in Tasks.ino
+static uint32_t sentenceActions[NMEA_SENTENCE_MAX];
+
+static const char builtInStream[] =
+    "$GNGGA,202530.00,4004.73854216,N,10513.77012021,W,4,28,0.8,1574.406,M,-21.321,M,1.0,0000*5A\r\n"
+    "$GNGSA,A,3,05,07,08,09,13,14,18,20,27,30,,,1.4,0.8,1.1,1*0E\r\n"
+    "$GNGSA,A,3,65,66,72,73,74,81,82,,,,,,1.4,0.8,1.1,2*03\r\n"
+    "$GNGST,202530.00,0.010,0.007,0.005,35.8,0.006,0.006,0.012*71\r\n"
+    "$GPGSV,3,1,11,05,44,305,44,07,28,056,41,08,14,106,37,09,19,178,40,1*6D\r\n"
+    "$GPGSV,3,2,11,13,71,238,46,14,47,141,45,18,21,255,40,20,45,092,44,1*61\r\n"
+    "$GPGSV,3,3,11,27,07,331,33,30,57,063,47,36,38,198,42,1*54\r\n"
+    "$GLGSV,2,1,07,65,29,296,39,66,35,007,42,72,42,241,44,73,57,051,45,1*73\r\n"
+    "$GLGSV,2,2,07,74,11,091,38,81,24,194,38,82,53,265,46,1*44\r\n"
+    "$GNRMC,202530.00,A,4004.73854216,N,10513.77012021,W,0.011,,171026,,,R,V*0E\r\n"
+    "$GNVTG,,T,,M,0.011,N,0.020,K,R*3A\r\n"
+    "$GNGLL,4004.73854216,N,10513.77012021,W,202530.00,A,R*6C\r\n"
+    "$GNGNS,202530.00,4004.73854216,N,10513.77012021,W,RRNNN,28,0.8,1574.406,-21.321,1.0,0000,S*35\r\n"
+    "$GNZDA,202530.00,17,10,2026,,*74\r\n"
+    "$PQTMEPE,2,0.0098,0.0076,0.0142,0.0124,0.0186*6A\r\n"
+    "$PQTMPVT,1,202530.000,20261017,4,28,40.07897570,-105.22950200,1574.406,-21.321,0.011,0.020,,0.8,1.4*4C\r\n";
+
+//----------------------------------------
+// Support routines
+//----------------------------------------
+
+// Get the time in nanoseconds
+static uint64_t nanoseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * NANOSECONDS_IN_A_SECOND + now.tv_nsec;
+}
+
+// Locate the NMEA sentences in the stream
+static int findSentences(const char *stream, size_t length, SENTENCE **sentences)
+{
+    const char *comma;
+    int count;
+    const char *end;
+    size_t nameLength;
+    const char *next;
+    SENTENCE *list;
+
+    count = 0;
+    list = NULL;
+    end = &stream[length];
+    next = stream;
+    while ((next = memchr(next, '$', end - next)) != NULL)
+    {
+        // Locate the end of the sentence name
+        next += 1;
+        for (comma = next; (comma < end) && (comma - next <= SENTENCE_NAME_MAX); comma++)
+            if ((*comma == ',') || (*comma < ' ') || (*comma > '~'))
+                break;
+        if ((comma >= end) || (*comma != ','))
+            continue;
+
+        // Save the sentence
+        list = realloc(list, (count + 1) * sizeof(*list));
+        if (!list)
+        {
+            fprintf(stderr, "ERROR: Failed to allocate the sentence list!\n");
+            exit(1);
+        }
+        nameLength = comma - next;
+        memcpy(list[count].name, next, nameLength);
+        list[count].name[nameLength] = 0;
+        list[count].sentence = next - 1;
+        count += 1;
+        next = comma;
+    }
+    *sentences = list;
+    return count;
+}
+
+//----------------------------------------
+// String method
+//----------------------------------------
+
+// Identify the sentence using the searches from processUart1Message
+static uint32_t stringClassify(const SENTENCE *sentence)
+{
+    uint32_t actions;
+    const char *name;
+    char messageName[4];
+    char sentenceType[4];
+
+    actions = 0;
+    name = sentence->name;
+
+    // Apple accessory
+    if (strstr(name, "GGA") != NULL)
+        actions |= ACTION_ACCESSORY_GGA;
+    else if (strstr(name, "RMC") != NULL)
+        actions |= ACTION_ACCESSORY_RMC;
+    else if (strstr(name, "GST") != NULL)
+        actions |= ACTION_ACCESSORY_GST;
+    else if (strstr(name, "VTG") != NULL)
+        actions |= ACTION_ACCESSORY_VTG;
+    else if ((strstr(name, "GSA") != NULL) || (strstr(name, "GSV") != NULL))
+        actions |= ACTION_ACCESSORY_EA_SESSION;
+
+    // LG290P message filter
+    if ((strstr(name, "PQTM") == NULL) && (name[0] == 'G'))
+    {
+        memset(messageName, 0, sizeof(messageName));
+        strncpy(messageName, &name[2], 3);
+        for (size_t messageNumber = 0; messageNumber < MAX_LG290P_NMEA_MSG; messageNumber++)
+            if (strncmp(lgMessagesNMEA[messageNumber], messageName, sizeof(messageName)) == 0)
+            {
+                actions |= (messageNumber + 1) << ACTION_LG290P_SHIFT;
+                break;
+            }
+    }
+
+    // Tilt compensation
+    memset(sentenceType, 0, sizeof(sentenceType));
+    strncpy(sentenceType, &sentence->sentence[3], 3);
+    if ((strncmp(sentenceType, "GGA", sizeof(sentenceType)) == 0)
+        || (strncmp(sentenceType, "GNS", sizeof(sentenceType)) == 0)
+        || (strncmp(sentenceType, "RMC", sizeof(sentenceType)) == 0)
+        || (strncmp(sentenceType, "GLL", sizeof(sentenceType)) == 0))
+        actions |= ACTION_TILT;
+
+    // PointPerfect Library
+    if (strstr(name, "GGA") != NULL)
+        actions |= ACTION_PPL;
+    else if (strstr(name, "ZDA") != NULL)
+        actions |= ACTION_PPL;
+
+    // GGA push
+    if (strstr(name, "GGA") != NULL)
+        actions |= ACTION_PUSH_GGA;
+    return actions;
+}
+
+//----------------------------------------
+// Classify method
+//----------------------------------------
+
+// Build the action table, done once by the firmware tables
+static void classifyInitialize(void)
+{
+    NMEA_SENTENCE_ID id;
+
+    sentenceActions[NMEA_SENTENCE_GGA] = ACTION_ACCESSORY_GGA | ACTION_TILT | ACTION_PPL | ACTION_PUSH_GGA;
+    sentenceActions[NMEA_SENTENCE_GLL] = ACTION_TILT;
+    sentenceActions[NMEA_SENTENCE_GNS] = ACTION_TILT;
+    sentenceActions[NMEA_SENTENCE_GSA] = ACTION_ACCESSORY_EA_SESSION;
+    sentenceActions[NMEA_SENTENCE_GST] = ACTION_ACCESSORY_GST;
+    sentenceActions[NMEA_SENTENCE_GSV] = ACTION_ACCESSORY_EA_SESSION;
+    sentenceActions[NMEA_SENTENCE_RMC] = ACTION_ACCESSORY_RMC | ACTION_TILT;
+    sentenceActions[NMEA_SENTENCE_VTG] = ACTION_ACCESSORY_VTG;
+    sentenceActions[NMEA_SENTENCE_ZDA] = ACTION_PPL;
+
+    // Same as the lookup table in lg290pMessageEnabled
+    for (size_t messageNumber = 0; messageNumber < MAX_LG290P_NMEA_MSG; messageNumber++)
+    {
+        id = nmeaSentenceFormatterId(lgMessagesNMEA[messageNumber]);
+        if (id != NMEA_SENTENCE_UNKNOWN)
+            sentenceActions[id] |= (messageNumber + 1) << ACTION_LG290P_SHIFT;
+    }
+}
+
+// Identify the sentence once and look up the actions
+static uint32_t classify(const SENTENCE *sentence)
+{
+    uint32_t actions;
+    NMEA_SENTENCE_ID id;
+
+    id = nmeaSentenceId(sentence->name);
+    actions = sentenceActions[id];
+
+    // The LG290P message filter requires a G talker ID
+    if (sentence->name[0] != 'G')
+        actions &= (1 << ACTION_LG290P_SHIFT) - 1;
+    return actions;
+}
+
+//----------------------------------------
+// Benchmark
+//----------------------------------------
+
+// Time a classification method
+static uint64_t timeMethod(uint32_t (*method)(const SENTENCE *sentence),
+                           const SENTENCE *sentences,
+                           int count,
+                           int passes,
+                           uint32_t *checksum)
+{
+    uint64_t start;
+    uint32_t sum;
+
+    sum = 0;
+    start = nanoseconds();
+    for (int pass = 0; pass < passes; pass++)
+        for (int index = 0; index < count; index++)
+            sum += method(&sentences[index]);
+    *checksum = sum;
+    return nanoseconds() - start;
+}
+
+// Compare the string and classify methods
+int main(int argc, char **argv)
+{
+    char *buffer;
+    uint32_t classifyChecksum;
+    uint64_t classifyTime;
+    int count;
+    FILE *file;
+    long length;
+    int mismatches;
+    int passes;
+    SENTENCE *sentences;
+    uint32_t stringChecksum;
+    uint64_t stringTime;
+
+    // Get the stream
+    buffer = (char *)builtInStream;
+    length = sizeof(builtInStream) - 1;
+    if (argc > 1)
+    {
+        file = fopen(argv[1], "rb");
+        if (!file)
+        {
+            fprintf(stderr, "ERROR: Failed to open %s\n", argv[1]);
+            return 1;
+        }
+        fseek(file, 0, SEEK_END);
+        length = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        buffer = malloc(length + 1);
+        if ((!buffer) || (fread(buffer, 1, length, file) != (size_t)length))
+        {
+            fprintf(stderr, "ERROR: Failed to read %s\n", argv[1]);
+            fclose(file);
+            return 1;
+        }
+        buffer[length] = 0;
+        fclose(file);
+    }
+    passes = (argc > 2) ? atoi(argv[2]) : DEFAULT_PASSES;
+    if (passes <= 0)
+    {
+        fprintf(stderr, "Usage: %s [capture_file [passes]]\n", argv[0]);
+        return 1;
+    }
+
+    // Locate the NMEA sentences
+    count = findSentences(buffer, length, &sentences);
+    if (count == 0)
+    {
+        fprintf(stderr, "ERROR: No NMEA sentences found!\n");
+        return 1;
+    }
+    printf("%d NMEA sentences, %d passes\n", count, passes);
+
+    // Verify that both methods produce the same actions
+    classifyInitialize();
+    mismatches = 0;
+    for (int index = 0; index < count; index++)
+        if (stringClassify(&sentences[index]) != classify(&sentences[index]))
+        {
+            if (mismatches++ < 10)
+                printf("Mismatch: %s, string: 0x%04x, classify: 0x%04x\n", sentences[index].name,
+                       stringClassify(&sentences[index]), classify(&sentences[index]));
+        }
+
+    // Time both methods
+    stringTime = timeMethod(stringClassify, sentences, count, passes, &stringChecksum);
+    classifyTime = timeMethod(classify, sentences, count, passes, &classifyChecksum);
+    printf("string:   %8.2f nSec/sentence (checksum 0x%08x)\n",
+           (double)stringTime / ((double)count * passes), stringChecksum);
+    printf("classify: %8.2f nSec/sentence (checksum 0x%08x)\n",
+           (double)classifyTime / ((double)count * passes), classifyChecksum);
+    if (classifyTime)
+        printf("speedup:  %8.2fx\n", (double)stringTime / (double)classifyTime);
+    printf("%s, %d mismatches\n", mismatches ? "FAILED" : "PASSED", mismatches);
+
+    free(sentences);
+    if (buffer != builtInStream)
+        free(buffer);
+    return mismatches ? 1 : 0;
+}
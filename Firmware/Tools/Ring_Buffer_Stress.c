@@ -0,0 +1,582 @@
+//------------------------------------------------------------------------------
+// Ring_Buffer_Stress.c
+//
+// Program to exercise the lock-free GNSS ring buffer routines in
+// RTK_Everywhere/RingBuffer.h on Linux.
+//
+// The producer thread mimics processUart1Message: it places framed messages
+// into the ring buffer at the GNSS data rate, records the message offsets in
+// an rbOffsetArray and discards the oldest messages when the ring buffer is
+// full.  Each consumer thread mimics ringBufferSendData: it claims its tail,
+// copies the data in random sized pieces, occasionally stalls like an SD card
+// write and then releases its tail.  One consumer also stops polling for a
+// while, like a disconnected client, causing its idle tail to be trimmed.
+//
+// Each consumer verifies the sequence number and checksum of every message
+// it receives.  A message that is overwritten while a consumer is reading it
+// is reported as corrupted.  Sequence gaps are only allowed when the producer
+// trimmed the consumer's tail.
+//
+// Usage: Ring_Buffer_Stress [seconds [bytes per second [buffer size]]]
+//
+//      The defaults run for 10 seconds at 460800 bps with a 16 KB buffer,
+//      use a bytes per second value of zero to run the producer flat out.
+//
+// Returns zero when no errors are detected and the ring buffer overflowed,
+// causing both discards and consumer tail trims.
+//------------------------------------------------------------------------------
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../RTK_Everywhere/RingBuffer.h"
+
+#define CONSUMER_COUNT              6
+#define DEFAULT_BUFFER_SIZE         (16 * 1024)
+#define DEFAULT_BYTES_PER_SECOND    (460800 / 10)
+#define DEFAULT_SECONDS             10
+
+#define IDLE_CONSUMER               1
+#define IDLE_NANOSECONDS            (500 * 1000 * 1000)
+#define STALL_CONSUMER              0
+#define STALL_NANOSECONDS           (250 * 1000 * 1000)
+
+#define AVERAGE_MESSAGE_LENGTH      32
+#define MESSAGE_HEADER_LENGTH       8
+#define MESSAGE_LENGTH_MAX          600
+#define MESSAGE_LENGTH_MIN          (MESSAGE_HEADER_LENGTH + 4)
+#define MESSAGE_PREAMBLE            0xb5
+
+#define NANOSECONDS_IN_A_SECOND     1000000000ull
+
+typedef struct _CONSUMER
+{
+    pthread_t thread;
+    int index;
+    RING_BUFFER_TAIL tail;          // Shared with the producer
+    uint16_t released;              // Tail last released by the consumer
+    uint16_t privateTail;           // Offset of the next byte to send
+    unsigned int seed;
+
+    // Message reassembly
+    uint8_t message[MESSAGE_LENGTH_MAX];
+    int messageLength;
+    uint32_t expectedSequence;
+    bool sequenceValid;
+
+    // Statistics
+    uint64_t bytes;
+    uint64_t corrupted;
+    uint64_t messages;
+    uint64_t sequenceErrors;
+    uint64_t trims;
+} CONSUMER;
+
+//----------------------------------------
+// Globals
+//----------------------------------------
+
+static uint16_t bufferSize;
+static CONSUMER consumer[CONSUMER_COUNT];
+static volatile uint16_t dataHead;
+static uint8_t * ringBuffer;
+static volatile bool stopRequest;
+
+// Producer statistics
+static uint64_t producerBusyDrops;
+static uint64_t producerDiscards;
+static uint64_t producerMessages;
+
+//----------------------------------------
+// Support routines
+//----------------------------------------
+
+uint64_t nanoseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * NANOSECONDS_IN_A_SECOND + now.tv_nsec;
+}
+
+void sleepNanoseconds(uint64_t delay)
+{
+    struct timespec request;
+
+    request.tv_sec = delay / NANOSECONDS_IN_A_SECOND;
+    request.tv_nsec = delay % NANOSECONDS_IN_A_SECOND;
+    nanosleep(&request, NULL);
+}
+
+uint8_t messageChecksum(const uint8_t * message, int length)
+{
+    uint8_t checksum;
+
+    checksum = 0;
+    while (length-- > 1)
+        checksum = (uint8_t)((checksum << 1) | (checksum >> 7)) ^ *message++;
+    return checksum;
+}
+
+// Build a message: preamble, length, sequence number, payload, checksum
+int messageBuild(uint8_t * message, uint32_t sequence, int length)
+{
+    int index;
+
+    message[0] = MESSAGE_PREAMBLE;
+    message[1] = (uint8_t)(length >> 8);
+    message[2] = (uint8_t)length;
+    message[3] = 0;
+    memcpy(&message[4], &sequence, sizeof(sequence));
+    for (index = MESSAGE_HEADER_LENGTH; index < (length - 1); index++)
+        message[index] = (uint8_t)(sequence + index);
+    message[length - 1] = messageChecksum(message, length);
+    return length;
+}
+
+//----------------------------------------
+// Consumer
+//----------------------------------------
+
+// Verify a complete message
+void consumerVerifyMessage(CONSUMER * c)
+{
+    uint32_t sequence;
+
+    c->messages += 1;
+    if (c->message[c->messageLength - 1] != messageChecksum(c->message, c->messageLength))
+    {
+        c->corrupted += 1;
+        c->sequenceValid = false;
+        return;
+    }
+
+    // Sequence gaps are only allowed after the tail was trimmed
+    memcpy(&sequence, &c->message[4], sizeof(sequence));
+    if (c->sequenceValid && (sequence != c->expectedSequence))
+        c->sequenceErrors += 1;
+    c->expectedSequence = sequence + 1;
+    c->sequenceValid = true;
+}
+
+// Reassemble the messages from the data stream
+void consumerReceive(CONSUMER * c, const uint8_t * data, int length)
+{
+    int messageLength;
+
+    while (length-- > 0)
+    {
+        // Synchronize with the preamble
+        if ((c->messageLength == 0) && (*data != MESSAGE_PREAMBLE))
+        {
+            c->corrupted += 1;
+            data++;
+            continue;
+        }
+        c->message[c->messageLength++] = *data++;
+        if (c->messageLength < 3)
+            continue;
+
+        // Validate the length
+        messageLength = (c->message[1] << 8) | c->message[2];
+        if ((messageLength < MESSAGE_LENGTH_MIN) || (messageLength > MESSAGE_LENGTH_MAX))
+        {
+            c->corrupted += 1;
+            c->messageLength = 0;
+            continue;
+        }
+        if (c->messageLength == messageLength)
+        {
+            consumerVerifyMessage(c);
+            c->messageLength = 0;
+        }
+    }
+}
+
+// Send the data to the consumer, see ringBufferSendData in Tasks.ino
+void consumerSendData(CONSUMER * c)
+{
+    int32_t bytesToSend;
+    uint16_t head;
+    uint16_t tail;
+
+    // Prevent the producer from discarding this consumer's data
+    tail = ringBufferTailClaim(&c->tail);
+
+    // Trim the consumer's tail when the producer discarded data, the tail
+    // is now on a message boundary
+    if (tail != c->released)
+    {
+        if (ringBufferTailInRange(c->privateTail, c->released, tail))
+            c->privateTail = tail;
+        c->messageLength = 0;
+        c->sequenceValid = false;
+        c->trims += 1;
+    }
+
+    // Send a random sized piece of the data, wrap at the end of the buffer
+    head = ringBufferHeadGet(&dataHead);
+    bytesToSend = head - c->privateTail;
+    if (bytesToSend < 0)
+        bytesToSend += bufferSize;
+    if ((c->privateTail + bytesToSend) > bufferSize)
+        bytesToSend = bufferSize - c->privateTail;
+    if (bytesToSend > 1)
+        bytesToSend = 1 + rand_r(&c->seed) % bytesToSend;
+
+    // Simulate the write time while holding the data, one consumer stalls like an SD card
+    if ((c->index == STALL_CONSUMER) && ((rand_r(&c->seed) % 100) == 0))
+        sleepNanoseconds(STALL_NANOSECONDS);
+    else if (rand_r(&c->seed) & 1)
+        sleepNanoseconds(rand_r(&c->seed) % (2 * 1000 * 1000));
+
+    // Read the data at the end of the write, any overwrite during the write
+    // is detected as a corrupted message
+    if (bytesToSend)
+    {
+        consumerReceive(c, &ringBuffer[c->privateTail], bytesToSend);
+        c->bytes += bytesToSend;
+        c->privateTail += bytesToSend;
+        if (c->privateTail >= bufferSize)
+            c->privateTail -= bufferSize;
+    }
+
+    // Publish the tail and release the data
+    c->released = c->privateTail;
+    ringBufferTailRelease(&c->tail, c->privateTail);
+}
+
+void * consumerThread(void * arg)
+{
+    CONSUMER * c;
+
+    c = (CONSUMER *)arg;
+    while (!stopRequest)
+    {
+        consumerSendData(c);
+
+        // Poll for new data, one consumer stops polling long enough for
+        // the ring buffer to fill
+        if ((c->index == IDLE_CONSUMER) && ((rand_r(&c->seed) % 100) == 0))
+            sleepNanoseconds(IDLE_NANOSECONDS);
+        else if (rand_r(&c->seed) & 1)
+            sleepNanoseconds(100 * 1000);
+    }
+    return NULL;
+}
+
+//----------------------------------------
+// Producer, see processUart1Message in Tasks.ino
+//----------------------------------------
+
+static uint16_t * rbOffsetArray;
+static uint16_t rbOffsetEntries;
+static uint16_t rbOffsetHead;
+
+#define WRAP_OFFSET(offset, increment, arraySize)   \
+    {                                               \
+        offset += increment;                        \
+        if (offset >= arraySize)                    \
+            offset -= arraySize;                    \
+    }
+
+// Determine the space available in the ring buffer
+int32_t producerAvailableSpace(void)
+{
+    int32_t bytes;
+    int index;
+    int32_t usedSpace;
+
+    usedSpace = 0;
+    for (index = 0; index < CONSUMER_COUNT; index++)
+    {
+        bytes = dataHead - ringBufferTailGet(&consumer[index].tail);
+        if (bytes < 0)
+            bytes += bufferSize;
+        if (usedSpace < bytes)
+            usedSpace = bytes;
+    }
+    return bufferSize - usedSpace - 1;
+}
+
+// Discard the oldest messages, returns false when a consumer is reading them
+bool producerDiscard(int32_t space, int32_t bytesToCopy, int32_t * discardedBytes)
+{
+    int32_t bufferedData;
+    int32_t bytesToDiscard;
+    int index;
+    int32_t listEnd;
+    int32_t messageLength;
+    int32_t previousTail;
+    int32_t rbOffsetTail;
+    bool trimmed;
+    int32_t use;
+
+    use = bufferSize - space;
+    previousTail = dataHead + space + 1;
+    if (previousTail >= bufferSize)
+        previousTail -= bufferSize;
+
+    // Walk newest message to oldest message
+    listEnd = rbOffsetHead;
+    WRAP_OFFSET(listEnd, 1, rbOffsetEntries);
+    rbOffsetTail = rbOffsetHead;
+    bufferedData = 0;
+    messageLength = 0;
+    while ((rbOffsetTail != listEnd) && (bufferedData < use))
+    {
+        messageLength = rbOffsetArray[rbOffsetTail];
+        WRAP_OFFSET(rbOffsetTail, rbOffsetEntries - 1, rbOffsetEntries);
+        messageLength -= rbOffsetArray[rbOffsetTail];
+        if (messageLength < 0)
+            messageLength += bufferSize;
+        bufferedData += messageLength;
+    }
+    *discardedBytes = 0;
+    if (bufferedData < use)
+        *discardedBytes = use - bufferedData;
+    else if (bufferedData > use)
+    {
+        *discardedBytes = messageLength + use - bufferedData;
+        WRAP_OFFSET(rbOffsetTail, 1, rbOffsetEntries);
+    }
+
+    // Discard at least a quarter of the buffer
+    bytesToDiscard = *discardedBytes;
+    if (bytesToDiscard < bytesToCopy)
+        bytesToDiscard = bytesToCopy;
+    if (bytesToDiscard < (bufferSize >> 2))
+        bytesToDiscard = bufferSize >> 2;
+    while ((*discardedBytes < bytesToDiscard) && (rbOffsetTail != rbOffsetHead))
+    {
+        WRAP_OFFSET(rbOffsetTail, 1, rbOffsetEntries);
+        *discardedBytes = rbOffsetArray[rbOffsetTail] - previousTail;
+        if (*discardedBytes < 0)
+            *discardedBytes += bufferSize;
+    }
+
+    // Check all of the consumers before trimming the tails, see
+    // updateRingBufferTails in Tasks.ino
+    for (index = 0; index < CONSUMER_COUNT; index++)
+        if (ringBufferTailBusyInRange(&consumer[index].tail, previousTail, rbOffsetArray[rbOffsetTail]))
+            return false;
+    trimmed = true;
+    for (index = 0; index < CONSUMER_COUNT; index++)
+        if (!ringBufferTailTrim(&consumer[index].tail, previousTail, rbOffsetArray[rbOffsetTail]))
+            trimmed = false;
+    return trimmed;
+}
+
+// Add a message to the ring buffer, returns false when the message was dropped
+bool producerAddMessage(const uint8_t * message, int32_t length)
+{
+    int32_t bytesToCopy;
+    int32_t discardedBytes;
+    uint16_t newDataHead;
+    int32_t space;
+
+    // Determine if this message will fit into the ring buffer
+    space = producerAvailableSpace();
+    discardedBytes = 0;
+    if (length > space)
+    {
+        producerDiscards += 1;
+        if (!producerDiscard(space, length, &discardedBytes))
+        {
+            producerBusyDrops += 1;
+            return false;
+        }
+        if (length > (space + discardedBytes - 1))
+        {
+            fprintf(stderr, "ERROR: Discard failed, length %d > space %d + discarded %d - 1\n",
+                    length, space, discardedBytes);
+            exit(1);
+        }
+    }
+
+    // Copy the data into the ring buffer
+    newDataHead = dataHead;
+    bytesToCopy = length;
+    if ((newDataHead + bytesToCopy) > bufferSize)
+        bytesToCopy = bufferSize - newDataHead;
+    memcpy(&ringBuffer[newDataHead], message, bytesToCopy);
+    if (length > bytesToCopy)
+        memcpy(ringBuffer, &message[bytesToCopy], length - bytesToCopy);
+    newDataHead += length;
+    if (newDataHead >= bufferSize)
+        newDataHead -= bufferSize;
+
+    // Add the head offset to the offset array
+    WRAP_OFFSET(rbOffsetHead, 1, rbOffsetEntries);
+    rbOffsetArray[rbOffsetHead] = newDataHead;
+
+    // Publish the head
+    ringBufferHeadSet(&dataHead, newDataHead);
+    producerMessages += 1;
+    return true;
+}
+
+//----------------------------------------
+// Single threaded checks
+//----------------------------------------
+
+int checkRoutines(void)
+{
+    int errors;
+    RING_BUFFER_TAIL tail;
+
+    errors = 0;
+
+    // Range checks, with and without wrap
+    errors += !ringBufferTailInRange(10, 10, 20);
+    errors += ringBufferTailInRange(20, 10, 20);
+    errors += ringBufferTailInRange(9, 10, 20);
+    errors += !ringBufferTailInRange(1000, 900, 5);
+    errors += !ringBufferTailInRange(4, 900, 5);
+    errors += ringBufferTailInRange(5, 900, 5);
+
+    // Idle tail in range is moved
+    ringBufferTailRelease(&tail, 100);
+    errors += !ringBufferTailTrim(&tail, 50, 200);
+    errors += ringBufferTailGet(&tail) != 200;
+
+    // Idle tail out of range is not moved
+    errors += !ringBufferTailTrim(&tail, 50, 150);
+    errors += ringBufferTailGet(&tail) != 200;
+
+    // Busy tail in range is not moved
+    errors += ringBufferTailClaim(&tail) != 200;
+    errors += ringBufferTailTrim(&tail, 150, 300);
+    errors += !ringBufferTailBusyInRange(&tail, 150, 300);
+    errors += ringBufferTailGet(&tail) != 200;
+
+    // Released tail may be trimmed again
+    ringBufferTailRelease(&tail, 250);
+    errors += ringBufferTailBusyInRange(&tail, 150, 300);
+    errors += !ringBufferTailTrim(&tail, 150, 300);
+    errors += ringBufferTailGet(&tail) != 300;
+
+    if (errors)
+        fprintf(stderr, "ERROR: %d ring buffer routine checks failed\n", errors);
+    return errors;
+}
+
+//----------------------------------------
+// Main
+//----------------------------------------
+
+int main(int argc, char ** argv)
+{
+    uint64_t bytesPerSecond;
+    uint64_t bytesSent;
+    uint64_t endTime;
+    uint64_t errors;
+    int index;
+    int length;
+    uint8_t message[MESSAGE_LENGTH_MAX];
+    int seconds;
+    unsigned int seed;
+    uint32_t sequence;
+    uint64_t startTime;
+    uint64_t trims;
+
+    // Get the parameters
+    seconds = (argc > 1) ? atoi(argv[1]) : DEFAULT_SECONDS;
+    bytesPerSecond = (argc > 2) ? strtoull(argv[2], NULL, 0) : DEFAULT_BYTES_PER_SECOND;
+    length = (argc > 3) ? atoi(argv[3]) : DEFAULT_BUFFER_SIZE;
+    if ((seconds <= 0) || (length < (4 * MESSAGE_LENGTH_MAX)) || (length > RING_BUFFER_TAIL_OFFSET))
+    {
+        fprintf(stderr, "%s [seconds [bytes per second [buffer size (%d - %d)]]]\n",
+                argv[0], 4 * MESSAGE_LENGTH_MAX, RING_BUFFER_TAIL_OFFSET);
+        return -1;
+    }
+    bufferSize = (uint16_t)length;
+
+    // Verify the routines before starting the threads
+    errors = checkRoutines();
+
+    // Allocate the ring buffer along with the offset array, see Begin.ino
+    rbOffsetEntries = (bufferSize >> 1) / AVERAGE_MESSAGE_LENGTH;
+    rbOffsetArray = calloc(rbOffsetEntries, sizeof(uint16_t));
+    ringBuffer = malloc(bufferSize);
+    if ((!rbOffsetArray) || (!ringBuffer))
+    {
+        fprintf(stderr, "ERROR: Failed to allocate the ring buffer\n");
+        return -1;
+    }
+
+    // Start the consumers
+    for (index = 0; index < CONSUMER_COUNT; index++)
+    {
+        consumer[index].index = index;
+        consumer[index].seed = index + 1;
+        if (pthread_create(&consumer[index].thread, NULL, consumerThread, &consumer[index]))
+        {
+            fprintf(stderr, "ERROR: Failed to start consumer %d\n", index);
+            return -1;
+        }
+    }
+
+    // Produce messages at the GNSS data rate
+    printf("Running %d seconds, %llu bytes/second, %d byte buffer, %d consumers\n",
+           seconds, (unsigned long long)bytesPerSecond, bufferSize, CONSUMER_COUNT);
+    seed = 0;
+    sequence = 0;
+    bytesSent = 0;
+    startTime = nanoseconds();
+    endTime = startTime + seconds * NANOSECONDS_IN_A_SECOND;
+    while (nanoseconds() < endTime)
+    {
+        length = MESSAGE_LENGTH_MIN + rand_r(&seed) % (MESSAGE_LENGTH_MAX - MESSAGE_LENGTH_MIN + 1);
+        // Dropped messages don't use a sequence number
+        if (producerAddMessage(message, messageBuild(message, sequence, length)))
+            sequence += 1;
+        bytesSent += length;
+
+        // Limit the data rate
+        if (bytesPerSecond)
+            while ((nanoseconds() - startTime) < (bytesSent * NANOSECONDS_IN_A_SECOND / bytesPerSecond))
+                sleepNanoseconds(100 * 1000);
+    }
+
+    // Stop the consumers
+    stopRequest = true;
+    for (index = 0; index < CONSUMER_COUNT; index++)
+        pthread_join(consumer[index].thread, NULL);
+
+    // Display the results
+    printf("Producer: %llu messages, %llu bytes, %llu discards, %llu dropped (consumer writing)\n",
+           (unsigned long long)producerMessages, (unsigned long long)bytesSent,
+           (unsigned long long)producerDiscards, (unsigned long long)producerBusyDrops);
+    trims = 0;
+    for (index = 0; index < CONSUMER_COUNT; index++)
+    {
+        CONSUMER * c = &consumer[index];
+
+        printf("Consumer %d: %llu messages, %llu bytes, %llu trims, %llu corrupted, %llu sequence errors\n",
+               index, (unsigned long long)c->messages, (unsigned long long)c->bytes,
+               (unsigned long long)c->trims, (unsigned long long)c->corrupted,
+               (unsigned long long)c->sequenceErrors);
+        errors += c->corrupted + c->sequenceErrors;
+        trims += c->trims;
+    }
+
+    // The run must exercise the discard path
+    if (producerDiscards == 0)
+    {
+        fprintf(stderr, "ERROR: The ring buffer never overflowed\n");
+        errors += 1;
+    }
+    if (trims == 0)
+    {
+        fprintf(stderr, "ERROR: No consumer tail was trimmed\n");
+        errors += 1;
+    }
+    printf("%s\n", errors ? "FAILED" : "PASSED");
+    return errors ? 1 : 0;
+}
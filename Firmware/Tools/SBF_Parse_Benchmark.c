@@ -0,0 +1,603 @@
+//------------------------------------------------------------------------------
+// SBF_Parse_Benchmark.c
+//
+// Program to compare the cost of splitting the mosaic-X5 COM1 stream into
+// SBF blocks and raw L-Band (SPARTN) data on Linux.
+//
+// The byte method repeats the previous gnssReadTask loop: each byte is passed
+// to the SBF parser, followed by the header checks with a linear search of
+// mosaicExpectedIDs, and each non-SBF byte is passed to the SPARTN parser.
+// The bulk method mirrors gnssReadSbfData and processNonSBFData: memchr skips
+// to the next sync while the parsers are idle, the data between the checks is
+// passed in bulk and the headers are checked once with RTK_Everywhere/SbfBlock.h.
+//
+// Both methods use the same simplified SBF and SPARTN framing, modeled on the
+// SparkFun Extensible Message Parser, and the results are compared.
+//
+// Usage: SBF_Parse_Benchmark [capture_file [passes]]
+//
+//      The capture file contains the raw mosaic-X5 COM1 output.  A generated
+//      stream of L-Band data, SBF blocks and SPARTN messages is used when the
+//      capture file is not specified.  The default is 200 passes through the
+//      stream.
+//
+// Returns zero when both methods produce the same results.
+//------------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../RTK_Everywhere/SbfBlock.h"
+
+#define DEFAULT_PASSES              200
+#define NANOSECONDS_IN_A_SECOND     1000000000ull
+#define READ_BURST_BYTES            1024    // GNSS_READ_BURST_BYTES in Tasks.ino
+#define SBF_BUFFER_LENGTH           16384   // psramFound() ? 16384 : sempGnssReadBufferSize
+#define SBF_SYNC_2                  '@'
+#define STREAM_EPOCHS               500
+#define STREAM_LBAND_BYTES          600     // L-Band bytes between the SBF blocks
+
+typedef enum
+{
+    STATE_IDLE = 0, // sempFirstByte
+    STATE_SYNC_2,
+    STATE_HEADER,
+    STATE_BODY,
+} PARSER_STATE;
+
+// Simplified SEMP_PARSE_STATE
+typedef struct _PARSER
+{
+    PARSER_STATE state;
+    size_t length;
+    uint16_t blockLength;
+    uint8_t buffer[SBF_BUFFER_LENGTH];
+    void (*invalidData)(const uint8_t *buffer, size_t length);
+} PARSER;
+
+// Results compared between the methods
+typedef struct _RESULTS
+{
+    uint32_t sbfBlocks;
+    uint32_t sbfChecksum;
+    uint32_t sbfCrcFailures;
+    uint32_t spartnMessages;
+    uint32_t spartnChecksum;
+} RESULTS;
+
+static uint16_t crc16Table[256];
+static PARSER sbfParse;
+static PARSER spartnParse;
+static RESULTS results;
+
+//----------------------------------------
+// Support routines
+//----------------------------------------
+
+// Get the time in nanoseconds
+static uint64_t nanoseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * NANOSECONDS_IN_A_SECOND + now.tv_nsec;
+}
+
+// Build the CRC-16-CCITT table
+static void crc16Initialize(void)
+{
+    uint16_t crc;
+
+    for (int index = 0; index < 256; index++)
+    {
+        crc = (uint16_t)(index << 8);
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        crc16Table[index] = crc;
+    }
+}
+
+// Update the SBF CRC, CRC-16-CCITT
+static uint16_t crc16(uint16_t crc, uint8_t data)
+{
+    return (uint16_t)((crc << 8) ^ crc16Table[(crc >> 8) ^ data]);
+}
+
+// Get the SBF block ID without the revision
+static uint16_t sbfGetId(const PARSER *parse)
+{
+    return (parse->buffer[4] | (((uint16_t)parse->buffer[5]) << 8)) & 0x1fff;
+}
+
+// Get the SBF block length
+static uint16_t sbfGetLength(const PARSER *parse)
+{
+    return parse->buffer[6] | (((uint16_t)parse->buffer[7]) << 8);
+}
+
+//----------------------------------------
+// Simplified SPARTN parser: preamble, payload length, payload
+//----------------------------------------
+
+static void spartnParseNextByte(PARSER *parse, uint8_t data)
+{
+    switch (parse->state)
+    {
+    default:
+        // Discard the data before the preamble
+        if (data != SPARTN_PREAMBLE)
+            return;
+        parse->length = 0;
+        parse->state = STATE_HEADER;
+        break;
+
+    case STATE_HEADER:
+        parse->blockLength = data + 2;
+        parse->state = STATE_BODY;
+        break;
+
+    case STATE_BODY:
+        break;
+    }
+    parse->buffer[parse->length++] = data;
+
+    // Process the message
+    if ((parse->state == STATE_BODY) && (parse->length >= parse->blockLength))
+    {
+        results.spartnMessages += 1;
+        for (size_t index = 0; index < parse->length; index++)
+            results.spartnChecksum = results.spartnChecksum * 31 + parse->buffer[index];
+        parse->state = STATE_IDLE;
+    }
+}
+
+//----------------------------------------
+// Simplified SBF parser
+//----------------------------------------
+
+// Return the bytes to the invalid data callback and look for the next block
+static void sbfInvalidData(PARSER *parse)
+{
+    parse->state = STATE_IDLE;
+    if (parse->invalidData)
+        parse->invalidData(parse->buffer, parse->length);
+}
+
+static void sbfParseNextByte(PARSER *parse, uint8_t data)
+{
+    uint16_t crc;
+
+    switch (parse->state)
+    {
+    case STATE_IDLE:
+        parse->length = 0;
+        parse->buffer[parse->length++] = data;
+        if (data == SBF_SYNC_1)
+            parse->state = STATE_SYNC_2;
+        else
+            sbfInvalidData(parse);
+        return;
+
+    case STATE_SYNC_2:
+        if (data != SBF_SYNC_2)
+        {
+            // Check the byte for the start of the next block
+            sbfInvalidData(parse);
+            sbfParseNextByte(parse, data);
+            return;
+        }
+        parse->buffer[parse->length++] = data;
+        parse->state = STATE_HEADER;
+        return;
+
+    case STATE_HEADER:
+        parse->buffer[parse->length++] = data;
+        if (parse->length < SBF_HEADER_LENGTH)
+            return;
+        parse->blockLength = sbfGetLength(parse);
+        if ((parse->blockLength < SBF_HEADER_LENGTH) || (parse->blockLength & 3)
+            || (parse->blockLength > sizeof(parse->buffer)))
+        {
+            sbfInvalidData(parse);
+            return;
+        }
+        parse->state = STATE_BODY;
+        return;
+
+    case STATE_BODY:
+        parse->buffer[parse->length++] = data;
+        if (parse->length < parse->blockLength)
+            return;
+
+        // Verify the CRC
+        crc = 0;
+        for (size_t index = 4; index < parse->length; index++)
+            crc = crc16(crc, parse->buffer[index]);
+        if (crc != (parse->buffer[2] | (((uint16_t)parse->buffer[3]) << 8)))
+        {
+            results.sbfCrcFailures += 1;
+            sbfInvalidData(parse);
+            return;
+        }
+
+        // Process the block
+        results.sbfBlocks += 1;
+        results.sbfChecksum = results.sbfChecksum * 31 + sbfGetId(parse) + parse->length;
+        parse->state = STATE_IDLE;
+        return;
+    }
+}
+
+static void sbfParseNextBytes(PARSER *parse, const uint8_t *data, size_t length)
+{
+    while (length--)
+        sbfParseNextByte(parse, *data++);
+}
+
+//----------------------------------------
+// Byte method, the previous gnssReadTask loop
+//----------------------------------------
+
+static void byteNonSbfData(const uint8_t *buffer, size_t length)
+{
+    for (uint32_t dataOffset = 0; dataOffset < length; dataOffset++)
+        // Update the SPARTN parser state based on the non-SBF byte
+        spartnParseNextByte(&spartnParse, buffer[dataOffset]);
+}
+
+static void byteMethod(const uint8_t *incomingData, size_t bytesIncoming)
+{
+    for (size_t x = 0; x < bytesIncoming; x++)
+    {
+        sbfParseNextByte(&sbfParse, incomingData[x]);
+
+        // Check if this is Length MSB
+        if ((sbfParse.state != STATE_IDLE) && (sbfParse.length == 8))
+        {
+            bool expected = false;
+            for (size_t b = 0; b < MAX_MOSAIC_EXPECTED_SBF; b++) // For each expected SBF block
+            {
+                if (mosaicExpectedIDs[b].ID == sbfGetId(&sbfParse)) // Check for ID match
+                {
+                    expected = true;
+                    if (mosaicExpectedIDs[b].fixedLength)
+                    {
+                        // Check for length match if fixed
+                        if (mosaicExpectedIDs[b].length != sbfGetLength(&sbfParse))
+                            expected = false;
+                    }
+                }
+            }
+            if (!expected) // SBF is not expected so restart the parsers
+            {
+                sbfParse.state = STATE_IDLE;
+                spartnParse.state = STATE_IDLE;
+            }
+        }
+
+        // Extra checks for EncapsulatedOutput
+        if ((sbfParse.length == 18) && (sbfGetId(&sbfParse) == 4097))
+        {
+            bool expected = true;
+            if ((sbfParse.buffer[14] != 2) && (sbfParse.buffer[14] != 4)) // Check Mode for RTCMv3 and NMEA
+                expected = false;
+
+            // SBF block length should be 20 more than N (payload length) - with padding
+            if (expected)
+            {
+                uint16_t N = sbfParse.buffer[16];
+                N |= ((uint16_t)sbfParse.buffer[17]) << 8;
+                uint16_t expectedLength = N + 20; // Expected length
+                uint16_t remainder = ((N + 20) % 4);
+                if (remainder > 0)
+                    expectedLength += 4 - remainder; // Include the padding
+                if (sbfGetLength(&sbfParse) != expectedLength)
+                    expected = false;
+            }
+
+            if (!expected) // SBF is not expected so restart the parsers
+            {
+                sbfParse.state = STATE_IDLE;
+                spartnParse.state = STATE_IDLE;
+            }
+        }
+    }
+}
+
+//----------------------------------------
+// Bulk method, mirrors gnssReadSbfData and processNonSBFData in GNSS_Mosaic.ino
+//----------------------------------------
+
+static void bulkNonSbfData(const uint8_t *buffer, size_t length)
+{
+    const uint8_t *end;
+    const uint8_t *preamble;
+
+    end = &buffer[length];
+    while (buffer < end)
+    {
+        // The idle SPARTN parser discards everything before the preamble, skip it in bulk
+        if (spartnParse.state == STATE_IDLE)
+        {
+            preamble = (const uint8_t *)memchr(buffer, SPARTN_PREAMBLE, end - buffer);
+            if (!preamble)
+                break;
+            buffer = preamble;
+        }
+        spartnParseNextByte(&spartnParse, *buffer++);
+    }
+}
+
+static void bulkMethod(const uint8_t *buffer, size_t length)
+{
+    size_t bytes;
+    const uint8_t *end;
+    bool expected;
+    size_t received;
+    const uint8_t *sync;
+
+    end = &buffer[length];
+    while (buffer < end)
+    {
+        // Determine the number of block bytes already received
+        received = 0;
+        if (sbfParse.state == STATE_IDLE)
+        {
+            // Skip the L-Band data before the next SBF sync
+            sync = (const uint8_t *)memchr(buffer, SBF_SYNC_1, end - buffer);
+            bytes = (sync ? sync : end) - buffer;
+            if (bytes)
+            {
+                bulkNonSbfData(buffer, bytes);
+                buffer += bytes;
+                continue;
+            }
+        }
+        else
+            received = sbfParse.length;
+
+        // Pass the data up to the next check
+        if (received >= SBF_HEADER_LENGTH)
+            bytes = mosaicSbfBytesToCheck(received, sbfGetId(&sbfParse), sbfGetLength(&sbfParse));
+        else
+            bytes = mosaicSbfBytesToCheck(received, 0, 0);
+        if (bytes > (size_t)(end - buffer))
+            bytes = end - buffer;
+        sbfParseNextBytes(&sbfParse, buffer, bytes);
+        buffer += bytes;
+        if (sbfParse.state == STATE_IDLE)
+            continue;
+
+        // Check the headers once
+        if (sbfParse.length == SBF_HEADER_LENGTH)
+            expected = mosaicSbfHeaderValid(sbfGetId(&sbfParse), sbfGetLength(&sbfParse));
+        else if ((sbfParse.length == SBF_ENCAPSULATED_HEADER_LENGTH)
+                 && (sbfGetId(&sbfParse) == SBF_ENCAPSULATED_OUTPUT_ID))
+            expected = mosaicSbfEncapsulatedValid(sbfParse.buffer, sbfGetLength(&sbfParse));
+        else
+            continue;
+        if (!expected)
+        {
+            sbfParse.state = STATE_IDLE;
+            spartnParse.state = STATE_IDLE;
+        }
+    }
+}
+
+//----------------------------------------
+// Stream generation
+//----------------------------------------
+
+static uint32_t randomState = 12345;
+
+// Linear congruential generator, repeatable streams
+static uint8_t randomByte(void)
+{
+    randomState = randomState * 1103515245 + 12345;
+    return (uint8_t)(randomState >> 16);
+}
+
+// Add data to the stream
+static void streamAdd(uint8_t **stream, size_t *length, size_t *allocated, const uint8_t *data, size_t dataLength)
+{
+    if ((*length + dataLength) > *allocated)
+    {
+        *allocated = (*length + dataLength) * 2;
+        *stream = realloc(*stream, *allocated);
+        if (!*stream)
+        {
+            fprintf(stderr, "ERROR: Failed to allocate the stream!\n");
+            exit(1);
+        }
+    }
+    memcpy(&(*stream)[*length], data, dataLength);
+    *length += dataLength;
+}
+
+// Add an SBF block to the stream, the block length is rounded up to a multiple of four
+static void streamAddSbf(uint8_t **stream, size_t *length, size_t *allocated, uint16_t id,
+                         const uint8_t *body, size_t bodyLength)
+{
+    uint8_t block[SBF_BUFFER_LENGTH];
+    uint16_t blockLength;
+    uint16_t crc;
+
+    blockLength = (uint16_t)((SBF_HEADER_LENGTH + bodyLength + 3) & ~3);
+    memset(block, 0, blockLength);
+    block[0] = SBF_SYNC_1;
+    block[1] = SBF_SYNC_2;
+    block[4] = (uint8_t)id;
+    block[5] = (uint8_t)(id >> 8);
+    block[6] = (uint8_t)blockLength;
+    block[7] = (uint8_t)(blockLength >> 8);
+    memcpy(&block[SBF_HEADER_LENGTH], body, bodyLength);
+    crc = 0;
+    for (size_t index = 4; index < blockLength; index++)
+        crc = crc16(crc, block[index]);
+    block[2] = (uint8_t)crc;
+    block[3] = (uint8_t)(crc >> 8);
+    streamAdd(stream, length, allocated, block, blockLength);
+}
+
+// Build a stream of L-Band data containing SPARTN messages, interspersed with SBF blocks
+static uint8_t *streamGenerate(size_t *streamLength)
+{
+    size_t allocated;
+    uint8_t body[512];
+    size_t length;
+    static const char nmea[] =
+        "$GNGGA,202530.00,4004.73854216,N,10513.77012021,W,4,28,0.8,1574.406,M,-21.321,M,1.0,0000*5A\r\n";
+    uint8_t *stream;
+
+    allocated = 0;
+    length = 0;
+    stream = NULL;
+    for (int epoch = 0; epoch < STREAM_EPOCHS; epoch++)
+    {
+        // Raw L-Band data containing a SPARTN message
+        for (int index = 0; index < STREAM_LBAND_BYTES; index++)
+        {
+            body[0] = randomByte();
+            if (index == STREAM_LBAND_BYTES / 2)
+            {
+                body[0] = SPARTN_PREAMBLE;
+                body[1] = 64;
+                for (int offset = 2; offset < 66; offset++)
+                    body[offset] = randomByte();
+                streamAdd(&stream, &length, &allocated, body, 66);
+                continue;
+            }
+            streamAdd(&stream, &length, &allocated, body, 1);
+        }
+
+        // PVTGeodetic and ReceiverTime
+        for (size_t index = 0; index < sizeof(body); index++)
+            body[index] = randomByte();
+        streamAddSbf(&stream, &length, &allocated, 4007, body, 96 - SBF_HEADER_LENGTH);
+        streamAddSbf(&stream, &length, &allocated, 5914, body, 24 - SBF_HEADER_LENGTH);
+
+        // Variable length ChannelStatus
+        streamAddSbf(&stream, &length, &allocated, 4013, body, 200 + (epoch & 0x3c));
+
+        // Unexpected MeasEpoch, rejected by the header check
+        streamAddSbf(&stream, &length, &allocated, 4027, body, 256);
+
+        // EncapsulatedOutput containing NMEA
+        memset(body, 0, SBF_ENCAPSULATED_HEADER_LENGTH - SBF_HEADER_LENGTH);
+        body[14 - SBF_HEADER_LENGTH] = SBF_ENCAPSULATED_MODE_NMEA;
+        body[16 - SBF_HEADER_LENGTH] = (uint8_t)(sizeof(nmea) - 1);
+        body[17 - SBF_HEADER_LENGTH] = 0;
+        memcpy(&body[20 - SBF_HEADER_LENGTH], nmea, sizeof(nmea) - 1);
+        streamAddSbf(&stream, &length, &allocated, SBF_ENCAPSULATED_OUTPUT_ID, body,
+                     20 - SBF_HEADER_LENGTH + sizeof(nmea) - 1);
+    }
+    *streamLength = length;
+    return stream;
+}
+
+//----------------------------------------
+// Benchmark
+//----------------------------------------
+
+// Time a method, the stream is passed in UART sized reads
+static uint64_t timeMethod(void (*method)(const uint8_t *buffer, size_t length),
+                           void (*nonSbfData)(const uint8_t *buffer, size_t length),
+                           const uint8_t *stream,
+                           size_t length,
+                           int passes,
+                           RESULTS *methodResults)
+{
+    size_t bytes;
+    uint64_t start;
+
+    memset(&results, 0, sizeof(results));
+    memset(&sbfParse, 0, sizeof(sbfParse));
+    memset(&spartnParse, 0, sizeof(spartnParse));
+    sbfParse.invalidData = nonSbfData;
+
+    start = nanoseconds();
+    for (int pass = 0; pass < passes; pass++)
+        for (size_t offset = 0; offset < length; offset += bytes)
+        {
+            bytes = length - offset;
+            if (bytes > READ_BURST_BYTES)
+                bytes = READ_BURST_BYTES;
+            method(&stream[offset], bytes);
+        }
+    *methodResults = results;
+    return nanoseconds() - start;
+}
+
+// Display the results of a method
+static void displayResults(const char *name, uint64_t time, size_t bytes, const RESULTS *methodResults)
+{
+    printf("%s %8.2f nSec/byte, SBF: %u blocks (0x%08x), %u CRC failures, SPARTN: %u messages (0x%08x)\n",
+           name, (double)time / (double)bytes, methodResults->sbfBlocks, methodResults->sbfChecksum,
+           methodResults->sbfCrcFailures, methodResults->spartnMessages, methodResults->spartnChecksum);
+}
+
+// Compare the byte and bulk methods
+int main(int argc, char **argv)
+{
+    RESULTS bulkResults;
+    uint64_t bulkTime;
+    RESULTS byteResults;
+    uint64_t byteTime;
+    FILE *file;
+    size_t length;
+    bool match;
+    int passes;
+    uint8_t *stream;
+
+    crc16Initialize();
+
+    // Get the stream
+    if (argc > 1)
+    {
+        file = fopen(argv[1], "rb");
+        if (!file)
+        {
+            fprintf(stderr, "ERROR: Failed to open %s\n", argv[1]);
+            return 1;
+        }
+        fseek(file, 0, SEEK_END);
+        length = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        stream = malloc(length);
+        if ((!stream) || (fread(stream, 1, length, file) != length))
+        {
+            fprintf(stderr, "ERROR: Failed to read %s\n", argv[1]);
+            fclose(file);
+            return 1;
+        }
+        fclose(file);
+    }
+    else
+        stream = streamGenerate(&length);
+    passes = (argc > 2) ? atoi(argv[2]) : DEFAULT_PASSES;
+    if ((passes <= 0) || (length == 0))
+    {
+        fprintf(stderr, "Usage: %s [capture_file [passes]]\n", argv[0]);
+        return 1;
+    }
+    printf("%zu bytes, %d passes\n", length, passes);
+
+    // Time both methods
+    byteTime = timeMethod(byteMethod, byteNonSbfData, stream, length, passes, &byteResults);
+    bulkTime = timeMethod(bulkMethod, bulkNonSbfData, stream, length, passes, &bulkResults);
+    displayResults("byte:", byteTime, length * passes, &byteResults);
+    displayResults("bulk:", bulkTime, length * passes, &bulkResults);
+    if (bulkTime)
+        printf("speedup: %8.2fx\n", (double)byteTime / (double)bulkTime);
+
+    // Verify that both methods produce the same results
+    match = (memcmp(&byteResults, &bulkResults, sizeof(byteResults)) == 0);
+    printf("%s\n", match ? "PASSED" : "FAILED");
+
+    free(stream);
+    return match ? 0 : 1;
+}
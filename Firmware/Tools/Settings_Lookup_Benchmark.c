@@ -0,0 +1,526 @@
+//------------------------------------------------------------------------------
+// Settings_Lookup_Benchmark.c
+//
+// Program to compare the cost of building commandIndex and looking up the
+// setting names while loading a settings file on Linux.
+//
+// The setting names, useSuffix and inCommands flags are read from the
+// rtkSettingsEntries table in settings.h.  The entries before
+// endOfPrioritySettings are the priority settings, the remaining entries are
+// sorted ignoring case like commandIndexFill.  The settings file contains
+// each name once, the suffix settings are listed with four suffixes.
+//
+// The linear method is the previous commandLookupSettingNameSelective, a
+// linear scan of commandIndex for the complete name followed by a second
+// linear scan for the name with the suffix removed.  The binary method is
+// commandLookupName, a linear scan of the priority settings followed by a
+// binary search of the sorted entries.  Both methods must return the same
+// entry for every line of the settings file.
+//
+// The exchange fill is the previous commandIndexFill, a platform filter
+// followed by an exchange sort of the commands after the priority settings.
+// The presorted fill is the current commandIndexFill, a single sort of all of
+// the commands after the priority settings followed by a platform filter for
+// each fill.  setup calls commandIndexFill twice, so each method fills the
+// index twice for each platform.  Both methods must produce the same order of
+// names.
+//
+// Usage: Settings_Lookup_Benchmark [settings.h [loads]]
+//
+//      The defaults read ../RTK_Everywhere/settings.h and load the
+//      settings file 100 times.
+//
+// Returns zero when both methods find the same entries.
+//------------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#define COMMAND_UNKNOWN             -1
+#define DEFAULT_LOADS               100
+#define DEFAULT_SETTINGS_FILE       "../RTK_Everywhere/settings.h"
+#define MAX_ENTRIES                 4096
+#define NAME_LENGTH                 64
+#define NANOSECONDS_IN_A_SECOND     1000000000ull
+#define PLATFORMS                   6
+#define SUFFIXES                    4
+
+typedef struct _ENTRY
+{
+    char name[NAME_LENGTH];
+    bool inCommands;
+    bool useSuffix;
+    bool platform[PLATFORMS];
+} ENTRY;
+
+const char *platformNames[PLATFORMS] = {"EVK", "Facet mosaic", "Torch", "Postcard", "Facet FP", "Torch X2"};
+
+ENTRY entries[MAX_ENTRIES];
+int entryCount;
+int16_t commandIndex[MAX_ENTRIES];
+int commandCount;
+int prioritySettingsEnd;
+int16_t fillIndex[MAX_ENTRIES];
+int16_t sortedIndex[MAX_ENTRIES];
+uint64_t compares;
+
+char (*lines)[NAME_LENGTH * 2];
+int lineCount;
+
+//----------------------------------------
+// Support routines
+//----------------------------------------
+
+// Get the time in nanoseconds
+uint64_t nanoseconds()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * NANOSECONDS_IN_A_SECOND) + now.tv_nsec;
+}
+
+// Split the name at the first underscore, like commandSplitName
+void splitName(const char *settingName, char *truncatedName, size_t truncatedNameLen)
+{
+    const char *underscore;
+    size_t length;
+
+    underscore = strchr(settingName, '_');
+    if (underscore == NULL)
+        length = strlen(settingName);
+    else
+        length = (underscore - settingName) + 1;
+    if (length >= truncatedNameLen)
+        length = truncatedNameLen - 1;
+    memcpy(truncatedName, settingName, length);
+    truncatedName[length] = 0;
+}
+
+// Compare two entries ignoring case, like commandIndexFill
+int sortCompare(const void *a, const void *b)
+{
+    return strcasecmp(entries[*(const int16_t *)a].name, entries[*(const int16_t *)b].name);
+}
+
+//----------------------------------------
+// Read the rtkSettingsEntries table
+//----------------------------------------
+
+// Read the setting names and flags from settings.h
+bool readSettingsTable(const char *fileName)
+{
+    char buffer[1024];
+    FILE *file;
+    char facetFp[16];
+    int inCommands;
+    int inWebConfig;
+    int platform[PLATFORMS];
+    char *name;
+    char *nameEnd;
+    char *text;
+    int useSuffix;
+
+    file = fopen(fileName, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "ERROR: Unable to open %s\n", fileName);
+        return false;
+    }
+
+    // Each table entry starts with { inWebConfig, inCommands, useSuffix, ...
+    prioritySettingsEnd = -1;
+    while (fgets(buffer, sizeof(buffer), file))
+    {
+        text = buffer;
+        while ((*text == ' ') || (*text == '\t'))
+            text++;
+        if (sscanf(text, "{ %d, %d, %d, %d, %d, %d, %d, %15[A-Z0-9], %d,", &inWebConfig, &inCommands, &useSuffix,
+                   &platform[0], &platform[1], &platform[2], &platform[3], facetFp, &platform[5]) != 9)
+            continue;
+        platform[4] = (strcmp(facetFp, "NON") != 0);
+        if ((strstr(text, "& settings.") == NULL) && (strstr(text, "nullptr, \"") == NULL))
+            continue;
+
+        // Get the setting name
+        name = strchr(text, '"');
+        if (name == NULL)
+            continue;
+        name++;
+        nameEnd = strchr(name, '"');
+        if ((nameEnd == NULL) || ((nameEnd - name) >= NAME_LENGTH))
+            continue;
+        *nameEnd = 0;
+
+        // The priority settings end marker does not appear in commandIndex
+        if (strcmp(name, "endOfPrioritySettings") == 0)
+        {
+            prioritySettingsEnd = entryCount;
+            continue;
+        }
+
+        if (entryCount >= MAX_ENTRIES)
+            break;
+        strcpy(entries[entryCount].name, name);
+        entries[entryCount].inCommands = inCommands;
+        entries[entryCount].useSuffix = useSuffix;
+        for (int index = 0; index < PLATFORMS; index++)
+            entries[entryCount].platform[index] = platform[index];
+        entryCount++;
+    }
+    fclose(file);
+
+    if (prioritySettingsEnd < 0)
+        prioritySettingsEnd = 0;
+    return (entryCount > 0);
+}
+
+// Build commandIndex and the settings file lines
+bool buildTables()
+{
+    // Fill and sort commandIndex
+    for (commandCount = 0; commandCount < entryCount; commandCount++)
+        commandIndex[commandCount] = commandCount;
+    qsort(&commandIndex[prioritySettingsEnd], commandCount - prioritySettingsEnd, sizeof(commandIndex[0]),
+          sortCompare);
+
+    // Create the settings file lines
+    lines = malloc(entryCount * SUFFIXES * sizeof(*lines));
+    if (lines == NULL)
+    {
+        fprintf(stderr, "ERROR: Unable to allocate the settings file lines\n");
+        return false;
+    }
+    for (int index = 0; index < entryCount; index++)
+    {
+        if (entries[index].useSuffix)
+            for (int suffix = 0; suffix < SUFFIXES; suffix++)
+                snprintf(lines[lineCount++], sizeof(lines[0]), "%s%d", entries[index].name, suffix);
+        else
+            snprintf(lines[lineCount++], sizeof(lines[0]), "%s", entries[index].name);
+    }
+    return true;
+}
+
+//----------------------------------------
+// Exchange fill: previous commandIndexFill
+//----------------------------------------
+
+int exchangeFill(int platform)
+{
+    int count;
+    int16_t temp;
+
+    count = 0;
+    for (int i = 0; i < entryCount; i++)
+        if (entries[i].platform[platform])
+            fillIndex[count++] = i;
+
+    // Determine the end of the priority settings
+    int end = prioritySettingsEnd;
+    for (int i = 0; i < prioritySettingsEnd; i++)
+        if (!entries[i].platform[platform])
+            end--;
+
+    // Sort the commands
+    for (int i = end; i < count - 1; i++)
+    {
+        for (int j = i + 1; j < count; j++)
+        {
+            compares++;
+            if (strncasecmp(entries[fillIndex[i]].name, entries[fillIndex[j]].name,
+                            strlen(entries[fillIndex[i]].name) + 1) > 0)
+            {
+                temp = fillIndex[i];
+                fillIndex[i] = fillIndex[j];
+                fillIndex[j] = temp;
+            }
+        }
+    }
+    return count;
+}
+
+//----------------------------------------
+// Presorted fill: commandIndexFill
+//----------------------------------------
+
+int sortedCount;
+
+// Compare two entries ignoring case, equal names remain in table order
+int presortCompare(const void *a, const void *b)
+{
+    int result;
+
+    compares++;
+    result = sortCompare(a, b);
+    if (result == 0)
+        result = *(const int16_t *)a - *(const int16_t *)b;
+    return result;
+}
+
+void presort()
+{
+    sortedCount = 0;
+    for (int i = prioritySettingsEnd; i < entryCount; i++)
+        sortedIndex[sortedCount++] = i;
+    qsort(sortedIndex, sortedCount, sizeof(sortedIndex[0]), presortCompare);
+}
+
+int presortedFill(int platform)
+{
+    int count;
+
+    count = 0;
+    for (int i = 0; i < prioritySettingsEnd; i++)
+        if (entries[i].platform[platform])
+            fillIndex[count++] = i;
+    for (int i = 0; i < sortedCount; i++)
+        if (entries[sortedIndex[i]].platform[platform])
+            fillIndex[count++] = sortedIndex[i];
+    return count;
+}
+
+//----------------------------------------
+// Linear lookup: previous commandLookupSettingNameSelective
+//----------------------------------------
+
+int linearLookup(bool inCommands, const char *settingName)
+{
+    char truncatedName[NAME_LENGTH];
+    int rtkIndex;
+
+    for (int i = 0; i < commandCount; i++)
+    {
+        rtkIndex = commandIndex[i];
+        if ((!entries[rtkIndex].useSuffix) && ((!inCommands) || entries[rtkIndex].inCommands))
+        {
+            compares++;
+            if ((entries[rtkIndex].name[0] == settingName[0]) && (strcmp(entries[rtkIndex].name, settingName) == 0))
+                return rtkIndex;
+        }
+    }
+
+    splitName(settingName, truncatedName, sizeof(truncatedName));
+    for (int i = 0; i < commandCount; i++)
+    {
+        rtkIndex = commandIndex[i];
+        if (entries[rtkIndex].useSuffix)
+        {
+            compares++;
+            if ((entries[rtkIndex].name[0] == truncatedName[0]) && (strcmp(entries[rtkIndex].name, truncatedName) == 0))
+                return rtkIndex;
+        }
+    }
+    return COMMAND_UNKNOWN;
+}
+
+//----------------------------------------
+// Binary lookup: commandLookupName
+//----------------------------------------
+
+bool binaryMatch(int rtkIndex, const char *name, bool useSuffix, bool inCommands)
+{
+    if (entries[rtkIndex].useSuffix != useSuffix)
+        return false;
+    if (inCommands && (!useSuffix) && (!entries[rtkIndex].inCommands))
+        return false;
+    compares++;
+    return (strcmp(entries[rtkIndex].name, name) == 0);
+}
+
+int binaryLookupName(bool inCommands, const char *name, bool useSuffix)
+{
+    int high;
+    int low;
+    int middle;
+
+    for (int i = 0; i < prioritySettingsEnd; i++)
+        if (binaryMatch(commandIndex[i], name, useSuffix, inCommands))
+            return commandIndex[i];
+
+    low = prioritySettingsEnd;
+    high = commandCount;
+    while (low < high)
+    {
+        middle = (low + high) / 2;
+        compares++;
+        if (strcasecmp(entries[commandIndex[middle]].name, name) < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    for (int i = low; i < commandCount; i++)
+    {
+        compares++;
+        if (strcasecmp(entries[commandIndex[i]].name, name))
+            break;
+        if (binaryMatch(commandIndex[i], name, useSuffix, inCommands))
+            return commandIndex[i];
+    }
+    return COMMAND_UNKNOWN;
+}
+
+int binaryLookup(bool inCommands, const char *settingName)
+{
+    char truncatedName[NAME_LENGTH];
+    int rtkIndex;
+
+    rtkIndex = binaryLookupName(inCommands, settingName, false);
+    if (rtkIndex == COMMAND_UNKNOWN)
+    {
+        splitName(settingName, truncatedName, sizeof(truncatedName));
+        rtkIndex = binaryLookupName(inCommands, truncatedName, true);
+    }
+    return rtkIndex;
+}
+
+//----------------------------------------
+// Benchmark
+//----------------------------------------
+
+// Compare the commandIndex fill methods, returns the number of errors
+int fillBenchmark()
+{
+    uint64_t exchangeCompares;
+    int exchangeCount;
+    int16_t exchangeIndex[MAX_ENTRIES];
+    uint64_t exchangeTime;
+    int errors;
+    uint64_t presortedCompares;
+    int presortedCount;
+    uint64_t presortedTime;
+    uint64_t startTime;
+
+    errors = 0;
+    printf("Platform       Exchange Compares   usec   Presorted Compares   usec\n");
+    for (int platform = 0; platform < PLATFORMS; platform++)
+    {
+        // Fill the index twice with the exchange sort
+        compares = 0;
+        startTime = nanoseconds();
+        for (int fill = 0; fill < 2; fill++)
+            exchangeCount = exchangeFill(platform);
+        exchangeTime = nanoseconds() - startTime;
+        exchangeCompares = compares;
+        memcpy(exchangeIndex, fillIndex, exchangeCount * sizeof(fillIndex[0]));
+
+        // Sort once and fill the index twice
+        compares = 0;
+        startTime = nanoseconds();
+        presort();
+        for (int fill = 0; fill < 2; fill++)
+            presortedCount = presortedFill(platform);
+        presortedTime = nanoseconds() - startTime;
+        presortedCompares = compares;
+
+        // Verify the order of the names
+        if (exchangeCount != presortedCount)
+        {
+            printf("ERROR: %s, exchange count %d, presorted count %d\n", platformNames[platform], exchangeCount,
+                   presortedCount);
+            errors++;
+        }
+        else
+        {
+            for (int index = 0; index < exchangeCount; index++)
+            {
+                if (strcasecmp(entries[exchangeIndex[index]].name, entries[fillIndex[index]].name))
+                {
+                    printf("ERROR: %s, entry %d, exchange %s, presorted %s\n", platformNames[platform], index,
+                           entries[exchangeIndex[index]].name, entries[fillIndex[index]].name);
+                    errors++;
+                    break;
+                }
+            }
+        }
+        printf("%-12s   %17llu   %4.0f   %18llu   %4.0f\n", platformNames[platform],
+               (unsigned long long)exchangeCompares, (double)exchangeTime / 1000.,
+               (unsigned long long)presortedCompares, (double)presortedTime / 1000.);
+    }
+    return errors;
+}
+
+// Load the settings file, returns the elapsed time in nanoseconds
+uint64_t loadSettings(int (*lookup)(bool inCommands, const char *settingName), int loads, int *results)
+{
+    uint64_t startTime;
+
+    startTime = nanoseconds();
+    for (int load = 0; load < loads; load++)
+        for (int line = 0; line < lineCount; line++)
+            results[line] = lookup(false, lines[line]);
+    return nanoseconds() - startTime;
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t binaryCompares;
+    uint64_t binaryTime;
+    int *binaryResults;
+    int errors;
+    uint64_t linearCompares;
+    uint64_t linearTime;
+    int *linearResults;
+    int loads;
+    const char *settingsFile;
+
+    settingsFile = (argc > 1) ? argv[1] : DEFAULT_SETTINGS_FILE;
+    loads = (argc > 2) ? atoi(argv[2]) : DEFAULT_LOADS;
+    if (loads <= 0)
+    {
+        fprintf(stderr, "ERROR: Invalid number of loads\n");
+        return -1;
+    }
+
+    if ((!readSettingsTable(settingsFile)) || (!buildTables()))
+        return -1;
+    printf("%d settings (%d priority), %d settings file lines, %d loads\n", entryCount, prioritySettingsEnd,
+           lineCount, loads);
+
+    linearResults = malloc(lineCount * sizeof(*linearResults));
+    binaryResults = malloc(lineCount * sizeof(*binaryResults));
+    if ((linearResults == NULL) || (binaryResults == NULL))
+    {
+        fprintf(stderr, "ERROR: Unable to allocate the results\n");
+        return -1;
+    }
+
+    // Time the commandIndex fills
+    errors = fillBenchmark();
+
+    // Time the lookups
+    compares = 0;
+    linearTime = loadSettings(linearLookup, loads, linearResults);
+    linearCompares = compares / loads;
+    compares = 0;
+    binaryTime = loadSettings(binaryLookup, loads, binaryResults);
+    binaryCompares = compares / loads;
+
+    // Verify the results
+    for (int line = 0; line < lineCount; line++)
+    {
+        if ((linearResults[line] != binaryResults[line]) || (linearResults[line] == COMMAND_UNKNOWN))
+        {
+            if (errors++ < 10)
+                printf("ERROR: %s, linear %d, binary %d\n", lines[line], linearResults[line], binaryResults[line]);
+        }
+    }
+
+    printf("Method   Compares/Load   usec/Load   nsec/Line\n");
+    printf("Linear   %13llu   %9.1f   %9.1f\n", (unsigned long long)linearCompares,
+           (double)linearTime / loads / 1000., (double)linearTime / loads / lineCount);
+    printf("Binary   %13llu   %9.1f   %9.1f\n", (unsigned long long)binaryCompares,
+           (double)binaryTime / loads / 1000., (double)binaryTime / loads / lineCount);
+    printf("Speedup: %.1fx, %d errors\n", (double)linearTime / (double)binaryTime, errors);
+
+    free(linearResults);
+    free(binaryResults);
+    free(lines);
+    return errors ? -1 : 0;
+}
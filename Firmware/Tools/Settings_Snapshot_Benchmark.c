@@ -0,0 +1,525 @@
+//------------------------------------------------------------------------------
+// Settings_Snapshot_Benchmark.c
+//
+// Program to compare the cost of saving and loading the settings as a clear
+// text file with the cost of saving and loading the binary settings snapshot
+// on Linux.
+//
+// The setting names, types and qualifiers are read from the
+// rtkSettingsEntries table in settings.h, keeping the first entry for the
+// names used by multiple GNSS receivers.  The character arrays use the
+// qualifier as the length, the suffix settings are modeled as four 32-bit
+// values and the remaining settings are modeled as a single 32-bit value.
+//
+// The text save formats each setting as name=value like
+// recordSystemSettingsToFile.  The text load splits each line at the equals
+// sign, converts the value with strtod and locates the setting with a binary
+// search of the sorted names like parseLine.  The snapshot create copies each
+// setting into an entry (ID, length, data) and computes the CRC-32 like
+// settingsSnapshotCreate.  The snapshot load verifies the CRC-32 and copies
+// the entries into the settings like settingsSnapshotApply.  Both loads must
+// restore the original settings.
+//
+// Usage: Settings_Snapshot_Benchmark [settings.h [loads]]
+//
+//      The defaults read ../RTK_Everywhere/settings.h and save and load the
+//      settings 100 times.
+//
+// Returns zero when both loads restore the settings.
+//------------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#define DEFAULT_LOADS               100
+#define DEFAULT_SETTINGS_FILE       "../RTK_Everywhere/settings.h"
+#define DEFAULT_STRING_LENGTH       50
+#define ENTRY_HEADER                (sizeof(uint32_t) + sizeof(uint16_t))
+#define HEADER_LENGTH               60
+#define MAX_ENTRIES                 4096
+#define NAME_LENGTH                 64
+#define NANOSECONDS_IN_A_SECOND     1000000000ull
+#define SUFFIXES                    4
+
+typedef struct _ENTRY
+{
+    char name[NAME_LENGTH];
+    bool string;
+    bool useSuffix;
+    int length;
+    int offset;
+} ENTRY;
+
+ENTRY entries[MAX_ENTRIES];
+int entryCount;
+int16_t sortedIndex[MAX_ENTRIES];
+uint32_t crcTable[256];
+
+uint8_t *settings;
+uint8_t *loadedSettings;
+int settingsLength;
+
+//----------------------------------------
+// Support routines
+//----------------------------------------
+
+// Get the time in nanoseconds
+uint64_t nanoseconds()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * NANOSECONDS_IN_A_SECOND) + now.tv_nsec;
+}
+
+// Build the CRC-32 table, same polynomial as esp_rom_crc32_le
+void crcBegin()
+{
+    uint32_t crc;
+
+    for (uint32_t index = 0; index < 256; index++)
+    {
+        crc = index;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xedb88320 : 0);
+        crcTable[index] = crc;
+    }
+}
+
+// Compute the CRC-32, same as esp_rom_crc32_le
+uint32_t crc32(uint32_t crc, const uint8_t *data, size_t length)
+{
+    crc = ~crc;
+    while (length--)
+        crc = crcTable[(crc ^ *data++) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+// Compute the entry ID, FNV-1a hash like settingsSnapshotId
+uint32_t entryId(const char *name)
+{
+    uint32_t id;
+
+    id = 2166136261u;
+    while (*name)
+    {
+        id ^= (uint8_t)*name++;
+        id *= 16777619u;
+    }
+    return id;
+}
+
+// Compare two entries ignoring case, like commandIndexFill
+int sortCompare(const void *a, const void *b)
+{
+    return strcasecmp(entries[*(const int16_t *)a].name, entries[*(const int16_t *)b].name);
+}
+
+// Locate the setting with a binary search of the sorted names
+int lookup(const char *name)
+{
+    int compare;
+    int high;
+    int low;
+    int middle;
+
+    low = 0;
+    high = entryCount - 1;
+    while (low <= high)
+    {
+        middle = (low + high) / 2;
+        compare = strcasecmp(name, entries[sortedIndex[middle]].name);
+        if (compare == 0)
+            return sortedIndex[middle];
+        if (compare < 0)
+            high = middle - 1;
+        else
+            low = middle + 1;
+    }
+    return -1;
+}
+
+//----------------------------------------
+// Read the rtkSettingsEntries table
+//----------------------------------------
+
+// Read the setting names, types and qualifiers from settings.h
+bool readSettingsTable(const char *fileName)
+{
+    char buffer[1024];
+    FILE *file;
+    char facetFp[16];
+    int flags[8];
+    char *name;
+    char *nameEnd;
+    char qualifier[64];
+    char *text;
+    char type[32];
+
+    file = fopen(fileName, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "ERROR: Unable to open %s\n", fileName);
+        return false;
+    }
+
+    // Each table entry starts with { inWebConfig, inCommands, useSuffix, ...
+    while (fgets(buffer, sizeof(buffer), file))
+    {
+        text = buffer;
+        while ((*text == ' ') || (*text == '\t'))
+            text++;
+        if (sscanf(text, "{ %d, %d, %d, %d, %d, %d, %d, %15[A-Z0-9], %d, %31[A-Za-z0-9_], %63[^,],", &flags[0],
+                   &flags[1], &flags[2], &flags[3], &flags[4], &flags[5], &flags[6], facetFp, &flags[7], type,
+                   qualifier) != 11)
+            continue;
+        if (strstr(text, "& settings.") == NULL)
+            continue;
+
+        // Get the setting name
+        name = strchr(text, '"');
+        if (name == NULL)
+            continue;
+        name++;
+        nameEnd = strchr(name, '"');
+        if ((nameEnd == NULL) || ((nameEnd - name) >= NAME_LENGTH))
+            continue;
+        *nameEnd = 0;
+
+        // Keep the first entry of the names used by multiple GNSS receivers
+        int index;
+        for (index = 0; index < entryCount; index++)
+            if (strcmp(entries[index].name, name) == 0)
+                break;
+        if (index < entryCount)
+            continue;
+
+        if (entryCount >= MAX_ENTRIES)
+            break;
+        strcpy(entries[entryCount].name, name);
+        entries[entryCount].useSuffix = flags[2];
+        entries[entryCount].string = (strcmp(type, "tCharArry") == 0);
+        if (entries[entryCount].string)
+        {
+            entries[entryCount].length = atoi(qualifier);
+            if (entries[entryCount].length <= 1)
+                entries[entryCount].length = DEFAULT_STRING_LENGTH;
+        }
+        else if (entries[entryCount].useSuffix)
+            entries[entryCount].length = SUFFIXES * sizeof(int32_t);
+        else
+            entries[entryCount].length = sizeof(int32_t);
+        entries[entryCount].offset = settingsLength;
+        settingsLength += entries[entryCount].length;
+        entryCount++;
+    }
+    fclose(file);
+    return (entryCount > 0);
+}
+
+// Sort the names and fill in the setting values
+bool buildTables()
+{
+    int32_t value;
+
+    for (int index = 0; index < entryCount; index++)
+        sortedIndex[index] = index;
+    qsort(sortedIndex, entryCount, sizeof(sortedIndex[0]), sortCompare);
+
+    settings = calloc(1, settingsLength);
+    loadedSettings = calloc(1, settingsLength);
+    if ((settings == NULL) || (loadedSettings == NULL))
+    {
+        fprintf(stderr, "ERROR: Unable to allocate the settings\n");
+        return false;
+    }
+
+    // Fill in the values
+    srand(1);
+    for (int index = 0; index < entryCount; index++)
+    {
+        uint8_t *data = &settings[entries[index].offset];
+        if (entries[index].string)
+        {
+            int length = rand() % entries[index].length;
+            for (int x = 0; x < length; x++)
+                data[x] = 'a' + (rand() % 26);
+        }
+        else
+            for (int x = 0; x < entries[index].length; x += sizeof(value))
+            {
+                value = (rand() % 2000000) - 1000000;
+                memcpy(&data[x], &value, sizeof(value));
+            }
+    }
+    return true;
+}
+
+//----------------------------------------
+// Clear text settings file
+//----------------------------------------
+
+// Write the settings as name=value lines, returns the file length
+int textSave(char *file, int fileLength)
+{
+    int length;
+    int32_t value;
+
+    length = 0;
+    for (int index = 0; index < entryCount; index++)
+    {
+        const uint8_t *data = &settings[entries[index].offset];
+        if (entries[index].string)
+            length += snprintf(&file[length], fileLength - length, "%s=%s\r\n", entries[index].name,
+                               (const char *)data);
+        else if (entries[index].useSuffix)
+            for (int suffix = 0; suffix < SUFFIXES; suffix++)
+            {
+                memcpy(&value, &data[suffix * sizeof(value)], sizeof(value));
+                length += snprintf(&file[length], fileLength - length, "%s%d=%d\r\n", entries[index].name, suffix,
+                                   value);
+            }
+        else
+        {
+            memcpy(&value, data, sizeof(value));
+            length += snprintf(&file[length], fileLength - length, "%s=%d\r\n", entries[index].name, value);
+        }
+    }
+    return length;
+}
+
+// Parse the name=value lines, returns the number of unknown lines
+int textLoad(char *file)
+{
+    double d;
+    char line[256];
+    int lineLength;
+    char name[NAME_LENGTH];
+    char *next;
+    int nameLength;
+    int index;
+    int suffix;
+    int unknown;
+    char *value;
+    int32_t number;
+
+    unknown = 0;
+    for (char *text = file; *text; text = next)
+    {
+        // Get the line
+        next = strstr(text, "\r\n");
+        lineLength = next ? (next - text) : (int)strlen(text);
+        next = next ? next + 2 : text + lineLength;
+        if (lineLength >= (int)sizeof(line))
+            lineLength = sizeof(line) - 1;
+        memcpy(line, text, lineLength);
+        line[lineLength] = 0;
+
+        // Split the line at the equals sign
+        value = strchr(line, '=');
+        if (value == NULL)
+        {
+            unknown++;
+            continue;
+        }
+        *value++ = 0;
+        d = strtod(value, NULL);
+
+        // Locate the setting, then remove the suffix
+        suffix = -1;
+        index = lookup(line);
+        if (index < 0)
+        {
+            nameLength = strlen(line) - 1;
+            if ((nameLength < 1) || (nameLength >= NAME_LENGTH))
+            {
+                unknown++;
+                continue;
+            }
+            memcpy(name, line, nameLength);
+            name[nameLength] = 0;
+            suffix = line[nameLength] - '0';
+            index = lookup(name);
+            if ((index < 0) || (!entries[index].useSuffix) || (suffix < 0) || (suffix >= SUFFIXES))
+            {
+                unknown++;
+                continue;
+            }
+        }
+
+        // Update the setting
+        uint8_t *data = &loadedSettings[entries[index].offset];
+        if (entries[index].string)
+        {
+            memset(data, 0, entries[index].length);
+            strncpy((char *)data, value, entries[index].length - 1);
+        }
+        else
+        {
+            number = (int32_t)d;
+            memcpy(&data[(suffix < 0) ? 0 : suffix * sizeof(number)], &number, sizeof(number));
+        }
+    }
+    return unknown;
+}
+
+//----------------------------------------
+// Binary settings snapshot
+//----------------------------------------
+
+// Build the snapshot, returns the snapshot length
+int snapshotCreate(uint8_t *snapshot)
+{
+    uint32_t crc;
+    uint32_t id;
+    uint16_t length;
+    uint8_t *data;
+
+    data = &snapshot[HEADER_LENGTH];
+    for (int index = 0; index < entryCount; index++)
+    {
+        id = entryId(entries[index].name);
+        length = entries[index].length;
+        memcpy(data, &id, sizeof(id));
+        memcpy(&data[sizeof(id)], &length, sizeof(length));
+        memcpy(&data[ENTRY_HEADER], &settings[entries[index].offset], length);
+        data += ENTRY_HEADER + length;
+    }
+    memset(snapshot, 0, HEADER_LENGTH);
+    crc = crc32(0, snapshot, data - snapshot);
+    memcpy(snapshot, &crc, sizeof(crc));
+    return data - snapshot;
+}
+
+// Verify and apply the snapshot, returns the number of unknown entries
+int snapshotLoad(const uint8_t *snapshot, int snapshotLength)
+{
+    uint32_t crc;
+    const uint8_t *data;
+    int entry;
+    uint32_t id;
+    int index;
+    uint16_t length;
+    int unknown;
+    uint8_t header[HEADER_LENGTH];
+
+    // Verify the CRC
+    memcpy(header, snapshot, HEADER_LENGTH);
+    memcpy(&crc, header, sizeof(crc));
+    memset(header, 0, sizeof(crc));
+    if (crc32(crc32(0, header, HEADER_LENGTH), &snapshot[HEADER_LENGTH], snapshotLength - HEADER_LENGTH) != crc)
+        return entryCount;
+
+    // Walk the entries, the entries are in table order
+    unknown = 0;
+    entry = 0;
+    for (data = &snapshot[HEADER_LENGTH]; (data + ENTRY_HEADER) <= &snapshot[snapshotLength];
+         data += ENTRY_HEADER + length)
+    {
+        memcpy(&id, data, sizeof(id));
+        memcpy(&length, &data[sizeof(id)], sizeof(length));
+        for (index = 0; index < entryCount; index++)
+        {
+            if (entryId(entries[entry].name) == id)
+                break;
+            entry = (entry + 1) % entryCount;
+        }
+        if ((index >= entryCount) || (length != entries[entry].length))
+        {
+            unknown++;
+            continue;
+        }
+        memcpy(&loadedSettings[entries[entry].offset], &data[ENTRY_HEADER], length);
+        entry = (entry + 1) % entryCount;
+    }
+    return unknown;
+}
+
+//----------------------------------------
+// Benchmark
+//----------------------------------------
+
+int main(int argc, char **argv)
+{
+    int errors;
+    char *file;
+    int fileLength;
+    int loads;
+    uint8_t *snapshot;
+    int snapshotLength;
+    const char *settingsFile;
+    uint64_t startTime;
+    uint64_t textLoadTime;
+    uint64_t textSaveTime;
+    int textErrors;
+    uint64_t snapshotCreateTime;
+    uint64_t snapshotLoadTime;
+    int snapshotErrors;
+
+    settingsFile = (argc > 1) ? argv[1] : DEFAULT_SETTINGS_FILE;
+    loads = (argc > 2) ? atoi(argv[2]) : DEFAULT_LOADS;
+    if (loads <= 0)
+    {
+        fprintf(stderr, "ERROR: Invalid number of loads\n");
+        return -1;
+    }
+
+    crcBegin();
+    if ((!readSettingsTable(settingsFile)) || (!buildTables()))
+        return -1;
+    printf("%d settings, %d bytes of settings, %d loads\n", entryCount, settingsLength, loads);
+
+    fileLength = entryCount * (NAME_LENGTH + 16) * SUFFIXES + settingsLength;
+    file = malloc(fileLength);
+    snapshot = malloc(HEADER_LENGTH + (entryCount * ENTRY_HEADER) + settingsLength);
+    if ((file == NULL) || (snapshot == NULL))
+    {
+        fprintf(stderr, "ERROR: Unable to allocate the buffers\n");
+        return -1;
+    }
+
+    // Time the clear text settings file
+    startTime = nanoseconds();
+    for (int load = 0; load < loads; load++)
+        fileLength = textSave(file, fileLength);
+    textSaveTime = nanoseconds() - startTime;
+    startTime = nanoseconds();
+    for (int load = 0; load < loads; load++)
+        textErrors = textLoad(file);
+    textLoadTime = nanoseconds() - startTime;
+    if (memcmp(settings, loadedSettings, settingsLength))
+        textErrors++;
+
+    // Time the binary settings snapshot
+    memset(loadedSettings, 0, settingsLength);
+    startTime = nanoseconds();
+    for (int load = 0; load < loads; load++)
+        snapshotLength = snapshotCreate(snapshot);
+    snapshotCreateTime = nanoseconds() - startTime;
+    startTime = nanoseconds();
+    for (int load = 0; load < loads; load++)
+        snapshotErrors = snapshotLoad(snapshot, snapshotLength);
+    snapshotLoadTime = nanoseconds() - startTime;
+    if (memcmp(settings, loadedSettings, settingsLength))
+        snapshotErrors++;
+
+    errors = textErrors + snapshotErrors;
+    printf("Method     File Bytes   Save usec   Load usec   Errors\n");
+    printf("Text       %10d   %9.1f   %9.1f   %6d\n", fileLength, (double)textSaveTime / loads / 1000.,
+           (double)textLoadTime / loads / 1000., textErrors);
+    printf("Snapshot   %10d   %9.1f   %9.1f   %6d\n", snapshotLength, (double)snapshotCreateTime / loads / 1000.,
+           (double)snapshotLoadTime / loads / 1000., snapshotErrors);
+    printf("Load speedup: %.1fx, file size: %.0f%%, %d errors\n", (double)textLoadTime / (double)snapshotLoadTime,
+           100. * snapshotLength / fileLength, errors);
+
+    free(file);
+    free(snapshot);
+    free(settings);
+    free(loadedSettings);
+    return errors ? -1 : 0;
+}